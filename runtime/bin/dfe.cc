@@ -3,9 +3,18 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "bin/dfe.h"
+
+#include <ctype.h>
+
 #include "bin/dartutils.h"
+#include "bin/directory.h"
 #include "bin/error_exit.h"
 #include "bin/file.h"
+#include "bin/lockers.h"
+#include "bin/log.h"
+#include "bin/process.h"
+#include "bin/thread.h"
+#include "platform/text_buffer.h"
 
 #include "vm/kernel.h"
 
@@ -15,12 +24,27 @@ namespace bin {
 const char kPlatformBinaryName[] = "platform.dill";
 const char kVMServiceIOBinaryName[] = "vmservice_io.dill";
 
+// The kernel files mapped into memory by TryReadKernelFile, so that
+// ReleaseMappedBytes can find the mapping of a buffer.
+struct MappedKernelFile {
+  MappedMemory* mapping;
+  MappedKernelFile* next;
+};
+static MappedKernelFile* mapped_kernel_files = NULL;
+static Mutex* mapped_kernel_files_mutex = NULL;
+
 DFE::DFE()
     : frontend_filename_(NULL),
       platform_binary_filename_(NULL),
       vmservice_io_binary_filename_(NULL),
       kernel_platform_(NULL),
-      kernel_file_specified_(false) {}
+      kernel_file_specified_(false),
+      kernel_cache_directory_(NULL),
+      trace_kernel_cache_(false) {
+  if (mapped_kernel_files_mutex == NULL) {
+    mapped_kernel_files_mutex = new Mutex();
+  }
+}
 
 DFE::~DFE() {
   frontend_filename_ = NULL;
@@ -56,6 +80,516 @@ static void ReleaseFetchedBytes(uint8_t* buffer) {
   free(buffer);
 }
 
+static void ReleaseMappedBytes(uint8_t* buffer) {
+  MutexLocker ml(mapped_kernel_files_mutex);
+  for (MappedKernelFile** link = &mapped_kernel_files; *link != NULL;
+       link = &(*link)->next) {
+    MappedKernelFile* file = *link;
+    if (file->mapping->address() == buffer) {
+      *link = file->next;
+      delete file->mapping;
+      delete file;
+      return;
+    }
+  }
+  UNREACHABLE();
+}
+
+// Scripts compiled by CompileAndReadScript are cached in the kernel cache
+// directory, keyed by a hash of what the compilation depends on besides the
+// sources: the VM version, the script, the platform binary and the .packages
+// file the front end finds for the script. An entry consists of
+//
+//   <key>.dill  the kernel binary, which is mapped into memory on a hit.
+//   <key>.deps  a line "<mtime> <hash> <path>" for each source file the
+//               kernel binary was compiled from.
+//
+// An entry is up to date if each source file still has the recorded
+// modification time, or failing that the recorded contents hash. The stamps
+// of an entry are taken before the front end reads the sources, so a file
+// edited during compilation makes the entry stale. Files are written under a
+// temporary name and renamed into place, so VMs sharing the cache never read
+// a partially written entry. The numbers of hits and misses are accumulated
+// in the file "stats" of the cache directory.
+class KernelCache {
+ public:
+  KernelCache(const char* directory,
+              const char* script_uri,
+              const char* platform_filename,
+              bool trace);
+  ~KernelCache();
+
+  // The kernel file of the entry for the script, or NULL if the script is not
+  // cached.
+  const char* kernel_path() const { return kernel_path_; }
+
+  // Returns whether the entry for the script is up to date, and deletes it if
+  // it is stale.
+  bool IsUpToDate();
+
+  void RecordLookup(bool hit);
+
+  // Stamps the script and the sources of the previous entry. Called before
+  // compiling the script.
+  void StampSources();
+
+  // Caches |kernel|, the kernel binary |program| was read from.
+  void Store(const uint8_t* kernel, intptr_t size, kernel::Program* program);
+
+ private:
+  // The modification time and contents hash of a source file.
+  struct Stamp {
+    char* path;
+    int64_t mtime;
+    uint64_t hash;
+    Stamp* next;
+  };
+
+  char* EntryPath(const char* key, const char* suffix);
+  void AddStamp(const char* path);
+  Stamp* FindStamp(const char* path) const;
+
+  const char* directory_;
+  char* script_path_;
+  char* kernel_path_;
+  char* deps_path_;
+  // The dependencies of the entry IsUpToDate found stale.
+  char* stale_deps_;
+  Stamp* stamps_;
+  // The modification time of a file written just before compiling, or -1.
+  // Sources first seen after compiling must be older.
+  int64_t compile_start_;
+  bool trace_;
+
+  DISALLOW_COPY_AND_ASSIGN(KernelCache);
+};
+
+// 64-bit FNV-1a.
+static const uint64_t kHashSeed = DART_UINT64_C(0xcbf29ce484222325);
+static const uint64_t kHashPrime = DART_UINT64_C(0x100000001b3);
+
+static uint64_t HashBytes(uint64_t hash, const void* data, intptr_t length) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  for (intptr_t i = 0; i < length; i++) {
+    hash = (hash ^ bytes[i]) * kHashPrime;
+  }
+  return hash;
+}
+
+// Includes the terminating NUL, so that consecutive strings are delimited.
+static uint64_t HashString(uint64_t hash, const char* str) {
+  return HashBytes(hash, str, strlen(str) + 1);
+}
+
+static uint64_t HashInt(uint64_t hash, int64_t value) {
+  return HashBytes(hash, &value, sizeof(value));
+}
+
+// Parses the line of an entry's dependencies at |*line| and advances |*line|
+// past it. Returns false at the end of the dependencies or on a malformed
+// line.
+static bool ParseDependency(char** line,
+                            int64_t* mtime,
+                            uint64_t* hash,
+                            const char** path) {
+  char* end = strchr(*line, '\n');
+  int path_start = 0;
+  if ((end == NULL) ||
+      (sscanf(*line, "%" Pd64 " %" Px64 " %n", mtime, hash, &path_start) <
+       2) ||
+      (path_start == 0)) {
+    return false;
+  }
+  *end = '\0';
+  *path = *line + path_start;
+  *line = end + 1;
+  return true;
+}
+
+// Returns the contents of a file in a malloc()ed buffer followed by a NUL, or
+// NULL if it cannot be read.
+static char* ReadFileContents(const char* path, intptr_t* length) {
+  File* file = File::Open(NULL, path, File::kRead);
+  if (file == NULL) {
+    return NULL;
+  }
+  char* contents = NULL;
+  int64_t file_length = file->Length();
+  if ((file_length >= 0) && (file_length < kIntptrMax)) {
+    contents = reinterpret_cast<char*>(malloc(file_length + 1));
+    if (file->ReadFully(contents, file_length)) {
+      contents[file_length] = '\0';
+      *length = file_length;
+    } else {
+      free(contents);
+      contents = NULL;
+    }
+  }
+  file->Release();
+  return contents;
+}
+
+static bool WriteFileAtomically(const char* path,
+                                const void* data,
+                                intptr_t length) {
+  TextBuffer temp_path(256);
+  temp_path.Printf("%s.%" Pd ".tmp", path, Process::CurrentProcessId());
+  File* file = File::Open(NULL, temp_path.buf(), File::kWriteTruncate);
+  if (file == NULL) {
+    return false;
+  }
+  bool written = file->WriteFully(data, length);
+  file->Release();
+  if (written && File::Rename(NULL, temp_path.buf(), path)) {
+    return true;
+  }
+  File::Delete(NULL, temp_path.buf());
+  return false;
+}
+
+// Returns the file system path of a script or source URI in a malloc()ed
+// string, or NULL if it does not name a local file.
+static char* UriToPath(const char* uri, intptr_t length) {
+  static const char kFileScheme[] = "file://";
+  static const intptr_t kFileSchemeLength = sizeof(kFileScheme) - 1;
+  if ((length > kFileSchemeLength) &&
+      (strncmp(uri, kFileScheme, kFileSchemeLength) == 0)) {
+    uri += kFileSchemeLength;
+    length -= kFileSchemeLength;
+#if defined(HOST_OS_WINDOWS)
+    // Drop the '/' before the drive letter of "file:///C:/...".
+    if (uri[0] == '/') {
+      uri++;
+      length--;
+    }
+#endif
+    char* path = reinterpret_cast<char*>(malloc(length + 1));
+    intptr_t path_length = 0;
+    for (intptr_t i = 0; i < length; i++) {
+      if ((uri[i] == '%') && (i + 2 < length) && isxdigit(uri[i + 1]) &&
+          isxdigit(uri[i + 2])) {
+        char hex[3] = {uri[i + 1], uri[i + 2], '\0'};
+        path[path_length++] = static_cast<char>(strtol(hex, NULL, 16));
+        i += 2;
+      } else {
+        path[path_length++] = uri[i];
+      }
+    }
+    path[path_length] = '\0';
+    return path;
+  }
+  // Other schemes, such as dart: and package:, are at least two characters
+  // long, which tells them apart from drive letters.
+  for (intptr_t i = 0; (i < length) && (uri[i] != '/') && (uri[i] != '\\');
+       i++) {
+    if ((uri[i] == ':') && (i > 1)) {
+      return NULL;
+    }
+  }
+  if (length == 0) {
+    return NULL;
+  }
+  TextBuffer path(256);
+  path.AddRaw(reinterpret_cast<const uint8_t*>(uri), length);
+  if (!File::IsAbsolutePath(path.buf())) {
+    char* current = Directory::CurrentNoScope();
+    if (current == NULL) {
+      return NULL;
+    }
+    TextBuffer absolute_path(256);
+    absolute_path.Printf("%s%s%s", current, File::PathSeparator(), path.buf());
+    free(current);
+    return absolute_path.Steal();
+  }
+  return path.Steal();
+}
+
+// Returns the .packages file in the directory of the script or the closest
+// parent directory, as the front end would, or NULL if there is none.
+static char* FindPackagesFile(const char* script_path) {
+  const char separator = File::PathSeparator()[0];
+  char* directory = strdup(script_path);
+  char* end = strrchr(directory, separator);
+  while (end != NULL) {
+    *end = '\0';
+    TextBuffer packages_path(256);
+    packages_path.Printf("%s%c.packages", directory, separator);
+    if (File::Exists(NULL, packages_path.buf())) {
+      free(directory);
+      return packages_path.Steal();
+    }
+    end = strrchr(directory, separator);
+  }
+  free(directory);
+  return NULL;
+}
+
+KernelCache::KernelCache(const char* directory,
+                         const char* script_uri,
+                         const char* platform_filename,
+                         bool trace)
+    : directory_(directory),
+      script_path_(NULL),
+      kernel_path_(NULL),
+      deps_path_(NULL),
+      stale_deps_(NULL),
+      stamps_(NULL),
+      compile_start_(-1),
+      trace_(trace) {
+  if (directory == NULL) {
+    return;
+  }
+  script_path_ = UriToPath(script_uri, strlen(script_uri));
+  if (script_path_ == NULL) {
+    return;
+  }
+  uint64_t hash = HashString(kHashSeed, Dart_VersionString());
+  hash = HashString(hash, script_path_);
+  // The platform binary is large and only changes when the SDK is updated,
+  // so it is identified by its modification time and size.
+  if (platform_filename != NULL) {
+    int64_t stat[File::kStatSize];
+    File::Stat(NULL, platform_filename, stat);
+    hash = HashString(hash, platform_filename);
+    hash = HashInt(hash, stat[File::kModifiedTime]);
+    hash = HashInt(hash, stat[File::kSize]);
+  }
+  char* packages_path = FindPackagesFile(script_path_);
+  if (packages_path != NULL) {
+    intptr_t length = 0;
+    char* packages = ReadFileContents(packages_path, &length);
+    hash = HashString(hash, packages_path);
+    if (packages != NULL) {
+      hash = HashBytes(hash, packages, length);
+      free(packages);
+    }
+    free(packages_path);
+  }
+  TextBuffer key(32);
+  key.Printf("%016" Px64, hash);
+  kernel_path_ = EntryPath(key.buf(), ".dill");
+  deps_path_ = EntryPath(key.buf(), ".deps");
+}
+
+KernelCache::~KernelCache() {
+  free(script_path_);
+  free(kernel_path_);
+  free(deps_path_);
+  free(stale_deps_);
+  while (stamps_ != NULL) {
+    Stamp* next = stamps_->next;
+    free(stamps_->path);
+    delete stamps_;
+    stamps_ = next;
+  }
+}
+
+char* KernelCache::EntryPath(const char* key, const char* suffix) {
+  TextBuffer path(256);
+  path.Printf("%s%s%s%s", directory_, File::PathSeparator(), key, suffix);
+  return path.Steal();
+}
+
+bool KernelCache::IsUpToDate() {
+  if (deps_path_ == NULL) {
+    return false;
+  }
+  intptr_t length = 0;
+  char* deps = ReadFileContents(deps_path_, &length);
+  if (deps == NULL) {
+    return false;
+  }
+  // The dependencies with the current modification times, which are written
+  // back if a file was touched without changing its contents.
+  TextBuffer updated_deps(length + 1);
+  bool touched = false;
+  bool up_to_date = true;
+  // Parsing modifies the buffer, so keep a copy for StampSources.
+  stale_deps_ = strdup(deps);
+  for (char* line = deps; up_to_date && (*line != '\0');) {
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+    const char* path = NULL;
+    if (!ParseDependency(&line, &mtime, &hash, &path)) {
+      up_to_date = false;
+      break;
+    }
+    int64_t stat[File::kStatSize];
+    File::Stat(NULL, path, stat);
+    if (stat[File::kType] != File::kIsFile) {
+      up_to_date = false;
+    } else if (stat[File::kModifiedTime] != mtime) {
+      intptr_t size = 0;
+      char* contents = ReadFileContents(path, &size);
+      up_to_date =
+          (contents != NULL) && (HashBytes(kHashSeed, contents, size) == hash);
+      free(contents);
+      mtime = stat[File::kModifiedTime];
+      touched = true;
+    }
+    if (!up_to_date && trace_) {
+      Log::PrintErr("Kernel cache: %s has changed\n", path);
+    }
+    updated_deps.Printf("%" Pd64 " %016" Px64 " %s\n", mtime, hash, path);
+  }
+  free(deps);
+  if (!up_to_date) {
+    File::Delete(NULL, deps_path_);
+    File::Delete(NULL, kernel_path_);
+    return false;
+  }
+  if (touched) {
+    WriteFileAtomically(deps_path_, updated_deps.buf(), updated_deps.length());
+  }
+  free(stale_deps_);
+  stale_deps_ = NULL;
+  return true;
+}
+
+void KernelCache::RecordLookup(bool hit) {
+  if (script_path_ == NULL) {
+    return;
+  }
+  TextBuffer stats_path(256);
+  stats_path.Printf("%s%sstats", directory_, File::PathSeparator());
+  int64_t hits = 0;
+  int64_t misses = 0;
+  intptr_t length = 0;
+  char* stats = ReadFileContents(stats_path.buf(), &length);
+  if (stats != NULL) {
+    if (sscanf(stats, "%" Pd64 " %" Pd64, &hits, &misses) != 2) {
+      hits = misses = 0;
+    }
+    free(stats);
+  }
+  if (hit) {
+    hits++;
+  } else {
+    misses++;
+  }
+  TextBuffer updated_stats(64);
+  updated_stats.Printf("%" Pd64 " %" Pd64 "\n", hits, misses);
+  Directory::Create(NULL, directory_);
+  WriteFileAtomically(stats_path.buf(), updated_stats.buf(),
+                      updated_stats.length());
+  if (trace_) {
+    Log::PrintErr("Kernel cache: %s for %s (%" Pd64 " hits, %" Pd64
+                  " misses, %.1f%% hit rate)\n",
+                  hit ? "hit" : "miss", script_path_, hits, misses,
+                  (100.0 * hits) / (hits + misses));
+  }
+}
+
+void KernelCache::AddStamp(const char* path) {
+  if (FindStamp(path) != NULL) {
+    return;
+  }
+  int64_t stat[File::kStatSize];
+  File::Stat(NULL, path, stat);
+  if (stat[File::kType] != File::kIsFile) {
+    return;
+  }
+  intptr_t length = 0;
+  char* contents = ReadFileContents(path, &length);
+  if (contents == NULL) {
+    return;
+  }
+  Stamp* stamp = new Stamp();
+  stamp->path = strdup(path);
+  stamp->mtime = stat[File::kModifiedTime];
+  stamp->hash = HashBytes(kHashSeed, contents, length);
+  stamp->next = stamps_;
+  stamps_ = stamp;
+  free(contents);
+}
+
+KernelCache::Stamp* KernelCache::FindStamp(const char* path) const {
+  for (Stamp* stamp = stamps_; stamp != NULL; stamp = stamp->next) {
+    if (strcmp(stamp->path, path) == 0) {
+      return stamp;
+    }
+  }
+  return NULL;
+}
+
+void KernelCache::StampSources() {
+  if (kernel_path_ == NULL) {
+    return;
+  }
+  // The stats file was just written by RecordLookup, so its modification time
+  // is the current time of the cache's file system.
+  TextBuffer stats_path(256);
+  stats_path.Printf("%s%sstats", directory_, File::PathSeparator());
+  int64_t stat[File::kStatSize];
+  File::Stat(NULL, stats_path.buf(), stat);
+  if (stat[File::kType] == File::kIsFile) {
+    compile_start_ = stat[File::kModifiedTime];
+  }
+  AddStamp(script_path_);
+  if (stale_deps_ != NULL) {
+    for (char* line = stale_deps_; *line != '\0';) {
+      int64_t mtime = 0;
+      uint64_t hash = 0;
+      const char* path = NULL;
+      if (!ParseDependency(&line, &mtime, &hash, &path)) {
+        break;
+      }
+      AddStamp(path);
+    }
+  }
+}
+
+void KernelCache::Store(const uint8_t* kernel,
+                        intptr_t size,
+                        kernel::Program* program) {
+  if (kernel_path_ == NULL) {
+    return;
+  }
+  TextBuffer deps(1024);
+  const intptr_t source_count = program->source_count();
+  for (intptr_t i = 0; i < source_count; i++) {
+    intptr_t uri_length = 0;
+    const uint8_t* uri = program->SourceUriAt(i, &uri_length);
+    char* path = UriToPath(reinterpret_cast<const char*>(uri), uri_length);
+    if (path == NULL) {
+      continue;
+    }
+    // A source not stamped before compiling is stamped now, which is only
+    // safe if it was not modified since the compilation started.
+    const char* reason = NULL;
+    Stamp* stamp = FindStamp(path);
+    if (stamp == NULL) {
+      AddStamp(path);
+      stamp = FindStamp(path);
+      if (stamp == NULL) {
+        reason = "cannot be read";
+      } else if ((compile_start_ < 0) || (stamp->mtime >= compile_start_)) {
+        reason = "changed during compilation";
+      }
+    }
+    if (reason != NULL) {
+      if (trace_) {
+        Log::PrintErr("Kernel cache: not caching %s, %s %s\n", script_path_,
+                      path, reason);
+      }
+      free(path);
+      return;
+    }
+    deps.Printf("%" Pd64 " %016" Px64 " %s\n", stamp->mtime, stamp->hash,
+                path);
+    free(path);
+  }
+  // The kernel file is written first, so that the dependencies of an entry
+  // never describe an older kernel file.
+  Directory::Create(NULL, directory_);
+  if (!WriteFileAtomically(kernel_path_, kernel, size) ||
+      !WriteFileAtomically(deps_path_, deps.buf(), deps.length())) {
+    if (trace_) {
+      Log::PrintErr("Kernel cache: failed to write %s\n", kernel_path_);
+    }
+  }
+}
+
 Dart_Handle DFE::ReadKernelBinary(Dart_Isolate isolate,
                                   const char* url_string) {
   ASSERT(!Dart_IsServiceIsolate(isolate) && !Dart_IsKernelIsolate(isolate));
@@ -63,7 +597,7 @@ Dart_Handle DFE::ReadKernelBinary(Dart_Isolate isolate,
   // skip the compilation step and directly reload the file.
   const uint8_t* kernel_ir = NULL;
   intptr_t kernel_ir_size = -1;
-  if (!TryReadKernelFile(url_string, &kernel_ir, &kernel_ir_size)) {
+  if (!TryReadKernelFile(url_string, &kernel_ir, &kernel_ir_size, false)) {
     // We have a source file, compile it into a kernel ir first.
     // TODO(asiva): We will have to change this API to pass in a list of files
     // that have changed. For now just pass in the main url_string and have it
@@ -87,14 +621,33 @@ Dart_Handle DFE::ReadKernelBinary(Dart_Isolate isolate,
 void* DFE::CompileAndReadScript(const char* script_uri,
                                 char** error,
                                 int* exit_code) {
+  KernelCache cache(kernel_cache_directory_, script_uri,
+                    platform_binary_filename_, trace_kernel_cache_);
+  if (cache.IsUpToDate()) {
+    const uint8_t* kernel_ir = NULL;
+    intptr_t kernel_ir_size = -1;
+    if (TryReadKernelFile(cache.kernel_path(), &kernel_ir, &kernel_ir_size,
+                          true)) {
+      cache.RecordLookup(true);
+      return Dart_ReadKernelBinary(kernel_ir, kernel_ir_size,
+                                   ReleaseMappedBytes);
+    }
+  }
+  cache.RecordLookup(false);
+  cache.StampSources();
+
   // TODO(aam): When Frontend is ready, VM should be passing outline.dill
   // instead of platform.dill to Frontend for compilation.
   Dart_KernelCompilationResult result =
       Dart_CompileToKernel(script_uri, platform_binary_filename_);
   switch (result.status) {
-    case Dart_KernelCompilationStatus_Ok:
-      return Dart_ReadKernelBinary(result.kernel, result.kernel_size,
-                                   ReleaseFetchedBytes);
+    case Dart_KernelCompilationStatus_Ok: {
+      void* program = Dart_ReadKernelBinary(result.kernel, result.kernel_size,
+                                            ReleaseFetchedBytes);
+      cache.Store(result.kernel, result.kernel_size,
+                  reinterpret_cast<kernel::Program*>(program));
+      return program;
+    }
     case Dart_KernelCompilationStatus_Error:
       *error = result.error;  // Copy error message.
       *exit_code = kCompilationErrorExitCode;
@@ -122,7 +675,7 @@ void* DFE::ReadVMServiceIO() const {
 void* DFE::ReadScript(const char* script_uri) const {
   const uint8_t* buffer = NULL;
   intptr_t buffer_length = -1;
-  bool result = TryReadKernelFile(script_uri, &buffer, &buffer_length);
+  bool result = TryReadKernelFile(script_uri, &buffer, &buffer_length, false);
   if (result) {
     return Dart_ReadKernelBinary(buffer, buffer_length, ReleaseFetchedBytes);
   }
@@ -131,9 +684,40 @@ void* DFE::ReadScript(const char* script_uri) const {
 
 bool DFE::TryReadKernelFile(const char* script_uri,
                             const uint8_t** kernel_ir,
-                            intptr_t* kernel_ir_size) const {
+                            intptr_t* kernel_ir_size,
+                            bool map_file) const {
   *kernel_ir = NULL;
   *kernel_ir_size = -1;
+  if (map_file) {
+    File* file = File::Open(NULL, script_uri, File::kRead);
+    if (file == NULL) {
+      return false;
+    }
+    int64_t length = file->Length();
+    MappedMemory* mapping =
+        (length > 0) ? file->Map(File::kReadOnly, 0, length) : NULL;
+    file->Release();
+    if (mapping == NULL) {
+      return false;
+    }
+    const uint8_t* buffer =
+        reinterpret_cast<const uint8_t*>(mapping->address());
+    if (DartUtils::SniffForMagicNumber(buffer, length) !=
+        DartUtils::kKernelMagicNumber) {
+      delete mapping;
+      return false;
+    }
+    MappedKernelFile* mapped_file = new MappedKernelFile();
+    mapped_file->mapping = mapping;
+    {
+      MutexLocker ml(mapped_kernel_files_mutex);
+      mapped_file->next = mapped_kernel_files;
+      mapped_kernel_files = mapped_file;
+    }
+    *kernel_ir = buffer;
+    *kernel_ir_size = length;
+    return true;
+  }
   void* script_file = DartUtils::OpenFile(script_uri, false);
   if (script_file != NULL) {
     const uint8_t* buffer = NULL;
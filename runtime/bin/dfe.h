@@ -38,6 +38,16 @@ class DFE {
   bool kernel_file_specified() const { return kernel_file_specified_; }
   void set_kernel_file_specified(bool value) { kernel_file_specified_ = value; }
 
+  // Directory in which CompileAndReadScript caches the kernel binaries it
+  // compiles, or NULL if they are not cached.
+  const char* kernel_cache_directory() const { return kernel_cache_directory_; }
+  void set_kernel_cache_directory(const char* directory) {
+    kernel_cache_directory_ = directory;
+  }
+
+  bool trace_kernel_cache() const { return trace_kernel_cache_; }
+  void set_trace_kernel_cache(bool value) { trace_kernel_cache_ = value; }
+
   // Method to read a kernel file into a kernel program blob.
   // If the specified script [url] is not a kernel IR, compile it first using
   // DFE and then read the resulting kernel file into a kernel program blob.
@@ -48,6 +58,8 @@ class DFE {
   // If the compilation is successful, returns a valid in memory kernel
   // representation of the script, NULL otherwise
   // 'error' and 'exit_code' have the error values in case of errors.
+  // If a kernel cache directory is set, an up to date kernel file cached
+  // by an earlier compilation of the script is read instead.
   void* CompileAndReadScript(const char* script_uri,
                              char** error,
                              int* exit_code);
@@ -71,15 +83,21 @@ class DFE {
   // to be the kernel IR contents.
   // The caller is responsible for free()ing [kernel_file] if `true`
   // was returned.
+  // If [map_file] is true, the file is mapped into memory instead of read,
+  // and the caller is responsible for releasing [kernel_file] with
+  // ReleaseMappedBytes.
   bool TryReadKernelFile(const char* script_uri,
                          const uint8_t** kernel_ir,
-                         intptr_t* kernel_ir_size) const;
+                         intptr_t* kernel_ir_size,
+                         bool map_file) const;
 
   const char* frontend_filename_;
   char* platform_binary_filename_;
   char* vmservice_io_binary_filename_;
   void* kernel_platform_;
   bool kernel_file_specified_;  // Kernel file was specified on the cmd line.
+  const char* kernel_cache_directory_;
+  bool trace_kernel_cache_;
 
   DISALLOW_COPY_AND_ASSIGN(DFE);
 };
@@ -70,6 +70,13 @@ DEFINE_STRING_OPTION_CB(dfe, { Options::dfe()->set_frontend_filename(value); });
 
 DEFINE_STRING_OPTION_CB(kernel_binaries,
                         { Options::dfe()->SetKernelBinaries(value); });
+
+DEFINE_STRING_OPTION_CB(kernel_cache, {
+  Options::dfe()->set_kernel_cache_directory(value);
+});
+
+DEFINE_BOOL_OPTION_CB(trace_kernel_cache,
+                      { Options::dfe()->set_trace_kernel_cache(true); });
 #endif  // !defined(DART_PRECOMPILED_RUNTIME)
 
 DEFINE_BOOL_OPTION_CB(hot_reload_test_mode, {
@@ -177,6 +184,13 @@ void Options::PrintUsage() {
 "--trace-loading\n"
 "  enables tracing of library and script loading\n"
 "\n"
+"--kernel-cache=<directory>\n"
+"  caches the kernel binaries compiled from scripts by --dfe in <directory>\n"
+"  and reuses them while the sources are unchanged\n"
+"\n"
+"--trace-kernel-cache\n"
+"  enables tracing of kernel cache lookups and hit rate\n"
+"\n"
 "--enable-vm-service[=<port>[/<bind-address>]]\n"
 "  enables the VM service and listens on specified port for connections\n"
 "  (default port number is 8181, default bind address is localhost).\n"
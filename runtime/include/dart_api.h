@@ -938,6 +938,21 @@ DART_EXPORT void Dart_EnterIsolate(Dart_Isolate isolate);
  */
 DART_EXPORT void Dart_NotifyIdle(int64_t deadline);
 
+/**
+ * Notifies the VM that the embedder expects to be idle for the next
+ * |budget_micros| microseconds, like Dart_NotifyIdle.
+ *
+ * When a full garbage collection would not fit in the budget, the VM may mark
+ * the heap incrementally, over several idle notifications, with a short final
+ * pause when marking is done.
+ *
+ * Returns true if the VM has more garbage collection work to do in idle time,
+ * in which case the embedder should report its next idle period as well.
+ *
+ * Requires there to be a current isolate.
+ */
+DART_EXPORT bool Dart_NotifyIdleBudget(int64_t budget_micros);
+
 /**
  * Notifies the VM that the current thread should not be profiled until a
  * matching call to Dart_ThreadEnableProfiling is made.
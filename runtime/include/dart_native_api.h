@@ -94,6 +94,15 @@ typedef struct _Dart_CObject {
  * data. When the message has been sent the graph will be fully
  * restored.
  *
+ * The data of Dart_CObject_kExternalTypedData objects is not copied.
+ * If the message is posted, ownership of the data passes to the receiver:
+ * - An isolate receives the data as an external typed data object and calls
+ *   'callback' with 'peer' when that object is collected.
+ * - A native port receives it as Dart_CObject_kExternalTypedData and is
+ *   responsible for calling 'callback' with 'peer' when it is done with
+ *   the data.
+ * If the message is not posted, the caller keeps ownership of the data.
+ *
  * \param port_id The destination port.
  * \param message The message to send.
  *
@@ -120,7 +129,13 @@ DART_EXPORT bool Dart_PostInteger(Dart_Port port_id, int64_t message);
  * The message received is decoded into the message structure. The
  * lifetime of the message data is controlled by the caller. All the
  * data references from the message are allocated by the caller and
- * will be reclaimed when returning to it.
+ * will be reclaimed when returning to it. The contents of byte typed data
+ * (Int8, Uint8 and Uint8Clamped) point directly into the received message
+ * and are not copied.
+ *
+ * Dart_CObject_kExternalTypedData objects are only received from
+ * Dart_PostCObject, and their data is owned by the handler (see
+ * Dart_PostCObject).
  */
 
 typedef void (*Dart_NativeMessageHandler)(Dart_Port dest_port_id,
@@ -1003,6 +1003,69 @@ typedef void (*Dart_StreamConsumer)(Dart_StreamConsumer_State state,
 DART_EXPORT bool Dart_GlobalTimelineGetTrace(Dart_StreamConsumer consumer,
                                              void* user_data);
 
+/*
+ * ========
+ * Profiler
+ * ========
+ */
+
+/**
+ * Writes the CPU samples of the current isolate in the pprof profile format.
+ *
+ * The profile is streamed to the consumer as one uncompressed stream, in
+ * chunks. Memory use is proportional to the number of distinct locations,
+ * functions and strings, not to the number of samples.
+ *
+ * Requires an isolate to be entered and the profiler to be enabled.
+ *
+ * \param thread_id Only include samples of this thread, or -1 for samples of
+ *   all the threads of the isolate.
+ * \param time_origin_micros Only include samples taken at or after this time,
+ *   in microseconds on the monotonic clock, or -1 for all samples.
+ * \param time_extent_micros Only include samples taken within this many
+ *   microseconds of time_origin_micros, or -1 for all samples.
+ * \param consumer A Dart_StreamConsumer.
+ * \param user_data User data passed into consumer.
+ *
+ * NOTE: The pprof format is documented here:
+ * https://github.com/google/pprof/blob/master/proto/profile.proto
+ *
+ * \return True if a stream was output.
+ */
+DART_EXPORT bool Dart_WriteCpuProfilePprof(int64_t thread_id,
+                                           int64_t time_origin_micros,
+                                           int64_t time_extent_micros,
+                                           Dart_StreamConsumer consumer,
+                                           void* user_data);
+
+/*
+ * ==============
+ * Heap snapshots
+ * ==============
+ */
+
+/**
+ * Writes a snapshot of the object graph of the current isolate.
+ *
+ * The snapshot is streamed to the consumer in chunks as it is written, so it
+ * is never held in memory as a whole. The consumer can write the chunks to a
+ * file or a socket. The format is documented with ObjectGraph::Serialize in
+ * runtime/vm/object_graph.h.
+ *
+ * Requires there to be a current isolate and a current scope.
+ *
+ * \param consumer A Dart_StreamConsumer.
+ * \param user_data User data passed into consumer.
+ * \param collect_garbage Whether to collect garbage before writing the
+ *   snapshot. Otherwise the snapshot includes unreachable objects.
+ *
+ * \return A valid handle if the snapshot was written, an error handle
+ *   otherwise.
+ */
+DART_EXPORT Dart_Handle Dart_WriteHeapSnapshot(Dart_StreamConsumer consumer,
+                                               void* user_data,
+                                               bool collect_garbage);
+
 typedef enum {
   Dart_Timeline_Event_Begin,          // Phase = 'B'.
   Dart_Timeline_Event_End,            // Phase = 'E'.
@@ -868,12 +868,15 @@ class _Bigint extends _IntegerImplementation implements int {
 
   // Return this * a.
   _Bigint _mul(_Bigint a) {
-    // TODO(regis): Use karatsuba multiplication when appropriate.
     var used = _used;
     var a_used = a._used;
     if (used == 0 || a_used == 0) {
       return _ZERO;
     }
+    if (used >= _KARATSUBA_THRESHOLD && a_used >= _KARATSUBA_THRESHOLD) {
+      var r = _karatsubaMul(_digits, used, a._digits, a_used);
+      return (_neg != a._neg) ? r._negate() : r;
+    }
     var r_used = used + a_used;
     var digits = _digits;
     var a_digits = a._digits;
@@ -890,6 +893,10 @@ class _Bigint extends _IntegerImplementation implements int {
   static int _mulDigits(Uint32List x_digits, int x_used, Uint32List a_digits,
       int a_used, Uint32List r_digits) {
     var r_used = x_used + a_used;
+    if (x_used >= _KARATSUBA_THRESHOLD && a_used >= _KARATSUBA_THRESHOLD) {
+      var r = _karatsubaMul(x_digits, x_used, a_digits, a_used);
+      return _copyProductDigits(r, r_used, r_digits);
+    }
     var i = r_used + (r_used & 1);
     assert(r_digits.length >= i);
     while (--i >= 0) {
@@ -908,6 +915,9 @@ class _Bigint extends _IntegerImplementation implements int {
     if (used == 0) {
       return _ZERO;
     }
+    if (used >= _KARATSUBA_THRESHOLD) {
+      return _karatsubaSqr(_digits, used);
+    }
     var r_used = 2 * used;
     var digits = _digits;
     var r_digits = new Uint32List(r_used);
@@ -927,6 +937,10 @@ class _Bigint extends _IntegerImplementation implements int {
   // Return r_used = 2*x_used.
   static int _sqrDigits(Uint32List x_digits, int x_used, Uint32List r_digits) {
     var r_used = 2 * x_used;
+    if (x_used >= _KARATSUBA_THRESHOLD) {
+      return _copyProductDigits(
+          _karatsubaSqr(x_digits, x_used), r_used, r_digits);
+    }
     assert(r_digits.length >= r_used);
     // Since r_used is even, no need for a leading zero for 64-bit processing.
     var i = r_used;
@@ -944,6 +958,78 @@ class _Bigint extends _IntegerImplementation implements int {
     return r_used;
   }
 
+  // Operands with at least this many digits are multiplied with the Karatsuba
+  // algorithm, which replaces one multiplication of n digit operands by three
+  // multiplications of n/2 digit operands. Below the threshold, the
+  // intrinsified schoolbook multiplication is faster since it does not
+  // allocate intermediate results.
+  static const int _KARATSUBA_THRESHOLD = 64;
+
+  // Return digits[from..to-1] as a non-negative _Bigint.
+  static _Bigint _sliceDigits(Uint32List digits, int from, int to) {
+    var n = to - from;
+    return new _Bigint(false, n, _cloneDigits(digits, from, to, n));
+  }
+
+  // r_digits[0..r_used-1] = abs(r), where r_used is at least r._used.
+  // Return r_used.
+  static int _copyProductDigits(_Bigint r, int r_used, Uint32List r_digits) {
+    var used = r._used;
+    var digits = r._digits;
+    assert(used <= r_used);
+    var n = r_used + (r_used & 1);
+    assert(r_digits.length >= n);
+    var i = 0;
+    while (i < used) {
+      r_digits[i] = digits[i];
+      i++;
+    }
+    while (i < n) {
+      r_digits[i++] = 0;
+    }
+    return r_used;
+  }
+
+  // Return x_digits[0..x_used-1]*a_digits[0..a_used-1] as a non-negative
+  // _Bigint, using Karatsuba multiplication.
+  // With x = x1*B + x0, a = a1*B + a0 and B = _DIGIT_BASE^h:
+  //   x*a = z2*B^2 + z1*B + z0, where
+  //   z2 = x1*a1, z0 = x0*a0 and z1 = (x1 + x0)*(a1 + a0) - z2 - z0.
+  // The half size products recurse through _mul, which falls back to the
+  // schoolbook algorithm below _KARATSUBA_THRESHOLD.
+  static _Bigint _karatsubaMul(
+      Uint32List x_digits, int x_used, Uint32List a_digits, int a_used) {
+    if (x_used < a_used) {
+      return _karatsubaMul(a_digits, a_used, x_digits, x_used);
+    }
+    var h = (x_used + 1) >> 1;
+    var x0 = _sliceDigits(x_digits, 0, h);
+    var x1 = _sliceDigits(x_digits, h, x_used);
+    if (a_used <= h) {
+      // Unbalanced operands, only split x: x*a = x1*a*B + x0*a.
+      var a = _sliceDigits(a_digits, 0, a_used);
+      return x1._mul(a)._dlShift(h)._add(x0._mul(a));
+    }
+    var a0 = _sliceDigits(a_digits, 0, h);
+    var a1 = _sliceDigits(a_digits, h, a_used);
+    var z0 = x0._mul(a0);
+    var z2 = x1._mul(a1);
+    var z1 = x1._add(x0)._mul(a1._add(a0))._sub(z2)._sub(z0);
+    return z2._dlShift(2 * h)._add(z1._dlShift(h))._add(z0);
+  }
+
+  // Return x_digits[0..x_used-1]^2 as a non-negative _Bigint, using Karatsuba
+  // squaring, i.e. _karatsubaMul with a == x.
+  static _Bigint _karatsubaSqr(Uint32List x_digits, int x_used) {
+    var h = (x_used + 1) >> 1;
+    var x0 = _sliceDigits(x_digits, 0, h);
+    var x1 = _sliceDigits(x_digits, h, x_used);
+    var z0 = x0._sqr();
+    var z2 = x1._sqr();
+    var z1 = x1._add(x0)._sqr()._sub(z2)._sub(z0);
+    return z2._dlShift(2 * h)._add(z1._dlShift(h))._add(z0);
+  }
+
   // Indices of the arguments of _estQuotientDigit.
   // For 64-bit processing by intrinsics on 64-bit platforms, the top digit pair
   // of divisor y is provided in the args array, and a 64-bit estimated quotient
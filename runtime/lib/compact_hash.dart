@@ -135,6 +135,26 @@ class _InternalLinkedHashMap<K, V> extends _HashVMBase
     _usedData = 0;
     _deletedKeys = 0;
   }
+
+  void _init(int size, int hashMask, List oldData, int oldUsed) {
+    // The VM moves the entries without calling hashCode and == where it can.
+    if (oldData == null ||
+        !identical(oldData, _data) ||
+        !_rehashNative(size, hashMask)) {
+      super._init(size, hashMask, oldData, oldUsed);
+    }
+  }
+
+  int _regenerateIndex() {
+    assert(_index == null);
+    final int size = _data.length;
+    if (_rehashNative(size, _HashBase._indexSizeToHashMask(size))) {
+      return size;
+    }
+    return super._regenerateIndex();
+  }
+
+  bool _rehashNative(int size, int hashMask) native "LinkedHashMap_rehash";
 }
 
 abstract class _LinkedHashMapMixin<K, V> implements _HashVMBase {
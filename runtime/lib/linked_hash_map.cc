@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/assert.h"
+#include "platform/utils.h"
 
 #include "vm/bootstrap_natives.h"
 #include "vm/exceptions.h"
@@ -82,4 +83,156 @@ DEFINE_NATIVE_ENTRY(LinkedHashMap_setUsedData, 2) {
   return Object::null();
 }
 
+// Keep in sync with _HashBase in compact_hash.dart.
+static const uint32_t kUnusedPair = 0;
+static const uint32_t kDeletedPair = 1;
+
+// Returns true and sets 'hash' to the hashCode of 'key' if calling its
+// hashCode getter would not run any Dart code.
+static bool KnownHashCode(const Object& key, int64_t* hash) {
+  if (key.IsSmi()) {
+    *hash = Smi::Cast(key).Value();
+    return true;
+  }
+  if (key.IsMint()) {
+    *hash = Mint::Cast(key).value();
+    return true;
+  }
+  if (key.IsString()) {
+    *hash = String::Cast(key).Hash();
+    return true;
+  }
+  return false;
+}
+
+// Moves the live entries of 'map' into a fresh index of 'size' slots and
+// data array, without calling hashCode or operator== on the keys.
+//
+// The keys are known to be distinct, so no equality tests are needed, and
+// the hash bits the new index uses are taken either from the key itself (see
+// KnownHashCode) or from the hash pattern recorded for it in the old index,
+// which holds the low bits of its hashCode. Returns false, leaving 'map'
+// untouched, if that is not enough for some key.
+static bool RehashEntries(Zone* zone,
+                          const LinkedHashMap& map,
+                          intptr_t size,
+                          intptr_t hash_mask) {
+  ASSERT(Utils::IsPowerOfTwo(size));
+  const Array& old_data = Array::Handle(zone, map.data());
+  const intptr_t old_used = Smi::Value(map.used_data());
+  const intptr_t num_entries = old_used >> 1;
+  const intptr_t max_entries = size >> 1;
+  const intptr_t size_mask = size - 1;
+  if (num_entries - Smi::Value(map.deleted_keys()) > max_entries) {
+    return false;
+  }
+
+  // Recover the hash bits stored in the old index. A masked hash of zero is
+  // stored as one, so entries with a stored one are ambiguous.
+  int64_t* hashes = zone->Alloc<int64_t>(num_entries);
+  bool* recorded = zone->Alloc<bool>(num_entries);
+  for (intptr_t i = 0; i < num_entries; i++) {
+    recorded[i] = false;
+  }
+  const TypedData& old_index = TypedData::Handle(zone, map.index());
+  const intptr_t old_mask = Smi::Value(map.hash_mask());
+  if (!old_index.IsNull() && ((hash_mask | size_mask) & ~old_mask) == 0) {
+    const intptr_t old_size = old_index.Length();
+    const intptr_t old_max_entries = old_size >> 1;
+    const int shift = Utils::ShiftForPowerOfTwo(old_max_entries);
+    for (intptr_t i = 0; i < old_size; i++) {
+      const uint32_t pair = old_index.GetUint32(i << 2);
+      if ((pair == kUnusedPair) || (pair == kDeletedPair)) {
+        continue;
+      }
+      const intptr_t entry = pair & (old_max_entries - 1);
+      const intptr_t masked_hash = pair >> shift;
+      if ((entry < num_entries) && (masked_hash != 1)) {
+        hashes[entry] = masked_hash;
+        recorded[entry] = true;
+      }
+    }
+  }
+
+  // Determine all hashes before allocating, so that bailing out is cheap.
+  Object& key = Object::Handle(zone);
+  for (intptr_t entry = 0; entry < num_entries; entry++) {
+    key = old_data.At(entry << 1);
+    if (key.raw() == old_data.raw()) {
+      continue;  // Deleted.
+    }
+    int64_t hash;
+    if (KnownHashCode(key, &hash)) {
+      hashes[entry] = hash;
+    } else if (!recorded[entry]) {
+      return false;
+    }
+  }
+
+  const TypedData& index = TypedData::Handle(
+      zone, TypedData::New(kTypedDataUint32ArrayCid, size));
+  const Array& data = Array::Handle(zone, Array::New(size));
+  Object& value = Object::Handle(zone);
+  intptr_t used = 0;
+  for (intptr_t entry = 0; entry < num_entries; entry++) {
+    key = old_data.At(entry << 1);
+    if (key.raw() == old_data.raw()) {
+      continue;
+    }
+    value = old_data.At((entry << 1) + 1);
+    // Same as _HashBase._hashPattern and _HashBase._firstProbe.
+    const int64_t hash = hashes[entry];
+    const uint64_t masked_hash = hash & hash_mask;
+    const uint64_t pattern = (masked_hash == 0 ? 1 : masked_hash) * max_entries;
+    ASSERT(pattern < (static_cast<uint64_t>(1) << 32));
+    intptr_t i = hash & size_mask;
+    i = ((i << 1) + i) & size_mask;
+    while (index.GetUint32(i << 2) != kUnusedPair) {
+      i = (i + 1) & size_mask;
+    }
+    index.SetUint32(i << 2, static_cast<uint32_t>(pattern | (used >> 1)));
+    data.SetAt(used++, key);
+    data.SetAt(used++, value);
+  }
+
+  map.SetIndex(index);
+  map.SetData(data);
+  map.SetHashMask(hash_mask);
+  map.SetUsedData(used);
+  map.SetDeletedKeys(0);
+  return true;
+}
+
+DEFINE_NATIVE_ENTRY(LinkedHashMap_rehash, 3) {
+  const LinkedHashMap& map =
+      LinkedHashMap::CheckedHandle(arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, size, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, hash_mask, arguments->NativeArgAt(2));
+  return Bool::Get(RehashEntries(zone, map, size.Value(), hash_mask.Value()))
+      .raw();
+}
+
+DEFINE_NATIVE_ENTRY(LinkedHashMap_reserve, 2) {
+  const LinkedHashMap& map =
+      LinkedHashMap::CheckedHandle(arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, capacity, arguments->NativeArgAt(1));
+  ASSERT(Smi::Value(map.used_data()) == 0);
+  // Same as _HashBase._INITIAL_INDEX_SIZE and _indexSizeToHashMask.
+  intptr_t size = 16;
+  while (((size >> 1) < capacity.Value()) && (size < kSmiMax / 2)) {
+    size <<= 1;
+  }
+  const intptr_t index_bits = Utils::ShiftForPowerOfTwo(size) - 1;
+  const intptr_t hash_bits = (kBitsPerWord == 64) ? 32 : 30;
+  if (index_bits >= hash_bits) {
+    return Object::null();  // Let the map grow as usual.
+  }
+  const TypedData& index = TypedData::Handle(
+      zone, TypedData::New(kTypedDataUint32ArrayCid, size));
+  map.SetIndex(index);
+  map.SetData(Array::Handle(zone, Array::New(size)));
+  map.SetHashMask((static_cast<intptr_t>(1) << (hash_bits - index_bits)) - 1);
+  return Object::null();
+}
+
 }  // namespace dart
@@ -12,12 +12,20 @@ class Map<K, V> {
   factory Map._fromLiteral(List elements) {
     var map = new LinkedHashMap<K, V>();
     var len = elements.length;
+    if (len > 16) {
+      // Larger than the initial capacity of a default map.
+      _reserve(map, len >> 1);
+    }
     for (int i = 1; i < len; i += 2) {
       map[elements[i - 1]] = elements[i];
     }
     return map;
   }
 
+  // Sizes the empty default [map] to hold [capacity] entries without
+  // growing.
+  static void _reserve(Map map, int capacity) native "LinkedHashMap_reserve";
+
   @patch
   factory Map.unmodifiable(Map other) {
     return new UnmodifiableMapView<K, V>(new Map.from(other));
@@ -10,6 +10,7 @@
 #include "vm/isolate.h"
 #include "vm/native_entry.h"
 #include "vm/object.h"
+#include "vm/string_search.h"
 #include "vm/symbols.h"
 #include "vm/unicode.h"
 
@@ -268,16 +269,23 @@ DEFINE_NATIVE_ENTRY(OneByteString_splitWithCharCode, 2) {
       zone, GrowableObjectArray::New(16, Heap::kNew));
   String& str = String::Handle(zone);
   intptr_t start = 0;
-  intptr_t i = 0;
-  for (; i < len; i++) {
-    if (split_code == OneByteString::CharAt(receiver, i)) {
-      str = OneByteString::SubStringUnchecked(receiver, start, (i - start),
-                                              Heap::kNew);
-      result.Add(str);
-      start = i + 1;
+  while (true) {
+    intptr_t i;
+    {
+      // Allocating the substrings may move the receiver.
+      NoSafepointScope no_safepoint;
+      i = StringSearch::IndexOfChar(String::OneByteDataStart(receiver), len,
+                                    split_code, start);
     }
+    if (i < 0) {
+      break;
+    }
+    str = OneByteString::SubStringUnchecked(receiver, start, (i - start),
+                                            Heap::kNew);
+    result.Add(str);
+    start = i + 1;
   }
-  str = OneByteString::SubStringUnchecked(receiver, start, (i - start),
+  str = OneByteString::SubStringUnchecked(receiver, start, (len - start),
                                           Heap::kNew);
   result.Add(str);
   return result.raw();
@@ -522,7 +530,42 @@ DEFINE_NATIVE_ENTRY(String_concat, 2) {
   const String& receiver =
       String::CheckedHandle(zone, arguments->NativeArgAt(0));
   GET_NON_NULL_NATIVE_ARGUMENT(String, b, arguments->NativeArgAt(1));
-  return String::Concat(receiver, b);
+  // Strings are immutable, so there is no need to copy the other operand when
+  // one of them is empty.
+  if (b.Length() == 0) {
+    return receiver.raw();
+  }
+  if (receiver.Length() == 0) {
+    return b.raw();
+  }
+  return String::ConcatForAppend(receiver, b);
+}
+
+DEFINE_NATIVE_ENTRY(StringBase_indexOf, 3) {
+  const String& receiver =
+      String::CheckedHandle(zone, arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(String, pattern, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, start_obj, arguments->NativeArgAt(2));
+  const intptr_t start = start_obj.Value();
+  ASSERT((0 <= start) && (start <= receiver.Length()));
+  return Smi::New(receiver.IndexOf(pattern, start));
+}
+
+DEFINE_NATIVE_ENTRY(StringBase_lastIndexOf, 3) {
+  const String& receiver =
+      String::CheckedHandle(zone, arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(String, pattern, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, start_obj, arguments->NativeArgAt(2));
+  const intptr_t start = start_obj.Value();
+  ASSERT((0 <= start) && (start <= receiver.Length()));
+  return Smi::New(receiver.LastIndexOf(pattern, start));
+}
+
+DEFINE_NATIVE_ENTRY(StringBase_compareTo, 2) {
+  const String& receiver =
+      String::CheckedHandle(zone, arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(String, other, arguments->NativeArgAt(1));
+  return Smi::New(receiver.CompareTo(other));
 }
 
 DEFINE_NATIVE_ENTRY(String_toLowerCase, 1) {
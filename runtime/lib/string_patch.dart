@@ -86,6 +86,13 @@ abstract class _StringBase {
   // TODO(lrn): See if this limit can be tweaked.
   static const int _maxJoinReplaceOneByteStringLength = 500;
 
+  // For strings of at least this many code units to scan, the word-at-a-time
+  // search, comparison and case mapping natives beat the code unit loops
+  // below despite the cost of calling into C++. At 32 one-byte code units,
+  // the natives scan four 64-bit words, which is about where the words they
+  // skip make up for the fixed cost of the call.
+  static const int _minNativeScanLength = 32;
+
   factory _StringBase._uninstantiable() {
     throw new UnsupportedError("_StringBase can't be instaniated");
   }
@@ -264,6 +271,9 @@ abstract class _StringBase {
     int thisLength = this.length;
     int otherLength = other.length;
     int len = (thisLength < otherLength) ? thisLength : otherLength;
+    if (len >= _minNativeScanLength) {
+      return _compareToNative(other);
+    }
     for (int i = 0; i < len; i++) {
       int thisCodeUnit = this.codeUnitAt(i);
       int otherCodeUnit = other.codeUnitAt(i);
@@ -279,6 +289,8 @@ abstract class _StringBase {
     return 0;
   }
 
+  int _compareToNative(String other) native "StringBase_compareTo";
+
   bool _substringMatches(int start, String other) {
     if (other.isEmpty) return true;
     final len = other.length;
@@ -313,8 +325,10 @@ abstract class _StringBase {
     }
     if (pattern is String) {
       String other = pattern;
+      if (this.length - start >= _minNativeScanLength) {
+        return _indexOfNative(other, start);
+      }
       int maxIndex = this.length - other.length;
-      // TODO: Use an efficient string search (e.g. BMH).
       for (int index = start; index <= maxIndex; index++) {
         if (_substringMatches(index, other)) {
           return index;
@@ -338,6 +352,9 @@ abstract class _StringBase {
     }
     if (pattern is String) {
       String other = pattern;
+      if (start >= _minNativeScanLength) {
+        return _lastIndexOfNative(other, start);
+      }
       int maxIndex = this.length - other.length;
       if (maxIndex < start) start = maxIndex;
       for (int index = start; index >= 0; index--) {
@@ -355,6 +372,11 @@ abstract class _StringBase {
     return -1;
   }
 
+  int _indexOfNative(String pattern, int start) native "StringBase_indexOf";
+
+  int _lastIndexOfNative(String pattern, int start)
+      native "StringBase_lastIndexOf";
+
   String substring(int startIndex, [int endIndex]) {
     if (endIndex == null) endIndex = this.length;
 
@@ -950,10 +972,31 @@ class _OneByteString extends _StringBase implements String {
     return super.split(pattern);
   }
 
+  // Up to this result length, copying one-byte strings in Dart is quicker than
+  // calling into the native concatenation.
+  // TODO(srdjan): Improve code below and raise or eliminate the limit.
+  static const int _maxDartConcatLength = 128;
+
+  String operator +(String other) {
+    if (ClassID.getID(other) == ClassID.cidOneByteString) {
+      final thisLength = this.length;
+      final otherLength = other.length;
+      if (otherLength == 0) return this;
+      if (thisLength == 0) return other;
+      final totalLength = thisLength + otherLength;
+      if (totalLength <= _maxDartConcatLength) {
+        final res = _OneByteString._allocate(totalLength);
+        res._setRange(0, this, 0, thisLength);
+        res._setRange(thisLength, other, 0, otherLength);
+        return res;
+      }
+    }
+    return super + other;
+  }
+
   // All element of 'strings' must be OneByteStrings.
   static _concatAll(List<String> strings, int totalLength) {
-    // TODO(srdjan): Improve code below and raise or eliminate the limit.
-    if (totalLength > 128) {
+    if (totalLength > _maxDartConcatLength) {
       // Native is quicker.
       return _StringBase._concatRangeNative(strings, 0, strings.length);
     }
@@ -982,6 +1025,9 @@ class _OneByteString extends _StringBase implements String {
         if (patternCu0 > 0xFF) {
           return -1;
         }
+        if (len - start >= _StringBase._minNativeScanLength) {
+          return _indexOfNative(pattern, start);
+        }
         for (int i = start; i < len; i++) {
           if (this.codeUnitAt(i) == patternCu0) {
             return i;
@@ -1004,6 +1050,9 @@ class _OneByteString extends _StringBase implements String {
         if (patternCu0 > 0xFF) {
           return false;
         }
+        if (len - start >= _StringBase._minNativeScanLength) {
+          return _indexOfNative(pattern, start) >= 0;
+        }
         for (int i = start; i < len; i++) {
           if (this.codeUnitAt(i) == patternCu0) {
             return true;
@@ -1139,6 +1188,9 @@ class _OneByteString extends _StringBase implements String {
       "\xd0\xd1\xd2\xd3\xd4\xd5\xd6\xf7\xd8\xd9\xda\xdb\xdc\xdd\xde\x00";
 
   String toLowerCase() {
+    if (this.length >= _StringBase._minNativeScanLength) {
+      return super.toLowerCase();
+    }
     for (int i = 0; i < this.length; i++) {
       final c = this.codeUnitAt(i);
       if (c == _LC_TABLE.codeUnitAt(c)) continue;
@@ -1156,6 +1208,9 @@ class _OneByteString extends _StringBase implements String {
   }
 
   String toUpperCase() {
+    if (this.length >= _StringBase._minNativeScanLength) {
+      return super.toUpperCase();
+    }
     for (int i = 0; i < this.length; i++) {
       final c = this.codeUnitAt(i);
       // Continue loop if character is unchanged by upper-case conversion.
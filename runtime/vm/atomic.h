@@ -37,6 +37,14 @@ class AtomicOperations : public AllStatic {
                                        uint32_t old_value,
                                        uint32_t new_value);
 
+  // Loads the word at ptr such that no later memory access is reordered
+  // before the load.
+  static uword LoadAcquire(uword* ptr);
+
+  // Keeps all earlier memory accesses from being reordered after any later
+  // store.
+  static void ReleaseFence();
+
   // Performs a load of a word from 'ptr', but without any guarantees about
   // memory order (i.e., no load barriers/fences).
   template <typename T>
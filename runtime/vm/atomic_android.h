@@ -55,6 +55,14 @@ inline uint32_t AtomicOperations::CompareAndSwapUint32(uint32_t* ptr,
   return __sync_val_compare_and_swap(ptr, old_value, new_value);
 }
 
+inline uword AtomicOperations::LoadAcquire(uword* ptr) {
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+
+inline void AtomicOperations::ReleaseFence() {
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
 }  // namespace dart
 
 #endif  // RUNTIME_VM_ATOMIC_ANDROID_H_
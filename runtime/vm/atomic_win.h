@@ -129,6 +129,27 @@ inline uint32_t AtomicOperations::CompareAndSwapUint32(uint32_t* ptr,
 #endif
 }
 
+inline uword AtomicOperations::LoadAcquire(uword* ptr) {
+#if (defined(HOST_ARCH_X64) || defined(HOST_ARCH_IA32))
+  // Loads are not reordered with other loads or stores on x86, only the
+  // compiler has to be kept from moving accesses across the load.
+  uword value = *static_cast<volatile uword*>(ptr);
+  _ReadWriteBarrier();
+  return value;
+#else
+#error Unsupported host architecture.
+#endif
+}
+
+inline void AtomicOperations::ReleaseFence() {
+#if (defined(HOST_ARCH_X64) || defined(HOST_ARCH_IA32))
+  // Stores are not reordered with earlier loads or stores on x86.
+  _ReadWriteBarrier();
+#else
+#error Unsupported host architecture.
+#endif
+}
+
 }  // namespace dart
 
 #endif  // RUNTIME_VM_ATOMIC_WIN_H_
@@ -5,6 +5,8 @@
 #include "vm/benchmark_test.h"
 
 #include "bin/builtin.h"
+#include "bin/dfe.h"
+#include "bin/directory.h"
 #include "bin/file.h"
 #include "bin/isolate_data.h"
 #include "bin/process.h"
@@ -15,13 +17,24 @@
 #include "vm/clustered_snapshot.h"
 #include "vm/compiler_stats.h"
 #include "vm/dart_api_impl.h"
+#include "vm/kernel.h"
+#include "vm/lockers.h"
+#include "vm/regexp.h"
+#include "vm/regexp_assembler_bytecode.h"
+#include "vm/regexp_assembler_ir.h"
+#include "vm/regexp_assembler_native.h"
 #include "vm/stack_frame.h"
+#include "vm/symbols.h"
+#include "vm/thread_pool.h"
 #include "vm/unit_test.h"
 
 using dart::bin::File;
 
 namespace dart {
 
+DECLARE_FLAG(bool, leaf_natives);
+DECLARE_FLAG(bool, native_irregexp);
+DECLARE_FLAG(bool, string_append_buffers);
 DECLARE_FLAG(bool, use_dart_frontend);
 
 Benchmark* Benchmark::first_ = NULL;
@@ -206,6 +219,59 @@ BENCHMARK(CorelibIsolateStartup) {
   Dart_EnterIsolate(reinterpret_cast<Dart_Isolate>(isolate));
 }
 
+#if !defined(DART_PRECOMPILED_RUNTIME)
+namespace bin {
+// Defined in bin/run_vm_tests.cc.
+extern DFE dfe;
+}  // namespace bin
+
+//
+// Measure reading a script's kernel binary from the kernel cache of the
+// standalone embedder, which replaces compiling it on a hit.
+//
+BENCHMARK(KernelCacheStartup) {
+  if (!FLAG_use_dart_frontend) {
+    return;
+  }
+  const int kNumIterations = 100;
+  Dart_EnterScope();
+  const char* temp_dir = bin::Directory::CreateTemp(
+      NULL, OS::SCreate(thread->zone(), "%s%skernel_cache",
+                        bin::Directory::SystemTemp(NULL),
+                        File::PathSeparator()));
+  EXPECT(temp_dir != NULL);
+  const char* script_path = OS::SCreate(thread->zone(), "%s%smain.dart",
+                                        temp_dir, File::PathSeparator());
+  const char* kScript = "main() {\n  print('Hello, World!');\n}\n";
+  File* file = File::Open(NULL, script_path, File::kWriteTruncate);
+  EXPECT(file != NULL);
+  EXPECT(file->WriteFully(kScript, strlen(kScript)));
+  file->Release();
+
+  bin::dfe.set_kernel_cache_directory(temp_dir);
+  char* error = NULL;
+  int exit_code = 0;
+  // Populate the cache.
+  void* program = bin::dfe.CompileAndReadScript(script_path, &error,
+                                                &exit_code);
+  EXPECT(program != NULL);
+  delete reinterpret_cast<kernel::Program*>(program);
+
+  Timer timer(true, "KernelCacheStartup");
+  for (int i = 0; i < kNumIterations; i++) {
+    timer.Start();
+    program = bin::dfe.CompileAndReadScript(script_path, &error, &exit_code);
+    timer.Stop();
+    EXPECT(program != NULL);
+    delete reinterpret_cast<kernel::Program*>(program);
+  }
+  bin::dfe.set_kernel_cache_directory(NULL);
+  benchmark->set_score(timer.TotalElapsedTime() / kNumIterations);
+  bin::Directory::Delete(NULL, temp_dir, true);
+  Dart_ExitScope();
+}
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+
 //
 // Measure invocation of Dart API functions.
 //
@@ -702,6 +768,965 @@ BENCHMARK(LargeMap) {
   benchmark->set_score(elapsed_time);
 }
 
+BENCHMARK(LargeMapRegenerateIndex) {
+  const char* kScript =
+      "makeMap() {\n"
+      "  Map m = {};\n"
+      "  for (int i = 0; i < 100000; ++i) m[i*13+i*(i>>7)] = i;\n"
+      "  return m;\n"
+      "}\n"
+      "lookup(Map m) => m[13];\n";
+  Dart_Handle h_lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(h_lib);
+  Dart_Handle h_result = Dart_Invoke(h_lib, NewString("makeMap"), 0, NULL);
+  EXPECT_VALID(h_result);
+  Instance& map = Instance::Handle();
+  map ^= Api::UnwrapHandle(h_result);
+  uint8_t* buffer;
+  MessageWriter writer(&buffer, &malloc_allocator, &malloc_deallocator, true);
+  writer.WriteMessage(map);
+  intptr_t buffer_len = writer.BytesWritten();
+  const intptr_t kLoopCount = 100;
+  Timer timer(true, "Large Map regenerate index");
+  for (intptr_t i = 0; i < kLoopCount; i++) {
+    StackZone zone(thread);
+    MessageSnapshotReader reader(buffer, buffer_len, thread);
+    Dart_Handle copy = Api::NewHandle(thread, reader.ReadObject());
+    // The first lookup rebuilds the index of the deserialized map.
+    timer.Start();
+    EXPECT_VALID(Dart_Invoke(h_lib, NewString("lookup"), 1, &copy));
+    timer.Stop();
+  }
+  free(buffer);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+// Growing maps rehashes them repeatedly. Int and String keys, and keys whose
+// low hash bits are still recorded in the index, are rehashed without
+// calling hashCode.
+BENCHMARK(LargeMapGrowth) {
+  const char* kScript =
+      "class Key {\n"
+      "  final int id;\n"
+      "  Key(this.id);\n"
+      "  int get hashCode => id * 31;\n"
+      "  bool operator ==(other) => other is Key && other.id == id;\n"
+      "}\n"
+      "final ints = new List<int>.generate(100000, (i) => i * 13 + (i >> 7));\n"
+      "final strings = new List<String>.generate(20000, (i) => 'k$i');\n"
+      "final keys = new List<Key>.generate(20000, (i) => new Key(i));\n"
+      "int fill(List list) {\n"
+      "  var m = {};\n"
+      "  for (var k in list) m[k] = k;\n"
+      "  int found = 0;\n"
+      "  for (var k in list) if (m[k] != null) found++;\n"
+      "  return found;\n"
+      "}\n"
+      "benchmark() {\n"
+      "  int found = 0;\n"
+      "  for (int r = 0; r < 5; r++) {\n"
+      "    found += fill(ints) + fill(strings) + fill(keys);\n"
+      "  }\n"
+      "  return found;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+  // Warmup first to avoid compilation jitters.
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  Timer timer(true, "Large Map growth");
+  timer.Start();
+  Dart_Handle result = Dart_Invoke(lib, NewString("benchmark"), 0, NULL);
+  timer.Stop();
+  EXPECT_VALID(result);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+//
+// Measure the string search, comparison and case mapping natives on inputs
+// resembling HTTP headers and log lines.
+//
+#define STRING_BENCHMARK_PRELUDE                                               \
+  "List<String> makeLines(int n) {\n"                                          \
+  "  var lines = <String>[];\n"                                                \
+  "  for (int i = 0; i < n; i++) {\n"                                          \
+  "    lines.add('2018-01-01 12:00:${i % 60} INFO request id=$i '\n"           \
+  "              'path=/api/v1/items/$i Content-Type: Text/HTML; '\n"          \
+  "              'charset=UTF-8 user-agent=Mozilla/5.0');\n"                   \
+  "  }\n"                                                                      \
+  "  return lines;\n"                                                          \
+  "}\n"                                                                        \
+  "final lines = makeLines(10000);\n"                                          \
+  "final text = lines.join('\\n');\n"
+
+static void RunStringBenchmark(Benchmark* benchmark,
+                               const char* script,
+                               const char* name) {
+  Dart_Handle lib = TestCase::LoadTestScript(script, NULL);
+  EXPECT_VALID(lib);
+  // Warmup first to avoid compilation jitters.
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  Timer timer(true, name);
+  timer.Start();
+  Dart_Handle result = Dart_Invoke(lib, NewString("benchmark"), 0, NULL);
+  timer.Stop();
+  EXPECT_VALID(result);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+BENCHMARK(StringIndexOf) {
+  const char* kScript = STRING_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  int found = 0;\n"
+      "  for (int r = 0; r < 10; r++) {\n"
+      "    for (var line in lines) {\n"
+      "      if (line.indexOf('user-agent=') >= 0) found++;\n"
+      "      if (line.contains('charset=')) found++;\n"
+      "      if (line.indexOf('?') >= 0) found++;\n"
+      "      found += line.lastIndexOf('Content');\n"
+      "    }\n"
+      "    for (int i = text.indexOf('\\n'); i >= 0;\n"
+      "         i = text.indexOf('\\n', i + 1)) {\n"
+      "      found++;\n"
+      "    }\n"
+      "  }\n"
+      "  return found;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript, "String indexOf benchmark");
+}
+
+BENCHMARK(StringSplit) {
+  const char* kScript = STRING_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  int parts = 0;\n"
+      "  for (int r = 0; r < 10; r++) {\n"
+      "    parts += text.split('\\n').length;\n"
+      "    for (var line in lines) {\n"
+      "      parts += line.split(' ').length;\n"
+      "      parts += line.split('; ').length;\n"
+      "    }\n"
+      "  }\n"
+      "  return parts;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript, "String split benchmark");
+}
+
+BENCHMARK(StringCaseConversion) {
+  const char* kScript = STRING_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  int length = 0;\n"
+      "  for (int r = 0; r < 10; r++) {\n"
+      "    for (var line in lines) {\n"
+      "      length += line.toLowerCase().length;\n"
+      "      length += line.toUpperCase().length;\n"
+      "    }\n"
+      "  }\n"
+      "  return length;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript, "String case conversion benchmark");
+}
+
+BENCHMARK(StringCompare) {
+  const char* kScript = STRING_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  var copies = lines\n"
+      "      .map((s) => new String.fromCharCodes(s.codeUnits))\n"
+      "      .toList();\n"
+      "  int result = 0;\n"
+      "  for (int r = 0; r < 10; r++) {\n"
+      "    for (int i = 1; i < lines.length; i++) {\n"
+      "      result += lines[i].compareTo(lines[i - 1]);\n"
+      "      if (lines[i] == copies[i]) result++;\n"
+      "    }\n"
+      "  }\n"
+      "  return result;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript, "String compare benchmark");
+}
+
+//
+// Measure building strings piecewise with '+', interpolation and StringBuffer.
+//
+BENCHMARK(StringConcatPlus) {
+  const char* kScript =
+      "benchmark() {\n"
+      "  int length = 0;\n"
+      "  for (int r = 0; r < 20000; r++) {\n"
+      "    var s = '';\n"
+      "    for (int i = 0; i < 20; i++) {\n"
+      "      s = s + 'key' + '/';\n"
+      "    }\n"
+      "    length += s.length;\n"
+      "  }\n"
+      "  return length;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript, "String concat '+' benchmark");
+}
+
+BENCHMARK(StringConcatInterpolation) {
+  const char* kScript =
+      "benchmark() {\n"
+      "  int length = 0;\n"
+      "  for (int r = 0; r < 20000; r++) {\n"
+      "    var s = '';\n"
+      "    for (int i = 0; i < 20; i++) {\n"
+      "      s = '${s}key/';\n"
+      "    }\n"
+      "    length += s.length;\n"
+      "  }\n"
+      "  return length;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript,
+                     "String concat interpolation benchmark");
+}
+
+BENCHMARK(StringConcatBuffer) {
+  const char* kScript =
+      "benchmark() {\n"
+      "  int length = 0;\n"
+      "  for (int r = 0; r < 20000; r++) {\n"
+      "    var sb = new StringBuffer();\n"
+      "    for (int i = 0; i < 20; i++) {\n"
+      "      sb..write('key')..write('/');\n"
+      "    }\n"
+      "    length += sb.toString().length;\n"
+      "  }\n"
+      "  return length;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript, "String concat buffer benchmark");
+}
+
+//
+// Measure appending to long strings with '+', with and without the shared
+// append buffers of String::ConcatForAppend, and then reading the result,
+// which is external when the buffers are used.
+//
+class StringAppendBuffersScope : public ValueObject {
+ public:
+  explicit StringAppendBuffersScope(bool append_buffers)
+      : saved_append_buffers_(FLAG_string_append_buffers) {
+    FLAG_string_append_buffers = append_buffers;
+  }
+  ~StringAppendBuffersScope() {
+    FLAG_string_append_buffers = saved_append_buffers_;
+  }
+
+ private:
+  const bool saved_append_buffers_;
+};
+
+static void RunStringAppendBenchmark(Benchmark* benchmark,
+                                     bool append_buffers,
+                                     const char* name) {
+  const char* kScript =
+      "benchmark() {\n"
+      "  int result = 0;\n"
+      "  for (int r = 0; r < 5; r++) {\n"
+      "    var s = '';\n"
+      "    for (int i = 0; i < 10000; i++) {\n"
+      "      s = s + 'key/';\n"
+      "    }\n"
+      "    result += s.length;\n"
+      "    for (int i = s.indexOf('/'); i >= 0; i = s.indexOf('/', i + 1)) {\n"
+      "      result += s.codeUnitAt(i - 1);\n"
+      "    }\n"
+      "  }\n"
+      "  return result;\n"
+      "}\n";
+  StringAppendBuffersScope scope(append_buffers);
+  RunStringBenchmark(benchmark, kScript, name);
+}
+
+BENCHMARK(StringAppendFlat) {
+  RunStringAppendBenchmark(benchmark, false, "String append flat benchmark");
+}
+
+BENCHMARK(StringAppendBuffered) {
+  RunStringAppendBenchmark(benchmark, true,
+                           "String append buffered benchmark");
+}
+
+//
+// Measure string hashing in map and symbol table lookups. The keys are
+// created anew for every lookup, so their hash codes are not cached yet.
+//
+BENCHMARK(StringHashMap) {
+  const char* kScript =
+      "benchmark() {\n"
+      "  int found = 0;\n"
+      "  for (int r = 0; r < 20; r++) {\n"
+      "    var map = <String, int>{};\n"
+      "    for (int i = 0; i < 5000; i++) {\n"
+      "      map['https://example.com/api/items/$i?fields=id,name'] = i;\n"
+      "    }\n"
+      "    for (int i = 0; i < 5000; i++) {\n"
+      "      found += map['https://example.com/api/items/$i?fields=id,name'];\n"
+      "    }\n"
+      "  }\n"
+      "  return found;\n"
+      "}\n";
+  RunStringBenchmark(benchmark, kScript, "String hash map benchmark");
+}
+
+BENCHMARK(StringHashSymbols) {
+  TransitionNativeToVM transition(thread);
+  const intptr_t kNumSymbols = 10000;
+  const intptr_t kLoopCount = 20;
+  const intptr_t kBufferSize = 64;
+  char* names = new char[kNumSymbols * kBufferSize];
+  for (intptr_t i = 0; i < kNumSymbols; i++) {
+    OS::SNPrint(&names[i * kBufferSize], kBufferSize,
+                "_InternalLinkedHashMap@0150898.benchmarkSymbol%" Pd, i);
+  }
+  String& symbol = String::Handle();
+  Timer timer(true, "String hash symbols benchmark");
+  timer.Start();
+  for (intptr_t r = 0; r < kLoopCount; r++) {
+    // The first round adds the symbols, the others look them up.
+    for (intptr_t i = 0; i < kNumSymbols; i++) {
+      symbol = Symbols::New(thread, &names[i * kBufferSize]);
+    }
+  }
+  timer.Stop();
+  EXPECT(symbol.IsSymbol());
+  delete[] names;
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+//
+// Measure arbitrary precision integer arithmetic. The multiplication
+// benchmarks use operands below and above the Karatsuba threshold of _Bigint.
+//
+#define BIGINT_BENCHMARK_PRELUDE                                               \
+  "int makeBigint(int bits, int seed) {\n"                                     \
+  "  var r = 1;\n"                                                             \
+  "  while (r.bitLength < bits) {\n"                                           \
+  "    seed = (seed * 1103515245 + 12345) & 0x7fffffff;\n"                     \
+  "    r = (r << 31) | seed;\n"                                                \
+  "  }\n"                                                                      \
+  "  return r;\n"                                                              \
+  "}\n"
+
+static void RunBigintBenchmark(Benchmark* benchmark,
+                               const char* script,
+                               const char* name) {
+  Dart_Handle lib = TestCase::LoadTestScript(script, NULL);
+  EXPECT_VALID(lib);
+  // Warmup first to avoid compilation jitters.
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  Timer timer(true, name);
+  timer.Start();
+  Dart_Handle result = Dart_Invoke(lib, NewString("benchmark"), 0, NULL);
+  timer.Stop();
+  EXPECT_VALID(result);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+BENCHMARK(BigintMultiplySmall) {
+  const char* kScript = BIGINT_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  final a = makeBigint(1024, 1);\n"
+      "  final b = makeBigint(1024, 2);\n"
+      "  int bits = 0;\n"
+      "  for (int i = 0; i < 20000; i++) {\n"
+      "    bits += (a * b).bitLength;\n"
+      "  }\n"
+      "  return bits;\n"
+      "}\n";
+  RunBigintBenchmark(benchmark, kScript, "Bigint multiply small benchmark");
+}
+
+BENCHMARK(BigintMultiplyLarge) {
+  const char* kScript = BIGINT_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  final a = makeBigint(65536, 1);\n"
+      "  final b = makeBigint(65536, 2);\n"
+      "  int bits = 0;\n"
+      "  for (int i = 0; i < 20; i++) {\n"
+      "    bits += (a * b).bitLength;\n"
+      "    bits += (a * a).bitLength;\n"
+      "  }\n"
+      "  return bits;\n"
+      "}\n";
+  RunBigintBenchmark(benchmark, kScript, "Bigint multiply large benchmark");
+}
+
+BENCHMARK(BigintDivide) {
+  const char* kScript = BIGINT_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  final a = makeBigint(8192, 1);\n"
+      "  final b = makeBigint(3000, 2);\n"
+      "  int bits = 0;\n"
+      "  for (int i = 0; i < 2000; i++) {\n"
+      "    bits += (a ~/ b).bitLength + (a % b).bitLength;\n"
+      "  }\n"
+      "  return bits;\n"
+      "}\n";
+  RunBigintBenchmark(benchmark, kScript, "Bigint divide benchmark");
+}
+
+BENCHMARK(BigintModPow) {
+  const char* kScript = BIGINT_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  final m = makeBigint(2048, 1) | 1;\n"
+      "  final e = makeBigint(2048, 2);\n"
+      "  var b = makeBigint(2000, 3);\n"
+      "  for (int i = 0; i < 10; i++) {\n"
+      "    b = b.modPow(e, m);\n"
+      "  }\n"
+      "  return b.bitLength;\n"
+      "}\n";
+  RunBigintBenchmark(benchmark, kScript, "Bigint modPow benchmark");
+}
+
+BENCHMARK(BigintToString) {
+  const char* kScript = BIGINT_BENCHMARK_PRELUDE
+      "benchmark() {\n"
+      "  final a = makeBigint(16384, 1);\n"
+      "  int length = 0;\n"
+      "  for (int i = 0; i < 20; i++) {\n"
+      "    length += a.toString().length;\n"
+      "    length += a.toRadixString(16).length;\n"
+      "  }\n"
+      "  return length;\n"
+      "}\n";
+  RunBigintBenchmark(benchmark, kScript, "Bigint toString benchmark");
+}
+
+//
+// Compare the irregexp backends: IL compiled by the optimizing compiler, the
+// bytecode interpreter and the native assembler. The backend is chosen when a
+// regexp is created and compiled, so the flags stay set for the whole run.
+//
+enum RegExpBackend { kRegExpIR, kRegExpBytecode, kRegExpNative };
+
+class RegExpBackendScope : public ValueObject {
+ public:
+  explicit RegExpBackendScope(RegExpBackend backend)
+      : saved_interpret_(FLAG_interpret_irregexp),
+        saved_native_(FLAG_native_irregexp) {
+    FLAG_interpret_irregexp = (backend == kRegExpBytecode);
+    FLAG_native_irregexp = (backend == kRegExpNative);
+  }
+  ~RegExpBackendScope() {
+    FLAG_interpret_irregexp = saved_interpret_;
+    FLAG_native_irregexp = saved_native_;
+  }
+
+ private:
+  const bool saved_interpret_;
+  const bool saved_native_;
+};
+
+static const char* kRegExpBenchmarkPatterns[] = {
+    "[a-z0-9._%+-]+@[a-z0-9.-]+\\.[a-z]{2,}",
+    "(\\d{1,3})\\.(\\d{1,3})\\.(\\d{1,3})\\.(\\d{1,3})",
+    "^(GET|POST|PUT) (\\S+) HTTP/1\\.[01]$",
+    "(\\w+)=([^&;\\s]*)",
+    "(['\"])(?:(?!\\1).)*\\1",
+};
+static const intptr_t kNumRegExpBenchmarkPatterns =
+    ARRAY_SIZE(kRegExpBenchmarkPatterns);
+
+static RawString* RegExpBenchmarkSubject() {
+  const char* kLine =
+      "GET /api/items?id=1234&fields=name;sort=asc HTTP/1.1\n"
+      "Host: 192.168.10.254 'quoted text' user.name+tag@example.com\n";
+  const intptr_t kNumLines = 100;
+  const intptr_t line_length = strlen(kLine);
+  char* buffer = new char[kNumLines * line_length + 1];
+  for (intptr_t i = 0; i < kNumLines; i++) {
+    memmove(&buffer[i * line_length], kLine, line_length);
+  }
+  buffer[kNumLines * line_length] = '\0';
+  RawString* subject = String::New(buffer);
+  delete[] buffer;
+  return subject;
+}
+
+static RawInstance* ExecuteRegExp(RegExpBackend backend,
+                                  const RegExp& regexp,
+                                  const String& subject,
+                                  const Smi& start_index,
+                                  Zone* zone) {
+  switch (backend) {
+    case kRegExpIR:
+      return IRRegExpMacroAssembler::Execute(regexp, subject, start_index,
+                                             /*sticky=*/false, zone);
+    case kRegExpBytecode:
+      return BytecodeRegExpMacroAssembler::Interpret(
+          regexp, subject, start_index, /*sticky=*/false, zone);
+    case kRegExpNative:
+#if defined(DART_NATIVE_IRREGEXP)
+      return NativeRegExpMacroAssembler::Execute(regexp, subject, start_index,
+                                                 /*sticky=*/false, zone);
+#endif
+      break;
+  }
+  UNREACHABLE();
+  return Instance::null();
+}
+
+static bool IsRegExpBackendSupported(RegExpBackend backend) {
+  switch (backend) {
+    case kRegExpIR:
+      return !USING_DBC;
+    case kRegExpBytecode:
+      return true;
+    case kRegExpNative:
+#if defined(DART_NATIVE_IRREGEXP)
+      return true;
+#else
+      return false;
+#endif
+  }
+  UNREACHABLE();
+  return false;
+}
+
+// Compilation happens on the first match, so the score is the time to create
+// the regexps and run one short match with each.
+static void RunRegExpCompileBenchmark(Benchmark* benchmark,
+                                      Thread* thread,
+                                      RegExpBackend backend,
+                                      const char* name) {
+  if (!IsRegExpBackendSupported(backend)) {
+    benchmark->set_score(0);
+    return;
+  }
+  TransitionNativeToVM transition(thread);
+  Zone* zone = thread->zone();
+  RegExpBackendScope scope(backend);
+  const String& subject = String::Handle(String::New("x"));
+  const Smi& start_index = Smi::Handle(Smi::New(0));
+  const intptr_t kLoopCount = 20;
+  String& pattern = String::Handle();
+  RegExp& regexp = RegExp::Handle();
+  Timer timer(true, name);
+  timer.Start();
+  for (intptr_t r = 0; r < kLoopCount; r++) {
+    for (intptr_t i = 0; i < kNumRegExpBenchmarkPatterns; i++) {
+      pattern = String::New(kRegExpBenchmarkPatterns[i]);
+      regexp = RegExpEngine::CreateRegExp(thread, pattern,
+                                          /*multi_line=*/true,
+                                          /*ignore_case=*/false);
+      ExecuteRegExp(backend, regexp, subject, start_index, zone);
+    }
+  }
+  timer.Stop();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+// Finds all matches of each pattern in a subject of about 12KB.
+static void RunRegExpMatchBenchmark(Benchmark* benchmark,
+                                    Thread* thread,
+                                    RegExpBackend backend,
+                                    const char* name) {
+  if (!IsRegExpBackendSupported(backend)) {
+    benchmark->set_score(0);
+    return;
+  }
+  TransitionNativeToVM transition(thread);
+  Zone* zone = thread->zone();
+  RegExpBackendScope scope(backend);
+  const String& subject = String::Handle(RegExpBenchmarkSubject());
+  const GrowableObjectArray& regexps =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  String& pattern = String::Handle();
+  RegExp& regexp = RegExp::Handle();
+  Smi& start_index = Smi::Handle(Smi::New(0));
+  for (intptr_t i = 0; i < kNumRegExpBenchmarkPatterns; i++) {
+    pattern = String::New(kRegExpBenchmarkPatterns[i]);
+    regexp = RegExpEngine::CreateRegExp(thread, pattern,
+                                        /*multi_line=*/true,
+                                        /*ignore_case=*/false);
+    // Warmup first to leave compilation out of the score.
+    ExecuteRegExp(backend, regexp, subject, start_index, zone);
+    regexps.Add(regexp);
+  }
+
+  const intptr_t kLoopCount = 5;
+  intptr_t matches = 0;
+  Object& match = Object::Handle();
+  Timer timer(true, name);
+  timer.Start();
+  for (intptr_t r = 0; r < kLoopCount; r++) {
+    for (intptr_t i = 0; i < regexps.Length(); i++) {
+      regexp ^= regexps.At(i);
+      intptr_t index = 0;
+      while (index <= subject.Length()) {
+        StackZone stack_zone(thread);
+        start_index = Smi::New(index);
+        match = ExecuteRegExp(backend, regexp, subject, start_index,
+                              stack_zone.GetZone());
+        if (match.IsNull()) break;
+        matches++;
+        // The end of the whole match is the second register.
+        intptr_t end;
+        if (match.IsTypedData()) {
+          end = TypedData::Cast(match).GetInt32(sizeof(int32_t));
+        } else {
+          end = Smi::Value(Smi::RawCast(Array::Cast(match).At(1)));
+        }
+        index = (end > index) ? end : index + 1;
+      }
+    }
+  }
+  timer.Stop();
+  EXPECT(matches > 0);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+BENCHMARK(RegExpCompileIR) {
+  RunRegExpCompileBenchmark(benchmark, thread, kRegExpIR,
+                            "RegExp IR compile benchmark");
+}
+
+BENCHMARK(RegExpCompileBytecode) {
+  RunRegExpCompileBenchmark(benchmark, thread, kRegExpBytecode,
+                            "RegExp bytecode compile benchmark");
+}
+
+BENCHMARK(RegExpCompileNative) {
+  RunRegExpCompileBenchmark(benchmark, thread, kRegExpNative,
+                            "RegExp native compile benchmark");
+}
+
+BENCHMARK(RegExpMatchIR) {
+  RunRegExpMatchBenchmark(benchmark, thread, kRegExpIR,
+                          "RegExp IR match benchmark");
+}
+
+BENCHMARK(RegExpMatchBytecode) {
+  RunRegExpMatchBenchmark(benchmark, thread, kRegExpBytecode,
+                          "RegExp bytecode match benchmark");
+}
+
+BENCHMARK(RegExpMatchNative) {
+  RunRegExpMatchBenchmark(benchmark, thread, kRegExpNative,
+                          "RegExp native match benchmark");
+}
+
+//
+// Compare the call overhead of regular natives and leaf natives. Whether a
+// native is called as a leaf is decided when the native function is compiled,
+// so the flag stays set for the whole run.
+//
+class LeafNativesScope : public ValueObject {
+ public:
+  explicit LeafNativesScope(bool leaf_natives)
+      : saved_leaf_natives_(FLAG_leaf_natives) {
+    FLAG_leaf_natives = leaf_natives;
+  }
+  ~LeafNativesScope() { FLAG_leaf_natives = saved_leaf_natives_; }
+
+ private:
+  const bool saved_leaf_natives_;
+};
+
+static void RunNativeCallBenchmark(Benchmark* benchmark,
+                                   bool leaf_natives,
+                                   const char* entry,
+                                   const char* name) {
+  const char* kScript =
+      "import 'dart:developer';\n"
+      "import 'dart:math';\n"
+      "benchmarkInt(int n) {\n"
+      "  int sum = 0;\n"
+      "  for (int i = 0; i < n; i++) {\n"
+      "    sum += Timeline.now & 1;\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n"
+      "benchmarkDouble(int n) {\n"
+      "  double sum = 0.0;\n"
+      "  for (int i = 0; i < n; i++) {\n"
+      "    sum += exp(-i.toDouble());\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  const intptr_t kNumCalls = 1000000;
+  LeafNativesScope scope(leaf_natives);
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle args[1];
+  // Warmup first to avoid compilation jitters.
+  args[0] = Dart_NewInteger(kNumCalls / 10);
+  EXPECT_VALID(Dart_Invoke(lib, NewString(entry), 1, args));
+  args[0] = Dart_NewInteger(kNumCalls);
+  Timer timer(true, name);
+  timer.Start();
+  Dart_Handle result = Dart_Invoke(lib, NewString(entry), 1, args);
+  timer.Stop();
+  EXPECT_VALID(result);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+BENCHMARK(NativeCallIntRegular) {
+  RunNativeCallBenchmark(benchmark, false, "benchmarkInt",
+                         "Regular int native call benchmark");
+}
+
+BENCHMARK(NativeCallIntLeaf) {
+  RunNativeCallBenchmark(benchmark, true, "benchmarkInt",
+                         "Leaf int native call benchmark");
+}
+
+BENCHMARK(NativeCallDoubleRegular) {
+  RunNativeCallBenchmark(benchmark, false, "benchmarkDouble",
+                         "Regular double native call benchmark");
+}
+
+BENCHMARK(NativeCallDoubleLeaf) {
+  RunNativeCallBenchmark(benchmark, true, "benchmarkDouble",
+                         "Leaf double native call benchmark");
+}
+
+//
+// Measure posting large typed data messages to a native port: copied from C,
+// transferred from C as external typed data, and sent from Dart.
+//
+static const intptr_t kFrameSize = 1 * MB;
+static const intptr_t kNumFrames = 100;
+
+static Monitor* frames_monitor = NULL;
+static intptr_t frames_received = 0;
+
+static void FreeFrame(void* isolate_callback_data,
+                      Dart_WeakPersistentHandle handle,
+                      void* peer) {
+  free(peer);
+}
+
+static void FrameHandler(Dart_Port dest_port_id, Dart_CObject* message) {
+  if (message->type == Dart_CObject_kExternalTypedData) {
+    // The handler owns external typed data.
+    EXPECT_EQ(kFrameSize, message->value.as_external_typed_data.length);
+    message->value.as_external_typed_data.callback(
+        NULL, NULL, message->value.as_external_typed_data.peer);
+  } else {
+    EXPECT_EQ(Dart_CObject_kTypedData, message->type);
+    EXPECT_EQ(kFrameSize, message->value.as_typed_data.length);
+  }
+  MonitorLocker ml(frames_monitor);
+  frames_received++;
+  ml.Notify();
+}
+
+static void WaitForFrames() {
+  MonitorLocker ml(frames_monitor);
+  while (frames_received < kNumFrames) {
+    ml.Wait();
+  }
+}
+
+static void RunPostCObjectBenchmark(Benchmark* benchmark,
+                                    bool external,
+                                    const char* name) {
+  frames_monitor = new Monitor();
+  frames_received = 0;
+  Dart_Port port = Dart_NewNativePort("FrameHandler", FrameHandler, false);
+  EXPECT(port != ILLEGAL_PORT);
+  uint8_t* frame = reinterpret_cast<uint8_t*>(malloc(kFrameSize));
+  memset(frame, 42, kFrameSize);
+  Timer timer(true, name);
+  timer.Start();
+  for (intptr_t i = 0; i < kNumFrames; i++) {
+    Dart_CObject message;
+    if (external) {
+      // Every frame is a new buffer handed over to the receiver.
+      uint8_t* data = reinterpret_cast<uint8_t*>(malloc(kFrameSize));
+      message.type = Dart_CObject_kExternalTypedData;
+      message.value.as_external_typed_data.type = Dart_TypedData_kUint8;
+      message.value.as_external_typed_data.length = kFrameSize;
+      message.value.as_external_typed_data.data = data;
+      message.value.as_external_typed_data.peer = data;
+      message.value.as_external_typed_data.callback = FreeFrame;
+    } else {
+      message.type = Dart_CObject_kTypedData;
+      message.value.as_typed_data.type = Dart_TypedData_kUint8;
+      message.value.as_typed_data.length = kFrameSize;
+      message.value.as_typed_data.values = frame;
+    }
+    EXPECT(Dart_PostCObject(port, &message));
+  }
+  WaitForFrames();
+  timer.Stop();
+  free(frame);
+  EXPECT(Dart_CloseNativePort(port));
+  delete frames_monitor;
+  frames_monitor = NULL;
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+BENCHMARK(PostCObjectTypedData) {
+  RunPostCObjectBenchmark(benchmark, false, "PostCObject typed data benchmark");
+}
+
+BENCHMARK(PostCObjectExternalTypedData) {
+  RunPostCObjectBenchmark(benchmark, true,
+                          "PostCObject external typed data benchmark");
+}
+
+BENCHMARK(NativePortReceiveTypedData) {
+  const char* kScript =
+      "import 'dart:isolate';\n"
+      "import 'dart:typed_data';\n"
+      "benchmark(SendPort port, int count, int size) {\n"
+      "  var frame = new Uint8List(size);\n"
+      "  for (int i = 0; i < count; i++) {\n"
+      "    port.send(frame);\n"
+      "  }\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+  frames_monitor = new Monitor();
+  frames_received = 0;
+  Dart_Port port = Dart_NewNativePort("FrameHandler", FrameHandler, false);
+  EXPECT(port != ILLEGAL_PORT);
+  Dart_Handle args[3];
+  args[0] = Dart_NewSendPort(port);
+  args[1] = Dart_NewInteger(kNumFrames);
+  args[2] = Dart_NewInteger(kFrameSize);
+  Timer timer(true, "Native port receive typed data benchmark");
+  timer.Start();
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 3, args));
+  WaitForFrames();
+  timer.Stop();
+  EXPECT(Dart_CloseNativePort(port));
+  delete frames_monitor;
+  frames_monitor = NULL;
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+//
+// Measure interning of symbols by several threads at once, as done by the
+// mutator, the background compiler and the kernel loader. Most symbols
+// already exist, and each thread also inserts symbols of its own.
+//
+static const intptr_t kNumSharedSymbols = 1000;
+static const intptr_t kNumOwnSymbols = 100;
+static const intptr_t kNumInterningRounds = 100;
+
+class SymbolInterningTask : public ThreadPool::Task {
+ public:
+  SymbolInterningTask(Isolate* isolate,
+                      intptr_t id,
+                      Monitor* monitor,
+                      intptr_t* done_count)
+      : isolate_(isolate),
+        id_(id),
+        monitor_(monitor),
+        done_count_(done_count) {}
+
+  virtual void Run() {
+    Thread::EnterIsolateAsHelper(isolate_, Thread::kUnknownTask);
+    {
+      Thread* thread = Thread::Current();
+      StackZone stack_zone(thread);
+      HANDLESCOPE(thread);
+      String& symbol = String::Handle(thread->zone());
+      for (intptr_t round = 0; round < kNumInterningRounds; round++) {
+        for (intptr_t i = 0; i < kNumSharedSymbols; i++) {
+          symbol = Symbols::NewFormatted(thread, "shared%" Pd, i);
+        }
+        symbol = Symbols::NewFormatted(thread, "own%" Pd "_%" Pd, id_,
+                                       round % kNumOwnSymbols);
+      }
+    }
+    Thread::ExitIsolateAsHelper();
+    MonitorLocker ml(monitor_);
+    ++*done_count_;
+    ml.Notify();
+  }
+
+ private:
+  Isolate* isolate_;
+  intptr_t id_;
+  Monitor* monitor_;
+  intptr_t* done_count_;
+};
+
+BENCHMARK(ConcurrentSymbolInterning) {
+  const intptr_t kNumTasks = 4;
+  TransitionNativeToVM transition(thread);
+  String& symbol = String::Handle();
+  for (intptr_t i = 0; i < kNumSharedSymbols; i++) {
+    symbol = Symbols::NewFormatted(thread, "shared%" Pd, i);
+  }
+  Monitor monitor;
+  intptr_t done_count = 0;
+  Timer timer(true, "Concurrent symbol interning benchmark");
+  timer.Start();
+  for (intptr_t i = 0; i < kNumTasks; i++) {
+    Dart::thread_pool()->Run(
+        new SymbolInterningTask(thread->isolate(), i, &monitor, &done_count));
+  }
+  {
+    MonitorLocker ml(&monitor);
+    while (done_count < kNumTasks) {
+      ml.WaitWithSafepointCheck(thread);
+    }
+  }
+  timer.Stop();
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+//
+// Measure allocation throughput and full collection time with a heap of a few
+// hundred megabytes, e.g., to compare runs with and without --use_huge_pages.
+//
+static const char* kLargeHeapScript =
+    "class Node {\n"
+    "  var left, right;\n"
+    "  Node(this.left, this.right);\n"
+    "}\n"
+    "Node build(int depth) => depth == 0\n"
+    "    ? new Node(null, null)\n"
+    "    : new Node(build(depth - 1), build(depth - 1));\n"
+    "var trees;\n"
+    "benchmark() {\n"
+    "  trees = new List(4);\n"
+    "  for (int i = 0; i < trees.length; i++) {\n"
+    "    trees[i] = build(20);\n"
+    "  }\n"
+    "}\n";
+
+BENCHMARK(LargeHeapAllocation) {
+  Dart_Handle lib = TestCase::LoadTestScript(kLargeHeapScript, NULL);
+  EXPECT_VALID(lib);
+  Timer timer(true, "Large heap allocation benchmark");
+  timer.Start();
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  timer.Stop();
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+BENCHMARK(LargeHeapMarkSweep) {
+  const intptr_t kNumIterations = 5;
+  Dart_Handle lib = TestCase::LoadTestScript(kLargeHeapScript, NULL);
+  EXPECT_VALID(lib);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 0, NULL));
+  TransitionNativeToVM transition(thread);
+  Heap* heap = thread->isolate()->heap();
+  Timer timer(true, "Large heap mark-sweep benchmark");
+  for (intptr_t i = 0; i < kNumIterations; i++) {
+    timer.Start();
+    heap->CollectAllGarbage();
+    timer.Stop();
+  }
+  benchmark->set_score(timer.TotalElapsedTime() / kNumIterations);
+}
+
 BENCHMARK_MEMORY(InitialRSS) {
   benchmark->set_score(bin::Process::MaxRSS());
 }
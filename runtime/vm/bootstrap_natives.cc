@@ -64,6 +64,26 @@ const uint8_t* BootstrapNatives::Symbol(Dart_NativeFunction* nf) {
   return NULL;
 }
 
+#define REGISTER_LEAF_NATIVE_ENTRY(name, entry, signature)                     \
+  {"" #name, signature, &k##entry##RuntimeEntry},
+
+static const LeafNativeEntry BootStrapLeafEntries[] = {
+    BOOTSTRAP_LEAF_NATIVE_LIST(REGISTER_LEAF_NATIVE_ENTRY)};
+
+const LeafNativeEntry* BootstrapNatives::LookupLeaf(const char* name) {
+  const intptr_t num_entries =
+      sizeof(BootStrapLeafEntries) / sizeof(LeafNativeEntry);
+  for (intptr_t i = 0; i < num_entries; i++) {
+    const LeafNativeEntry* entry = &(BootStrapLeafEntries[i]);
+    if (strcmp(name, entry->name_) == 0) {
+      ASSERT(entry->argument_count() <= LeafNativeEntry::kMaxArguments);
+      ASSERT(entry->argument_count() == entry->entry().argument_count());
+      return entry;
+    }
+  }
+  return NULL;
+}
+
 void Bootstrap::SetupNativeResolver() {
   Library& library = Library::Handle();
 
@@ -118,6 +118,9 @@ namespace dart {
   V(StringBase_createFromCodePoints, 3)                                        \
   V(StringBase_substringUnchecked, 3)                                          \
   V(StringBase_joinReplaceAllResult, 4)                                        \
+  V(StringBase_indexOf, 3)                                                     \
+  V(StringBase_lastIndexOf, 3)                                                 \
+  V(StringBase_compareTo, 2)                                                   \
   V(StringBuffer_createStringFromUint16Array, 3)                               \
   V(OneByteString_substringUnchecked, 3)                                       \
   V(OneByteString_splitWithCharCode, 2)                                        \
@@ -326,6 +329,8 @@ namespace dart {
   V(LinkedHashMap_setUsedData, 2)                                              \
   V(LinkedHashMap_getDeletedKeys, 1)                                           \
   V(LinkedHashMap_setDeletedKeys, 2)                                           \
+  V(LinkedHashMap_rehash, 3)                                                   \
+  V(LinkedHashMap_reserve, 2)                                                  \
   V(WeakProperty_new, 2)                                                       \
   V(WeakProperty_getKey, 1)                                                    \
   V(WeakProperty_getValue, 1)                                                  \
@@ -406,6 +411,26 @@ namespace dart {
   V(TypedefMirror_declaration, 1)                                              \
   V(VariableMirror_type, 2)
 
+// Bootstrap natives that can also be called as leaf natives (see
+// LeafNativeEntry): the name of the native, the leaf runtime entry that
+// implements it and its signature.
+#define BOOTSTRAP_LEAF_NATIVE_LIST(V)                                          \
+  V(Math_sqrt, LibcSqrt, "dd")                                                 \
+  V(Math_sin, LibcSin, "dd")                                                   \
+  V(Math_cos, LibcCos, "dd")                                                   \
+  V(Math_tan, LibcTan, "dd")                                                   \
+  V(Math_asin, LibcAsin, "dd")                                                 \
+  V(Math_acos, LibcAcos, "dd")                                                 \
+  V(Math_atan, LibcAtan, "dd")                                                 \
+  V(Math_atan2, LibcAtan2, "ddd")                                              \
+  V(Math_exp, LibcExp, "dd")                                                   \
+  V(Math_log, LibcLog, "dd")                                                   \
+  V(Math_doublePow, LibcPow, "ddd")                                            \
+  V(Stopwatch_now, StopwatchNow, "i")                                          \
+  V(Stopwatch_frequency, StopwatchFrequency, "i")                              \
+  V(Timeline_getTraceClock, TimelineGetTraceClock, "i")                        \
+  V(Timeline_getThreadCpuClock, TimelineGetThreadCpuClock, "i")
+
 class BootstrapNatives : public AllStatic {
  public:
   static Dart_NativeFunction Lookup(Dart_Handle name,
@@ -414,6 +439,9 @@ class BootstrapNatives : public AllStatic {
 
   static const uint8_t* Symbol(Dart_NativeFunction* nf);
 
+  // Returns the leaf native called 'name', or NULL.
+  static const LeafNativeEntry* LookupLeaf(const char* name);
+
 #define DECLARE_BOOTSTRAP_NATIVE(name, ignored)                                \
   static void DN_##name(Dart_NativeArguments args);
 
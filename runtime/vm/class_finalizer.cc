@@ -8,6 +8,7 @@
 #include "vm/hash_table.h"
 #include "vm/heap.h"
 #include "vm/isolate.h"
+#include "vm/kernel_loader.h"
 #include "vm/log.h"
 #include "vm/longjump.h"
 #include "vm/object_store.h"
@@ -151,11 +152,14 @@ bool ClassFinalizer::ProcessPendingClasses(bool from_kernel) {
 
     // Classes compiled from Dart sources are finalized more lazily, classes
     // compiled from Kernel binaries can be finalized now (and should be,
-    // since we will not revisit them).
+    // since we will not revisit them). Classes whose members are still to be
+    // read are finalized on first use.
     if (from_kernel) {
       for (intptr_t i = 0; i < class_array.Length(); i++) {
         cls ^= class_array.At(i);
-        FinalizeClass(cls);
+        if (!cls.has_pending_kernel_members()) {
+          FinalizeClass(cls);
+        }
       }
     }
 
@@ -2629,6 +2633,11 @@ void ClassFinalizer::FinalizeClass(const Class& cls) {
   if (FLAG_trace_class_finalization) {
     THR_Print("Finalize %s\n", cls.ToCString());
   }
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  if (cls.has_pending_kernel_members()) {
+    kernel::KernelLoader::FinishLoading(cls);
+  }
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
   if (cls.is_patch()) {
     // The fields and functions of a patch class are copied to the
     // patched class after parsing. There is nothing to finalize.
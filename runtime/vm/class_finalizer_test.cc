@@ -4,11 +4,15 @@
 
 #include "vm/class_finalizer.h"
 #include "platform/assert.h"
+#include "vm/dart_api_impl.h"
 #include "vm/symbols.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, lazy_kernel_loading);
+DECLARE_FLAG(bool, use_dart_frontend);
+
 static RawClass* CreateTestClass(const char* name) {
   const String& class_name =
       String::Handle(Symbols::New(Thread::Current(), name));
@@ -99,4 +103,48 @@ TEST_CASE(ClassFinalize_Resolve) {
   EXPECT(ClassFinalizer::ProcessPendingClasses());
 }
 
+TEST_CASE(ClassFinalize_LazyKernelLoading) {
+  if (!FLAG_use_dart_frontend) {
+    return;
+  }
+  const char* kScriptChars =
+      "class Used {\n"
+      "  var field = 40;\n"
+      "  method() => field + 2;\n"
+      "}\n"
+      "class Unused {\n"
+      "  method() => 0;\n"
+      "}\n"
+      "main() => new Used().method();\n";
+  const bool saved_flag = FLAG_lazy_kernel_loading;
+  FLAG_lazy_kernel_loading = true;
+  Dart_Handle h_lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  FLAG_lazy_kernel_loading = saved_flag;
+  EXPECT_VALID(h_lib);
+  Library& lib = Library::Handle();
+  lib ^= Api::UnwrapHandle(h_lib);
+  const Class& used =
+      Class::Handle(lib.LookupClass(String::Handle(String::New("Used"))));
+  const Class& unused =
+      Class::Handle(lib.LookupClass(String::Handle(String::New("Unused"))));
+  EXPECT(used.has_pending_kernel_members());
+  EXPECT(unused.has_pending_kernel_members());
+  EXPECT(!used.is_finalized());
+
+  Dart_Handle result = Dart_Invoke(h_lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(42, value);
+
+  EXPECT(!used.has_pending_kernel_members());
+  EXPECT(used.is_finalized());
+  EXPECT_EQ(1, Array::Handle(used.fields()).Length());
+  EXPECT(unused.has_pending_kernel_members());
+  EXPECT(!Function::Handle(unused.LookupDynamicFunction(String::Handle(
+                               Symbols::New(thread, "method"))))
+              .IsNull());
+  EXPECT(!unused.has_pending_kernel_members());
+}
+
 }  // namespace dart
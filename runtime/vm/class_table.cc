@@ -16,6 +16,16 @@
 namespace dart {
 
 DEFINE_FLAG(bool, print_class_table, false, "Print initial class table.");
+DEFINE_FLAG(bool,
+            pretenuring,
+            false,
+            "Allocate objects of classes that mostly survive their first "
+            "scavenge directly in old space.");
+DEFINE_FLAG(int,
+            pretenuring_survival_percent,
+            90,
+            "Pretenure a class when at least this percentage of its new "
+            "objects survive their first scavenge.");
 
 ClassTable::ClassTable()
     : top_(kNumPredefinedCids),
@@ -104,6 +114,11 @@ bool ClassTable::TraceAllocationFor(intptr_t cid) {
   ClassHeapStats* stats = PreliminaryStatsAt(cid);
   return stats->trace_allocation();
 }
+
+bool ClassTable::PretenureFor(intptr_t cid) {
+  ClassHeapStats* stats = PreliminaryStatsAt(cid);
+  return stats->pretenure();
+}
 #endif  // !PRODUCT
 
 void ClassTable::Register(const Class& cls) {
@@ -283,8 +298,14 @@ void ClassHeapStats::Initialize() {
   last_reset.Reset();
   promoted_count = 0;
   promoted_size = 0;
+  old_pre_new_gc_count_ = 0;
+  old_pre_new_gc_size_ = 0;
+  new_pre_new_gc_count_ = 0;
+  new_survived_count_ = 0;
+  sampled_new_count_ = 0;
+  surviving_new_count_ = 0;
+  old_pre_old_gc_count_ = 0;
   state_ = 0;
-  USE(align_);
 }
 
 void ClassHeapStats::ResetAtNewGC() {
@@ -298,6 +319,8 @@ void ClassHeapStats::ResetAtNewGC() {
   accumulated.new_size += recent.new_size - last_reset.new_size;
   accumulated.new_external_size +=
       recent.new_external_size - last_reset.new_external_size;
+  new_pre_new_gc_count_ = recent.new_count;
+  new_survived_count_ = 0;
   last_reset.ResetNew();
   post_gc.ResetNew();
   recent.ResetNew();
@@ -316,6 +339,7 @@ void ClassHeapStats::ResetAtOldGC() {
   accumulated.old_size += recent.old_size - last_reset.old_size;
   accumulated.old_external_size +=
       recent.old_external_size - last_reset.old_external_size;
+  old_pre_old_gc_count_ = recent.old_count;
   last_reset.ResetOld();
   post_gc.ResetOld();
   recent.ResetOld();
@@ -354,6 +378,44 @@ void ClassHeapStats::ResetAccumulator() {
 void ClassHeapStats::UpdatePromotedAfterNewGC() {
   promoted_count = recent.old_count - old_pre_new_gc_count_;
   promoted_size = recent.old_size - old_pre_new_gc_size_;
+  if (FLAG_pretenuring) {
+    UpdatePretenuringAfterNewGC();
+  }
+}
+
+void ClassHeapStats::UpdatePretenuringAfterNewGC() {
+  // Everything allocated since the previous new GC was scavenged for the
+  // first time.
+  sampled_new_count_ += new_pre_new_gc_count_;
+  surviving_new_count_ += new_survived_count_;
+  if (sampled_new_count_ < kPretenuringMinSamples) {
+    return;
+  }
+  if (static_cast<int64_t>(surviving_new_count_) * 100 >=
+      static_cast<int64_t>(sampled_new_count_) *
+          FLAG_pretenuring_survival_percent) {
+    set_pretenure(true);
+  }
+  // Decay the samples so that the decision follows recent behavior.
+  sampled_new_count_ /= 2;
+  surviving_new_count_ /= 2;
+}
+
+void ClassHeapStats::UpdatePretenuringAfterOldGC() {
+  if (!pretenure() || (old_pre_old_gc_count_ < kPretenuringMinSamples)) {
+    return;
+  }
+  // Pretenured objects no longer show up in new space. Instead, assume the
+  // objects that died were allocated since the previous old GC, and stop
+  // pretenuring when fewer of those survived than required to start.
+  const intptr_t died = pre_gc.old_count - post_gc.old_count;
+  if (static_cast<int64_t>(died) * 100 >
+      static_cast<int64_t>(old_pre_old_gc_count_) *
+          (100 - FLAG_pretenuring_survival_percent)) {
+    set_pretenure(false);
+    sampled_new_count_ = 0;
+    surviving_new_count_ = 0;
+  }
 }
 
 void ClassHeapStats::PrintToJSONObject(const Class& cls,
@@ -393,6 +455,9 @@ void ClassHeapStats::PrintToJSONObject(const Class& cls,
   }
   obj->AddProperty("promotedInstances", promoted_count);
   obj->AddProperty("promotedBytes", promoted_size);
+  obj->AddProperty("_pretenured", pretenure());
+  obj->AddProperty("_sampledNewInstances", sampled_new_count_);
+  obj->AddProperty("_survivingNewInstances", surviving_new_count_);
 }
 
 void ClassTable::UpdateAllocatedNew(intptr_t cid, intptr_t size) {
@@ -479,6 +544,18 @@ void ClassTable::UpdatePromoted() {
   }
 }
 
+void ClassTable::UpdatePretenuring() {
+  if (!FLAG_pretenuring) {
+    return;
+  }
+  for (intptr_t i = 0; i < kNumPredefinedCids; i++) {
+    predefined_class_heap_stats_table_[i].UpdatePretenuringAfterOldGC();
+  }
+  for (intptr_t i = kNumPredefinedCids; i < top_; i++) {
+    class_heap_stats_table_[i].UpdatePretenuringAfterOldGC();
+  }
+}
+
 ClassHeapStats** ClassTable::TableAddressFor(intptr_t cid) {
   return (cid < kNumPredefinedCids) ? &predefined_class_heap_stats_table_
                                     : &class_heap_stats_table_;
@@ -577,6 +654,12 @@ void ClassTable::UpdateLiveNew(intptr_t cid, intptr_t size) {
   stats->post_gc.AddNew(size);
 }
 
+void ClassTable::UpdateSurvivedNew(intptr_t cid) {
+  ClassHeapStats* stats = PreliminaryStatsAt(cid);
+  ASSERT(stats != NULL);
+  stats->AddSurvivedNew();
+}
+
 void ClassTable::UpdateLiveOldExternal(intptr_t cid, intptr_t size) {
   ClassHeapStats* stats = PreliminaryStatsAt(cid);
   ASSERT(stats != NULL);
@@ -120,12 +120,18 @@ class ClassHeapStats {
   }
   static intptr_t state_offset() { return OFFSET_OF(ClassHeapStats, state_); }
   static intptr_t TraceAllocationMask() { return (1 << kTraceAllocationBit); }
+  // Generated code takes the allocation slow path for classes with any of
+  // these bits set.
+  static intptr_t SlowPathAllocationMask() {
+    return TraceAllocationMask() | (1 << kPretenureBit);
+  }
 
   void Initialize();
   void ResetAtNewGC();
   void ResetAtOldGC();
   void ResetAccumulator();
   void UpdatePromotedAfterNewGC();
+  void UpdatePretenuringAfterOldGC();
   void UpdateSize(intptr_t instance_size);
 #ifndef PRODUCT
   void PrintToJSONObject(const Class& cls, JSONObject* obj) const;
@@ -138,19 +144,50 @@ class ClassHeapStats {
     state_ = TraceAllocationBit::update(trace_allocation, state_);
   }
 
+  // Whether objects of this class are allocated directly in old space,
+  // because most of them survive their first scavenge.
+  bool pretenure() const { return PretenureBit::decode(state_); }
+
+  void set_pretenure(bool pretenure) {
+    state_ = PretenureBit::update(pretenure, state_);
+  }
+
+  // Called by the scavenger for objects that survive their first scavenge.
+  void AddSurvivedNew() {
+    AtomicOperations::IncrementBy(&new_survived_count_, 1);
+  }
+
  private:
   enum StateBits {
     kTraceAllocationBit = 0,
+    kPretenureBit = 1,
   };
 
   class TraceAllocationBit
       : public BitField<intptr_t, bool, kTraceAllocationBit, 1> {};
+  class PretenureBit : public BitField<intptr_t, bool, kPretenureBit, 1> {};
+
+  // Number of allocations observed before deciding to pretenure a class, or
+  // to stop pretenuring it.
+  static const intptr_t kPretenuringMinSamples = 1024;
+
+  void UpdatePretenuringAfterNewGC();
 
   // Recent old at start of last new GC (used to compute promoted_*).
   intptr_t old_pre_new_gc_count_;
   intptr_t old_pre_new_gc_size_;
+  // Recent new at start of last new GC, and how many of those objects
+  // survived it.
+  intptr_t new_pre_new_gc_count_;
+  intptr_t new_survived_count_;
+  // New objects and first scavenge survivors, decayed across new GCs.
+  intptr_t sampled_new_count_;
+  intptr_t surviving_new_count_;
+  // Recent old at start of last old GC.
+  intptr_t old_pre_old_gc_count_;
   intptr_t state_;
-  intptr_t align_;  // Make SIMARM and ARM agree on the size of ClassHeapStats.
+  // Keep an even number of intptr_t fields so that SIMARM and ARM agree on
+  // the size of ClassHeapStats.
 };
 #endif  // !PRODUCT
 
@@ -225,6 +262,8 @@ class ClassTable {
   void ResetCountersNew();
   // Called immediately after a new GC.
   void UpdatePromoted();
+  // Called immediately after an old GC.
+  void UpdatePretenuring();
 
   // Used by the generated code.
   ClassHeapStats** TableAddressFor(intptr_t cid);
@@ -253,6 +292,7 @@ class ClassTable {
 
   void SetTraceAllocationFor(intptr_t cid, bool trace);
   bool TraceAllocationFor(intptr_t cid);
+  bool PretenureFor(intptr_t cid);
 
  private:
   friend class GCMarker;
@@ -280,6 +320,7 @@ class ClassTable {
   ClassHeapStats* PreliminaryStatsAt(intptr_t cid);
   void UpdateLiveOld(intptr_t cid, intptr_t size, intptr_t count = 1);
   void UpdateLiveNew(intptr_t cid, intptr_t size);
+  void UpdateSurvivedNew(intptr_t cid);
   void UpdateLiveOldExternal(intptr_t cid, intptr_t size);
   void UpdateLiveNewExternal(intptr_t cid, intptr_t size);
 #endif  // !PRODUCT
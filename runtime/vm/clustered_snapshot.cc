@@ -16,6 +16,7 @@
 #include "vm/native_entry.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
+#include "vm/string_hasher.h"
 #include "vm/stub_code.h"
 #include "vm/symbols.h"
 #include "vm/timeline.h"
@@ -236,14 +237,28 @@ class ClassDeserializationCluster : public DeserializationCluster {
          i++) {
       cls ^= refs.At(i);
       cls.RehashConstants(zone);
+      RehashFunctions(cls, zone);
     }
     for (intptr_t i = start_index_; i < stop_index_; i++) {
       cls ^= refs.At(i);
       cls.RehashConstants(zone);
+      RehashFunctions(cls, zone);
     }
   }
 
  private:
+  // The functions lookup table is keyed by name hashes, which the snapshot
+  // recorded unseeded.
+  static void RehashFunctions(const Class& cls, Zone* zone) {
+    if (!StringHasher::IsSeeded()) {
+      return;
+    }
+    const Array& functions = Array::Handle(zone, cls.functions());
+    if (!functions.IsNull()) {
+      cls.SetFunctions(functions);
+    }
+  }
+
   intptr_t predefined_start_index_;
   intptr_t predefined_stop_index_;
 };
@@ -1449,6 +1464,23 @@ class LibraryDeserializationCluster : public DeserializationCluster {
       lib->ptr()->is_in_fullsnapshot_ = true;
     }
   }
+
+  void PostLoad(const Array& refs, Snapshot::Kind kind, Zone* zone) {
+    if (!StringHasher::IsSeeded()) {
+      return;
+    }
+    // Dictionaries are keyed by name hashes, which the snapshot recorded
+    // unseeded.
+    Library& lib = Library::Handle(zone);
+    Array& dict = Array::Handle(zone);
+    for (intptr_t i = start_index_; i < stop_index_; i++) {
+      lib ^= refs.At(i);
+      dict = lib.dictionary();
+      if (!dict.IsNull()) {
+        lib.RehashDictionary(dict, dict.Length() - 1);
+      }
+    }
+  }
 };
 
 #if !defined(DART_PRECOMPILED_RUNTIME)
@@ -1898,17 +1930,13 @@ class RODataSerializationCluster : public SerializationCluster {
     if (cid_ == kOneByteStringCid) {
       RawOneByteString* str = static_cast<RawOneByteString*>(object);
       if (String::GetCachedHash(str) == 0) {
-        intptr_t hash =
-            String::Hash(str->ptr()->data(), Smi::Value(str->ptr()->length_));
-        String::SetCachedHash(str, hash);
+        String::SetCachedHash(str, String::Hash(str));
       }
       ASSERT(String::GetCachedHash(str) != 0);
     } else if (cid_ == kTwoByteStringCid) {
       RawTwoByteString* str = static_cast<RawTwoByteString*>(object);
       if (String::GetCachedHash(str) == 0) {
-        intptr_t hash = String::Hash(str->ptr()->data(),
-                                     Smi::Value(str->ptr()->length_) * 2);
-        String::SetCachedHash(str, hash);
+        String::SetCachedHash(str, String::Hash(str));
       }
       ASSERT(String::GetCachedHash(str) != 0);
     }
@@ -3900,7 +3928,7 @@ class RegExpSerializationCluster : public SerializationCluster {
     RawObject** from = regexp->from();
     RawObject** to = regexp->to();
     for (RawObject** p = from; p <= to; p++) {
-      s->Push(*p);
+      s->Push(WithoutNativeCode(*p));
     }
   }
 
@@ -3921,7 +3949,7 @@ class RegExpSerializationCluster : public SerializationCluster {
       RawObject** from = regexp->from();
       RawObject** to = regexp->to();
       for (RawObject** p = from; p <= to; p++) {
-        s->WriteRef(*p);
+        s->WriteRef(WithoutNativeCode(*p));
       }
 
       s->Write<int32_t>(regexp->ptr()->num_registers_);
@@ -3930,6 +3958,15 @@ class RegExpSerializationCluster : public SerializationCluster {
   }
 
  private:
+  // Matchers compiled by the native regexp assembler are not written; they
+  // are recompiled on first use after the snapshot is loaded.
+  static RawObject* WithoutNativeCode(RawObject* object) {
+    if (object->IsHeapObject() && object->IsCode()) {
+      return Object::null();
+    }
+    return object;
+  }
+
   GrowableArray<RawRegExp*> objects_;
 };
 #endif  // !DART_PRECOMPILED_RUNTIME
@@ -4329,10 +4366,15 @@ class OneByteStringDeserializationCluster : public DeserializationCluster {
                                      OneByteString::InstanceSize(length),
                                      is_vm_object, is_canonical);
       str->ptr()->length_ = Smi::New(length);
-      String::SetCachedHash(str, d->Read<int32_t>());
+      intptr_t hash = d->Read<int32_t>();
       for (intptr_t j = 0; j < length; j++) {
         str->ptr()->data()[j] = d->Read<uint8_t>();
       }
+      if (StringHasher::IsSeeded()) {
+        // Snapshots record unseeded hashes.
+        hash = String::Hash(str);
+      }
+      String::SetCachedHash(str, hash);
     }
   }
 };
@@ -4406,9 +4448,14 @@ class TwoByteStringDeserializationCluster : public DeserializationCluster {
                                      TwoByteString::InstanceSize(length),
                                      is_vm_object, is_canonical);
       str->ptr()->length_ = Smi::New(length);
-      String::SetCachedHash(str, d->Read<int32_t>());
+      intptr_t hash = d->Read<int32_t>();
       uint8_t* cdata = reinterpret_cast<uint8_t*>(str->ptr()->data());
       d->ReadBytes(cdata, length * 2);
+      if (StringHasher::IsSeeded()) {
+        // Snapshots record unseeded hashes.
+        hash = String::Hash(str);
+      }
+      String::SetCachedHash(str, hash);
     }
   }
 };
@@ -5111,6 +5158,16 @@ RawApiError* Deserializer::VerifyVersionAndFeatures(Isolate* isolate) {
     return ApiError::New(msg, Heap::kOld);
   }
   free(const_cast<char*>(expected_features));
+
+  if (Snapshot::IncludesCode(kind_) && StringHasher::IsSeeded()) {
+    // String hashes live in read-only snapshot data and cannot be reseeded.
+    const String& msg = String::Handle(
+        String::New("Snapshots containing code cannot be loaded with "
+                    "--randomize_string_hashes",
+                    Heap::kOld));
+    return ApiError::New(msg, Heap::kOld);
+  }
+
   Advance(expected_len + 1);
   return ApiError::null();
 }
@@ -5130,6 +5187,8 @@ void Deserializer::Deserialize() {
            " base objects, but deserializer provided %" Pd,
            num_base_objects_, next_ref_index_ - 1);
   }
+  // Objects are allocated unmarked, so incremental marking would miss them.
+  ASSERT(!thread()->isolate()->heap()->old_space()->IsMarkingIncrementally());
 
   {
     NOT_IN_PRODUCT(TimelineDurationScope tds(
@@ -5256,6 +5315,11 @@ void Deserializer::ReadVMSnapshot() {
   // allocations (e.g., FinalizeVMIsolate) before allocating new pages.
   heap_->old_space()->AbandonBumpAllocation();
 
+  if (StringHasher::IsSeeded()) {
+    // The symbol table was built with the unseeded hashes of the writer.
+    Symbols::RehashSymbolTable(isolate());
+  }
+
   Symbols::InitOnceFromSnapshot(isolate());
 
   Object::set_vm_isolate_snapshot_object_table(refs);
@@ -5311,6 +5375,18 @@ void Deserializer::ReadIsolateSnapshot(ObjectStore* object_store) {
     }
   }
 
+  if (StringHasher::IsSeeded()) {
+    // The remaining tables keyed by string hashes were built with the
+    // unseeded hashes of the writer.
+    Symbols::RehashSymbolTable(thread()->isolate());
+    Library::RegisterLibraries(
+        thread(),
+        GrowableObjectArray::Handle(zone_, object_store->libraries()));
+#if !defined(DART_PRECOMPILED_RUNTIME)
+    ClassFinalizer::RehashTypes();
+#endif
+  }
+
   // Setup native resolver for bootstrap impl.
   Bootstrap::SetupNativeResolver();
 }
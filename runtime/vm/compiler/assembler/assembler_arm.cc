@@ -1616,6 +1616,40 @@ void Assembler::StoreIntoObject(Register object,
   Bind(&done);
 }
 
+void Assembler::StoreIntoArray(Register object,
+                               Register slot,
+                               Register value,
+                               bool can_value_be_smi) {
+  ASSERT(object != value);
+  ASSERT(slot != value);
+  str(value, Address(slot, 0));
+  Label done;
+  if (can_value_be_smi) {
+    StoreIntoObjectFilter(object, value, &done);
+  } else {
+    StoreIntoObjectFilterNoSmi(object, value, &done);
+  }
+  // A card mark or store buffer update is required.
+  RegList regs = (1 << CODE_REG) | (1 << LR);
+  if (value != R0) {
+    regs |= (1 << R0);  // Preserve R0.
+  }
+  if (value != R1) {
+    regs |= (1 << R1);  // Preserve R1.
+  }
+  PushList(regs);
+  // Move the object to R0 and the slot to R1.
+  Push(object);
+  Push(slot);
+  Pop(R1);
+  Pop(R0);
+  ldr(LR, Address(THR, Thread::array_write_barrier_entry_point_offset()));
+  ldr(CODE_REG, Address(THR, Thread::array_write_barrier_code_offset()));
+  blx(LR);
+  PopList(regs);
+  Bind(&done);
+}
+
 void Assembler::StoreIntoObjectOffset(Register object,
                                       int32_t offset,
                                       Register value,
@@ -3099,7 +3133,7 @@ void Assembler::MaybeTraceAllocation(intptr_t cid,
   LoadAllocationStatsAddress(temp_reg, cid);
   const uword state_offset = ClassHeapStats::state_offset();
   ldr(temp_reg, Address(temp_reg, state_offset));
-  tst(temp_reg, Operand(ClassHeapStats::TraceAllocationMask()));
+  tst(temp_reg, Operand(ClassHeapStats::SlowPathAllocationMask()));
   b(trace, NE);
 }
 
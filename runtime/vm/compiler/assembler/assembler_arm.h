@@ -794,6 +794,13 @@ class Assembler : public ValueObject {
                        const Address& dest,  // Where we are storing into.
                        Register value,       // Value we are storing.
                        bool can_value_be_smi = true);
+  // Stores into an element of an Array. Large arrays are card remembered
+  // (see RawObject::IsCardRemembered), so the barrier needs the slot.
+  // Destroys value.
+  void StoreIntoArray(Register object,  // Array we are storing into.
+                      Register slot,    // Address of the element.
+                      Register value,   // Value we are storing.
+                      bool can_value_be_smi = true);
   void StoreIntoObjectOffset(Register object,
                              int32_t offset,
                              Register value,
@@ -1069,8 +1076,9 @@ class Assembler : public ValueObject {
   void LoadWordUnaligned(Register dst, Register addr, Register tmp);
   void StoreWordUnaligned(Register src, Register addr, Register tmp);
 
-  // If allocation tracing for |cid| is enabled, will jump to |trace| label,
-  // which will allocate in the runtime where tracing occurs.
+  // If allocation tracing or pretenuring for |cid| is enabled, will jump to
+  // |trace| label, which will allocate in the runtime where tracing and
+  // pretenuring occur.
   void MaybeTraceAllocation(intptr_t cid, Register temp_reg, Label* trace);
 
   // Inlined allocation of an instance of class 'cls', code has no runtime
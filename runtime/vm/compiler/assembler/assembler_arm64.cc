@@ -867,6 +867,49 @@ void Assembler::StoreIntoObject(Register object,
   Bind(&done);
 }
 
+void Assembler::StoreIntoArray(Register object,
+                               Register slot,
+                               Register value,
+                               bool can_value_be_smi) {
+  ASSERT(object != value);
+  ASSERT(slot != value);
+  str(value, Address(slot, 0));
+  Label done;
+  if (can_value_be_smi) {
+    StoreIntoObjectFilter(object, value, &done);
+  } else {
+    StoreIntoObjectFilterNoSmi(object, value, &done);
+  }
+  // A card mark or store buffer update is required.
+  if (value != R0) {
+    // Preserve R0.
+    Push(R0);
+  }
+  if (value != R1) {
+    // Preserve R1.
+    Push(R1);
+  }
+  Push(LR);
+  // Move the object to R0 and the slot to R1.
+  Push(object);
+  Push(slot);
+  Pop(R1);
+  Pop(R0);
+  ldr(TMP, Address(THR, Thread::array_write_barrier_entry_point_offset()));
+  ldr(CODE_REG, Address(THR, Thread::array_write_barrier_code_offset()));
+  blr(TMP);
+  Pop(LR);
+  if (value != R1) {
+    // Restore R1.
+    Pop(R1);
+  }
+  if (value != R0) {
+    // Restore R0.
+    Pop(R0);
+  }
+  Bind(&done);
+}
+
 void Assembler::StoreIntoObjectNoBarrier(Register object,
                                          const Address& dest,
                                          Register value) {
@@ -1208,7 +1251,7 @@ void Assembler::MaybeTraceAllocation(intptr_t cid,
   ldr(temp_reg, Address(temp_reg, table_offset));
   AddImmediate(temp_reg, state_offset);
   ldr(temp_reg, Address(temp_reg, 0));
-  tsti(temp_reg, Immediate(ClassHeapStats::TraceAllocationMask()));
+  tsti(temp_reg, Immediate(ClassHeapStats::SlowPathAllocationMask()));
   b(trace, NE);
 }
 
@@ -451,6 +451,8 @@ class Assembler : public ValueObject {
 
   // Misc. functionality
   intptr_t CodeSize() const { return buffer_.Size(); }
+  // Address of code at offset.
+  uword CodeAddress(intptr_t offset) { return buffer_.Address(offset); }
   intptr_t prologue_offset() const { return prologue_offset_; }
   bool has_single_entry_point() const { return has_single_entry_point_; }
 
@@ -1239,6 +1241,13 @@ class Assembler : public ValueObject {
                        const Address& dest,
                        Register value,
                        bool can_value_be_smi = true);
+  // Stores into an element of an Array. Large arrays are card remembered
+  // (see RawObject::IsCardRemembered), so the barrier needs the slot.
+  // Destroys value.
+  void StoreIntoArray(Register object,  // Array we are storing into.
+                      Register slot,    // Address of the element.
+                      Register value,   // Value we are storing.
+                      bool can_value_be_smi = true);
   void StoreIntoObjectOffset(Register object,
                              int32_t offset,
                              Register value,
@@ -1321,8 +1330,9 @@ class Assembler : public ValueObject {
                                      Register size_reg,
                                      Heap::Space space);
 
-  // If allocation tracing for |cid| is enabled, will jump to |trace| label,
-  // which will allocate in the runtime where tracing occurs.
+  // If allocation tracing or pretenuring for |cid| is enabled, will jump to
+  // |trace| label, which will allocate in the runtime where tracing and
+  // pretenuring occur.
   void MaybeTraceAllocation(intptr_t cid, Register temp_reg, Label* trace);
 
   // Inlined allocation of an instance of class 'cls', code has no runtime
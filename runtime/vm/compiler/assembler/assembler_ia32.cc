@@ -2022,6 +2022,42 @@ void Assembler::StoreIntoObject(Register object,
   Bind(&done);
 }
 
+// Destroys the value register.
+void Assembler::StoreIntoArray(Register object,
+                               Register slot,
+                               Register value,
+                               bool can_value_be_smi) {
+  ASSERT(object != value);
+  ASSERT(slot != value);
+  movl(Address(slot, 0), value);
+  Label done;
+  if (can_value_be_smi) {
+    StoreIntoObjectFilter(object, value, &done);
+  } else {
+    StoreIntoObjectFilterNoSmi(object, value, &done);
+  }
+  // A card mark or store buffer update is required.
+  if (value != EDX) {
+    pushl(EDX);  // Preserve EDX.
+  }
+  if (value != EAX) {
+    pushl(EAX);  // Preserve EAX.
+  }
+  // Move the object to EDX and the slot to EAX.
+  pushl(object);
+  pushl(slot);
+  popl(EAX);
+  popl(EDX);
+  call(Address(THR, Thread::array_write_barrier_entry_point_offset()));
+  if (value != EAX) {
+    popl(EAX);  // Restore EAX.
+  }
+  if (value != EDX) {
+    popl(EDX);  // Restore EDX.
+  }
+  Bind(&done);
+}
+
 void Assembler::StoreIntoObjectNoBarrier(Register object,
                                          const Address& dest,
                                          Register value) {
@@ -2289,9 +2325,9 @@ void Assembler::MaybeTraceAllocation(intptr_t cid,
       Isolate::class_table_offset() + ClassTable::TableOffsetFor(cid);
   movl(temp_reg, Address(temp_reg, table_offset));
   state_address = Address(temp_reg, state_offset);
-  testb(state_address, Immediate(ClassHeapStats::TraceAllocationMask()));
-  // We are tracing for this class, jump to the trace label which will use
-  // the allocation stub.
+  testb(state_address, Immediate(ClassHeapStats::SlowPathAllocationMask()));
+  // We are tracing or pretenuring this class, jump to the trace label which
+  // will use the allocation stub.
   j(NOT_ZERO, trace, near_jump);
 }
 
@@ -668,6 +668,13 @@ class Assembler : public ValueObject {
                        const Address& dest,  // Where we are storing into.
                        Register value,       // Value we are storing.
                        bool can_value_be_smi = true);
+  // Stores into an element of an Array. Large arrays are card remembered
+  // (see RawObject::IsCardRemembered), so the barrier needs the slot.
+  // Destroys value.
+  void StoreIntoArray(Register object,  // Array we are storing into.
+                      Register slot,    // Address of the element.
+                      Register value,   // Value we are storing.
+                      bool can_value_be_smi = true);
 
   void StoreIntoObjectNoBarrier(Register object,
                                 const Address& dest,
@@ -842,8 +849,9 @@ class Assembler : public ValueObject {
     return kEntryPointToPcMarkerOffset;
   }
 
-  // If allocation tracing for |cid| is enabled, will jump to |trace| label,
-  // which will allocate in the runtime where tracing occurs.
+  // If allocation tracing or pretenuring for |cid| is enabled, will jump to
+  // |trace| label, which will allocate in the runtime where tracing and
+  // pretenuring occur.
   void MaybeTraceAllocation(intptr_t cid,
                             Register temp_reg,
                             Label* trace,
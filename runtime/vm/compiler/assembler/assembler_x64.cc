@@ -2684,6 +2684,38 @@ void Assembler::StoreIntoObject(Register object,
   Bind(&done);
 }
 
+void Assembler::StoreIntoArray(Register object,
+                               Register slot,
+                               Register value,
+                               bool can_value_be_smi) {
+  ASSERT(object != value);
+  ASSERT(slot != value);
+  movq(Address(slot, 0), value);
+  Label done;
+  if (can_value_be_smi) {
+    StoreIntoObjectFilter(object, value, &done);
+  } else {
+    StoreIntoObjectFilterNoSmi(object, value, &done);
+  }
+  // A card mark or store buffer update is required.
+  if (value != RDX) pushq(RDX);
+  if (value != RAX) pushq(RAX);
+  // Move the object to RDX and the slot to RAX.
+  pushq(object);
+  pushq(slot);
+  popq(RAX);
+  popq(RDX);
+  pushq(CODE_REG);
+  movq(TMP, Address(THR, Thread::array_write_barrier_entry_point_offset()));
+  movq(CODE_REG, Address(THR, Thread::array_write_barrier_code_offset()));
+  call(TMP);
+
+  popq(CODE_REG);
+  if (value != RAX) popq(RAX);
+  if (value != RDX) popq(RDX);
+  Bind(&done);
+}
+
 void Assembler::StoreIntoObjectNoBarrier(Register object,
                                          const Address& dest,
                                          Register value) {
@@ -3055,9 +3087,9 @@ void Assembler::MaybeTraceAllocation(intptr_t cid,
       Isolate::class_table_offset() + ClassTable::TableOffsetFor(cid);
   movq(temp_reg, Address(temp_reg, table_offset));
   testb(Address(temp_reg, state_offset),
-        Immediate(ClassHeapStats::TraceAllocationMask()));
-  // We are tracing for this class, jump to the trace label which will use
-  // the allocation stub.
+        Immediate(ClassHeapStats::SlowPathAllocationMask()));
+  // We are tracing or pretenuring this class, jump to the trace label which
+  // will use the allocation stub.
   j(NOT_ZERO, trace, near_jump);
 }
 
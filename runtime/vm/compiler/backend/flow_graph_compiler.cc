@@ -170,6 +170,7 @@ FlowGraphCompiler::FlowGraphCompiler(
 bool FlowGraphCompiler::IsUnboxedField(const Field& field) {
   bool valid_class =
       (SupportsUnboxedDoubles() && (field.guarded_cid() == kDoubleCid)) ||
+      (SupportsUnboxedMintFields() && (field.guarded_cid() == kMintCid)) ||
       (SupportsUnboxedSimd128() && (field.guarded_cid() == kFloat32x4Cid)) ||
       (SupportsUnboxedSimd128() && (field.guarded_cid() == kFloat64x2Cid));
   return field.is_unboxing_candidate() && !field.is_final() &&
@@ -1880,8 +1881,8 @@ void FlowGraphCompiler::FrameStateUpdateWith(Instruction* instr) {
 
 void FlowGraphCompiler::FrameStatePush(Definition* defn) {
   Representation rep = defn->representation();
-  if ((rep == kUnboxedDouble) || (rep == kUnboxedFloat64x2) ||
-      (rep == kUnboxedFloat32x4)) {
+  if ((rep == kUnboxedDouble) || (rep == kUnboxedInt64) ||
+      (rep == kUnboxedFloat64x2) || (rep == kUnboxedFloat32x4)) {
     // LoadField instruction lies about its representation in the unoptimized
     // code because Definition::representation() can't depend on the type of
     // compilation but MakeLocationSummary and EmitNativeCode can.
@@ -278,6 +278,7 @@ class FlowGraphCompiler : public ValueObject {
   static bool SupportsUnboxedDoubles();
   static bool SupportsUnboxedMints();
   static bool SupportsUnboxedSimd128();
+  static bool SupportsUnboxedMintFields();
   static bool SupportsHardwareDivision();
   static bool CanConvertUnboxedMintToDouble();
 
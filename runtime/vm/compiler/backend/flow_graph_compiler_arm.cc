@@ -48,6 +48,10 @@ bool FlowGraphCompiler::SupportsUnboxedSimd128() {
   return TargetCPUFeatures::neon_supported() && FLAG_enable_simd_inline;
 }
 
+bool FlowGraphCompiler::SupportsUnboxedMintFields() {
+  return false;
+}
+
 bool FlowGraphCompiler::SupportsHardwareDivision() {
   return TargetCPUFeatures::can_divide();
 }
@@ -46,6 +46,10 @@ bool FlowGraphCompiler::SupportsUnboxedSimd128() {
   return FLAG_enable_simd_inline;
 }
 
+bool FlowGraphCompiler::SupportsUnboxedMintFields() {
+  return false;
+}
+
 bool FlowGraphCompiler::CanConvertUnboxedMintToDouble() {
   // ARM does not have a short instruction sequence for converting int64 to
   // double.
@@ -54,6 +54,10 @@ bool FlowGraphCompiler::SupportsUnboxedSimd128() {
   return false;
 }
 
+bool FlowGraphCompiler::SupportsUnboxedMintFields() {
+  return false;
+}
+
 bool FlowGraphCompiler::SupportsHardwareDivision() {
   return true;
 }
@@ -51,6 +51,10 @@ bool FlowGraphCompiler::SupportsUnboxedSimd128() {
   return FLAG_enable_simd_inline;
 }
 
+bool FlowGraphCompiler::SupportsUnboxedMintFields() {
+  return false;
+}
+
 bool FlowGraphCompiler::SupportsHardwareDivision() {
   return true;
 }
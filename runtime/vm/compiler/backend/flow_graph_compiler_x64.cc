@@ -24,6 +24,10 @@ namespace dart {
 
 DEFINE_FLAG(bool, trap_on_deoptimization, false, "Trap on deoptimization.");
 DEFINE_FLAG(bool, unbox_mints, true, "Optimize 64-bit integer arithmetic.");
+DEFINE_FLAG(bool,
+            unbox_mint_fields,
+            true,
+            "Store instance fields that only hold mints in a mutable box.");
 DECLARE_FLAG(bool, enable_simd_inline);
 
 FlowGraphCompiler::~FlowGraphCompiler() {
@@ -47,6 +51,10 @@ bool FlowGraphCompiler::SupportsUnboxedSimd128() {
   return FLAG_enable_simd_inline;
 }
 
+bool FlowGraphCompiler::SupportsUnboxedMintFields() {
+  return FLAG_unbox_mint_fields && SupportsUnboxedMints();
+}
+
 bool FlowGraphCompiler::SupportsHardwareDivision() {
   return true;
 }
@@ -8,6 +8,7 @@
 
 #include "vm/bit_vector.h"
 #include "vm/bootstrap.h"
+#include "vm/bootstrap_natives.h"
 #include "vm/compiler/backend/constant_propagator.h"
 #include "vm/compiler/backend/flow_graph_compiler.h"
 #include "vm/compiler/backend/linearscan.h"
@@ -42,7 +43,12 @@ DEFINE_FLAG(bool,
 DEFINE_FLAG(bool,
             unbox_numeric_fields,
             !USING_DBC,
-            "Support unboxed double and float32x4 fields.");
+            "Support unboxed double, mint and float32x4 fields.");
+DEFINE_FLAG(bool,
+            leaf_natives,
+            true,
+            "Call natives that have a leaf version directly with unboxed "
+            "arguments (x64 and arm64 only).");
 DECLARE_FLAG(bool, eliminate_type_checks);
 
 #if defined(DEBUG)
@@ -351,6 +357,8 @@ Representation LoadFieldInstr::representation() const {
     switch (cid) {
       case kDoubleCid:
         return kUnboxedDouble;
+      case kMintCid:
+        return kUnboxedInt64;
       case kFloat32x4Cid:
         return kUnboxedFloat32x4;
       case kFloat64x2Cid:
@@ -380,6 +388,8 @@ Representation StoreInstanceFieldInstr::RequiredInputRepresentation(
     switch (cid) {
       case kDoubleCid:
         return kUnboxedDouble;
+      case kMintCid:
+        return kUnboxedInt64;
       case kFloat32x4Cid:
         return kUnboxedFloat32x4;
       case kFloat64x2Cid:
@@ -4208,7 +4218,35 @@ intptr_t TruncDivModInstr::OutputIndexOf(Token::Kind token) {
   }
 }
 
+const LeafNativeEntry* NativeCallInstr::LookupLeafNative() const {
+#if (defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)) &&               \
+    !defined(USING_SIMULATOR)
+  if (!FLAG_leaf_natives || function().HasOptionalParameters() ||
+      function().IsGeneric()) {
+    return NULL;
+  }
+  Zone* zone = Thread::Current()->zone();
+  const Class& cls = Class::Handle(zone, function().Owner());
+  const Library& library = Library::Handle(zone, cls.library());
+  if (!Bootstrap::IsBootstapResolver(library.native_entry_resolver())) {
+    return NULL;
+  }
+  const LeafNativeEntry* leaf =
+      BootstrapNatives::LookupLeaf(native_name().ToCString());
+  if ((leaf == NULL) ||
+      (leaf->argument_count() != function().NumParameters())) {
+    return NULL;
+  }
+  return leaf;
+#else
+  return NULL;
+#endif
+}
+
 void NativeCallInstr::SetupNative() {
+  // Leaf natives are called through the thread's runtime entry table, so
+  // they do not depend on how the regular native is linked.
+  leaf_native_ = LookupLeafNative();
   if (link_lazily()) {
     // Resolution will happen during NativeEntry::LinkNativeCall.
     return;
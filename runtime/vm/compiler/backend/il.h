@@ -31,6 +31,7 @@ class FlowGraphBuilder;
 class FlowGraphCompiler;
 class FlowGraphVisitor;
 class Instruction;
+struct LeafNativeEntry;
 class LocalVariable;
 class ParsedFunction;
 class Range;
@@ -3526,6 +3527,7 @@ class NativeCallInstr : public TemplateDefinition<0, Throws> {
       : native_name_(&node->native_c_function_name()),
         function_(&node->function()),
         native_c_function_(NULL),
+        leaf_native_(NULL),
         is_bootstrap_native_(false),
         link_lazily_(node->link_lazily()),
         token_pos_(node->token_pos()) {}
@@ -3537,6 +3539,7 @@ class NativeCallInstr : public TemplateDefinition<0, Throws> {
       : native_name_(name),
         function_(function),
         native_c_function_(NULL),
+        leaf_native_(NULL),
         is_bootstrap_native_(false),
         is_auto_scope_(true),
         link_lazily_(link_lazily),
@@ -3547,6 +3550,9 @@ class NativeCallInstr : public TemplateDefinition<0, Throws> {
   const String& native_name() const { return *native_name_; }
   const Function& function() const { return *function_; }
   NativeFunction native_c_function() const { return native_c_function_; }
+  // The leaf version of the native if it has one and it can be called
+  // directly on this platform, or NULL.
+  const LeafNativeEntry* leaf_native() const { return leaf_native_; }
   bool is_bootstrap_native() const { return is_bootstrap_native_; }
   bool is_auto_scope() const { return is_auto_scope_; }
   bool link_lazily() const { return link_lazily_; }
@@ -3568,9 +3574,17 @@ class NativeCallInstr : public TemplateDefinition<0, Throws> {
   void set_is_bootstrap_native(bool value) { is_bootstrap_native_ = value; }
   void set_is_auto_scope(bool value) { is_auto_scope_ = value; }
 
+  const LeafNativeEntry* LookupLeafNative() const;
+
+  // Calls the leaf native with the parameters unboxed and boxes its result.
+  // Jumps to 'not_leaf' before the call if a parameter does not have the
+  // expected type.
+  void EmitLeafNativeCall(FlowGraphCompiler* compiler, Label* not_leaf);
+
   const String* native_name_;
   const Function* function_;
   NativeFunction native_c_function_;
+  const LeafNativeEntry* leaf_native_;
   bool is_bootstrap_native_;
   bool is_auto_scope_;
   bool link_lazily_;
@@ -1310,6 +1310,9 @@ LocationSummary* StoreIndexedInstr::MakeLocationSummary(Zone* zone,
   const intptr_t kNumInputs = 3;
   LocationSummary* locs;
 
+  // The card marking barrier of arrays needs the address of the element.
+  const bool store_into_array =
+      (class_id() == kArrayCid) && ShouldEmitStoreBarrier();
   bool needs_base = false;
   intptr_t kNumTemps = 0;
   if (CanBeImmediateIndex(index(), class_id(), IsExternal(),
@@ -1317,7 +1320,7 @@ LocationSummary* StoreIndexedInstr::MakeLocationSummary(Zone* zone,
                           &needs_base)) {
     if (!aligned()) {
       kNumTemps += 2;
-    } else if (needs_base) {
+    } else if (needs_base || store_into_array) {
       kNumTemps += 1;
     }
 
@@ -1329,6 +1332,8 @@ LocationSummary* StoreIndexedInstr::MakeLocationSummary(Zone* zone,
   } else {
     if (!aligned()) {
       kNumTemps += 2;
+    } else if (store_into_array) {
+      kNumTemps += 1;
     }
 
     locs = new (zone)
@@ -1384,9 +1389,11 @@ void StoreIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
       (locs()->temp_count() > 0) ? locs()->temp(0).reg() : kNoRegister;
   const Register temp2 =
       (locs()->temp_count() > 1) ? locs()->temp(1).reg() : kNoRegister;
+  const bool store_into_array =
+      (class_id() == kArrayCid) && ShouldEmitStoreBarrier();
 
   Address element_address(kNoRegister);
-  if (aligned()) {
+  if (aligned() && !store_into_array) {
     element_address = index.IsRegister()
                           ? __ ElementAddressForRegIndex(
                                 false,  // Store.
@@ -1415,7 +1422,7 @@ void StoreIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
     case kArrayCid:
       if (ShouldEmitStoreBarrier()) {
         const Register value = locs()->in(2).reg();
-        __ StoreIntoObject(array, element_address, value);
+        __ StoreIntoArray(array, temp, value);
       } else if (locs()->in(2).IsConstant()) {
         const Object& constant = locs()->in(2).constant();
         __ StoreIntoObjectNoBarrier(array, element_address, constant);
@@ -664,6 +664,13 @@ void NativeCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   SetupNative();
   const Register result = locs()->out(0).reg();
 
+  Label not_leaf, done;
+  if (leaf_native() != NULL) {
+    EmitLeafNativeCall(compiler, &not_leaf);
+    __ b(&done);
+    __ Bind(&not_leaf);
+  }
+
   // Push the result place holder initialized to NULL.
   __ PushObject(Object::null_object());
   // Pass a pointer to the first argument in R2.
@@ -713,6 +720,7 @@ void NativeCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
                            locs());
   }
   __ Pop(result);
+  __ Bind(&done);
 }
 
 LocationSummary* OneByteStringFromCharCodeInstr::MakeLocationSummary(
@@ -1168,7 +1176,9 @@ Representation StoreIndexedInstr::RequiredInputRepresentation(
 LocationSummary* StoreIndexedInstr::MakeLocationSummary(Zone* zone,
                                                         bool opt) const {
   const intptr_t kNumInputs = 3;
-  const intptr_t kNumTemps = aligned() ? 0 : 2;
+  const bool store_into_array =
+      (class_id() == kArrayCid) && ShouldEmitStoreBarrier();
+  const intptr_t kNumTemps = aligned() ? (store_into_array ? 1 : 0) : 2;
   LocationSummary* locs = new (zone)
       LocationSummary(zone, kNumInputs, kNumTemps, LocationSummary::kNoCall);
   locs->set_in(0, Location::RequiresRegister());
@@ -1182,6 +1192,10 @@ LocationSummary* StoreIndexedInstr::MakeLocationSummary(Zone* zone,
       locs->set_in(2, ShouldEmitStoreBarrier()
                           ? Location::WritableRegister()
                           : Location::RegisterOrConstant(value()));
+      if (store_into_array) {
+        // The address of the element, for the card marking barrier.
+        locs->set_temp(0, Location::RequiresRegister());
+      }
       break;
     case kExternalTypedDataUint8ArrayCid:
     case kExternalTypedDataUint8ClampedArrayCid:
@@ -1219,11 +1233,14 @@ void StoreIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   // The array register points to the backing store for external arrays.
   const Register array = locs()->in(0).reg();
   const Location index = locs()->in(1);
-  const Register address = aligned() ? kNoRegister : locs()->temp(0).reg();
+  const bool store_into_array =
+      (class_id() == kArrayCid) && ShouldEmitStoreBarrier();
+  const Register address =
+      (aligned() && !store_into_array) ? kNoRegister : locs()->temp(0).reg();
   const Register scratch = aligned() ? kNoRegister : locs()->temp(1).reg();
 
   Address element_address(TMP);  // Bad address.
-  if (aligned()) {
+  if (aligned() && !store_into_array) {
     element_address =
         index.IsRegister()
             ? __ ElementAddressForRegIndex(false,  // Store.
@@ -1250,7 +1267,7 @@ void StoreIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
       ASSERT(aligned());
       if (ShouldEmitStoreBarrier()) {
         const Register value = locs()->in(2).reg();
-        __ StoreIntoObject(array, element_address, value);
+        __ StoreIntoArray(array, address, value);
       } else if (locs()->in(2).IsConstant()) {
         const Object& constant = locs()->in(2).constant();
         __ StoreIntoObjectNoBarrier(array, element_address, constant);
@@ -1709,6 +1726,120 @@ static void EnsureMutableBox(FlowGraphCompiler* compiler,
   __ Bind(&done);
 }
 
+void NativeCallInstr::EmitLeafNativeCall(FlowGraphCompiler* compiler,
+                                         Label* not_leaf) {
+  const LeafNativeEntry& leaf = *leaf_native();
+  const intptr_t num_params = function().NumParameters();
+  ASSERT(leaf.argument_count() == num_params);
+  ASSERT(num_params <= LeafNativeEntry::kMaxArguments);
+  static const Register kCpuArgs[LeafNativeEntry::kMaxArguments] = {R0, R1, R2,
+                                                                    R3};
+  static const VRegister kFpuArgs[LeafNativeEntry::kMaxArguments] = {V0, V1, V2,
+                                                                     V3};
+  const Register result = locs()->out(0).reg();
+  ASSERT(result == R0);
+
+  // Unbox the parameters into the argument registers, using R4 as a scratch
+  // register.
+  intptr_t cpu_index = 0;
+  intptr_t fpu_index = 0;
+  for (intptr_t i = 0; i < num_params; i++) {
+    const intptr_t param_offset =
+        (kParamEndSlotFromFp + num_params - i) * kWordSize;
+    switch (leaf.argument_type(i)) {
+      case LeafNativeEntry::kInt64: {
+        const Register reg = kCpuArgs[cpu_index++];
+        Label is_smi, unboxed;
+        __ LoadFromOffset(reg, FP, param_offset);
+        __ BranchIfSmi(reg, &is_smi);
+        __ CompareClassId(reg, kMintCid);
+        __ b(not_leaf, NE);
+        __ LoadFieldFromOffset(reg, reg, Mint::value_offset());
+        __ b(&unboxed);
+        __ Bind(&is_smi);
+        __ SmiUntag(reg);
+        __ Bind(&unboxed);
+        break;
+      }
+      case LeafNativeEntry::kDouble: {
+        const VRegister reg = kFpuArgs[fpu_index++];
+        __ LoadFromOffset(R4, FP, param_offset);
+        __ BranchIfSmi(R4, not_leaf);
+        __ CompareClassId(R4, kDoubleCid);
+        __ b(not_leaf, NE);
+        __ LoadDFieldFromOffset(reg, R4, Double::value_offset());
+        break;
+      }
+      case LeafNativeEntry::kData: {
+        const Register reg = kCpuArgs[cpu_index++];
+        Label external, unboxed;
+        __ LoadFromOffset(reg, FP, param_offset);
+        __ BranchIfSmi(reg, not_leaf);
+        __ LoadClassId(R4, reg);
+        __ AddImmediate(R4, R4, -kTypedDataInt8ArrayCid);
+        __ CompareImmediate(
+            R4, kTypedDataFloat64x2ArrayCid - kTypedDataInt8ArrayCid);
+        __ b(&external, HI);
+        __ AddImmediate(reg, reg, TypedData::data_offset() - kHeapObjectTag);
+        __ b(&unboxed);
+        __ Bind(&external);
+        __ AddImmediate(
+            R4, R4, kTypedDataInt8ArrayCid - kExternalTypedDataInt8ArrayCid);
+        __ CompareImmediate(R4, kExternalTypedDataFloat64x2ArrayCid -
+                                    kExternalTypedDataInt8ArrayCid);
+        __ b(not_leaf, HI);
+        __ LoadFieldFromOffset(reg, reg, ExternalTypedData::data_offset());
+        __ Bind(&unboxed);
+        break;
+      }
+      default:
+        UNREACHABLE();
+    }
+  }
+
+  __ CallRuntime(leaf.entry(), num_params);
+
+  // Box the result. The 64 bits of a result that needs a box are kept on the
+  // stack as two Smis while the box is allocated, as the allocation may call
+  // into the runtime.
+  const Class* box_class = NULL;
+  intptr_t value_offset = 0;
+  Label done;
+  switch (leaf.return_type()) {
+    case LeafNativeEntry::kVoid:
+      __ LoadObject(result, Object::null_object());
+      return;
+    case LeafNativeEntry::kInt64:
+      __ mov(R2, R0);
+      __ adds(result, R0, Operand(R0));
+      __ b(&done, VC);
+      box_class = &compiler->mint_class();
+      value_offset = Mint::value_offset();
+      break;
+    case LeafNativeEntry::kDouble:
+      __ fmovrd(R2, V0);
+      box_class = &compiler->double_class();
+      value_offset = Double::value_offset();
+      break;
+    default:
+      UNREACHABLE();
+  }
+  __ LsrImmediate(R1, R2, 32);
+  __ SmiTag(R1);
+  __ andi(R2, R2, Immediate(0xffffffff));
+  __ SmiTag(R2);
+  __ Push(R1);
+  __ Push(R2);
+  BoxAllocationSlowPath::Allocate(compiler, this, *box_class, result, R1);
+  __ Pop(R2);
+  __ SmiUntag(R2);
+  __ Pop(R1);
+  __ SmiUntag(R1);
+  __ orr(R1, R2, Operand(R1, LSL, 32));
+  __ StoreFieldToOffset(R1, result, value_offset);
+  __ Bind(&done);
+}
+
 LocationSummary* StoreInstanceFieldInstr::MakeLocationSummary(Zone* zone,
                                                               bool opt) const {
   const intptr_t kNumInputs = 2;
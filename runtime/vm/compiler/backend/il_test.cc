@@ -3,10 +3,18 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/compiler/backend/il.h"
+
+#include <math.h>
+
+#include "vm/bootstrap_natives.h"
+#include "vm/native_entry.h"
+#include "vm/os.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, leaf_natives);
+
 TEST_CASE(InstructionTests) {
   TargetEntryInstr* target_instr = new TargetEntryInstr(
       1, CatchClauseNode::kInvalidTryIndex, Thread::kNoDeoptId);
@@ -39,4 +47,145 @@ TEST_CASE(OptimizationTests) {
   EXPECT(!c3->Equals(c1));
 }
 
+
+// Leaf natives run without a safepoint transition, so their entries must be
+// leaf runtime entries, which never allocate or call back into the VM.
+TEST_CASE(LeafNatives_Entries) {
+#define CHECK_LEAF_NATIVE(name, ignored1, ignored2)                            \
+  {                                                                            \
+    const LeafNativeEntry* leaf = BootstrapNatives::LookupLeaf(#name);         \
+    EXPECT(leaf != NULL);                                                      \
+    EXPECT(leaf->entry().is_leaf());                                           \
+    EXPECT_EQ(leaf->argument_count(), leaf->entry().argument_count());         \
+    EXPECT(leaf->argument_count() <= LeafNativeEntry::kMaxArguments);          \
+    EXPECT_EQ(leaf->return_type() == LeafNativeEntry::kDouble,                 \
+              leaf->entry().is_float());                                       \
+  }
+  BOOTSTRAP_LEAF_NATIVE_LIST(CHECK_LEAF_NATIVE)
+#undef CHECK_LEAF_NATIVE
+  EXPECT(BootstrapNatives::LookupLeaf("Math_random") == NULL);
+}
+
+// The natives are bound with the bootstrap resolver, so they are called as
+// leaf natives where that is supported. Their parameters are untyped, so
+// arguments of any type reach the native function. The regular
+// Math_doublePow does not check its first argument, so it is only passed
+// doubles.
+static const char* kLeafNativesScript =
+    "double sqrtNative(x) native 'Math_sqrt';\n"
+    "double powNative(x, y) native 'Math_doublePow';\n"
+    "int frequencyNative() native 'Stopwatch_frequency';\n"
+    "int nowNative() native 'Stopwatch_now';\n"
+    "sqrtOf(double x) => sqrtNative(x);\n"
+    "powOf(double x, double y) => powNative(x, y);\n"
+    "fallback(f()) {\n"
+    "  try {\n"
+    "    f();\n"
+    "  } on ArgumentError {\n"
+    "    return true;\n"
+    "  }\n"
+    "  return false;\n"
+    "}\n"
+    "testFallback() {\n"
+    "  return fallback(() => sqrtNative(4)) &&\n"
+    "      fallback(() => sqrtNative(1 << 62)) &&\n"
+    "      fallback(() => sqrtNative(null)) &&\n"
+    "      fallback(() => sqrtNative('4.0')) &&\n"
+    "      fallback(() => powNative(2.0, 3)) &&\n"
+    "      sqrtNative(4.0) == 2.0 && powNative(2.0, 3.0) == 8.0;\n"
+    "}\n"
+    "testMonotonic() {\n"
+    "  var last = nowNative();\n"
+    "  for (var i = 0; i < 100000; i++) {\n"
+    "    var now = nowNative();\n"
+    "    if (now < last) return false;\n"
+    "    last = now;\n"
+    "  }\n"
+    "  return true;\n"
+    "}\n"
+    "testBoxes(int n) {\n"
+    "  var boxes = new List(n);\n"
+    "  for (var i = 0; i < n; i++) {\n"
+    "    boxes[i] = sqrtNative(i * i + 0.0);\n"
+    "  }\n"
+    "  for (var i = 0; i < n; i++) {\n"
+    "    if (boxes[i] != i) return false;\n"
+    "  }\n"
+    "  return true;\n"
+    "}\n";
+
+static bool InvokeBool(Dart_Handle lib, const char* name) {
+  Dart_Handle result = Dart_Invoke(lib, NewString(name), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  return value;
+}
+
+static void ExpectLeafNatives(bool leaf_natives) {
+  const bool saved_leaf_natives = FLAG_leaf_natives;
+  FLAG_leaf_natives = leaf_natives;
+  Dart_Handle lib = TestCase::LoadTestScript(
+      kLeafNativesScript,
+      reinterpret_cast<Dart_NativeEntryResolver>(BootstrapNatives::Lookup));
+  EXPECT_VALID(lib);
+
+  // Arguments of the wrong type go to the regular native, which throws.
+  EXPECT(InvokeBool(lib, "testFallback"));
+
+  // Double results, including the ones with special bit patterns.
+  const double kValues[] = {0.0, -0.0, 0.5, 2.0, 1e300, -1.0, INFINITY, NAN};
+  const intptr_t kNumValues = ARRAY_SIZE(kValues);
+  Dart_Handle args[2];
+  double value;
+  for (intptr_t i = 0; i < kNumValues; i++) {
+    args[0] = Dart_NewDouble(kValues[i]);
+    Dart_Handle result = Dart_Invoke(lib, NewString("sqrtOf"), 1, args);
+    EXPECT_VALID(result);
+    EXPECT_VALID(Dart_DoubleValue(result, &value));
+    EXPECT_EQ(bit_cast<int64_t>(sqrt(kValues[i])), bit_cast<int64_t>(value));
+    for (intptr_t j = 0; j < kNumValues; j++) {
+      args[1] = Dart_NewDouble(kValues[j]);
+      result = Dart_Invoke(lib, NewString("powOf"), 2, args);
+      EXPECT_VALID(result);
+      EXPECT_VALID(Dart_DoubleValue(result, &value));
+      EXPECT_EQ(bit_cast<int64_t>(pow(kValues[i], kValues[j])),
+                bit_cast<int64_t>(value));
+    }
+  }
+
+  // Integer results.
+  Dart_Handle result = Dart_Invoke(lib, NewString("frequencyNative"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t frequency = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &frequency));
+  EXPECT_EQ(OS::GetCurrentMonotonicFrequency(), frequency);
+  EXPECT(InvokeBool(lib, "testMonotonic"));
+
+  // The result boxes are allocated after the call, which may run a GC. Make
+  // enough of them to trigger scavenges and to optimize the loop.
+  args[0] = Dart_NewInteger(200000);
+  result = Dart_Invoke(lib, NewString("testBoxes"), 1, args);
+  EXPECT_VALID(result);
+  bool boxes_ok = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &boxes_ok));
+  EXPECT(boxes_ok);
+  {
+    TransitionNativeToVM transition(Thread::Current());
+    Heap* heap = Isolate::Current()->heap();
+    heap->CollectAllGarbage();
+    EXPECT(heap->Verify());
+  }
+
+  FLAG_leaf_natives = saved_leaf_natives;
+}
+
+TEST_CASE(LeafNatives_Calls) {
+  ExpectLeafNatives(true);
+}
+
+TEST_CASE(LeafNatives_RegularCalls) {
+  ExpectLeafNatives(false);
+}
+
 }  // namespace dart
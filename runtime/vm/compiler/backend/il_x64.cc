@@ -706,6 +706,13 @@ void NativeCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   Register result = locs()->out(0).reg();
   const intptr_t argc_tag = NativeArguments::ComputeArgcTag(function());
 
+  Label not_leaf, done;
+  if (leaf_native() != NULL) {
+    EmitLeafNativeCall(compiler, &not_leaf);
+    __ jmp(&done);
+    __ Bind(&not_leaf);
+  }
+
   // Push the result place holder initialized to NULL.
   __ PushObject(Object::null_object());
   // Pass a pointer to the first argument in RAX.
@@ -738,6 +745,7 @@ void NativeCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
                            locs());
   }
   __ popq(result);
+  __ Bind(&done);
 }
 
 static bool CanBeImmediateIndex(Value* index, intptr_t cid) {
@@ -1185,7 +1193,8 @@ Representation StoreIndexedInstr::RequiredInputRepresentation(
 LocationSummary* StoreIndexedInstr::MakeLocationSummary(Zone* zone,
                                                         bool opt) const {
   const intptr_t kNumInputs = 3;
-  const intptr_t kNumTemps = 0;
+  const intptr_t kNumTemps =
+      ((class_id() == kArrayCid) && ShouldEmitStoreBarrier()) ? 1 : 0;
   LocationSummary* locs = new (zone)
       LocationSummary(zone, kNumInputs, kNumTemps, LocationSummary::kNoCall);
   locs->set_in(0, Location::RequiresRegister());
@@ -1207,6 +1216,9 @@ LocationSummary* StoreIndexedInstr::MakeLocationSummary(Zone* zone,
       locs->set_in(2, ShouldEmitStoreBarrier()
                           ? Location::WritableRegister()
                           : Location::RegisterOrConstant(value()));
+      if (ShouldEmitStoreBarrier()) {
+        locs->set_temp(0, Location::RequiresRegister());
+      }
       break;
     case kExternalTypedDataUint8ArrayCid:
     case kExternalTypedDataUint8ClampedArrayCid:
@@ -1265,7 +1277,9 @@ void StoreIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
     case kArrayCid:
       if (ShouldEmitStoreBarrier()) {
         Register value = locs()->in(2).reg();
-        __ StoreIntoObject(array, element_address, value);
+        Register slot = locs()->temp(0).reg();
+        __ leaq(slot, element_address);
+        __ StoreIntoArray(array, slot, value);
       } else if (locs()->in(2).IsConstant()) {
         const Object& constant = locs()->in(2).constant();
         __ StoreIntoObjectNoBarrier(array, element_address, constant);
@@ -1660,6 +1674,136 @@ class BoxAllocationSlowPath : public SlowPathCode {
   const Register result_;
 };
 
+void NativeCallInstr::EmitLeafNativeCall(FlowGraphCompiler* compiler,
+                                         Label* not_leaf) {
+  const LeafNativeEntry& leaf = *leaf_native();
+  const intptr_t num_params = function().NumParameters();
+  ASSERT(leaf.argument_count() == num_params);
+  ASSERT(num_params <= LeafNativeEntry::kMaxArguments);
+  static const Register kCpuArgs[LeafNativeEntry::kMaxArguments] = {
+      CallingConventions::kArg1Reg, CallingConventions::kArg2Reg,
+      CallingConventions::kArg3Reg, CallingConventions::kArg4Reg};
+  static const XmmRegister kXmmArgs[LeafNativeEntry::kMaxArguments] = {
+      XMM0, XMM1, XMM2, XMM3};
+  const Register result = locs()->out(0).reg();
+  ASSERT(result == RAX);
+
+  // Unbox the parameters into the argument registers. RAX is not used to pass
+  // arguments and is free to use as a scratch register.
+  intptr_t cpu_index = 0;
+  intptr_t xmm_index = 0;
+  for (intptr_t i = 0; i < num_params; i++) {
+#if defined(_WIN64)
+    // Each argument uses the register for its position, whatever its type.
+    cpu_index = xmm_index = i;
+#endif
+    const Address param(RBP,
+                        (kParamEndSlotFromFp + num_params - i) * kWordSize);
+    switch (leaf.argument_type(i)) {
+      case LeafNativeEntry::kInt64: {
+        const Register reg = kCpuArgs[cpu_index++];
+        Label is_smi, unboxed;
+        __ movq(reg, param);
+        __ testq(reg, Immediate(kSmiTagMask));
+        __ j(ZERO, &is_smi, Assembler::kNearJump);
+        __ CompareClassId(reg, kMintCid);
+        __ j(NOT_EQUAL, not_leaf);
+        __ movq(reg, FieldAddress(reg, Mint::value_offset()));
+        __ jmp(&unboxed, Assembler::kNearJump);
+        __ Bind(&is_smi);
+        __ SmiUntag(reg);
+        __ Bind(&unboxed);
+        break;
+      }
+      case LeafNativeEntry::kDouble: {
+        const XmmRegister reg = kXmmArgs[xmm_index++];
+        __ movq(RAX, param);
+        __ testq(RAX, Immediate(kSmiTagMask));
+        __ j(ZERO, not_leaf);
+        __ CompareClassId(RAX, kDoubleCid);
+        __ j(NOT_EQUAL, not_leaf);
+        __ movsd(reg, FieldAddress(RAX, Double::value_offset()));
+        break;
+      }
+      case LeafNativeEntry::kData: {
+        const Register reg = kCpuArgs[cpu_index++];
+        Label external, unboxed;
+        __ movq(reg, param);
+        __ testq(reg, Immediate(kSmiTagMask));
+        __ j(ZERO, not_leaf);
+        __ LoadClassId(RAX, reg);
+        __ subq(RAX, Immediate(kTypedDataInt8ArrayCid));
+        __ cmpq(RAX, Immediate(kTypedDataFloat64x2ArrayCid -
+                               kTypedDataInt8ArrayCid));
+        __ j(ABOVE, &external, Assembler::kNearJump);
+        __ leaq(reg, FieldAddress(reg, TypedData::data_offset()));
+        __ jmp(&unboxed, Assembler::kNearJump);
+        __ Bind(&external);
+        __ subq(RAX, Immediate(kExternalTypedDataInt8ArrayCid -
+                               kTypedDataInt8ArrayCid));
+        __ cmpq(RAX, Immediate(kExternalTypedDataFloat64x2ArrayCid -
+                               kExternalTypedDataInt8ArrayCid));
+        __ j(ABOVE, not_leaf);
+        __ movq(reg, FieldAddress(reg, ExternalTypedData::data_offset()));
+        __ Bind(&unboxed);
+        break;
+      }
+      default:
+        UNREACHABLE();
+    }
+  }
+
+  // R13 is callee saved in the C calling convention, so it survives the call.
+  __ movq(R13, RSP);
+  __ ReserveAlignedFrameSpace(0);
+  __ CallRuntime(leaf.entry(), num_params);
+  __ movq(RSP, R13);
+
+  // Box the result. The 64 bits of a result that needs a box are kept on the
+  // stack as two Smis while the box is allocated, as the allocation may call
+  // into the runtime.
+  const Class* box_class = NULL;
+  intptr_t value_offset = 0;
+  Label done;
+  switch (leaf.return_type()) {
+    case LeafNativeEntry::kVoid:
+      __ LoadObject(result, Object::null_object());
+      return;
+    case LeafNativeEntry::kInt64:
+      __ movq(RDX, RAX);
+      __ SmiTag(result);
+      __ j(NO_OVERFLOW, &done);
+      box_class = &compiler->mint_class();
+      value_offset = Mint::value_offset();
+      break;
+    case LeafNativeEntry::kDouble:
+      __ subq(RSP, Immediate(kDoubleSize));
+      __ movsd(Address(RSP, 0), XMM0);
+      __ popq(RDX);
+      box_class = &compiler->double_class();
+      value_offset = Double::value_offset();
+      break;
+    default:
+      UNREACHABLE();
+  }
+  __ movq(RCX, RDX);
+  __ shrq(RCX, Immediate(32));
+  __ SmiTag(RCX);
+  __ pushq(RCX);
+  __ movl(RDX, RDX);
+  __ SmiTag(RDX);
+  __ pushq(RDX);
+  BoxAllocationSlowPath::Allocate(compiler, this, *box_class, result, RCX);
+  __ popq(RDX);
+  __ SmiUntag(RDX);
+  __ popq(RCX);
+  __ SmiUntag(RCX);
+  __ shlq(RCX, Immediate(32));
+  __ orq(RCX, RDX);
+  __ movq(FieldAddress(result, value_offset), RCX);
+  __ Bind(&done);
+}
+
 LocationSummary* StoreInstanceFieldInstr::MakeLocationSummary(Zone* zone,
                                                               bool opt) const {
   const intptr_t kNumInputs = 2;
@@ -1674,7 +1818,9 @@ LocationSummary* StoreInstanceFieldInstr::MakeLocationSummary(Zone* zone,
 
   summary->set_in(0, Location::RequiresRegister());
   if (IsUnboxedStore() && opt) {
-    summary->set_in(1, Location::RequiresFpuRegister());
+    summary->set_in(1, (field().UnboxedFieldCid() == kMintCid)
+                           ? Location::RequiresRegister()
+                           : Location::RequiresFpuRegister());
     summary->set_temp(0, Location::RequiresRegister());
     summary->set_temp(1, Location::RequiresRegister());
   } else if (IsPotentialUnboxedStore()) {
@@ -1717,7 +1863,6 @@ void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   Register instance_reg = locs()->in(0).reg();
 
   if (IsUnboxedStore() && compiler->is_optimizing()) {
-    XmmRegister value = locs()->in(1).fpu_reg();
     Register temp = locs()->temp(0).reg();
     Register temp2 = locs()->temp(1).reg();
     const intptr_t cid = field().UnboxedFieldCid();
@@ -1728,6 +1873,9 @@ void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
         case kDoubleCid:
           cls = &compiler->double_class();
           break;
+        case kMintCid:
+          cls = &compiler->mint_class();
+          break;
         case kFloat32x4Cid:
           cls = &compiler->float32x4_class();
           break;
@@ -1748,15 +1896,22 @@ void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
     switch (cid) {
       case kDoubleCid:
         __ Comment("UnboxedDoubleStoreInstanceFieldInstr");
-        __ movsd(FieldAddress(temp, Double::value_offset()), value);
+        __ movsd(FieldAddress(temp, Double::value_offset()),
+                 locs()->in(1).fpu_reg());
+        break;
+      case kMintCid:
+        __ Comment("UnboxedMintStoreInstanceFieldInstr");
+        __ movq(FieldAddress(temp, Mint::value_offset()), locs()->in(1).reg());
         break;
       case kFloat32x4Cid:
         __ Comment("UnboxedFloat32x4StoreInstanceFieldInstr");
-        __ movups(FieldAddress(temp, Float32x4::value_offset()), value);
+        __ movups(FieldAddress(temp, Float32x4::value_offset()),
+                  locs()->in(1).fpu_reg());
         break;
       case kFloat64x2Cid:
         __ Comment("UnboxedFloat64x2StoreInstanceFieldInstr");
-        __ movups(FieldAddress(temp, Float64x2::value_offset()), value);
+        __ movups(FieldAddress(temp, Float64x2::value_offset()),
+                  locs()->in(1).fpu_reg());
         break;
       default:
         UNREACHABLE();
@@ -1778,6 +1933,7 @@ void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 
     Label store_pointer;
     Label store_double;
+    Label store_mint;
     Label store_float32x4;
     Label store_float64x2;
 
@@ -1795,6 +1951,12 @@ void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
             Immediate(kDoubleCid));
     __ j(EQUAL, &store_double);
 
+    if (FlowGraphCompiler::SupportsUnboxedMintFields()) {
+      __ cmpw(FieldAddress(temp, Field::guarded_cid_offset()),
+              Immediate(kMintCid));
+      __ j(EQUAL, &store_mint);
+    }
+
     __ cmpw(FieldAddress(temp, Field::guarded_cid_offset()),
             Immediate(kFloat32x4Cid));
     __ j(EQUAL, &store_float32x4);
@@ -1820,6 +1982,15 @@ void StoreInstanceFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
       __ jmp(&skip_store);
     }
 
+    if (FlowGraphCompiler::SupportsUnboxedMintFields()) {
+      __ Bind(&store_mint);
+      EnsureMutableBox(compiler, this, temp, compiler->mint_class(),
+                       instance_reg, offset_in_bytes_, temp2);
+      __ movq(temp2, FieldAddress(value_reg, Mint::value_offset()));
+      __ movq(FieldAddress(temp, Mint::value_offset()), temp2);
+      __ jmp(&skip_store);
+    }
+
     {
       __ Bind(&store_float32x4);
       EnsureMutableBox(compiler, this, temp, compiler->float32x4_class(),
@@ -2061,22 +2232,28 @@ void LoadFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   ASSERT(sizeof(classid_t) == kInt16Size);
   Register instance_reg = locs()->in(0).reg();
   if (IsUnboxedLoad() && compiler->is_optimizing()) {
-    XmmRegister result = locs()->out(0).fpu_reg();
     Register temp = locs()->temp(0).reg();
     __ movq(temp, FieldAddress(instance_reg, offset_in_bytes()));
     intptr_t cid = field()->UnboxedFieldCid();
     switch (cid) {
       case kDoubleCid:
         __ Comment("UnboxedDoubleLoadFieldInstr");
-        __ movsd(result, FieldAddress(temp, Double::value_offset()));
+        __ movsd(locs()->out(0).fpu_reg(),
+                 FieldAddress(temp, Double::value_offset()));
+        break;
+      case kMintCid:
+        __ Comment("UnboxedMintLoadFieldInstr");
+        __ movq(locs()->out(0).reg(), FieldAddress(temp, Mint::value_offset()));
         break;
       case kFloat32x4Cid:
         __ Comment("UnboxedFloat32x4LoadFieldInstr");
-        __ movups(result, FieldAddress(temp, Float32x4::value_offset()));
+        __ movups(locs()->out(0).fpu_reg(),
+                  FieldAddress(temp, Float32x4::value_offset()));
         break;
       case kFloat64x2Cid:
         __ Comment("UnboxedFloat64x2LoadFieldInstr");
-        __ movups(result, FieldAddress(temp, Float64x2::value_offset()));
+        __ movups(locs()->out(0).fpu_reg(),
+                  FieldAddress(temp, Float64x2::value_offset()));
         break;
       default:
         UNREACHABLE();
@@ -2092,6 +2269,7 @@ void LoadFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 
     Label load_pointer;
     Label load_double;
+    Label load_mint;
     Label load_float32x4;
     Label load_float64x2;
 
@@ -2106,6 +2284,11 @@ void LoadFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
     __ cmpw(field_cid_operand, Immediate(kDoubleCid));
     __ j(EQUAL, &load_double);
 
+    if (FlowGraphCompiler::SupportsUnboxedMintFields()) {
+      __ cmpw(field_cid_operand, Immediate(kMintCid));
+      __ j(EQUAL, &load_mint);
+    }
+
     __ cmpw(field_cid_operand, Immediate(kFloat32x4Cid));
     __ j(EQUAL, &load_float32x4);
 
@@ -2129,6 +2312,16 @@ void LoadFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
       __ jmp(&done);
     }
 
+    if (FlowGraphCompiler::SupportsUnboxedMintFields()) {
+      __ Bind(&load_mint);
+      BoxAllocationSlowPath::Allocate(compiler, this, compiler->mint_class(),
+                                      result, temp);
+      __ movq(temp, FieldAddress(instance_reg, offset_in_bytes()));
+      __ movq(temp, FieldAddress(temp, Mint::value_offset()));
+      __ movq(FieldAddress(result, Mint::value_offset()), temp);
+      __ jmp(&done);
+    }
+
     {
       __ Bind(&load_float32x4);
       BoxAllocationSlowPath::Allocate(
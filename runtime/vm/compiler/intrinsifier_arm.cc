@@ -77,7 +77,8 @@ void Intrinsifier::ObjectArraySetIndexed(Assembler* assembler) {
   ASSERT(kSmiTagShift == 1);
   __ ldr(R2, Address(SP, 0 * kWordSize));  // Value.
   __ add(R1, R0, Operand(R1, LSL, 1));     // R1 is Smi.
-  __ StoreIntoObject(R0, FieldAddress(R1, Array::data_offset()), R2);
+  __ AddImmediate(R1, Array::data_offset() - kHeapObjectTag);
+  __ StoreIntoArray(R0, R1, R2);
   // Caller is responsible for preserving the value if necessary.
   __ Ret();
   __ Bind(&fall_through);
@@ -145,7 +146,8 @@ void Intrinsifier::GrowableArray_add(Assembler* assembler) {
   __ ldr(R0, Address(SP, 0 * kWordSize));  // Value.
   ASSERT(kSmiTagShift == 1);
   __ add(R1, R2, Operand(R1, LSL, 1));
-  __ StoreIntoObject(R2, FieldAddress(R1, Array::data_offset()), R0);
+  __ AddImmediate(R1, Array::data_offset() - kHeapObjectTag);
+  __ StoreIntoArray(R2, R1, R0);
   __ LoadObject(R0, Object::null_object());
   __ Ret();
   __ Bind(&fall_through);
@@ -1849,61 +1851,9 @@ void Intrinsifier::StringBaseIsEmpty(Assembler* assembler) {
 }
 
 void Intrinsifier::OneByteString_getHashCode(Assembler* assembler) {
-  __ ldr(R1, Address(SP, 0 * kWordSize));
-  __ ldr(R0, FieldAddress(R1, String::hash_offset()));
-  __ cmp(R0, Operand(0));
-  __ bx(LR, NE);  // Return if already computed.
-
-  __ ldr(R2, FieldAddress(R1, String::length_offset()));
-
-  Label done;
-  // If the string is empty, set the hash to 1, and return.
-  __ cmp(R2, Operand(Smi::RawValue(0)));
-  __ b(&done, EQ);
-
-  __ SmiUntag(R2);
-  __ mov(R3, Operand(0));
-  __ AddImmediate(R8, R1, OneByteString::data_offset() - kHeapObjectTag);
-  // R1: Instance of OneByteString.
-  // R2: String length, untagged integer.
-  // R3: Loop counter, untagged integer.
-  // R8: String data.
-  // R0: Hash code, untagged integer.
-
-  Label loop;
-  // Add to hash code: (hash_ is uint32)
-  // hash_ += ch;
-  // hash_ += hash_ << 10;
-  // hash_ ^= hash_ >> 6;
-  // Get one characters (ch).
-  __ Bind(&loop);
-  __ ldrb(NOTFP, Address(R8, 0));
-  // NOTFP: ch.
-  __ add(R3, R3, Operand(1));
-  __ add(R8, R8, Operand(1));
-  __ add(R0, R0, Operand(NOTFP));
-  __ add(R0, R0, Operand(R0, LSL, 10));
-  __ eor(R0, R0, Operand(R0, LSR, 6));
-  __ cmp(R3, Operand(R2));
-  __ b(&loop, NE);
-
-  // Finalize.
-  // hash_ += hash_ << 3;
-  // hash_ ^= hash_ >> 11;
-  // hash_ += hash_ << 15;
-  __ add(R0, R0, Operand(R0, LSL, 3));
-  __ eor(R0, R0, Operand(R0, LSR, 11));
-  __ add(R0, R0, Operand(R0, LSL, 15));
-  // hash_ = hash_ & ((static_cast<intptr_t>(1) << bits) - 1);
-  __ LoadImmediate(R2, (static_cast<intptr_t>(1) << String::kHashBits) - 1);
-  __ and_(R0, R0, Operand(R2));
-  __ cmp(R0, Operand(0));
-  // return hash_ == 0 ? 1 : hash_;
-  __ Bind(&done);
-  __ mov(R0, Operand(1), EQ);
-  __ SmiTag(R0);
-  __ StoreIntoSmiField(FieldAddress(R1, String::hash_offset()), R0);
-  __ Ret();
+  // The string hash function is only implemented in C++ (String::Hash), so
+  // just return the cached hash and let the native compute it otherwise.
+  String_getHashCode(assembler);
 }
 
 // Allocates one-byte string of length 'end - start'. The content is not
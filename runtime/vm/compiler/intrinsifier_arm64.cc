@@ -13,6 +13,7 @@
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/regexp_assembler.h"
+#include "vm/regexp_assembler_native.h"
 #include "vm/symbols.h"
 #include "vm/timeline.h"
 
@@ -81,7 +82,8 @@ void Intrinsifier::ObjectArraySetIndexed(Assembler* assembler) {
   ASSERT(kSmiTagShift == 1);
   __ ldr(R2, Address(SP, 0 * kWordSize));  // Value.
   __ add(R1, R0, Operand(R1, LSL, 2));     // R1 is Smi.
-  __ StoreIntoObject(R0, FieldAddress(R1, Array::data_offset()), R2);
+  __ AddImmediate(R1, Array::data_offset() - kHeapObjectTag);
+  __ StoreIntoArray(R0, R1, R2);
   // Caller is responsible for preserving the value if necessary.
   __ ret();
   __ Bind(&fall_through);
@@ -147,7 +149,8 @@ void Intrinsifier::GrowableArray_add(Assembler* assembler) {
   __ ldr(R0, Address(SP, 0 * kWordSize));  // Value.
   ASSERT(kSmiTagShift == 1);
   __ add(R1, R2, Operand(R1, LSL, 2));
-  __ StoreIntoObject(R2, FieldAddress(R1, Array::data_offset()), R0);
+  __ AddImmediate(R1, Array::data_offset() - kHeapObjectTag);
+  __ StoreIntoArray(R2, R1, R0);
   __ LoadObject(R0, Object::null_object());
   __ ret();
   __ Bind(&fall_through);
@@ -1925,62 +1928,9 @@ void Intrinsifier::StringBaseIsEmpty(Assembler* assembler) {
 }
 
 void Intrinsifier::OneByteString_getHashCode(Assembler* assembler) {
-  Label compute_hash;
-  __ ldr(R1, Address(SP, 0 * kWordSize));  // OneByteString object.
-  __ ldr(R0, FieldAddress(R1, String::hash_offset()), kUnsignedWord);
-  __ adds(R0, R0, Operand(R0));  // Smi tag the hash code, setting Z flag.
-  __ b(&compute_hash, EQ);
-  __ ret();  // Return if already computed.
-
-  __ Bind(&compute_hash);
-  __ ldr(R2, FieldAddress(R1, String::length_offset()));
-  __ SmiUntag(R2);
-
-  Label done;
-  // If the string is empty, set the hash to 1, and return.
-  __ CompareRegisters(R2, ZR);
-  __ b(&done, EQ);
-
-  __ mov(R3, ZR);
-  __ AddImmediate(R6, R1, OneByteString::data_offset() - kHeapObjectTag);
-  // R1: Instance of OneByteString.
-  // R2: String length, untagged integer.
-  // R3: Loop counter, untagged integer.
-  // R6: String data.
-  // R0: Hash code, untagged integer.
-
-  Label loop;
-  // Add to hash code: (hash_ is uint32)
-  // hash_ += ch;
-  // hash_ += hash_ << 10;
-  // hash_ ^= hash_ >> 6;
-  // Get one characters (ch).
-  __ Bind(&loop);
-  __ ldr(R7, Address(R6, R3), kUnsignedByte);
-  // R7: ch.
-  __ add(R3, R3, Operand(1));
-  __ addw(R0, R0, Operand(R7));
-  __ addw(R0, R0, Operand(R0, LSL, 10));
-  __ eorw(R0, R0, Operand(R0, LSR, 6));
-  __ cmp(R3, Operand(R2));
-  __ b(&loop, NE);
-
-  // Finalize.
-  // hash_ += hash_ << 3;
-  // hash_ ^= hash_ >> 11;
-  // hash_ += hash_ << 15;
-  __ addw(R0, R0, Operand(R0, LSL, 3));
-  __ eorw(R0, R0, Operand(R0, LSR, 11));
-  __ addw(R0, R0, Operand(R0, LSL, 15));
-  // hash_ = hash_ & ((static_cast<intptr_t>(1) << bits) - 1);
-  __ AndImmediate(R0, R0, (static_cast<intptr_t>(1) << String::kHashBits) - 1);
-  __ CompareRegisters(R0, ZR);
-  // return hash_ == 0 ? 1 : hash_;
-  __ Bind(&done);
-  __ csinc(R0, R0, ZR, NE);  // R0 <- (R0 != 0) ? R0 : (ZR + 1).
-  __ str(R0, FieldAddress(R1, String::hash_offset()), kUnsignedWord);
-  __ SmiTag(R0);
-  __ ret();
+  // The string hash function is only implemented in C++ (String::Hash), so
+  // just return the cached hash and let the native compute it otherwise.
+  String_getHashCode(assembler);
 }
 
 // Allocates one-byte string of length 'end - start'. The content is not
@@ -2141,7 +2091,7 @@ void Intrinsifier::OneByteString_allocate(Assembler* assembler) {
 
 // TODO(srdjan): Add combinations (one-byte/two-byte/external strings).
 static void StringEquality(Assembler* assembler, intptr_t string_cid) {
-  Label fall_through, is_true, is_false, loop;
+  Label fall_through, is_true, is_false;
   __ ldr(R0, Address(SP, 1 * kWordSize));  // This.
   __ ldr(R1, Address(SP, 0 * kWordSize));  // Other.
 
@@ -2161,8 +2111,8 @@ static void StringEquality(Assembler* assembler, intptr_t string_cid) {
   __ cmp(R2, Operand(R3));
   __ b(&is_false, NE);
 
-  // Check contents, no fall-through possible.
-  // TODO(zra): try out other sequences.
+  // Check contents, no fall-through possible. Compare a word at a time and
+  // finish the remaining bytes one by one.
   ASSERT((string_cid == kOneByteStringCid) ||
          (string_cid == kTwoByteStringCid));
   const intptr_t offset = (string_cid == kOneByteStringCid)
@@ -2171,26 +2121,31 @@ static void StringEquality(Assembler* assembler, intptr_t string_cid) {
   __ AddImmediate(R0, offset - kHeapObjectTag);
   __ AddImmediate(R1, offset - kHeapObjectTag);
   __ SmiUntag(R2);
-  __ Bind(&loop);
-  __ AddImmediate(R2, -1);
-  __ CompareRegisters(R2, ZR);
-  __ b(&is_true, LT);
-  if (string_cid == kOneByteStringCid) {
-    __ ldr(R3, Address(R0), kUnsignedByte);
-    __ ldr(R4, Address(R1), kUnsignedByte);
-    __ AddImmediate(R0, 1);
-    __ AddImmediate(R1, 1);
-  } else if (string_cid == kTwoByteStringCid) {
-    __ ldr(R3, Address(R0), kUnsignedHalfword);
-    __ ldr(R4, Address(R1), kUnsignedHalfword);
-    __ AddImmediate(R0, 2);
-    __ AddImmediate(R1, 2);
-  } else {
-    UNIMPLEMENTED();
+  if (string_cid == kTwoByteStringCid) {
+    __ add(R2, R2, Operand(R2));  // Length in bytes.
   }
+  Label word_loop, byte_loop;
+  __ Bind(&word_loop);
+  __ CompareImmediate(R2, kWordSize);
+  __ b(&byte_loop, LT);
+  __ ldr(R3, Address(R0, kWordSize, Address::PostIndex));
+  __ ldr(R4, Address(R1, kWordSize, Address::PostIndex));
+  __ AddImmediate(R2, -kWordSize);
   __ cmp(R3, Operand(R4));
   __ b(&is_false, NE);
-  __ b(&loop);
+  __ b(&word_loop);
+
+  __ Bind(&byte_loop);
+  __ CompareRegisters(R2, ZR);
+  __ b(&is_true, LE);
+  __ ldr(R3, Address(R0, 1, Address::PostIndex, kUnsignedByte),
+         kUnsignedByte);
+  __ ldr(R4, Address(R1, 1, Address::PostIndex, kUnsignedByte),
+         kUnsignedByte);
+  __ AddImmediate(R2, -1);
+  __ cmp(R3, Operand(R4));
+  __ b(&is_false, NE);
+  __ b(&byte_loop);
 
   __ Bind(&is_true);
   __ LoadObject(R0, Bool::True());
@@ -2213,7 +2168,9 @@ void Intrinsifier::TwoByteString_equality(Assembler* assembler) {
 
 void Intrinsifier::IntrinsifyRegExpExecuteMatch(Assembler* assembler,
                                                 bool sticky) {
-  if (FLAG_interpret_irregexp) return;
+  if (FLAG_interpret_irregexp || NativeRegExpMacroAssembler::IsEnabled()) {
+    return;
+  }
 
   static const intptr_t kRegExpParamOffset = 2 * kWordSize;
   static const intptr_t kStringParamOffset = 1 * kWordSize;
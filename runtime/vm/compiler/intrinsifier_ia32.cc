@@ -111,8 +111,8 @@ void Intrinsifier::ObjectArraySetIndexed(Assembler* assembler) {
   ASSERT(kSmiTagShift == 1);
   // Destroy ECX (ic data) as we will not continue in the function.
   __ movl(ECX, Address(ESP, +1 * kWordSize));  // Value.
-  __ StoreIntoObject(EAX, FieldAddress(EAX, EBX, TIMES_2, Array::data_offset()),
-                     ECX);
+  __ leal(EBX, FieldAddress(EAX, EBX, TIMES_2, Array::data_offset()));
+  __ StoreIntoArray(EAX, EBX, ECX);
   // Caller is responsible of preserving the value if necessary.
   __ ret();
   __ Bind(&fall_through);
@@ -172,8 +172,8 @@ void Intrinsifier::GrowableArray_add(Assembler* assembler) {
                        1);
   __ movl(EAX, Address(ESP, +1 * kWordSize));  // Value
   ASSERT(kSmiTagShift == 1);
-  __ StoreIntoObject(EDI, FieldAddress(EDI, EBX, TIMES_2, Array::data_offset()),
-                     EAX);
+  __ leal(EBX, FieldAddress(EDI, EBX, TIMES_2, Array::data_offset()));
+  __ StoreIntoArray(EDI, EBX, EAX);
   const Immediate& raw_null =
       Immediate(reinterpret_cast<int32_t>(Object::null()));
   __ movl(EAX, raw_null);
@@ -1868,71 +1868,9 @@ void Intrinsifier::StringBaseIsEmpty(Assembler* assembler) {
 }
 
 void Intrinsifier::OneByteString_getHashCode(Assembler* assembler) {
-  Label compute_hash;
-  __ movl(EBX, Address(ESP, +1 * kWordSize));  // OneByteString object.
-  __ movl(EAX, FieldAddress(EBX, String::hash_offset()));
-  __ cmpl(EAX, Immediate(0));
-  __ j(EQUAL, &compute_hash, Assembler::kNearJump);
-  __ ret();
-
-  __ Bind(&compute_hash);
-  // Hash not yet computed, use algorithm of class StringHasher.
-  __ movl(ECX, FieldAddress(EBX, String::length_offset()));
-  __ SmiUntag(ECX);
-  __ xorl(EAX, EAX);
-  __ xorl(EDI, EDI);
-  // EBX: Instance of OneByteString.
-  // ECX: String length, untagged integer.
-  // EDI: Loop counter, untagged integer.
-  // EAX: Hash code, untagged integer.
-  Label loop, done, set_hash_code;
-  __ Bind(&loop);
-  __ cmpl(EDI, ECX);
-  __ j(EQUAL, &done, Assembler::kNearJump);
-  // Add to hash code: (hash_ is uint32)
-  // hash_ += ch;
-  // hash_ += hash_ << 10;
-  // hash_ ^= hash_ >> 6;
-  // Get one characters (ch).
-  __ movzxb(EDX, FieldAddress(EBX, EDI, TIMES_1, OneByteString::data_offset()));
-  // EDX: ch and temporary.
-  __ addl(EAX, EDX);
-  __ movl(EDX, EAX);
-  __ shll(EDX, Immediate(10));
-  __ addl(EAX, EDX);
-  __ movl(EDX, EAX);
-  __ shrl(EDX, Immediate(6));
-  __ xorl(EAX, EDX);
-
-  __ incl(EDI);
-  __ jmp(&loop, Assembler::kNearJump);
-
-  __ Bind(&done);
-  // Finalize:
-  // hash_ += hash_ << 3;
-  // hash_ ^= hash_ >> 11;
-  // hash_ += hash_ << 15;
-  __ movl(EDX, EAX);
-  __ shll(EDX, Immediate(3));
-  __ addl(EAX, EDX);
-  __ movl(EDX, EAX);
-  __ shrl(EDX, Immediate(11));
-  __ xorl(EAX, EDX);
-  __ movl(EDX, EAX);
-  __ shll(EDX, Immediate(15));
-  __ addl(EAX, EDX);
-  // hash_ = hash_ & ((static_cast<intptr_t>(1) << bits) - 1);
-  __ andl(EAX,
-          Immediate(((static_cast<intptr_t>(1) << String::kHashBits) - 1)));
-
-  // return hash_ == 0 ? 1 : hash_;
-  __ cmpl(EAX, Immediate(0));
-  __ j(NOT_EQUAL, &set_hash_code, Assembler::kNearJump);
-  __ incl(EAX);
-  __ Bind(&set_hash_code);
-  __ SmiTag(EAX);
-  __ StoreIntoSmiField(FieldAddress(EBX, String::hash_offset()), EAX);
-  __ ret();
+  // The string hash function is only implemented in C++ (String::Hash), so
+  // just return the cached hash and let the native compute it otherwise.
+  String_getHashCode(assembler);
 }
 
 // Allocates one-byte string of length 'end - start'. The content is not
@@ -13,6 +13,7 @@
 #include "vm/instructions.h"
 #include "vm/object_store.h"
 #include "vm/regexp_assembler.h"
+#include "vm/regexp_assembler_native.h"
 #include "vm/symbols.h"
 #include "vm/timeline.h"
 
@@ -70,8 +71,8 @@ void Intrinsifier::ObjectArraySetIndexed(Assembler* assembler) {
   // Note that RBX is Smi, i.e, times 2.
   ASSERT(kSmiTagShift == 1);
   // Destroy RCX (ic data) as we will not continue in the function.
-  __ StoreIntoObject(RAX, FieldAddress(RAX, RCX, TIMES_4, Array::data_offset()),
-                     RDX);
+  __ leaq(RCX, FieldAddress(RAX, RCX, TIMES_4, Array::data_offset()));
+  __ StoreIntoArray(RAX, RCX, RDX);
   // Caller is responsible of preserving the value if necessary.
   __ ret();
   __ Bind(&fall_through);
@@ -132,8 +133,8 @@ void Intrinsifier::GrowableArray_add(Assembler* assembler) {
                        1);
   __ movq(RAX, Address(RSP, +1 * kWordSize));  // Value
   ASSERT(kSmiTagShift == 1);
-  __ StoreIntoObject(RDX, FieldAddress(RDX, RCX, TIMES_4, Array::data_offset()),
-                     RAX);
+  __ leaq(RCX, FieldAddress(RDX, RCX, TIMES_4, Array::data_offset()));
+  __ StoreIntoArray(RDX, RCX, RAX);
   __ LoadObject(RAX, Object::null_object());
   __ ret();
   __ Bind(&fall_through);
@@ -1844,72 +1845,9 @@ void Intrinsifier::StringBaseIsEmpty(Assembler* assembler) {
 }
 
 void Intrinsifier::OneByteString_getHashCode(Assembler* assembler) {
-  Label compute_hash;
-  __ movq(RBX, Address(RSP, +1 * kWordSize));  // OneByteString object.
-  __ movl(RAX, FieldAddress(RBX, String::hash_offset()));
-  __ cmpq(RAX, Immediate(0));
-  __ j(EQUAL, &compute_hash, Assembler::kNearJump);
-  __ SmiTag(RAX);
-  __ ret();
-
-  __ Bind(&compute_hash);
-  // Hash not yet computed, use algorithm of class StringHasher.
-  __ movq(RCX, FieldAddress(RBX, String::length_offset()));
-  __ SmiUntag(RCX);
-  __ xorq(RAX, RAX);
-  __ xorq(RDI, RDI);
-  // RBX: Instance of OneByteString.
-  // RCX: String length, untagged integer.
-  // RDI: Loop counter, untagged integer.
-  // RAX: Hash code, untagged integer.
-  Label loop, done, set_hash_code;
-  __ Bind(&loop);
-  __ cmpq(RDI, RCX);
-  __ j(EQUAL, &done, Assembler::kNearJump);
-  // Add to hash code: (hash_ is uint32)
-  // hash_ += ch;
-  // hash_ += hash_ << 10;
-  // hash_ ^= hash_ >> 6;
-  // Get one characters (ch).
-  __ movzxb(RDX, FieldAddress(RBX, RDI, TIMES_1, OneByteString::data_offset()));
-  // RDX: ch and temporary.
-  __ addl(RAX, RDX);
-  __ movq(RDX, RAX);
-  __ shll(RDX, Immediate(10));
-  __ addl(RAX, RDX);
-  __ movq(RDX, RAX);
-  __ shrl(RDX, Immediate(6));
-  __ xorl(RAX, RDX);
-
-  __ incq(RDI);
-  __ jmp(&loop, Assembler::kNearJump);
-
-  __ Bind(&done);
-  // Finalize:
-  // hash_ += hash_ << 3;
-  // hash_ ^= hash_ >> 11;
-  // hash_ += hash_ << 15;
-  __ movq(RDX, RAX);
-  __ shll(RDX, Immediate(3));
-  __ addl(RAX, RDX);
-  __ movq(RDX, RAX);
-  __ shrl(RDX, Immediate(11));
-  __ xorl(RAX, RDX);
-  __ movq(RDX, RAX);
-  __ shll(RDX, Immediate(15));
-  __ addl(RAX, RDX);
-  // hash_ = hash_ & ((static_cast<intptr_t>(1) << bits) - 1);
-  __ andl(RAX,
-          Immediate(((static_cast<intptr_t>(1) << String::kHashBits) - 1)));
-
-  // return hash_ == 0 ? 1 : hash_;
-  __ cmpq(RAX, Immediate(0));
-  __ j(NOT_EQUAL, &set_hash_code, Assembler::kNearJump);
-  __ incq(RAX);
-  __ Bind(&set_hash_code);
-  __ movl(FieldAddress(RBX, String::hash_offset()), RAX);
-  __ SmiTag(RAX);
-  __ ret();
+  // The string hash function is only implemented in C++ (String::Hash), so
+  // just return the cached hash and let the native compute it otherwise.
+  String_getHashCode(assembler);
 }
 
 // Allocates one-byte string of length 'end - start'. The content is not
@@ -2063,7 +2001,7 @@ void Intrinsifier::OneByteString_allocate(Assembler* assembler) {
 
 // TODO(srdjan): Add combinations (one-byte/two-byte/external strings).
 static void StringEquality(Assembler* assembler, intptr_t string_cid) {
-  Label fall_through, is_true, is_false, loop;
+  Label fall_through, is_true, is_false;
   __ movq(RAX, Address(RSP, +2 * kWordSize));  // This.
   __ movq(RCX, Address(RSP, +1 * kWordSize));  // Other.
 
@@ -2082,29 +2020,42 @@ static void StringEquality(Assembler* assembler, intptr_t string_cid) {
   __ cmpq(RDI, FieldAddress(RCX, String::length_offset()));
   __ j(NOT_EQUAL, &is_false, Assembler::kNearJump);
 
-  // Check contents, no fall-through possible.
-  // TODO(srdjan): write a faster check.
+  // Check contents, no fall-through possible. Compare a word at a time and
+  // finish the remaining bytes one by one.
+  ASSERT((string_cid == kOneByteStringCid) ||
+         (string_cid == kTwoByteStringCid));
+  const intptr_t offset = (string_cid == kOneByteStringCid)
+                              ? OneByteString::data_offset()
+                              : TwoByteString::data_offset();
   __ SmiUntag(RDI);
-  __ Bind(&loop);
-  __ decq(RDI);
-  __ cmpq(RDI, Immediate(0));
-  __ j(LESS, &is_true, Assembler::kNearJump);
-  if (string_cid == kOneByteStringCid) {
-    __ movzxb(RBX,
-              FieldAddress(RAX, RDI, TIMES_1, OneByteString::data_offset()));
-    __ movzxb(RDX,
-              FieldAddress(RCX, RDI, TIMES_1, OneByteString::data_offset()));
-  } else if (string_cid == kTwoByteStringCid) {
-    __ movzxw(RBX,
-              FieldAddress(RAX, RDI, TIMES_2, TwoByteString::data_offset()));
-    __ movzxw(RDX,
-              FieldAddress(RCX, RDI, TIMES_2, TwoByteString::data_offset()));
-  } else {
-    UNIMPLEMENTED();
+  if (string_cid == kTwoByteStringCid) {
+    __ addq(RDI, RDI);  // Length in bytes.
   }
+  __ leaq(RAX, FieldAddress(RAX, offset));
+  __ leaq(RCX, FieldAddress(RCX, offset));
+  Label word_loop, byte_loop;
+  __ Bind(&word_loop);
+  __ cmpq(RDI, Immediate(kWordSize));
+  __ j(LESS, &byte_loop, Assembler::kNearJump);
+  __ movq(RBX, Address(RAX, 0));
+  __ cmpq(RBX, Address(RCX, 0));
+  __ j(NOT_EQUAL, &is_false, Assembler::kNearJump);
+  __ addq(RAX, Immediate(kWordSize));
+  __ addq(RCX, Immediate(kWordSize));
+  __ subq(RDI, Immediate(kWordSize));
+  __ jmp(&word_loop, Assembler::kNearJump);
+
+  __ Bind(&byte_loop);
+  __ testq(RDI, RDI);
+  __ j(ZERO, &is_true, Assembler::kNearJump);
+  __ movzxb(RBX, Address(RAX, 0));
+  __ movzxb(RDX, Address(RCX, 0));
   __ cmpq(RBX, RDX);
   __ j(NOT_EQUAL, &is_false, Assembler::kNearJump);
-  __ jmp(&loop, Assembler::kNearJump);
+  __ incq(RAX);
+  __ incq(RCX);
+  __ decq(RDI);
+  __ jmp(&byte_loop, Assembler::kNearJump);
 
   __ Bind(&is_true);
   __ LoadObject(RAX, Bool::True());
@@ -2127,7 +2078,9 @@ void Intrinsifier::TwoByteString_equality(Assembler* assembler) {
 
 void Intrinsifier::IntrinsifyRegExpExecuteMatch(Assembler* assembler,
                                                 bool sticky) {
-  if (FLAG_interpret_irregexp) return;
+  if (FLAG_interpret_irregexp || NativeRegExpMacroAssembler::IsEnabled()) {
+    return;
+  }
 
   static const intptr_t kRegExpParamOffset = 3 * kWordSize;
   static const intptr_t kStringParamOffset = 2 * kWordSize;
@@ -423,8 +423,9 @@ RawError* Compiler::CompileClass(const Class& cls) {
     return Error::null();
   }
   // If the class is a typedef class there is no need to try and
-  // compile it. Just finalize it directly.
-  if (cls.IsTypedefClass()) {
+  // compile it. Just finalize it directly. The same holds for classes loaded
+  // from Kernel binaries, whose members are read when they are finalized.
+  if (cls.IsTypedefClass() || cls.has_pending_kernel_members()) {
 #if defined(DEBUG)
     const Class& closure_cls =
         Class::Handle(Isolate::Current()->object_store()->closure_class());
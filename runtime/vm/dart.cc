@@ -29,6 +29,7 @@
 #include "vm/simulator.h"
 #include "vm/snapshot.h"
 #include "vm/store_buffer.h"
+#include "vm/string_hasher.h"
 #include "vm/stub_code.h"
 #include "vm/symbols.h"
 #include "vm/thread_interrupter.h"
@@ -40,7 +41,9 @@
 namespace dart {
 
 DECLARE_FLAG(bool, print_class_table);
+DECLARE_FLAG(bool, randomize_string_hashes);
 DECLARE_FLAG(bool, trace_time_all);
+DECLARE_FLAG(int, thread_pool_workers);
 DEFINE_FLAG(bool, keep_code, false, "Keep deoptimized code for profiling.");
 DEFINE_FLAG(bool, trace_shutdown, false, "Trace VM shutdown on stderr");
 
@@ -137,7 +140,15 @@ char* Dart::InitOnce(const uint8_t* vm_isolate_snapshot,
   set_thread_exit_callback(thread_exit);
   SetFileCallbacks(file_open, file_read, file_write, file_close);
   set_entropy_source_callback(entropy_source);
+#if defined(DART_PRECOMPILED_RUNTIME)
+  if (FLAG_randomize_string_hashes) {
+    // Precompiled snapshots hold string hashes in read-only memory.
+    return strdup("Precompiled runtime does not support "
+                  "--randomize_string_hashes");
+  }
+#endif
   OS::InitOnce();
+  StringHasher::InitOnce();
   start_time_micros_ = OS::GetCurrentMonotonicMicros();
   VirtualMemory::InitOnce();
   OSThread::InitOnce();
@@ -167,7 +178,10 @@ char* Dart::InitOnce(const uint8_t* vm_isolate_snapshot,
   predefined_handles_ = new ReadOnlyHandles();
   // Create the VM isolate and finish the VM initialization.
   ASSERT(thread_pool_ == NULL);
-  thread_pool_ = new ThreadPool();
+  ThreadPool::InitOnce();
+  thread_pool_ = new ThreadPool(FLAG_thread_pool_workers < 0
+                                    ? OS::NumberOfAvailableProcessors()
+                                    : FLAG_thread_pool_workers);
   {
     ASSERT(vm_isolate_ == NULL);
     ASSERT(Flags::Initialized());
@@ -32,11 +32,13 @@
 #include "vm/message_handler.h"
 #include "vm/native_entry.h"
 #include "vm/object.h"
+#include "vm/object_graph.h"
 #include "vm/object_store.h"
 #include "vm/os.h"
 #include "vm/os_thread.h"
 #include "vm/port.h"
 #include "vm/profiler.h"
+#include "vm/profiler_pprof.h"
 #include "vm/program_visitor.h"
 #include "vm/resolver.h"
 #include "vm/reusable_handles.h"
@@ -60,6 +62,7 @@ namespace dart {
 #define Z (T->zone())
 
 DECLARE_FLAG(bool, print_class_table);
+DECLARE_FLAG(bool, randomize_string_hashes);
 DECLARE_FLAG(bool, verify_handles);
 #if defined(DART_NO_SNAPSHOT)
 DEFINE_FLAG(bool,
@@ -592,6 +595,11 @@ bool Api::StringGetPeerHelper(NativeArguments* arguments,
     return false;
   }
   intptr_t cid = raw_obj->GetClassId();
+  if (String::IsAppendString(reinterpret_cast<RawString*>(raw_obj))) {
+    // The characters of an append string belong to the VM; its peer is
+    // looked up like that of an internal string.
+    cid = kOneByteStringCid;
+  }
   if (cid == kExternalOneByteStringCid) {
     RawExternalOneByteString* raw_string =
         reinterpret_cast<RawExternalOneByteString*>(raw_obj)->ptr();
@@ -1438,6 +1446,15 @@ DART_EXPORT void Dart_NotifyIdle(int64_t deadline) {
   T->isolate()->heap()->NotifyIdle(deadline);
 }
 
+DART_EXPORT bool Dart_NotifyIdleBudget(int64_t budget_micros) {
+  Thread* T = Thread::Current();
+  CHECK_ISOLATE(T->isolate());
+  API_TIMELINE_BEGIN_END;
+  TransitionNativeToVM transition(T);
+  const int64_t deadline = OS::GetCurrentMonotonicMicros() + budget_micros;
+  return T->isolate()->heap()->NotifyIdle(deadline);
+}
+
 DART_EXPORT void Dart_ExitIsolate() {
   Thread* T = Thread::Current();
   CHECK_ISOLATE(T->isolate());
@@ -1459,6 +1476,33 @@ static uint8_t* ApiReallocate(uint8_t* ptr,
       ->Realloc<uint8_t>(ptr, old_size, new_size);
 }
 
+// Snapshots do not contain the Kernel binaries needed to read the members of
+// the classes loaded with --lazy_kernel_loading, so read them all beforehand.
+static Dart_Handle FinishLazyKernelLoading(Thread* T) {
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  Isolate* I = T->isolate();
+  const Array& lazy_classes =
+      Array::Handle(T->zone(), I->object_store()->lazy_kernel_classes());
+  if (lazy_classes.IsNull()) {
+    return Api::Success();
+  }
+  Class& cls = Class::Handle(T->zone());
+  Error& error = Error::Handle(T->zone());
+  for (intptr_t cid = 0; cid < lazy_classes.Length(); cid++) {
+    // Finalizing a class also reads the members of its super classes.
+    if (lazy_classes.At(cid) == Object::null()) {
+      continue;
+    }
+    cls = I->class_table()->At(cid);
+    error = cls.EnsureIsFinalized(T);
+    if (!error.IsNull()) {
+      return Api::NewHandle(T, error.raw());
+    }
+  }
+#endif  // !defined(DART_PRECOMPILED_RUNTIME)
+  return Api::Success();
+}
+
 DART_EXPORT Dart_Handle
 Dart_CreateSnapshot(uint8_t** vm_snapshot_data_buffer,
                     intptr_t* vm_snapshot_data_size,
@@ -1471,6 +1515,10 @@ Dart_CreateSnapshot(uint8_t** vm_snapshot_data_buffer,
     return Api::NewError(
         "Creating full snapshots requires --load_deferred_eagerly");
   }
+  if (FLAG_randomize_string_hashes) {
+    return Api::NewError(
+        "Creating snapshots is not supported with --randomize_string_hashes");
+  }
   if (vm_snapshot_data_buffer != NULL && vm_snapshot_data_size == NULL) {
     RETURN_NULL_ERROR(vm_snapshot_data_size);
   }
@@ -1481,6 +1529,10 @@ Dart_CreateSnapshot(uint8_t** vm_snapshot_data_buffer,
   if (::Dart_IsError(state)) {
     return state;
   }
+  state = FinishLazyKernelLoading(T);
+  if (::Dart_IsError(state)) {
+    return state;
+  }
   I->StopBackgroundCompiler();
 
 #if defined(DEBUG)
@@ -1917,7 +1969,14 @@ DART_EXPORT bool Dart_IsStringLatin1(Dart_Handle object) {
 }
 
 DART_EXPORT bool Dart_IsExternalString(Dart_Handle object) {
-  return RawObject::IsExternalStringClassId(Api::ClassId(object));
+  if (!RawObject::IsExternalStringClassId(Api::ClassId(object))) {
+    return false;
+  }
+  // Strings built by String::ConcatForAppend are external only as an
+  // implementation detail.
+  NoSafepointScope no_safepoint_scope;
+  return !String::IsAppendString(
+      reinterpret_cast<RawString*>(Api::UnwrapHandle(object)));
 }
 
 DART_EXPORT bool Dart_IsList(Dart_Handle object) {
@@ -2459,7 +2518,7 @@ DART_EXPORT Dart_Handle Dart_StringGetProperties(Dart_Handle object,
   if (str.IsNull()) {
     RETURN_TYPE_ERROR(thread->zone(), object, String);
   }
-  if (str.IsExternal()) {
+  if (str.IsExternal() && !str.IsAppendString()) {
     *peer = str.GetPeer();
     ASSERT(*peer != NULL);
   } else {
@@ -5894,6 +5953,14 @@ DART_EXPORT bool Dart_GlobalTimelineGetTrace(Dart_StreamConsumer consumer,
   return false;
 }
 
+DART_EXPORT bool Dart_WriteCpuProfilePprof(int64_t thread_id,
+                                           int64_t time_origin_micros,
+                                           int64_t time_extent_micros,
+                                           Dart_StreamConsumer consumer,
+                                           void* user_data) {
+  return false;
+}
+
 DART_EXPORT void Dart_TimelineEvent(const char* label,
                                     int64_t timestamp0,
                                     int64_t timestamp1_or_async_id,
@@ -6163,6 +6230,32 @@ DART_EXPORT bool Dart_GlobalTimelineGetTrace(Dart_StreamConsumer consumer,
   return success;
 }
 
+DART_EXPORT bool Dart_WriteCpuProfilePprof(int64_t thread_id,
+                                           int64_t time_origin_micros,
+                                           int64_t time_extent_micros,
+                                           Dart_StreamConsumer consumer,
+                                           void* user_data) {
+  Thread* thread = Thread::Current();
+  Isolate* isolate = thread->isolate();
+  CHECK_ISOLATE(isolate);
+  if (consumer == NULL) {
+    return false;
+  }
+  SampleBuffer* sample_buffer = Profiler::sample_buffer();
+  if (sample_buffer == NULL) {
+    // The profiler is disabled.
+    return false;
+  }
+  const intptr_t thread_task_mask = Thread::kMutatorTask |
+                                    Thread::kCompilerTask |
+                                    Thread::kSweeperTask | Thread::kMarkerTask;
+  CpuSampleFilter filter(isolate->main_port(), thread_task_mask, thread_id,
+                         time_origin_micros, time_extent_micros);
+  PprofExporter exporter(consumer, user_data);
+  exporter.Export(thread, sample_buffer, &filter);
+  return true;
+}
+
 DART_EXPORT void Dart_TimelineEvent(const char* label,
                                     int64_t timestamp0,
                                     int64_t timestamp1_or_async_id,
@@ -6232,6 +6325,16 @@ DART_EXPORT void Dart_TimelineEvent(const char* label,
 }
 #endif  // defined(PRODUCT)
 
+DART_EXPORT Dart_Handle Dart_WriteHeapSnapshot(Dart_StreamConsumer consumer,
+                                               void* user_data,
+                                               bool collect_garbage) {
+  DARTSCOPE(Thread::Current());
+  CHECK_NULL(consumer);
+  ObjectGraph graph(T);
+  graph.Serialize(consumer, user_data, ObjectGraph::kVM, collect_garbage);
+  return Api::Success();
+}
+
 DART_EXPORT void Dart_SetThreadName(const char* name) {
   OSThread* thread = OSThread::Current();
   if (thread == NULL) {
@@ -6455,6 +6558,10 @@ Dart_Precompile(Dart_QualifiedFunctionName entry_points[],
   if (!FLAG_precompiled_mode) {
     return Api::NewError("Flag --precompilation was not specified.");
   }
+  if (FLAG_randomize_string_hashes) {
+    return Api::NewError(
+        "Creating snapshots is not supported with --randomize_string_hashes");
+  }
   Dart_Handle result = Api::CheckAndFinalizePendingClasses(T);
   if (::Dart_IsError(result)) {
     return result;
@@ -6624,6 +6731,10 @@ DART_EXPORT Dart_Handle Dart_CreateCoreJITSnapshotAsBlobs(
     return Api::NewError(
         "Creating full snapshots requires --load_deferred_eagerly");
   }
+  if (FLAG_randomize_string_hashes) {
+    return Api::NewError(
+        "Creating snapshots is not supported with --randomize_string_hashes");
+  }
   CHECK_NULL(vm_snapshot_data_buffer);
   CHECK_NULL(vm_snapshot_data_size);
   CHECK_NULL(vm_snapshot_instructions_buffer);
@@ -6637,6 +6748,10 @@ DART_EXPORT Dart_Handle Dart_CreateCoreJITSnapshotAsBlobs(
   if (::Dart_IsError(state)) {
     return state;
   }
+  state = FinishLazyKernelLoading(T);
+  if (::Dart_IsError(state)) {
+    return state;
+  }
   I->StopBackgroundCompiler();
 
   ProgramVisitor::Dedup();
@@ -6683,6 +6798,10 @@ Dart_CreateAppJITSnapshotAsBlobs(uint8_t** isolate_snapshot_data_buffer,
     return Api::NewError(
         "Creating full snapshots requires --load_deferred_eagerly");
   }
+  if (FLAG_randomize_string_hashes) {
+    return Api::NewError(
+        "Creating snapshots is not supported with --randomize_string_hashes");
+  }
   CHECK_NULL(isolate_snapshot_data_buffer);
   CHECK_NULL(isolate_snapshot_data_size);
   CHECK_NULL(isolate_snapshot_instructions_buffer);
@@ -6692,6 +6811,10 @@ Dart_CreateAppJITSnapshotAsBlobs(uint8_t** isolate_snapshot_data_buffer,
   if (::Dart_IsError(state)) {
     return state;
   }
+  state = FinishLazyKernelLoading(T);
+  if (::Dart_IsError(state)) {
+    return state;
+  }
   I->StopBackgroundCompiler();
 
   ProgramVisitor::Dedup();
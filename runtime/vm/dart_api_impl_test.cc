@@ -24,6 +24,7 @@ namespace dart {
 DECLARE_FLAG(bool, verify_acquired_data);
 DECLARE_FLAG(bool, ignore_patch_signature_mismatch);
 DECLARE_FLAG(bool, use_dart_frontend);
+DECLARE_FLAG(bool, incremental_marking);
 
 #ifndef PRODUCT
 
@@ -1159,6 +1160,42 @@ TEST_CASE(DartAPI_IsString) {
   EXPECT(!Dart_IsExternalString(str32));
 }
 
+// Strings appended to with '+' may share a buffer owned by the VM, which the
+// embedder sees as an internal string without a peer.
+TEST_CASE(DartAPI_AppendedStringIsInternal) {
+  const char* kScriptChars =
+      "main() {\n"
+      "  var s = '';\n"
+      "  for (int i = 0; i < 100; i++) {\n"
+      "    s = s + 'key/';\n"
+      "  }\n"
+      "  return s;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle str = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(str);
+  {
+    TransitionNativeToVM transition(thread);
+    const String& appended = Api::UnwrapStringHandle(thread->zone(), str);
+    EXPECT(appended.IsAppendString());
+  }
+  EXPECT(Dart_IsString(str));
+  EXPECT(Dart_IsStringLatin1(str));
+  EXPECT(!Dart_IsExternalString(str));
+  intptr_t char_size;
+  intptr_t str_len;
+  void* peer;
+  EXPECT_VALID(Dart_StringGetProperties(str, &char_size, &str_len, &peer));
+  EXPECT_EQ(1, char_size);
+  EXPECT_EQ(400, str_len);
+  EXPECT(!peer);
+
+  int data = 0;
+  EXPECT_VALID(Dart_SetPeer(str, &data));
+  EXPECT_VALID(Dart_StringGetProperties(str, &char_size, &str_len, &peer));
+  EXPECT_EQ(&data, peer);
+}
+
 TEST_CASE(DartAPI_NewString) {
   const char* ascii = "string";
   Dart_Handle ascii_str = NewString(ascii);
@@ -9058,6 +9095,46 @@ TEST_CASE(DartAPI_NotifyIdle) {
   EXPECT_VALID(result);
 }
 
+void NotifyIdleBudgetNative(Dart_NativeArguments args) {
+  // Keep reporting idle time while the VM asks for more, as an event loop
+  // would across its idle periods.
+  while (Dart_NotifyIdleBudget(kMicrosecondsPerMillisecond)) {
+  }
+}
+
+static Dart_NativeFunction NotifyIdleBudget_native_lookup(
+    Dart_Handle name,
+    int argument_count,
+    bool* auto_setup_scope) {
+  ASSERT(auto_setup_scope != NULL);
+  *auto_setup_scope = true;
+  return reinterpret_cast<Dart_NativeFunction>(&NotifyIdleBudgetNative);
+}
+
+TEST_CASE(DartAPI_NotifyIdleBudget) {
+  const char* kScriptChars =
+      "void notifyIdleBudget() native 'Test_nativeFunc';\n"
+      "void main() {\n"
+      "  var v;\n"
+      "  for (var i = 0; i < 100; i++) {\n"
+      "    var t = new List();\n"
+      "    for (var j = 0; j < 10000; j++) {\n"
+      "      t.add(new List(100));\n"
+      "    }\n"
+      "    v = t;\n"
+      "    notifyIdleBudget();\n"
+      "  }\n"
+      "}\n";
+  const bool saved_incremental_marking = FLAG_incremental_marking;
+  FLAG_incremental_marking = true;
+  Dart_Handle lib =
+      TestCase::LoadTestScript(kScriptChars, &NotifyIdleBudget_native_lookup);
+
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  FLAG_incremental_marking = saved_incremental_marking;
+}
+
 // There exists another test by name DartAPI_Invoke_CrossLibrary.
 // However, that currently fails for the dartk configuration as it
 // uses Dart_LoadLibray. This test here effectively tests the same
@@ -160,6 +160,77 @@ static int GetTypedDataSizeInBytes(Dart_TypedData_Type type) {
   return -1;
 }
 
+// Returns the class id of the internal typed data class for 'type', or
+// kIllegalCid if typed data of this type cannot be sent in a message.
+static intptr_t GetTypedDataClassId(Dart_TypedData_Type type) {
+  switch (type) {
+    case Dart_TypedData_kInt8:
+      return kTypedDataInt8ArrayCid;
+    case Dart_TypedData_kUint8:
+      return kTypedDataUint8ArrayCid;
+    case Dart_TypedData_kUint8Clamped:
+      return kTypedDataUint8ClampedArrayCid;
+    case Dart_TypedData_kInt16:
+      return kTypedDataInt16ArrayCid;
+    case Dart_TypedData_kUint16:
+      return kTypedDataUint16ArrayCid;
+    case Dart_TypedData_kInt32:
+      return kTypedDataInt32ArrayCid;
+    case Dart_TypedData_kUint32:
+      return kTypedDataUint32ArrayCid;
+    case Dart_TypedData_kInt64:
+      return kTypedDataInt64ArrayCid;
+    case Dart_TypedData_kUint64:
+      return kTypedDataUint64ArrayCid;
+    case Dart_TypedData_kFloat32:
+      return kTypedDataFloat32ArrayCid;
+    case Dart_TypedData_kFloat64:
+      return kTypedDataFloat64ArrayCid;
+    default:
+      return kIllegalCid;
+  }
+}
+
+static Dart_TypedData_Type GetTypedDataType(intptr_t class_id) {
+  switch (class_id) {
+    case kTypedDataInt8ArrayCid:
+      return Dart_TypedData_kInt8;
+    case kTypedDataUint8ArrayCid:
+      return Dart_TypedData_kUint8;
+    case kTypedDataUint8ClampedArrayCid:
+      return Dart_TypedData_kUint8Clamped;
+    case kTypedDataInt16ArrayCid:
+      return Dart_TypedData_kInt16;
+    case kTypedDataUint16ArrayCid:
+      return Dart_TypedData_kUint16;
+    case kTypedDataInt32ArrayCid:
+      return Dart_TypedData_kInt32;
+    case kTypedDataUint32ArrayCid:
+      return Dart_TypedData_kUint32;
+    case kTypedDataInt64ArrayCid:
+      return Dart_TypedData_kInt64;
+    case kTypedDataUint64ArrayCid:
+      return Dart_TypedData_kUint64;
+    case kTypedDataFloat32ArrayCid:
+      return Dart_TypedData_kFloat32;
+    case kTypedDataFloat64ArrayCid:
+      return Dart_TypedData_kFloat64;
+    default:
+      return Dart_TypedData_kInvalid;
+  }
+}
+
+// The external typed data classes are in the same order as the internal ones.
+static intptr_t ExternalToInternalTypedDataClassId(intptr_t class_id) {
+  ASSERT(RawObject::IsExternalTypedDataClassId(class_id));
+  return class_id - kExternalTypedDataInt8ArrayCid + kTypedDataInt8ArrayCid;
+}
+
+static intptr_t InternalToExternalTypedDataClassId(intptr_t class_id) {
+  ASSERT(RawObject::IsTypedDataClassId(class_id));
+  return class_id - kTypedDataInt8ArrayCid + kExternalTypedDataInt8ArrayCid;
+}
+
 Dart_CObject* ApiMessageReader::AllocateDartCObjectTypedData(
     Dart_TypedData_Type type,
     intptr_t length) {
@@ -688,64 +759,72 @@ Dart_CObject* ApiMessageReader::ReadInternalVMObject(intptr_t class_id,
     return object;                                                             \
   }
 
+// Bytes are not encoded, so they are used in place in the message buffer
+// instead of being copied. The message outlives the decoded objects.
+#define READ_TYPED_DATA_BYTES(element_type)                                    \
+  {                                                                            \
+    intptr_t len = ReadSmiValue();                                             \
+    Dart_CObject* object = AllocateDartCObject(Dart_CObject_kTypedData);       \
+    object->value.as_typed_data.type = Dart_TypedData_k##element_type;         \
+    object->value.as_typed_data.length = len;                                  \
+    object->value.as_typed_data.values = NULL;                                 \
+    if (len > 0) {                                                             \
+      object->value.as_typed_data.values =                                     \
+          const_cast<uint8_t*>(CurrentBufferAddress());                        \
+      Advance(len);                                                            \
+    }                                                                          \
+    AddBackRef(object_id, object, kIsDeserialized);                            \
+    return object;                                                             \
+  }
+
     case kTypedDataInt8ArrayCid:
-    case kExternalTypedDataInt8ArrayCid: {
-      READ_TYPED_DATA_HEADER(Int8);
-      if (len > 0) {
-        uint8_t* p =
-            reinterpret_cast<uint8_t*>(object->value.as_typed_data.values);
-        ReadBytes(p, len);
-      }
-      return object;
-    }
+      READ_TYPED_DATA_BYTES(Int8);
 
     case kTypedDataUint8ArrayCid:
-    case kExternalTypedDataUint8ArrayCid: {
-      READ_TYPED_DATA_HEADER(Uint8);
-      if (len > 0) {
-        uint8_t* p =
-            reinterpret_cast<uint8_t*>(object->value.as_typed_data.values);
-        ReadBytes(p, len);
-      }
-      return object;
-    }
+      READ_TYPED_DATA_BYTES(Uint8);
 
     case kTypedDataUint8ClampedArrayCid:
-    case kExternalTypedDataUint8ClampedArrayCid:
-      READ_TYPED_DATA(Uint8Clamped, uint8_t);
+      READ_TYPED_DATA_BYTES(Uint8Clamped);
 
     case kTypedDataInt16ArrayCid:
-    case kExternalTypedDataInt16ArrayCid:
       READ_TYPED_DATA(Int16, int16_t);
 
     case kTypedDataUint16ArrayCid:
-    case kExternalTypedDataUint16ArrayCid:
       READ_TYPED_DATA(Uint16, uint16_t);
 
     case kTypedDataInt32ArrayCid:
-    case kExternalTypedDataInt32ArrayCid:
       READ_TYPED_DATA(Int32, int32_t);
 
     case kTypedDataUint32ArrayCid:
-    case kExternalTypedDataUint32ArrayCid:
       READ_TYPED_DATA(Uint32, uint32_t);
 
     case kTypedDataInt64ArrayCid:
-    case kExternalTypedDataInt64ArrayCid:
       READ_TYPED_DATA(Int64, int64_t);
 
     case kTypedDataUint64ArrayCid:
-    case kExternalTypedDataUint64ArrayCid:
       READ_TYPED_DATA(Uint64, uint64_t);
 
     case kTypedDataFloat32ArrayCid:
-    case kExternalTypedDataFloat32ArrayCid:
       READ_TYPED_DATA(Float32, float);
 
     case kTypedDataFloat64ArrayCid:
-    case kExternalTypedDataFloat64ArrayCid:
       READ_TYPED_DATA(Float64, double);
 
+#undef READ_TYPED_DATA_BYTES
+
+    case kExternalTypedDataInt8ArrayCid:
+    case kExternalTypedDataUint8ArrayCid:
+    case kExternalTypedDataUint8ClampedArrayCid:
+    case kExternalTypedDataInt16ArrayCid:
+    case kExternalTypedDataUint16ArrayCid:
+    case kExternalTypedDataInt32ArrayCid:
+    case kExternalTypedDataUint32ArrayCid:
+    case kExternalTypedDataInt64ArrayCid:
+    case kExternalTypedDataUint64ArrayCid:
+    case kExternalTypedDataFloat32ArrayCid:
+    case kExternalTypedDataFloat64ArrayCid:
+      return ReadExternalTypedData(class_id, object_id);
+
     case kGrowableObjectArrayCid: {
       // A GrowableObjectArray is serialized as its type arguments and
       // length followed by its backing store. The backing store is an
@@ -787,6 +866,27 @@ Dart_CObject* ApiMessageReader::ReadInternalVMObject(intptr_t class_id,
   }
 }
 
+// External typed data is only written by ApiMessageWriter, which passes the
+// data pointer and its finalizer instead of the contents. The receiver of the
+// message takes ownership of the data.
+Dart_CObject* ApiMessageReader::ReadExternalTypedData(intptr_t class_id,
+                                                      intptr_t object_id) {
+  intptr_t length = ReadSmiValue();
+  Dart_CObject* object = AllocateDartCObject(Dart_CObject_kExternalTypedData);
+  object->value.as_external_typed_data.type =
+      GetTypedDataType(ExternalToInternalTypedDataClassId(class_id));
+  object->value.as_external_typed_data.length = length;
+  object->value.as_external_typed_data.data =
+      reinterpret_cast<uint8_t*>(ReadRawPointerValue());
+  object->value.as_external_typed_data.peer =
+      reinterpret_cast<void*>(ReadRawPointerValue());
+  object->value.as_external_typed_data.callback =
+      reinterpret_cast<Dart_WeakPersistentHandleFinalizer>(
+          ReadRawPointerValue());
+  AddBackRef(object_id, object, kIsDeserialized);
+  return object;
+}
+
 Dart_CObject* ApiMessageReader::ReadIndexedObject(intptr_t object_id) {
   if (object_id == kDynamicType || object_id == kDoubleType ||
       object_id == kIntType || object_id == kBoolType ||
@@ -1159,50 +1259,20 @@ bool ApiMessageWriter::WriteCObjectInlined(Dart_CObject* object,
       // Write out the serialization header value for this object.
       WriteInlinedHeader(object);
       // Write out the class and tags information.
-      intptr_t class_id;
-      switch (object->value.as_typed_data.type) {
-        case Dart_TypedData_kInt8:
-          class_id = kTypedDataInt8ArrayCid;
-          break;
-        case Dart_TypedData_kUint8:
-          class_id = kTypedDataUint8ArrayCid;
-          break;
-        case Dart_TypedData_kUint32:
-          class_id = kTypedDataUint32ArrayCid;
-          break;
-        default:
-          class_id = kTypedDataUint8ArrayCid;
-          UNIMPLEMENTED();
+      const intptr_t class_id =
+          GetTypedDataClassId(object->value.as_typed_data.type);
+      if (class_id == kIllegalCid) {
+        return false;
       }
-
       intptr_t len = object->value.as_typed_data.length;
       if (len < 0 || len > TypedData::MaxElements(class_id)) {
         return false;
       }
-
       WriteIndexedObject(class_id);
       WriteTags(0);
       WriteSmi(len);
-      switch (class_id) {
-        case kTypedDataInt8ArrayCid:
-        case kTypedDataUint8ArrayCid: {
-          uint8_t* bytes = object->value.as_typed_data.values;
-          for (intptr_t i = 0; i < len; i++) {
-            Write<uint8_t>(bytes[i]);
-          }
-          break;
-        }
-        case kTypedDataUint32ArrayCid: {
-          uint32_t* words =
-              reinterpret_cast<uint32_t*>(object->value.as_typed_data.values);
-          for (intptr_t i = 0; i < len; i++) {
-            Write<uint32_t>(words[i]);
-          }
-          break;
-        }
-        default:
-          UNIMPLEMENTED();
-      }
+      WriteTypedDataElements(class_id, object->value.as_typed_data.values,
+                             len);
       break;
     }
     case Dart_CObject_kExternalTypedData: {
@@ -1211,16 +1281,25 @@ bool ApiMessageWriter::WriteCObjectInlined(Dart_CObject* object,
       // sure that messages containing pointers can never be posted
       // to other processes.
 
+      // The data is not copied: its ownership is transferred to the
+      // receiver together with the finalizer.
       // Write out serialization header value for this object.
       WriteInlinedHeader(object);
-      // Write out the class and tag information.
-      WriteIndexedObject(kExternalTypedDataUint8ArrayCid);
-      WriteTags(0);
+      const intptr_t class_id =
+          GetTypedDataClassId(object->value.as_external_typed_data.type);
+      if (class_id == kIllegalCid) {
+        return false;
+      }
+      const intptr_t external_class_id =
+          InternalToExternalTypedDataClassId(class_id);
       intptr_t length = object->value.as_external_typed_data.length;
-      if (length < 0 || length > ExternalTypedData::MaxElements(
-                                     kExternalTypedDataUint8ArrayCid)) {
+      if (length < 0 ||
+          length > ExternalTypedData::MaxElements(external_class_id)) {
         return false;
       }
+      // Write out the class and tag information.
+      WriteIndexedObject(external_class_id);
+      WriteTags(0);
       uint8_t* data = object->value.as_external_typed_data.data;
       void* peer = object->value.as_external_typed_data.peer;
       Dart_WeakPersistentHandleFinalizer callback =
@@ -1253,6 +1332,46 @@ bool ApiMessageWriter::WriteCObjectInlined(Dart_CObject* object,
   return true;
 }
 
+void ApiMessageWriter::WriteTypedDataElements(intptr_t class_id,
+                                              const uint8_t* data,
+                                              intptr_t length) {
+#define WRITE_TYPED_DATA(type)                                                 \
+  {                                                                            \
+    const type* elements = reinterpret_cast<const type*>(data);                \
+    for (intptr_t i = 0; i < length; i++) {                                    \
+      Write<type>(elements[i]);                                                \
+    }                                                                          \
+    break;                                                                     \
+  }
+
+  switch (class_id) {
+    case kTypedDataInt8ArrayCid:
+    case kTypedDataUint8ArrayCid:
+    case kTypedDataUint8ClampedArrayCid:
+      WriteBytes(data, length);
+      break;
+    case kTypedDataInt16ArrayCid:
+      WRITE_TYPED_DATA(int16_t);
+    case kTypedDataUint16ArrayCid:
+      WRITE_TYPED_DATA(uint16_t);
+    case kTypedDataInt32ArrayCid:
+      WRITE_TYPED_DATA(int32_t);
+    case kTypedDataUint32ArrayCid:
+      WRITE_TYPED_DATA(uint32_t);
+    case kTypedDataInt64ArrayCid:
+      WRITE_TYPED_DATA(int64_t);
+    case kTypedDataUint64ArrayCid:
+      WRITE_TYPED_DATA(uint64_t);
+    case kTypedDataFloat32ArrayCid:
+      WRITE_TYPED_DATA(float);  // NOLINT.
+    case kTypedDataFloat64ArrayCid:
+      WRITE_TYPED_DATA(double);  // NOLINT.
+    default:
+      UNREACHABLE();
+  }
+#undef WRITE_TYPED_DATA
+}
+
 bool ApiMessageWriter::WriteCMessage(Dart_CObject* object) {
   bool success = WriteCObject(object);
   if (!success) {
@@ -112,6 +112,7 @@ class ApiMessageReader : public BaseReader {
   Dart_CObject* ReadVMIsolateObject(intptr_t value);
   Dart_CObject* ReadInternalVMObject(intptr_t class_id, intptr_t object_id);
   Dart_CObject* ReadInlinedObject(intptr_t object_id);
+  Dart_CObject* ReadExternalTypedData(intptr_t class_id, intptr_t object_id);
   Dart_CObject* ReadObjectImpl();
   Dart_CObject* ReadIndexedObject(intptr_t object_id);
   Dart_CObject* ReadPredefinedSymbol(intptr_t object_id);
@@ -191,6 +192,9 @@ class ApiMessageWriter : public BaseWriter {
   void WriteInt64(Dart_CObject* object);
   void WriteInlinedHeader(Dart_CObject* object);
   bool WriteCObject(Dart_CObject* object);
+  void WriteTypedDataElements(intptr_t class_id,
+                              const uint8_t* data,
+                              intptr_t length);
   bool WriteCObjectRef(Dart_CObject* object);
   bool WriteForwardedCObject(Dart_CObject* object);
   bool WriteCObjectInlined(Dart_CObject* object, Dart_CObject_Type type);
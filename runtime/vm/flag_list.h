@@ -157,6 +157,8 @@
   C(support_reload, false, false, bool, true, "Support isolate reload.")       \
   R(support_service, false, bool, true, "Support the service protocol.")       \
   R(support_timeline, false, bool, true, "Support timeline.")                  \
+  R(sweeper_tasks, USING_MULTICORE ? 2 : 1, int, USING_MULTICORE ? 2 : 1,     \
+    "The number of tasks to spawn for concurrent old gen GC sweeping.")        \
   D(trace_cha, bool, false, "Trace CHA operations")                            \
   D(trace_field_guards, bool, false, "Trace changes in field's cids.")         \
   C(trace_irregexp, false, false, bool, false, "Trace irregexps.")             \
@@ -54,7 +54,13 @@ intptr_t FreeListElement::HeaderSizeFor(intptr_t size) {
 
 FreeList::FreeList()
     : mutex_(new Mutex()),
-      freelist_search_budget_(kInitialFreeListSearchBudget) {
+      freelist_search_budget_(kInitialFreeListSearchBudget),
+      large_searches_(0),
+      large_search_steps_(0),
+      max_large_search_length_(0) {
+  COMPILE_ASSERT((1 << (kMinLargeSizeLog2 - kObjectAlignmentLog2)) ==
+                 kNumLists);
+  COMPILE_ASSERT(kNumLargeLists <= kBitsPerWord);
   Reset();
 }
 
@@ -74,7 +80,7 @@ uword FreeList::TryAllocateLocked(intptr_t size, bool is_protected) {
 
   // Postcondition: if allocation succeeds, the allocated block is writable.
   int index = IndexForSize(size);
-  if ((index != kNumLists) && free_map_.Test(index)) {
+  if ((index < kNumLists) && free_map_.Test(index)) {
     FreeListElement* element = DequeueElement(index);
     if (is_protected) {
       bool status = VirtualMemory::Protect(reinterpret_cast<void*>(element),
@@ -109,77 +115,128 @@ uword FreeList::TryAllocateLocked(intptr_t size, bool is_protected) {
     }
   }
 
-  FreeListElement* previous = NULL;
-  FreeListElement* current = free_lists_[kNumLists];
-  // We are willing to search the freelist further for a big block.
-  // For each successful free-list search we:
-  //   * increase the search budget by #allocated-words
-  //   * decrease the search budget by #free-list-entries-traversed
-  //     which guarantees us to not waste more than around 1 search step per
-  //     word of allocation
-  //
-  // If we run out of search budget we fall back to allocating a new page and
-  // reset the search budget.
-  intptr_t tries_left = freelist_search_budget_ + (size >> kWordSizeLog2);
-  while (current != NULL) {
-    if (current->Size() >= size) {
-      // Found an element large enough to hold the requested size. Dequeue,
-      // split and enqueue the remainder.
-      intptr_t remainder_size = current->Size() - size;
-      intptr_t region_size =
-          size + FreeListElement::HeaderSizeFor(remainder_size);
-      if (is_protected) {
-        // Make the allocated block and the header of the remainder element
-        // writable.  The remainder will be non-writable if necessary after
-        // the call to SplitElementAfterAndEnqueue.
-        bool status =
-            VirtualMemory::Protect(reinterpret_cast<void*>(current),
-                                   region_size, VirtualMemory::kReadWrite);
-        ASSERT(status);
-      }
+  FreeListElement* element = DequeueLargeElement(size, is_protected);
+  if (element == NULL) {
+    return 0;  // Trigger allocation of new page.
+  }
+  SplitElementAfterAndEnqueue(element, size, is_protected);
+  return reinterpret_cast<uword>(element);
+}
 
-      if (previous == NULL) {
-        free_lists_[kNumLists] = current->next();
-      } else {
-        // If the previous free list element's next field is protected, it
-        // needs to be unprotected before storing to it and reprotected
-        // after.
-        bool target_is_protected = false;
-        uword target_address = 0L;
+FreeListElement* FreeList::DequeueLargeElement(intptr_t size,
+                                               bool is_protected) {
+  // Every element in a size class above that of 'size' is large enough, but
+  // the elements in the class of 'size' itself might not be. Search that
+  // class first, so that larger elements are kept for larger requests.
+  intptr_t index = kNumLists;
+  intptr_t length = 0;
+  if (size >= (static_cast<intptr_t>(1) << kMinLargeSizeLog2)) {
+    index = IndexForSize(size);
+    FreeListElement* previous = NULL;
+    FreeListElement* current = free_lists_[index];
+    // We are willing to search the list further for a big block.
+    // For each successful search we:
+    //   * increase the search budget by #allocated-words
+    //   * decrease the search budget by #free-list-entries-traversed
+    //     which guarantees us to not waste more than around 1 search step per
+    //     word of allocation
+    //
+    // If we run out of search budget we fall back to the larger size classes,
+    // or else to allocating a new page, and reset the search budget.
+    intptr_t tries_left = freelist_search_budget_ + (size >> kWordSizeLog2);
+    while (current != NULL) {
+      length++;
+      if (current->Size() >= size) {
+        // Found an element large enough to hold the requested size.
+        intptr_t remainder_size = current->Size() - size;
+        intptr_t region_size =
+            size + FreeListElement::HeaderSizeFor(remainder_size);
         if (is_protected) {
-          uword writable_start = reinterpret_cast<uword>(current);
-          uword writable_end = writable_start + region_size - 1;
-          target_address = previous->next_address();
-          target_is_protected =
-              !VirtualMemory::InSamePage(target_address, writable_start) &&
-              !VirtualMemory::InSamePage(target_address, writable_end);
-        }
-        if (target_is_protected) {
+          // Make the allocated block and the header of the remainder element
+          // writable.  The remainder will be non-writable if necessary after
+          // the call to SplitElementAfterAndEnqueue.
           bool status =
-              VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
-                                     kWordSize, VirtualMemory::kReadWrite);
+              VirtualMemory::Protect(reinterpret_cast<void*>(current),
+                                     region_size, VirtualMemory::kReadWrite);
           ASSERT(status);
         }
-        previous->set_next(current->next());
-        if (target_is_protected) {
-          bool status =
-              VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
-                                     kWordSize, VirtualMemory::kReadExecute);
-          ASSERT(status);
+        if (previous == NULL) {
+          DequeueElement(index);
+        } else {
+          UnlinkElementAfter(previous, is_protected, region_size);
         }
+        freelist_search_budget_ =
+            Utils::Minimum(tries_left, kInitialFreeListSearchBudget);
+        RecordLargeSearch(length);
+        return current;
+      } else if (tries_left-- < 0) {
+        freelist_search_budget_ = kInitialFreeListSearchBudget;
+        break;
       }
-      SplitElementAfterAndEnqueue(current, size, is_protected);
-      freelist_search_budget_ =
-          Utils::Minimum(tries_left, kInitialFreeListSearchBudget);
-      return reinterpret_cast<uword>(current);
-    } else if (tries_left-- < 0) {
-      freelist_search_budget_ = kInitialFreeListSearchBudget;
-      return 0;  // Trigger allocation of new page.
+      previous = current;
+      current = current->next();
     }
-    previous = current;
-    current = current->next();
+    index++;
   }
-  return 0;
+
+  RecordLargeSearch(length);
+  // Take the head of the smallest non-empty class above.
+  const intptr_t shift = index - kNumLists;
+  const uword larger_classes = (shift < kBitsPerWord) ? (large_map_ >> shift)
+                                                      : 0;
+  if (larger_classes == 0) {
+    return NULL;
+  }
+  index += Utils::CountTrailingZeros(larger_classes);
+  FreeListElement* element = free_lists_[index];
+  ASSERT(element->Size() >= size);
+  if (is_protected) {
+    intptr_t remainder_size = element->Size() - size;
+    intptr_t region_size =
+        size + FreeListElement::HeaderSizeFor(remainder_size);
+    bool status =
+        VirtualMemory::Protect(reinterpret_cast<void*>(element), region_size,
+                               VirtualMemory::kReadWrite);
+    ASSERT(status);
+  }
+  return DequeueElement(index);
+}
+
+void FreeList::UnlinkElementAfter(FreeListElement* previous,
+                                  bool is_protected,
+                                  intptr_t region_size) {
+  FreeListElement* element = previous->next();
+  // If the previous free list element's next field is protected, it needs to
+  // be unprotected before storing to it and reprotected after.
+  bool target_is_protected = false;
+  uword target_address = 0L;
+  if (is_protected) {
+    uword writable_start = reinterpret_cast<uword>(element);
+    uword writable_end = writable_start + region_size - 1;
+    target_address = previous->next_address();
+    target_is_protected =
+        !VirtualMemory::InSamePage(target_address, writable_start) &&
+        !VirtualMemory::InSamePage(target_address, writable_end);
+  }
+  if (target_is_protected) {
+    bool status =
+        VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
+                               kWordSize, VirtualMemory::kReadWrite);
+    ASSERT(status);
+  }
+  previous->set_next(element->next());
+  if (target_is_protected) {
+    bool status =
+        VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
+                               kWordSize, VirtualMemory::kReadExecute);
+    ASSERT(status);
+  }
+}
+
+void FreeList::RecordLargeSearch(intptr_t length) {
+  large_searches_++;
+  large_search_steps_ += length;
+  max_large_search_length_ = Utils::Maximum(max_large_search_length_, length);
 }
 
 void FreeList::Free(uword addr, intptr_t size) {
@@ -203,8 +260,9 @@ void FreeList::FreeLocked(uword addr, intptr_t size) {
 void FreeList::Reset() {
   MutexLocker ml(mutex_);
   free_map_.Reset();
+  large_map_ = 0;
   last_free_small_size_ = -1;
-  for (int i = 0; i < (kNumLists + 1); i++) {
+  for (int i = 0; i < (kNumLists + kNumLargeLists); i++) {
     free_lists_[i] = NULL;
   }
 }
@@ -215,17 +273,24 @@ intptr_t FreeList::IndexForSize(intptr_t size) {
 
   intptr_t index = size >> kObjectAlignmentLog2;
   if (index >= kNumLists) {
-    index = kNumLists;
+    const intptr_t size_class = Utils::HighestBit(size) - kMinLargeSizeLog2;
+    index = kNumLists +
+            Utils::Minimum(size_class,
+                           static_cast<intptr_t>(kNumLargeLists - 1));
   }
   return index;
 }
 
 void FreeList::EnqueueElement(FreeListElement* element, intptr_t index) {
   FreeListElement* next = free_lists_[index];
-  if (next == NULL && index != kNumLists) {
-    free_map_.Set(index, true);
-    last_free_small_size_ =
-        Utils::Maximum(last_free_small_size_, index << kObjectAlignmentLog2);
+  if (next == NULL) {
+    if (index < kNumLists) {
+      free_map_.Set(index, true);
+      last_free_small_size_ =
+          Utils::Maximum(last_free_small_size_, index << kObjectAlignmentLog2);
+    } else {
+      large_map_ |= static_cast<uword>(1) << (index - kNumLists);
+    }
   }
   element->set_next(next);
   free_lists_[index] = element;
@@ -234,14 +299,18 @@ void FreeList::EnqueueElement(FreeListElement* element, intptr_t index) {
 FreeListElement* FreeList::DequeueElement(intptr_t index) {
   FreeListElement* result = free_lists_[index];
   FreeListElement* next = result->next();
-  if (next == NULL && index != kNumLists) {
-    intptr_t size = index << kObjectAlignmentLog2;
-    if (size == last_free_small_size_) {
-      // Note: This is -1 * kObjectAlignment if no other small sizes remain.
-      last_free_small_size_ =
-          free_map_.ClearLastAndFindPrevious(index) * kObjectAlignment;
+  if (next == NULL) {
+    if (index < kNumLists) {
+      intptr_t size = index << kObjectAlignmentLog2;
+      if (size == last_free_small_size_) {
+        // Note: This is -1 * kObjectAlignment if no other small sizes remain.
+        last_free_small_size_ =
+            free_map_.ClearLastAndFindPrevious(index) * kObjectAlignment;
+      } else {
+        free_map_.Set(index, false);
+      }
     } else {
-      free_map_.Set(index, false);
+      large_map_ &= ~(static_cast<uword>(1) << (index - kNumLists));
     }
   }
   free_lists_[index] = next;
@@ -311,16 +380,18 @@ void FreeList::PrintLarge() const {
   int large_objects = 0;
   intptr_t large_bytes = 0;
   MallocDirectChainedHashMap<NumbersKeyValueTrait<IntptrPair> > map;
-  FreeListElement* node;
-  for (node = free_lists_[kNumLists]; node != NULL; node = node->next()) {
-    IntptrPair* pair = map.Lookup(node->Size());
-    if (pair == NULL) {
-      large_sizes += 1;
-      map.Insert(IntptrPair(node->Size(), 1));
-    } else {
-      pair->set_second(pair->second() + 1);
+  for (int i = kNumLists; i < (kNumLists + kNumLargeLists); ++i) {
+    FreeListElement* node;
+    for (node = free_lists_[i]; node != NULL; node = node->next()) {
+      IntptrPair* pair = map.Lookup(node->Size());
+      if (pair == NULL) {
+        large_sizes += 1;
+        map.Insert(IntptrPair(node->Size(), 1));
+      } else {
+        pair->set_second(pair->second() + 1);
+      }
+      large_objects += 1;
     }
-    large_objects += 1;
   }
 
   MallocDirectChainedHashMap<NumbersKeyValueTrait<IntptrPair> >::Iterator it =
@@ -340,10 +411,20 @@ void FreeList::PrintLarge() const {
   }
 }
 
+void FreeList::PrintSearches() const {
+  OS::Print("large searches: %" Pd "; %8.1f avg steps; %" Pd " max steps\n",
+            large_searches_,
+            (large_searches_ == 0)
+                ? 0.0
+                : large_search_steps_ / static_cast<double>(large_searches_),
+            max_large_search_length_);
+}
+
 void FreeList::Print() const {
   MutexLocker ml(mutex_);
   PrintSmall();
   PrintLarge();
+  PrintSearches();
 }
 
 void FreeList::SplitElementAfterAndEnqueue(FreeListElement* element,
@@ -380,31 +461,17 @@ FreeListElement* FreeList::TryAllocateLarge(intptr_t minimum_size) {
 
 FreeListElement* FreeList::TryAllocateLargeLocked(intptr_t minimum_size) {
   DEBUG_ASSERT(mutex_->IsOwnedByCurrentThread());
-  FreeListElement* previous = NULL;
-  FreeListElement* current = free_lists_[kNumLists];
-  // TODO(koda): Find largest.
-  // We are willing to search the freelist further for a big block.
-  intptr_t tries_left =
-      freelist_search_budget_ + (minimum_size >> kWordSizeLog2);
-  while (current != NULL) {
-    FreeListElement* next = current->next();
-    if (current->Size() >= minimum_size) {
-      if (previous == NULL) {
-        free_lists_[kNumLists] = next;
-      } else {
-        previous->set_next(next);
-      }
-      freelist_search_budget_ =
-          Utils::Minimum(tries_left, kInitialFreeListSearchBudget);
-      return current;
-    } else if (tries_left-- < 0) {
-      freelist_search_budget_ = kInitialFreeListSearchBudget;
-      return 0;  // Trigger allocation of new page.
-    }
-    previous = current;
-    current = next;
+  if (large_map_ == 0) {
+    return NULL;
+  }
+  // Prefer the head of the largest size class, which is large enough unless
+  // 'minimum_size' falls in that class too.
+  intptr_t index = kNumLists + Utils::HighestBit(large_map_);
+  if (free_lists_[index]->Size() >= minimum_size) {
+    RecordLargeSearch(0);
+    return DequeueElement(index);
   }
-  return NULL;
+  return DequeueLargeElement(minimum_size, false);
 }
 
 uword FreeList::TryAllocateSmallLocked(intptr_t size) {
@@ -413,7 +480,7 @@ uword FreeList::TryAllocateSmallLocked(intptr_t size) {
     return 0;
   }
   int index = IndexForSize(size);
-  if (index != kNumLists && free_map_.Test(index)) {
+  if ((index < kNumLists) && free_map_.Test(index)) {
     return reinterpret_cast<uword>(DequeueElement(index));
   }
   if ((index + 1) < kNumLists) {
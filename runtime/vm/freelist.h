@@ -98,8 +98,21 @@ class FreeList {
   // (i.e., fixed size lists).
   uword TryAllocateSmallLocked(intptr_t size);
 
+  // Statistics on the searches of the large lists: how many were made, how
+  // many elements they visited in total, and the longest one.
+  intptr_t large_searches() const { return large_searches_; }
+  intptr_t large_search_steps() const { return large_search_steps_; }
+  intptr_t max_large_search_length() const {
+    return max_large_search_length_;
+  }
+
  private:
+  // Exact lists for the small sizes, followed by lists for power-of-two
+  // size classes starting at kNumLists * kObjectAlignment. The last class
+  // also holds all larger elements.
   static const int kNumLists = 128;
+  static const int kNumLargeLists = 16;
+  static const int kMinLargeSizeLog2 = 7 + kObjectAlignmentLog2;
   static const intptr_t kInitialFreeListSearchBudget = 1000;
 
   static intptr_t IndexForSize(intptr_t size);
@@ -109,22 +122,41 @@ class FreeList {
   void EnqueueElement(FreeListElement* element, intptr_t index);
   FreeListElement* DequeueElement(intptr_t index);
 
+  // Dequeues an element of at least 'size' bytes from the large lists, or
+  // returns NULL. If 'is_protected', the first 'size' bytes of the element
+  // and the header of the remainder are left writable.
+  FreeListElement* DequeueLargeElement(intptr_t size, bool is_protected);
+  // Unlinks the successor of 'previous', whose first 'region_size' bytes
+  // are writable.
+  void UnlinkElementAfter(FreeListElement* previous,
+                          bool is_protected,
+                          intptr_t region_size);
+  void RecordLargeSearch(intptr_t length);
+
   void SplitElementAfterAndEnqueue(FreeListElement* element,
                                    intptr_t size,
                                    bool is_protected);
 
   void PrintSmall() const;
   void PrintLarge() const;
+  void PrintSearches() const;
 
   // Lock protecting the free list data structures.
   Mutex* mutex_;
 
   BitSet<kNumLists> free_map_;
 
-  FreeListElement* free_lists_[kNumLists + 1];
+  // Bit i is set if the large list kNumLists + i is non-empty.
+  uword large_map_;
+
+  FreeListElement* free_lists_[kNumLists + kNumLargeLists];
 
   intptr_t freelist_search_budget_;
 
+  intptr_t large_searches_;
+  intptr_t large_search_steps_;
+  intptr_t max_large_search_length_;
+
   // The largest available small size in bytes, or negative if there is none.
   intptr_t last_free_small_size_;
 
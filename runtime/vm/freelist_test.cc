@@ -4,6 +4,8 @@
 
 #include "vm/freelist.h"
 #include "platform/assert.h"
+#include "vm/benchmark_test.h"
+#include "vm/timer.h"
 #include "vm/unit_test.h"
 
 namespace dart {
@@ -185,4 +187,70 @@ TEST_CASE(FreeListProtectedVariableSizeObjects) {
   delete[] objects;
 }
 
+TEST_CASE(FreeListLargeSizeClasses) {
+  FreeList* free_list = new FreeList();
+  const intptr_t kBlobSize = 1 * MB;
+  VirtualMemory* region = VirtualMemory::Reserve(kBlobSize);
+  region->Commit(/* is_executable */ false, NULL);
+  uword blob = region->start();
+
+  // The large blocks are in different size classes. The largest one is
+  // freed last, so it would be at the head of a single large list.
+  free_list->Free(blob, 3 * KB);
+  free_list->Free(blob + 43 * KB, 5 * KB);
+  free_list->Free(blob + 3 * KB, 40 * KB);
+
+  // Large allocations are served from their own size class.
+  EXPECT_EQ(blob + 43 * KB, free_list->TryAllocate(4 * KB, false));
+  EXPECT_EQ(blob, free_list->TryAllocate(2 * KB + 512, false));
+
+  // The bump allocator gets the largest block.
+  FreeListElement* element = free_list->TryAllocateLarge(1 * KB);
+  EXPECT_EQ(blob + 3 * KB, reinterpret_cast<uword>(element));
+  EXPECT_EQ(40 * KB, element->Size());
+
+  // Each size class search found a block at its head.
+  EXPECT_EQ(3, free_list->large_searches());
+  EXPECT_EQ(2, free_list->large_search_steps());
+  EXPECT_EQ(1, free_list->max_large_search_length());
+
+  // Delete the memory associated with the test.
+  delete region;
+  delete free_list;
+}
+
+BENCHMARK(FreeListAllocateLarge) {
+  const intptr_t kRegionSize = 16 * MB;
+  const intptr_t kRounds = 100;
+  VirtualMemory* region = VirtualMemory::Reserve(kRegionSize);
+  region->Commit(/* is_executable */ false, NULL);
+  FreeList* free_list = new FreeList();
+  Timer timer(true, "FreeList large allocation benchmark");
+  timer.Start();
+  for (intptr_t round = 0; round < kRounds; round++) {
+    // Fragment the region into blocks of 2KB to 64KB.
+    free_list->Reset();
+    uword current = region->start();
+    for (intptr_t i = 0; true; i++) {
+      const intptr_t size = (static_cast<intptr_t>(2) << (i % 6)) * KB;
+      if (current + size > region->end()) {
+        break;
+      }
+      free_list->Free(current, size);
+      current += size;
+    }
+    // Allocate blocks of 2KB to 10KB until the free list gives up.
+    for (intptr_t i = 0; true; i++) {
+      const intptr_t size = ((i % 5) + 1) * 2 * KB;
+      if (free_list->TryAllocate(size, false) == 0) {
+        break;
+      }
+    }
+  }
+  timer.Stop();
+  benchmark->set_score(timer.TotalElapsedTime());
+  delete free_list;
+  delete region;
+}
+
 }  // namespace dart
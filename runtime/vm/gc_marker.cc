@@ -17,10 +17,13 @@
 #include "vm/thread_pool.h"
 #include "vm/thread_registry.h"
 #include "vm/timeline.h"
+#include "vm/virtual_memory.h"
 #include "vm/visitor.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, incremental_marking);
+
 class SkippedCodeFunctions : public ZoneAllocated {
  public:
   SkippedCodeFunctions() {}
@@ -125,6 +128,11 @@ class MarkerWorkList : public ValueObject {
 
   void Finalize() {
     ASSERT(work_->IsEmpty());
+    Flush();
+  }
+
+  // Returns the remaining work to the marking stack, to be resumed later.
+  void Flush() {
     marking_stack_->PushBlock(work_);
     work_ = NULL;
     // Fail fast on attempts to mark after finalizing.
@@ -142,7 +150,8 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   MarkingVisitorBase(Isolate* isolate,
                      PageSpace* page_space,
                      MarkingStack* marking_stack,
-                     SkippedCodeFunctions* skipped_code_functions)
+                     SkippedCodeFunctions* skipped_code_functions,
+                     bool incremental)
       : ObjectPointerVisitor(isolate),
         thread_(Thread::Current()),
 #ifndef PRODUCT
@@ -154,8 +163,10 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
         delayed_weak_properties_(NULL),
         visiting_old_object_(NULL),
         skipped_code_functions_(skipped_code_functions),
-        marked_bytes_(0) {
+        marked_bytes_(0),
+        incremental_(incremental) {
     ASSERT(thread_->isolate() == isolate);
+    ASSERT(!incremental_ || (skipped_code_functions_ == NULL));
 #ifndef PRODUCT
     class_stats_count_.SetLength(isolate->class_table()->NumCids());
     class_stats_size_.SetLength(isolate->class_table()->NumCids());
@@ -185,7 +196,10 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
       RawObject* raw_key = cur_weak->ptr()->key_;
       // Reset the next pointer in the weak property.
       cur_weak->ptr()->next_ = 0;
-      if (raw_key->IsMarked()) {
+      // When marking incrementally, the key may have been replaced since the
+      // weak property was enqueued.
+      if (!raw_key->IsHeapObject() || !raw_key->IsOldObject() ||
+          raw_key->IsMarked()) {
         RawObject* raw_val = cur_weak->ptr()->value_;
         marked = marked || (raw_val->IsHeapObject() && !raw_val->IsMarked());
 
@@ -239,6 +253,55 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     VisitingOldObject(NULL);
   }
 
+  // Like DrainMarkingStack, but returns early once 'deadline' has passed.
+  // Returns true if there is nothing left to mark.
+  bool DrainMarkingStackUntil(int64_t deadline) {
+    // Bytes marked between reads of the clock.
+    const uintptr_t kDeadlineCheckInterval = 64 * KB;
+    uintptr_t next_deadline_check = marked_bytes_ + kDeadlineCheckInterval;
+    RawObject* raw_obj = work_list_.Pop();
+    while (raw_obj != NULL) {
+      VisitingOldObject(raw_obj);
+      const intptr_t class_id = raw_obj->GetClassId();
+      if (class_id != kWeakPropertyCid) {
+        marked_bytes_ += raw_obj->VisitPointersNonvirtual(this);
+      } else {
+        RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+        marked_bytes_ += ProcessWeakProperty(raw_weak);
+      }
+      if (marked_bytes_ >= next_deadline_check) {
+        if (OS::GetCurrentMonotonicMicros() >= deadline) {
+          VisitingOldObject(NULL);
+          return false;
+        }
+        next_deadline_check = marked_bytes_ + kDeadlineCheckInterval;
+      }
+      raw_obj = work_list_.Pop();
+      if (raw_obj == NULL) {
+        // Marking stack is empty.
+        ProcessPendingWeakProperties();
+        raw_obj = work_list_.Pop();
+      }
+    }
+    VisitingOldObject(NULL);
+    return true;
+  }
+
+  // Hands over the weak properties waiting for their keys to be marked.
+  RawWeakProperty* DetachDelayedWeakProperties() {
+    RawWeakProperty* result = delayed_weak_properties_;
+    delayed_weak_properties_ = NULL;
+    return result;
+  }
+
+  void AttachDelayedWeakProperties(RawWeakProperty* list) {
+    ASSERT(delayed_weak_properties_ == NULL);
+    delayed_weak_properties_ = list;
+  }
+
+  // Called at the end of an incremental marking step.
+  void Flush() { work_list_.Flush(); }
+
   void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; current++) {
       MarkObject(*current, current);
@@ -314,7 +377,10 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     // We acquired the mark bit => no other task is modifying the header.
     // TODO(koda): For concurrent mutator, this needs synchronization. Consider
     // clearing these bits already in the CAS for the mark bit.
-    raw_obj->ClearRememberedBitUnsynchronized();
+    // Incremental marking leaves the store buffer to the mutator.
+    if (!incremental_) {
+      raw_obj->ClearRememberedBitUnsynchronized();
+    }
     work_list_.Push(raw_obj);
   }
 
@@ -345,7 +411,9 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     // if (marked) return;
     // ...
     if (raw_obj->IsNewObject()) {
-      ProcessNewSpaceObject(raw_obj, p);
+      if (!incremental_) {
+        ProcessNewSpaceObject(raw_obj, p);
+      }
       return;
     }
 
@@ -377,7 +445,11 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   void ProcessNewSpaceObject(RawObject* raw_obj, RawObject** p) {
     // TODO(iposva): Add consistency check.
     if ((visiting_old_object_ != NULL) &&
-        TryAcquireRememberedBit(visiting_old_object_)) {
+        visiting_old_object_->IsCardRemembered()) {
+      // Marking a card is idempotent, no need to synchronize.
+      visiting_old_object_->RememberCard(p);
+    } else if ((visiting_old_object_ != NULL) &&
+               TryAcquireRememberedBit(visiting_old_object_)) {
       // NOTE: We pass in the pointer to the address we are visiting
       // allows us to get a distance from the object start. At some
       // point we might want to store exact addresses in store buffers
@@ -410,6 +482,7 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   RawObject* visiting_old_object_;
   SkippedCodeFunctions* skipped_code_functions_;
   uintptr_t marked_bytes_;
+  const bool incremental_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitorBase);
 };
@@ -572,7 +645,7 @@ class MarkTask : public ThreadPool::Task {
       SkippedCodeFunctions* skipped_code_functions =
           collect_code_ ? new (zone) SkippedCodeFunctions() : NULL;
       SyncMarkingVisitor visitor(isolate_, page_space_, marking_stack_,
-                                 skipped_code_functions);
+                                 skipped_code_functions, false);
       // Phase 1: Iterate over roots and drain marking stack in tasks.
       marker_->IterateRoots(isolate_, &visitor, task_index_, num_tasks_);
 
@@ -661,23 +734,26 @@ class MarkTask : public ThreadPool::Task {
 };
 
 template <class MarkingVisitorType>
-void GCMarker::FinalizeResultsFrom(MarkingVisitorType* visitor) {
-  {
-    MutexLocker ml(&stats_mutex_);
-    marked_bytes_ += visitor->marked_bytes();
+void GCMarker::AccumulateResultsFrom(MarkingVisitorType* visitor) {
+  MutexLocker ml(&stats_mutex_);
+  marked_bytes_ += visitor->marked_bytes();
 #ifndef PRODUCT
-    // Class heap stats are not themselves thread-safe yet, so we update the
-    // stats while holding stats_mutex_.
-    ClassTable* table = heap_->isolate()->class_table();
-    for (intptr_t i = 0; i < table->NumCids(); ++i) {
-      const intptr_t count = visitor->live_count(i);
-      if (count > 0) {
-        const intptr_t size = visitor->live_size(i);
-        table->UpdateLiveOld(i, size, count);
-      }
+  // Class heap stats are not themselves thread-safe yet, so we update the
+  // stats while holding stats_mutex_.
+  ClassTable* table = heap_->isolate()->class_table();
+  for (intptr_t i = 0; i < table->NumCids(); ++i) {
+    const intptr_t count = visitor->live_count(i);
+    if (count > 0) {
+      const intptr_t size = visitor->live_size(i);
+      table->UpdateLiveOld(i, size, count);
     }
-#endif  // !PRODUCT
   }
+#endif  // !PRODUCT
+}
+
+template <class MarkingVisitorType>
+void GCMarker::FinalizeResultsFrom(MarkingVisitorType* visitor) {
+  AccumulateResultsFrom(visitor);
   visitor->Finalize();
 }
 
@@ -699,7 +775,7 @@ void GCMarker::MarkObjects(Isolate* isolate,
       SkippedCodeFunctions* skipped_code_functions =
           collect_code ? new (zone) SkippedCodeFunctions() : NULL;
       UnsyncMarkingVisitor mark(isolate, page_space, &marking_stack,
-                                skipped_code_functions);
+                                skipped_code_functions, false);
       IterateRoots(isolate, &mark, 0, 1);
       mark.DrainMarkingStack();
       {
@@ -760,4 +836,160 @@ void GCMarker::MarkObjects(Isolate* isolate,
   Epilogue(isolate);
 }
 
+// Set while an isolate is marking incrementally, see IncrementalMarker.
+static uword incremental_marker_claimed = 0;
+
+IncrementalMarker::IncrementalMarker(Heap* heap,
+                                     intptr_t used_in_words_at_start)
+    : marker_(heap),
+      delayed_weak_properties_(NULL),
+      used_in_words_at_start_(used_in_words_at_start),
+      visited_roots_(false) {}
+
+IncrementalMarker::~IncrementalMarker() {
+  AtomicOperations::CompareAndSwapWord(&incremental_marker_claimed, 1, 0);
+}
+
+IncrementalMarker* IncrementalMarker::TryCreate(Heap* heap) {
+  // Dirty page tracking has side effects on the whole process, see
+  // VirtualMemory::ClearDirtyPages. Only use it when asked to.
+  if (!FLAG_incremental_marking ||
+      !VirtualMemory::SupportsDirtyPageTracking()) {
+    return NULL;
+  }
+  if (AtomicOperations::CompareAndSwapWord(&incremental_marker_claimed, 0,
+                                           1) != 0) {
+    return NULL;
+  }
+  return new IncrementalMarker(heap, heap->old_space()->UsedInWords());
+}
+
+// Revisits the pointers of marked objects, which the mutator may have written
+// to after they were marked. Weak properties are visited strongly, since
+// their keys may have changed too; the floating garbage this leaves is
+// collected by the next collection.
+template <class MarkingVisitorType>
+class RescanMarkedObjectsVisitor : public ObjectVisitor {
+ public:
+  explicit RescanMarkedObjectsVisitor(MarkingVisitorType* visitor)
+      : visitor_(visitor) {}
+
+  void VisitObject(RawObject* raw_obj) {
+    if (raw_obj->IsMarked()) {
+      visitor_->VisitingOldObject(raw_obj);
+      raw_obj->VisitPointersNonvirtual(visitor_);
+      visitor_->VisitingOldObject(NULL);
+    }
+  }
+
+ private:
+  MarkingVisitorType* visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(RescanMarkedObjectsVisitor);
+};
+
+template <class MarkingVisitorType>
+void IncrementalMarker::RescanDirtyPages(PageSpace* page_space,
+                                         MarkingVisitorType* visitor) {
+  RescanMarkedObjectsVisitor<MarkingVisitorType> rescan(visitor);
+  page_space->VisitObjectsOnDirtyPages(&rescan);
+}
+
+bool IncrementalMarker::Step(Isolate* isolate,
+                             PageSpace* page_space,
+                             int64_t deadline) {
+  Thread* thread = Thread::Current();
+  TIMELINE_FUNCTION_GC_DURATION(thread, "IncrementalMarkStep");
+  StackZone stack_zone(thread);
+  UnsyncMarkingVisitor visitor(isolate, page_space, &marking_stack_, NULL,
+                               true);
+  visitor.AttachDelayedWeakProperties(delayed_weak_properties_);
+  if (!visited_roots_) {
+    marker_.IterateRoots(isolate, &visitor, 0, 1);
+    visited_roots_ = true;
+  } else {
+    RescanDirtyPages(page_space, &visitor);
+  }
+  const bool done = visitor.DrainMarkingStackUntil(deadline);
+  delayed_weak_properties_ = visitor.DetachDelayedWeakProperties();
+  marker_.AccumulateResultsFrom(&visitor);
+  visitor.Flush();
+  // Only the pages written by the mutator after this step need to be
+  // rescanned, not the ones written by marking. If clearing fails, the next
+  // step just rescans more.
+  VirtualMemory::ClearDirtyPages();
+  return done;
+}
+
+void IncrementalMarker::Finish(Isolate* isolate, PageSpace* page_space) {
+  Thread* thread = Thread::Current();
+  isolate->PrepareForGC();
+  {
+    StackZone stack_zone(thread);
+    UnsyncMarkingVisitor visitor(isolate, page_space, &marking_stack_, NULL,
+                                 true);
+    visitor.AttachDelayedWeakProperties(delayed_weak_properties_);
+    delayed_weak_properties_ = NULL;
+    RescanDirtyPages(page_space, &visitor);
+    marker_.IterateRoots(isolate, &visitor, 0, 1);
+    visitor.DrainMarkingStack();
+    {
+      TIMELINE_FUNCTION_GC_DURATION(thread, "WeakHandleProcessing");
+      MarkingWeakVisitor mark_weak(thread);
+      marker_.IterateWeakRoots(isolate, &mark_weak);
+    }
+    marker_.FinalizeResultsFrom(&visitor);
+  }
+  marker_.ProcessWeakTables(page_space);
+  marker_.ProcessObjectIdTable(isolate);
+  FilterStoreBuffer(isolate);
+}
+
+void IncrementalMarker::FilterStoreBuffer(Isolate* isolate) {
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  StoreBufferBlock* pending = store_buffer->Blocks();
+  while (pending != NULL) {
+    StoreBufferBlock* next = pending->next();
+    StoreBufferBlock* live = store_buffer->PopEmptyBlock();
+    while (!pending->IsEmpty()) {
+      RawObject* raw_object = pending->Pop();
+      // Unmarked objects are about to be swept.
+      if (raw_object->IsMarked()) {
+        live->Push(raw_object);
+      }
+    }
+    pending->Reset();
+    store_buffer->PushBlock(pending, StoreBuffer::kIgnoreThreshold);
+    store_buffer->PushBlock(live, StoreBuffer::kIgnoreThreshold);
+    pending = next;
+  }
+}
+
+class ClearMarkBitsVisitor : public ObjectVisitor {
+ public:
+  ClearMarkBitsVisitor() {}
+
+  void VisitObject(RawObject* raw_obj) {
+    if (raw_obj->IsMarked()) {
+      raw_obj->ClearMarkBit();
+    }
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ClearMarkBitsVisitor);
+};
+
+void IncrementalMarker::Abort(PageSpace* page_space) {
+  marking_stack_.Reset();
+  RawWeakProperty* cur_weak = delayed_weak_properties_;
+  delayed_weak_properties_ = NULL;
+  while (cur_weak != NULL) {
+    uword next_weak = cur_weak->ptr()->next_;
+    cur_weak->ptr()->next_ = 0;
+    cur_weak = reinterpret_cast<RawWeakProperty*>(next_weak);
+  }
+  ClearMarkBitsVisitor visitor;
+  page_space->VisitObjectsNoImagePages(&visitor);
+}
+
 }  // namespace dart
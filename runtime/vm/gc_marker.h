@@ -7,6 +7,7 @@
 
 #include "vm/allocation.h"
 #include "vm/os_thread.h"  // Mutex.
+#include "vm/store_buffer.h"
 
 namespace dart {
 
@@ -47,6 +48,9 @@ class GCMarker : public ValueObject {
   // Called by anyone: finalize and accumulate stats from 'visitor'.
   template <class MarkingVisitorType>
   void FinalizeResultsFrom(MarkingVisitorType* visitor);
+  // Accumulate stats from 'visitor' without finalizing it.
+  template <class MarkingVisitorType>
+  void AccumulateResultsFrom(MarkingVisitorType* visitor);
 
   Heap* heap_;
 
@@ -54,10 +58,55 @@ class GCMarker : public ValueObject {
   // TODO(koda): Remove after verifying it's redundant w.r.t. ClassHeapStats.
   uintptr_t marked_bytes_;
 
+  friend class IncrementalMarker;
   friend class MarkTask;
   DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
 };
 
+// The class IncrementalMarker marks old generation objects in bounded steps,
+// between which the mutator runs. There is no write barrier for marking:
+// instead, each step rescans the marked objects on the pages written since the
+// previous step, as reported by VirtualMemory's dirty page tracking. Objects
+// allocated in old space while marking are allocated marked.
+// Dirty page tracking is process wide, so only one isolate at a time can mark
+// incrementally.
+class IncrementalMarker {
+ public:
+  // Returns NULL if dirty pages cannot be tracked, or if another isolate is
+  // already marking incrementally.
+  static IncrementalMarker* TryCreate(Heap* heap);
+  ~IncrementalMarker();
+
+  // Marks until 'deadline'. Returns true if only the final phase is left.
+  bool Step(Isolate* isolate, PageSpace* page_space, int64_t deadline);
+
+  // Completes marking, including the processing of weak references. Dead old
+  // objects are dropped from the store buffer, which is not rebuilt.
+  void Finish(Isolate* isolate, PageSpace* page_space);
+
+  // Clears all mark bits and discards the marking state.
+  void Abort(PageSpace* page_space);
+
+  intptr_t marked_words() { return marker_.marked_words(); }
+  intptr_t used_in_words_at_start() const { return used_in_words_at_start_; }
+
+ private:
+  IncrementalMarker(Heap* heap, intptr_t used_in_words_at_start);
+
+  template <class MarkingVisitorType>
+  void RescanDirtyPages(PageSpace* page_space, MarkingVisitorType* visitor);
+  void FilterStoreBuffer(Isolate* isolate);
+
+  GCMarker marker_;
+  MarkingStack marking_stack_;
+  // Weak properties with unmarked keys, kept between steps.
+  RawWeakProperty* delayed_weak_properties_;
+  const intptr_t used_in_words_at_start_;
+  bool visited_roots_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalMarker);
+};
+
 }  // namespace dart
 
 #endif  // RUNTIME_VM_GC_MARKER_H_
@@ -96,23 +96,15 @@ intptr_t GCSweeper::SweepLargePage(HeapPage* page) {
   return words_to_end;
 }
 
+// Sweeps pages until there are no more left. The tasks and the allocator take
+// the pages to sweep one at a time, so they split the page list between them
+// by how fast they go.
 class SweeperTask : public ThreadPool::Task {
  public:
-  SweeperTask(Isolate* isolate,
-              PageSpace* old_space,
-              HeapPage* first,
-              HeapPage* last,
-              FreeList* freelist)
-      : task_isolate_(isolate),
-        old_space_(old_space),
-        first_(first),
-        last_(last),
-        freelist_(freelist) {
+  SweeperTask(Isolate* isolate, PageSpace* old_space)
+      : task_isolate_(isolate), old_space_(old_space) {
     ASSERT(task_isolate_ != NULL);
-    ASSERT(first_ != NULL);
     ASSERT(old_space_ != NULL);
-    ASSERT(last_ != NULL);
-    ASSERT(freelist_ != NULL);
     MonitorLocker ml(old_space_->tasks_lock());
     old_space_->set_tasks(old_space_->tasks() + 1);
   }
@@ -124,20 +116,12 @@ class SweeperTask : public ThreadPool::Task {
     {
       Thread* thread = Thread::Current();
       TIMELINE_FUNCTION_GC_DURATION(thread, "SweeperTask");
-      GCSweeper sweeper;
-
-      HeapPage* page = first_;
-      HeapPage* prev_page = NULL;
-
-      while (page != NULL) {
+      const bool is_locked = false;
+      const bool is_lazy = false;
+      while (true) {
         thread->CheckForSafepoint();
-        HeapPage* next_page = page->next();
-        ASSERT(page->type() == HeapPage::kData);
-        bool page_in_use = sweeper.SweepPage(page, freelist_, false);
-        if (page_in_use) {
-          prev_page = page;
-        } else {
-          old_space_->FreePage(page, prev_page);
+        if (!old_space_->SweepNextPage(is_locked, is_lazy)) {
+          break;
         }
         {
           // Notify the mutator thread that we have added elements to the free
@@ -145,8 +129,6 @@ class SweeperTask : public ThreadPool::Task {
           MonitorLocker ml(old_space_->tasks_lock());
           ml.Notify();
         }
-        if (page == last_) break;
-        page = next_page;
       }
     }
     // Exit isolate cleanly *before* notifying it, to avoid shutdown race.
@@ -162,19 +144,15 @@ class SweeperTask : public ThreadPool::Task {
  private:
   Isolate* task_isolate_;
   PageSpace* old_space_;
-  HeapPage* first_;
-  HeapPage* last_;
-  FreeList* freelist_;
 };
 
-void GCSweeper::SweepConcurrent(Isolate* isolate,
-                                HeapPage* first,
-                                HeapPage* last,
-                                FreeList* freelist) {
-  SweeperTask* task = new SweeperTask(isolate, isolate->heap()->old_space(),
-                                      first, last, freelist);
+void GCSweeper::SweepConcurrent(Isolate* isolate, intptr_t num_tasks) {
+  ASSERT(num_tasks > 0);
+  PageSpace* old_space = isolate->heap()->old_space();
   ThreadPool* pool = Dart::thread_pool();
-  pool->Run(task);
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    pool->Run(new SweeperTask(isolate, old_space));
+  }
 }
 
 }  // namespace dart
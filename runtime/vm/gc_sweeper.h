@@ -34,11 +34,9 @@ class GCSweeper {
   // last marked object.
   intptr_t SweepLargePage(HeapPage* page);
 
-  // Sweep the regular sized data pages between first and last inclusive.
-  static void SweepConcurrent(Isolate* isolate,
-                              HeapPage* first,
-                              HeapPage* last,
-                              FreeList* freelist);
+  // Sweep the regular sized data pages left by the last mark-sweep on
+  // 'num_tasks' tasks, see PageSpace::SweepNextPage.
+  static void SweepConcurrent(Isolate* isolate, intptr_t num_tasks);
 };
 
 }  // namespace dart
@@ -124,6 +124,17 @@ uword Heap::AllocateOld(intptr_t size, HeapPage::PageType type) {
   return 0;
 }
 
+uword Heap::AllocatePretenured(intptr_t size) {
+  isolate()->AssertCurrentThreadIsMutator();
+  // Bump allocate like the scavenger does for promoted objects, which keeps
+  // objects allocated together close to each other.
+  uword addr = old_space_.TryAllocateDataBump(size, PageSpace::kControlGrowth);
+  if (addr != 0) {
+    return addr;
+  }
+  return AllocateOld(size, HeapPage::kData);
+}
+
 void Heap::AllocateExternal(intptr_t cid, intptr_t size, Space space) {
   ASSERT(Thread::Current()->no_safepoint_scope_depth() == 0);
   if (space == kNew) {
@@ -216,6 +227,10 @@ HeapIterationScope::HeapIterationScope(Thread* thread, bool writable)
 
   isolate()->safepoint_handler()->SafepointThreads(thread);
 
+  // Iteration may use the mark bits, or move or free objects, and the mutator
+  // might create objects the incremental marker does not know about.
+  old_space_->AbortIncrementalMarkingAtSafepoint();
+
   if (writable_) {
     heap_->WriteProtectCode(false);
   }
@@ -360,7 +375,7 @@ void Heap::UpdateClassHeapStatsBeforeGC(Heap::Space space) {
 }
 #endif
 
-void Heap::NotifyIdle(int64_t deadline) {
+bool Heap::NotifyIdle(int64_t deadline) {
   Thread* thread = Thread::Current();
   if (new_space_.ShouldPerformIdleScavenge(deadline)) {
     TIMELINE_FUNCTION_GC_DURATION(thread, "IdleGC");
@@ -369,10 +384,33 @@ void Heap::NotifyIdle(int64_t deadline) {
   // Because we use a deadline instead of a timeout, we automatically take any
   // time used up by a scavenge into account when deciding if we can complete
   // a mark-sweep on time.
-  if (old_space_.ShouldPerformIdleMarkSweep(deadline)) {
+  if (old_space_.IsMarkingIncrementally()) {
+    TIMELINE_FUNCTION_GC_DURATION(thread, "IdleGC");
+    if (MarkOldSpaceIncrementally(thread, deadline) &&
+        (OS::GetCurrentMonotonicMicros() < deadline)) {
+      // Only the final phase is left: rescanning what the mutator wrote since
+      // the last step, and sweeping.
+      CollectOldSpaceGarbage(thread, kIdle);
+    }
+  } else if (old_space_.ShouldPerformIdleMarkSweep(deadline)) {
     TIMELINE_FUNCTION_GC_DURATION(thread, "IdleGC");
     CollectOldSpaceGarbage(thread, kIdle);
+  } else if (old_space_.ShouldStartIncrementalMarking()) {
+    // A mark-sweep does not fit in the idle time, so start marking in steps.
+    TIMELINE_FUNCTION_GC_DURATION(thread, "IdleGC");
+    MarkOldSpaceIncrementally(thread, deadline);
   }
+  return old_space_.IsMarkingIncrementally();
+}
+
+bool Heap::MarkOldSpaceIncrementally(Thread* thread, int64_t deadline) {
+  bool done = false;
+  if (BeginOldSpaceGC(thread)) {
+    VMTagScope tagScope(thread, VMTag::kGCOldSpaceTagId);
+    done = old_space_.MarkIncrementally(deadline);
+    EndOldSpaceGC();
+  }
+  return done;
 }
 
 void Heap::EvacuateNewSpace(Thread* thread, GCReason reason) {
@@ -417,11 +455,21 @@ void Heap::CollectOldSpaceGarbage(Thread* thread,
                                   GCReason reason) {
   ASSERT((reason != kNewSpace));
   if (BeginOldSpaceGC(thread)) {
+    if (reason == kFull) {
+      // Collect the objects incremental marking would keep alive as well.
+      old_space_.AbortIncrementalMarking();
+    }
     RecordBeforeGC(kOld, reason);
     VMTagScope tagScope(thread, VMTag::kGCOldSpaceTagId);
     TIMELINE_FUNCTION_GC_DURATION_BASIC(thread, "CollectOldGeneration");
-    NOT_IN_PRODUCT(UpdateClassHeapStatsBeforeGC(kOld));
+#ifndef PRODUCT
+    // Incremental marking reset the stats when it started.
+    if (!old_space_.IsMarkingIncrementally()) {
+      UpdateClassHeapStatsBeforeGC(kOld);
+    }
+#endif  // !PRODUCT
     old_space_.MarkSweep();
+    NOT_IN_PRODUCT(isolate()->class_table()->UpdatePretenuring());
     RecordAfterGC(kOld);
     PrintStats();
     NOT_IN_PRODUCT(PrintStatsToTimeline(&tds));
@@ -79,6 +79,10 @@ class Heap {
     return 0;
   }
 
+  // Allocates an object of a class that is pretenured, see
+  // ClassHeapStats::pretenure.
+  uword AllocatePretenured(intptr_t size);
+
   // Track external data.
   void AllocateExternal(intptr_t cid, intptr_t size, Space space);
   void FreeExternal(intptr_t size, Space space);
@@ -105,7 +109,9 @@ class Heap {
   RawObject* FindNewObject(FindObjectVisitor* visitor) const;
   RawObject* FindObject(FindObjectVisitor* visitor) const;
 
-  void NotifyIdle(int64_t deadline);
+  // Uses the time until 'deadline' for garbage collection. Returns true if
+  // incremental marking is in progress and more idle time would be useful.
+  bool NotifyIdle(int64_t deadline);
 
   void CollectGarbage(Space space);
   void CollectGarbage(Space space, GCReason reason);
@@ -319,6 +325,8 @@ class Heap {
   void RecordAfterGC(Space space);
   void PrintStats();
   void UpdateClassHeapStatsBeforeGC(Heap::Space space);
+  // Returns true if only the final phase of marking is left.
+  bool MarkOldSpaceIncrementally(Thread* thread, int64_t deadline);
   void PrintStatsToTimeline(TimelineEventScope* event);
 
   // Updates gc in progress flags.
@@ -9,10 +9,17 @@
 #include "vm/dart_api_impl.h"
 #include "vm/globals.h"
 #include "vm/heap.h"
+#include "vm/safepoint.h"
 #include "vm/unit_test.h"
+#include "vm/virtual_memory.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, incremental_marking);
+DECLARE_FLAG(bool, pretenuring);
+DECLARE_FLAG(int, new_gen_growth_factor);
+DECLARE_FLAG(int, new_gen_pause_target_micros);
+
 TEST_CASE(OldGC) {
   const char* kScriptChars =
       "main() {\n"
@@ -551,4 +558,419 @@ ISOLATE_UNIT_TEST_CASE(CollectAllGarbage_LiveOldToNewChain) {
   EXPECT(size_before < size_after);
 }
 
+ISOLATE_UNIT_TEST_CASE(Scavenge_AgeAndPromote) {
+  Heap* heap = Isolate::Current()->heap();
+
+  Array& neu = Array::Handle(Array::New(1, Heap::kNew));
+  EXPECT_EQ(0, neu.raw()->Age());
+  intptr_t age = 0;
+  while (neu.raw()->IsNewObject()) {
+    const intptr_t tenuring_age = heap->new_space()->tenuring_age();
+    EXPECT(tenuring_age <= RawObject::kMaxAge);
+    heap->CollectGarbage(Heap::kNew);
+    if (age < tenuring_age) {
+      age++;
+      EXPECT_EQ(age, neu.raw()->Age());
+    }
+  }
+  // Promoted objects carry no age.
+  EXPECT_EQ(0, neu.raw()->Age());
+}
+
+ISOLATE_UNIT_TEST_CASE(Scavenge_PauseTarget) {
+  Heap* heap = Isolate::Current()->heap();
+  const intptr_t saved_pause_target = FLAG_new_gen_pause_target_micros;
+  FLAG_new_gen_pause_target_micros = 1000;
+
+  const intptr_t max_capacity = FLAG_new_gen_semi_max_size * MBInWords;
+  Array& survivor = Array::Handle();
+  for (intptr_t i = 0; i < 10; i++) {
+    // Mostly short-lived objects.
+    for (intptr_t j = 0; j < 1000; j++) {
+      survivor = Array::New(16, Heap::kNew);
+    }
+    heap->CollectGarbage(Heap::kNew);
+    EXPECT(heap->new_space()->tenuring_age() >= 1);
+    EXPECT(heap->new_space()->tenuring_age() <= RawObject::kMaxAge);
+    EXPECT(heap->new_space()->CapacityInWords() <= max_capacity);
+  }
+
+  FLAG_new_gen_pause_target_micros = saved_pause_target;
+}
+
+// Drop the pause target while new space holds more survivors than the
+// smallest new gen, so that a smaller to space would overflow.
+ISOLATE_UNIT_TEST_CASE(Scavenge_PauseTargetShrinkWithSurvivors) {
+  Heap* heap = Isolate::Current()->heap();
+  const intptr_t saved_pause_target = FLAG_new_gen_pause_target_micros;
+  const intptr_t min_capacity =
+      FLAG_new_gen_semi_max_size * MBInWords /
+      (FLAG_new_gen_growth_factor * FLAG_new_gen_growth_factor);
+
+  // Grow new gen to at least four times its smallest size.
+  FLAG_new_gen_pause_target_micros = 1000000000;
+  for (intptr_t i = 0; i < 3; i++) {
+    heap->CollectGarbage(Heap::kNew);
+  }
+  EXPECT(heap->new_space()->CapacityInWords() >= 4 * min_capacity);
+
+  // Each batch holds one and a half times the smallest new gen.
+  const intptr_t kLength = 1024;
+  const intptr_t kNumArrays = (3 * min_capacity / 2) / kLength;
+  const Array& first = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  const Array& second = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  Array& element = Array::Handle();
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    element = Array::New(kLength, Heap::kNew);
+    element.SetAt(kLength - 1, Smi::Handle(Smi::New(i)));
+    first.SetAt(i, element);
+  }
+
+  // A tiny pause target asks for the smallest new gen, which the survivors
+  // of this scavenge do not fit.
+  FLAG_new_gen_pause_target_micros = 1;
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(heap->new_space()->CapacityInWords() >= 3 * min_capacity / 2);
+
+  // The second batch is young and copied by the next scavenge.
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    element = Array::New(kLength, Heap::kNew);
+    element.SetAt(kLength - 1, Smi::Handle(Smi::New(-i)));
+    second.SetAt(i, element);
+  }
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(heap->new_space()->UsedInWords() <=
+         heap->new_space()->CapacityInWords());
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    element ^= first.At(i);
+    EXPECT_EQ(i, Smi::Value(Smi::RawCast(element.At(kLength - 1))));
+    element ^= second.At(i);
+    EXPECT_EQ(-i, Smi::Value(Smi::RawCast(element.At(kLength - 1))));
+  }
+
+  FLAG_new_gen_pause_target_micros = saved_pause_target;
+}
+
+ISOLATE_UNIT_TEST_CASE(ConcurrentSweep_AllocateWhileSweeping) {
+  if (!FLAG_concurrent_sweep) {
+    return;
+  }
+  Heap* heap = thread->isolate()->heap();
+  PageSpace* old_space = heap->old_space();
+
+  // Fill several pages with garbage.
+  const intptr_t kGarbageArrays = 10000;
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < kGarbageArrays; i++) {
+    array = Array::New(32, Heap::kOld);
+  }
+  array = Array::null();
+  heap->WaitForSweeperTasks(thread);
+  const intptr_t lazily_before = old_space->pages_swept_lazily();
+  const intptr_t concurrently_before = old_space->pages_swept_concurrently();
+
+  intptr_t pages_to_sweep = 0;
+  {
+    // The sweeper tasks cannot enter the isolate during a safepoint
+    // operation, so the allocator has to sweep pages itself.
+    SafepointOperationScope safepoint(thread);
+    heap->CollectGarbage(Heap::kOld);
+    pages_to_sweep = old_space->pages_pending_sweep();
+    EXPECT(pages_to_sweep > 0);
+    // Allocate less than the garbage, which does not need another GC.
+    for (intptr_t i = 0; i < kGarbageArrays / 2; i++) {
+      array = Array::New(32, Heap::kOld);
+      EXPECT_EQ(32, array.Length());
+    }
+    EXPECT(old_space->pages_swept_lazily() > lazily_before);
+  }
+  heap->WaitForSweeperTasks(thread);
+
+  // Every page was swept exactly once, by the allocator or a sweeper task.
+  EXPECT_EQ(0, old_space->pages_pending_sweep());
+  EXPECT_EQ(pages_to_sweep,
+            (old_space->pages_swept_lazily() - lazily_before) +
+                (old_space->pages_swept_concurrently() - concurrently_before));
+}
+
+// Stores new-space elements at the start, middle and end of |large| and
+// checks that they are found through its cards until they are promoted.
+static void CheckCardMarking(Heap* heap, const Array& large) {
+  EXPECT(large.raw()->IsOldObject());
+  EXPECT(large.raw()->IsCardRemembered());
+  const intptr_t length = large.Length();
+  const intptr_t kNumIndices = 3;
+  const intptr_t indices[kNumIndices] = {0, length / 2, length - 1};
+  Array& element = Array::Handle();
+  for (intptr_t i = 0; i < kNumIndices; i++) {
+    element = Array::New(1, Heap::kNew);
+    element.SetAt(0, Smi::Handle(Smi::New(indices[i])));
+    large.SetAt(indices[i], element);
+  }
+  // The stores marked cards instead of remembering the whole array.
+  EXPECT(!large.raw()->IsRemembered());
+
+  for (intptr_t j = 0; j <= RawObject::kMaxAge + 1; j++) {
+    heap->CollectGarbage(Heap::kNew);
+    EXPECT(!large.raw()->IsRemembered());
+    for (intptr_t i = 0; i < kNumIndices; i++) {
+      element ^= large.At(indices[i]);
+      EXPECT_EQ(1, element.Length());
+      EXPECT_EQ(indices[i], Smi::Value(Smi::RawCast(element.At(0))));
+    }
+  }
+  for (intptr_t i = 0; i < kNumIndices; i++) {
+    element ^= large.At(indices[i]);
+    EXPECT(element.raw()->IsOldObject());
+  }
+}
+
+// The smallest array that is card remembered in old space.
+static const intptr_t kCardMarkedLength =
+    PageSpace::kAllocatablePageSize / kWordSize;
+
+ISOLATE_UNIT_TEST_CASE(Scavenge_CardMarking) {
+  Heap* heap = thread->isolate()->heap();
+
+  // Only arrays on a large page are card remembered.
+  const Array& large = Array::Handle(Array::New(64 * KB, Heap::kOld));
+  const Array& small = Array::Handle(Array::New(1, Heap::kOld));
+  EXPECT(!small.raw()->IsCardRemembered());
+  CheckCardMarking(heap, large);
+}
+
+ISOLATE_UNIT_TEST_CASE(Scavenge_CardMarkingPromoted) {
+  Heap* heap = thread->isolate()->heap();
+
+  // Arrays in new space are card remembered once promoted to a large page.
+  const Array& large =
+      Array::Handle(Array::New(kCardMarkedLength, Heap::kNew));
+  EXPECT(large.raw()->IsNewObject());
+  EXPECT(!large.raw()->IsCardRemembered());
+  const Array& small = Array::Handle(Array::New(1, Heap::kNew));
+  while (large.raw()->IsNewObject() || small.raw()->IsNewObject()) {
+    heap->CollectGarbage(Heap::kNew);
+  }
+  EXPECT(!small.raw()->IsCardRemembered());
+  CheckCardMarking(heap, large);
+}
+
+#ifndef PRODUCT
+ISOLATE_UNIT_TEST_CASE(Scavenge_CardMarkingPretenured) {
+  Heap* heap = thread->isolate()->heap();
+  ClassHeapStats* stats = ClassHeapStatsTestHelper::GetHeapStatsForCid(
+      thread->isolate()->class_table(), kArrayCid);
+  const bool saved_pretenure = stats->pretenure();
+  stats->set_pretenure(true);
+
+  // Pretenured arrays are bump allocated, but large ones still get their own
+  // page, even when the bump block has room for them.
+  const Array& small = Array::Handle(Array::New(1, Heap::kNew));
+  EXPECT(small.raw()->IsOldObject());
+  EXPECT(!small.raw()->IsCardRemembered());
+  const Array& large =
+      Array::Handle(Array::New(kCardMarkedLength, Heap::kNew));
+  stats->set_pretenure(saved_pretenure);
+  CheckCardMarking(heap, large);
+}
+#endif  // !PRODUCT
+
+// Stores into card remembered arrays from Dart go through the
+// ArrayWriteBarrier stub, from the intrinsic of List.[]= and from optimized
+// code.
+static void CheckCardMarkingFromDart(Thread* thread, bool pretenure) {
+  const char* kScriptChars =
+      "List list;\n"
+      "void allocate(int length) {\n"
+      "  list = new List(length);\n"
+      "}\n"
+      "void store(int index, int count) {\n"
+      "  for (int i = 0; i < count; i++) {\n"
+      "    list[index] = [i];\n"
+      "  }\n"
+      "}\n"
+      "bool check(int index, int value) => list[index][0] == value;\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(lib);
+  Heap* heap = thread->isolate()->heap();
+
+  Dart_Handle args[2];
+  args[0] = Dart_NewInteger(kCardMarkedLength);
+#ifndef PRODUCT
+  ClassHeapStats* stats = ClassHeapStatsTestHelper::GetHeapStatsForCid(
+      thread->isolate()->class_table(), kArrayCid);
+  const bool saved_pretenure = stats->pretenure();
+  stats->set_pretenure(pretenure);
+#else
+  ASSERT(!pretenure);
+#endif  // !PRODUCT
+  EXPECT_VALID(Dart_Invoke(lib, NewString("allocate"), 1, args));
+  NOT_IN_PRODUCT(stats->set_pretenure(saved_pretenure));
+  Dart_Handle list = Dart_GetField(lib, NewString("list"));
+  EXPECT_VALID(list);
+  {
+    TransitionNativeToVM transition(thread);
+    const Array& large = Array::CheckedHandle(Api::UnwrapHandle(list));
+    EXPECT_EQ(pretenure, large.raw()->IsOldObject());
+    while (large.raw()->IsNewObject()) {
+      heap->CollectGarbage(Heap::kNew);
+    }
+    EXPECT(large.raw()->IsCardRemembered());
+  }
+
+  // The loop at the middle index runs long enough to be optimized.
+  const intptr_t kNumIndices = 3;
+  const intptr_t indices[kNumIndices] = {0, kCardMarkedLength / 2,
+                                         kCardMarkedLength - 1};
+  const intptr_t counts[kNumIndices] = {1, 100000, 1};
+  for (intptr_t i = 0; i < kNumIndices; i++) {
+    args[0] = Dart_NewInteger(indices[i]);
+    args[1] = Dart_NewInteger(counts[i]);
+    EXPECT_VALID(Dart_Invoke(lib, NewString("store"), 2, args));
+  }
+  {
+    TransitionNativeToVM transition(thread);
+    const Array& large = Array::CheckedHandle(Api::UnwrapHandle(list));
+    EXPECT(!large.raw()->IsRemembered());
+  }
+
+  for (intptr_t j = 0; j <= RawObject::kMaxAge + 1; j++) {
+    {
+      TransitionNativeToVM transition(thread);
+      heap->CollectGarbage(Heap::kNew);
+      const Array& large = Array::CheckedHandle(Api::UnwrapHandle(list));
+      EXPECT(!large.raw()->IsRemembered());
+    }
+    for (intptr_t i = 0; i < kNumIndices; i++) {
+      args[0] = Dart_NewInteger(indices[i]);
+      args[1] = Dart_NewInteger(counts[i] - 1);
+      Dart_Handle result = Dart_Invoke(lib, NewString("check"), 2, args);
+      EXPECT_VALID(result);
+      bool value = false;
+      EXPECT_VALID(Dart_BooleanValue(result, &value));
+      EXPECT(value);
+    }
+  }
+}
+
+TEST_CASE(Scavenge_CardMarkingFromDart) {
+  CheckCardMarkingFromDart(thread, false);
+}
+
+#ifndef PRODUCT
+TEST_CASE(Scavenge_CardMarkingFromDartPretenured) {
+  CheckCardMarkingFromDart(thread, true);
+}
+#endif  // !PRODUCT
+
+#ifndef PRODUCT
+ISOLATE_UNIT_TEST_CASE(Pretenuring) {
+  const bool saved_pretenuring = FLAG_pretenuring;
+  FLAG_pretenuring = true;
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  ClassTable* class_table = isolate->class_table();
+  EXPECT(!class_table->PretenureFor(kMintCid));
+
+  // Mints that all survive their first scavenge get pretenured.
+  const intptr_t kLength = 4096;
+  const Array& survivors = Array::Handle(Array::New(kLength, Heap::kOld));
+  Integer& mint = Integer::Handle();
+  for (intptr_t i = 0; i < kLength; i++) {
+    mint = Integer::New(kMaxInt64 - i);
+    EXPECT(mint.IsNew());
+    survivors.SetAt(i, mint);
+  }
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(class_table->PretenureFor(kMintCid));
+
+  // Pretenured mints that die stop the pretenuring at the next old GC.
+  for (intptr_t i = 0; i < kLength; i++) {
+    mint = Integer::New(kMaxInt64 - i);
+    EXPECT(mint.IsOld());
+  }
+  mint = Integer::null();
+  heap->CollectAllGarbage();
+  EXPECT(!class_table->PretenureFor(kMintCid));
+  mint = Integer::New(kMaxInt64);
+  EXPECT(mint.IsNew());
+
+  FLAG_pretenuring = saved_pretenuring;
+}
+#endif  // !PRODUCT
+
+ISOLATE_UNIT_TEST_CASE(IncrementalMarking_MutationBetweenSteps) {
+  const bool saved_incremental_marking = FLAG_incremental_marking;
+  FLAG_incremental_marking = true;
+  if (!VirtualMemory::SupportsDirtyPageTracking()) {
+    FLAG_incremental_marking = saved_incremental_marking;
+    return;
+  }
+  Heap* heap = Isolate::Current()->heap();
+  PageSpace* old_space = heap->old_space();
+  heap->CollectAllGarbage();
+
+  // A list too long to be marked in one step.
+  const intptr_t kLength = 100000;
+  Array& list = Array::Handle();
+  Array& element = Array::Handle();
+  for (intptr_t i = 0; i < kLength; i++) {
+    element = Array::New(2, Heap::kOld);
+    element.SetAt(0, list);
+    element.SetAt(1, Smi::Handle(Smi::New(i)));
+    list = element.raw();
+  }
+
+  // Mark a little, then move the end of the list, which is not marked yet, to
+  // an object allocated while marking.
+  old_space->MarkIncrementally(0);
+  EXPECT(old_space->IsMarkingIncrementally());
+  const Array& holder = Array::Handle(Array::New(1, Heap::kOld));
+  EXPECT(holder.raw()->IsMarked());
+  element = list.raw();
+  while (Smi::Value(Smi::RawCast(element.At(1))) != 2) {
+    element ^= element.At(0);
+  }
+  Object& tail = Object::Handle(element.At(0));
+  holder.SetAt(0, tail);
+  element.SetAt(0, Object::null_object());
+  // Only the holder keeps the end of the list alive.
+  tail = Object::null();
+  element = Array::null();
+
+  while (!old_space->MarkIncrementally(0)) {
+  }
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(!old_space->IsMarkingIncrementally());
+  EXPECT(heap->Verify());
+
+  element ^= holder.At(0);
+  EXPECT_EQ(1, Smi::Value(Smi::RawCast(element.At(1))));
+  element ^= element.At(0);
+  EXPECT_EQ(0, Smi::Value(Smi::RawCast(element.At(1))));
+
+  FLAG_incremental_marking = saved_incremental_marking;
+}
+
+ISOLATE_UNIT_TEST_CASE(IncrementalMarking_Abort) {
+  const bool saved_incremental_marking = FLAG_incremental_marking;
+  FLAG_incremental_marking = true;
+  if (!VirtualMemory::SupportsDirtyPageTracking()) {
+    FLAG_incremental_marking = saved_incremental_marking;
+    return;
+  }
+  Heap* heap = Isolate::Current()->heap();
+  PageSpace* old_space = heap->old_space();
+  const Array& live = Array::Handle(Array::New(1, Heap::kOld));
+  old_space->MarkIncrementally(0);
+  EXPECT(old_space->IsMarkingIncrementally());
+  // A full collection does not finish incremental marking.
+  heap->CollectAllGarbage();
+  EXPECT(!old_space->IsMarkingIncrementally());
+  EXPECT(!live.raw()->IsMarked());
+  EXPECT(heap->Verify());
+
+  FLAG_incremental_marking = saved_incremental_marking;
+}
+
 }  // namespace dart
@@ -42,6 +42,7 @@
 #include "vm/symbols.h"
 #include "vm/tags.h"
 #include "vm/thread_interrupter.h"
+#include "vm/thread_pool.h"
 #include "vm/thread_registry.h"
 #include "vm/timeline.h"
 #include "vm/timeline_analysis.h"
@@ -2389,6 +2390,7 @@ void Isolate::PauseEventHandler() {
   if (pause_loop_monitor_ == NULL) {
     pause_loop_monitor_ = new Monitor();
   }
+  ThreadPool::BlockingScope blocking_scope;
   Dart_EnterScope();
   MonitorLocker ml(pause_loop_monitor_);
 
@@ -2699,6 +2701,10 @@ void Isolate::UnscheduleThread(Thread* thread,
   OSThread* os_thread = thread->os_thread();
   ASSERT(os_thread != NULL);
   os_thread->DisableThreadInterrupts();
+#if !defined(PRODUCT)
+  // The thread structure may be reused by another thread.
+  Profiler::ReleaseSampleBlock(thread);
+#endif  // !defined(PRODUCT)
   os_thread->set_thread(NULL);
   OSThread::SetCurrent(os_thread);
   if (is_mutator) {
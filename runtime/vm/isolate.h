@@ -923,7 +923,7 @@ class Isolate : public BaseIsolate {
   Random random_;
   Simulator* simulator_;
   Mutex* mutex_;          // Protects compiler stats.
-  Mutex* symbols_mutex_;  // Protects concurrent access to the symbol table.
+  Mutex* symbols_mutex_;  // Serializes insertions into the symbol table.
   Mutex* type_canonicalization_mutex_;      // Protects type canonicalization.
   Mutex* constant_canonicalization_mutex_;  // Protects const canonicalization.
   Mutex* megamorphic_lookup_mutex_;  // Protects megamorphic table lookup.
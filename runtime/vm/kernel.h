@@ -67,6 +67,12 @@ class Program {
   const uint8_t* kernel_data() { return kernel_data_; }
   intptr_t kernel_data_size() { return kernel_data_size_; }
   intptr_t library_count() { return library_count_; }
+
+  // The number of entries in the source table, and the URI of an entry as
+  // |length| bytes of UTF-8 in the binary (not NUL terminated).
+  intptr_t source_count();
+  const uint8_t* SourceUriAt(intptr_t index, intptr_t* length);
+
   void set_release_buffer_callback(Dart_ReleaseBufferCallback callback) {
     release_callback = callback;
   }
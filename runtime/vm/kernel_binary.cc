@@ -36,6 +36,23 @@ Program* Program::ReadFrom(Reader* reader) {
   return program;
 }
 
+intptr_t Program::source_count() {
+  Reader reader(kernel_data_, kernel_data_size_);
+  reader.set_offset(source_table_offset_);
+  return reader.ReadUInt32();  // read source table size.
+}
+
+const uint8_t* Program::SourceUriAt(intptr_t index, intptr_t* length) {
+  Reader reader(kernel_data_, kernel_data_size_);
+  reader.set_offset(source_table_offset_);
+  intptr_t size = reader.ReadUInt32();  // read source table size.
+  ASSERT((index >= 0) && (index < size));
+  reader.set_offset(
+      reader.ReadFromIndexNoReset(name_table_offset_, 0, size, index));
+  *length = reader.ReadUInt();  // read uri List<byte> size.
+  return kernel_data_ + reader.offset();
+}
+
 }  // namespace kernel
 
 kernel::Program* ReadPrecompiledKernelFromBuffer(const uint8_t* buffer,
@@ -241,6 +241,7 @@ void KernelIsolate::FinishedInitializing() {
 }
 
 Dart_Port KernelIsolate::WaitForKernelPort() {
+  ThreadPool::BlockingScope blocking_scope;
   MonitorLocker ml(monitor_);
   while (initializing_ && (kernel_port_ == ILLEGAL_PORT)) {
     ml.Wait();
@@ -361,7 +362,9 @@ class KernelCompilationRequest : public ValueObject {
     // Send the message.
     Dart_PostCObject(kernel_port, &message);
 
-    // Wait for reply to arrive.
+    // Wait for reply to arrive. The kernel isolate may need a worker of the
+    // pool to produce it.
+    ThreadPool::BlockingScope blocking_scope;
     MonitorLocker ml(monitor_);
     while (result_.status == Dart_KernelCompilationStatus_Unknown) {
       ml.Wait();
@@ -8,17 +8,37 @@
 
 #include "vm/compiler/frontend/kernel_binary_flowgraph.h"
 #include "vm/compiler/frontend/kernel_to_il.h"
+#include "vm/atomic.h"
 #include "vm/dart_api_impl.h"
+#include "vm/flags.h"
 #include "vm/kernel_binary.h"
 #include "vm/longjump.h"
 #include "vm/object_store.h"
+#include "vm/os.h"
 #include "vm/parser.h"
 #include "vm/symbols.h"
 
 #if !defined(DART_PRECOMPILED_RUNTIME)
 namespace dart {
+
+DEFINE_FLAG(bool,
+            lazy_kernel_loading,
+            false,
+            "Read the members of classes loaded from Kernel binaries on first "
+            "use.");
+DEFINE_FLAG(bool,
+            trace_lazy_kernel_loading,
+            false,
+            "Trace the classes whose members are read on first use.");
+
 namespace kernel {
 
+// Totals of the classes loaded by KernelLoader::FinishLoading, reported by
+// --trace_lazy_kernel_loading.
+static intptr_t lazy_classes_loaded = 0;
+static intptr_t lazy_functions_loaded = 0;
+static intptr_t lazy_load_micros = 0;
+
 #define Z (zone_)
 #define I (isolate_)
 #define T (builder_.type_translator_)
@@ -129,6 +149,7 @@ KernelLoader::KernelLoader(Program* program)
       isolate_(thread_->isolate()),
       scripts_(Array::ZoneHandle(zone_)),
       patch_classes_(Array::ZoneHandle(zone_)),
+      program_info_(Array::ZoneHandle(zone_)),
       translation_helper_(this, thread_),
       builder_(&translation_helper_,
                zone_,
@@ -173,13 +194,60 @@ KernelLoader::KernelLoader(Program* program)
   H.SetCanonicalNames(names);
 }
 
+KernelLoader::KernelLoader(const Array& program_info)
+    : program_(NULL),
+      thread_(Thread::Current()),
+      zone_(thread_->zone()),
+      isolate_(thread_->isolate()),
+      scripts_(Array::ZoneHandle(
+          zone_,
+          Array::RawCast(program_info.At(kProgramScripts)))),
+      patch_classes_(Array::ZoneHandle(zone_)),
+      program_info_(Array::ZoneHandle(zone_, program_info.raw())),
+      translation_helper_(this, thread_),
+      builder_(&translation_helper_,
+               zone_,
+               0,
+               TypedData::ZoneHandle(
+                   zone_,
+                   TypedData::RawCast(program_info.At(kProgramData)))) {
+  T.active_class_ = &active_class_;
+  T.finalize_ = false;
+
+  patch_classes_ = Array::New(scripts_.Length(), Heap::kOld);
+
+  H.SetStringOffsets(TypedData::Handle(
+      Z, TypedData::RawCast(program_info.At(kProgramStringOffsets))));
+  H.SetStringData(TypedData::Handle(
+      Z, TypedData::RawCast(program_info.At(kProgramStringData))));
+  H.SetCanonicalNames(TypedData::Handle(
+      Z, TypedData::RawCast(program_info.At(kProgramCanonicalNames))));
+}
+
 Object& KernelLoader::LoadProgram() {
   LongJumpScope jump;
   if (setjmp(*jump.Set()) == 0) {
+    const int64_t start = OS::GetCurrentMonotonicMicros();
     intptr_t length = program_->library_count();
     for (intptr_t i = 0; i < length; i++) {
       LoadLibrary(i);
     }
+    if (FLAG_trace_lazy_kernel_loading) {
+      intptr_t lazy_class_count = 0;
+      if (!program_info_.IsNull()) {
+        const Array& lazy_classes =
+            Array::Handle(Z, I->object_store()->lazy_kernel_classes());
+        for (intptr_t i = 0; i < lazy_classes.Length(); i++) {
+          if (lazy_classes.At(i) != Object::null()) {
+            lazy_class_count++;
+          }
+        }
+      }
+      THR_Print("Loaded %" Pd " libraries in %" Pd64
+                " us, %" Pd " classes have pending members\n",
+                length, OS::GetCurrentMonotonicMicros() - start,
+                lazy_class_count);
+    }
 
     for (intptr_t i = 0; i < length; i++) {
       Library& library = LookupLibrary(library_canonical_name(i));
@@ -494,10 +562,6 @@ Class& KernelLoader::LoadClass(const Library& library,
                                intptr_t class_end) {
   intptr_t class_offset = builder_.ReaderOffset();
 
-  // Read part of class index.
-  intptr_t procedure_count =
-      builder_.reader_->ReadFromIndex(class_end, 0, 1, 0);
-
   ClassHelper class_helper(&builder_);
   class_helper.ReadUntilIncluding(ClassHelper::kCanonicalName);
   Class& klass = LookupClass(class_helper.canonical_name_);
@@ -531,6 +595,32 @@ Class& KernelLoader::LoadClass(const Library& library,
     class_helper.SetJustRead(ClassHelper::kTypeParameters);
   }
 
+  if (ShouldLoadLazily(library)) {
+    AddLazyClass(klass, class_offset, class_end);
+  } else {
+    LoadClassMembers(library, klass, &class_helper, class_end);
+  }
+
+  if (FLAG_enable_mirrors && class_helper.annotation_count_ > 0) {
+    TypedData& header_data = builder_.reader_->CopyDataToVMHeap(
+        Z, class_offset, class_offset_after_annotations);
+    library.AddClassMetadata(klass, toplevel_class, TokenPosition::kNoSource,
+                             class_offset, &header_data);
+  }
+
+  builder_.SetOffset(class_end);
+
+  return klass;
+}
+
+void KernelLoader::LoadClassMembers(const Library& library,
+                                    const Class& klass,
+                                    ClassHelper* class_helper,
+                                    intptr_t class_end) {
+  // Read part of class index.
+  intptr_t procedure_count =
+      builder_.reader_->ReadFromIndex(class_end, 0, 1, 0);
+
   fields_.Clear();
   functions_.Clear();
 
@@ -541,7 +631,7 @@ Class& KernelLoader::LoadClass(const Library& library,
     // fields.
     klass.InjectCIDFields();
   } else {
-    class_helper.ReadUntilExcluding(ClassHelper::kFields);
+    class_helper->ReadUntilExcluding(ClassHelper::kFields);
     int field_count = builder_.ReadListLength();  // read list length.
     for (intptr_t i = 0; i < field_count; ++i) {
       intptr_t field_offset = builder_.ReaderOffset();
@@ -589,10 +679,10 @@ Class& KernelLoader::LoadClass(const Library& library,
       fields_.Add(&field);
     }
     klass.AddFields(fields_);
-    class_helper.SetJustRead(ClassHelper::kFields);
+    class_helper->SetJustRead(ClassHelper::kFields);
   }
 
-  class_helper.ReadUntilExcluding(ClassHelper::kConstructors);
+  class_helper->ReadUntilExcluding(ClassHelper::kConstructors);
   int constructor_count = builder_.ReadListLength();  // read list length.
   for (intptr_t i = 0; i < constructor_count; ++i) {
     intptr_t constructor_offset = builder_.ReaderOffset();
@@ -652,17 +742,112 @@ Class& KernelLoader::LoadClass(const Library& library,
   if (!klass.is_marked_for_parsing()) {
     klass.set_is_marked_for_parsing();
   }
+}
 
-  if (FLAG_enable_mirrors && class_helper.annotation_count_ > 0) {
-    TypedData& header_data = builder_.reader_->CopyDataToVMHeap(
-        Z, class_offset, class_offset_after_annotations);
-    library.AddClassMetadata(klass, toplevel_class, TokenPosition::kNoSource,
-                             class_offset, &header_data);
+bool KernelLoader::ShouldLoadLazily(const Library& library) {
+  if (!FLAG_lazy_kernel_loading || (program_ == NULL)) {
+    return false;
   }
+#if !defined(PRODUCT)
+  // A reload compares the members of the new classes with the old ones.
+  if (I->IsReloading()) {
+    return false;
+  }
+#endif  // !defined(PRODUCT)
+  // The VM accesses the members of the core libraries directly.
+  return !library.is_dart_scheme();
+}
 
-  builder_.SetOffset(class_end);
+RawArray* KernelLoader::ProgramInfo() {
+  if (program_info_.IsNull()) {
+    program_info_ = Array::New(kProgramInfoSize, Heap::kOld);
+    program_info_.SetAt(kProgramData,
+                        builder_.reader_->CopyDataToVMHeap(
+                            Z, 0, program_->kernel_data_size()));
+    program_info_.SetAt(kProgramScripts, scripts_);
+    program_info_.SetAt(kProgramStringOffsets, H.string_offsets());
+    program_info_.SetAt(kProgramStringData, H.string_data());
+    program_info_.SetAt(kProgramCanonicalNames, H.canonical_names());
+  }
+  return program_info_.raw();
+}
 
-  return klass;
+void KernelLoader::AddLazyClass(const Class& klass,
+                                intptr_t class_offset,
+                                intptr_t class_end) {
+  ObjectStore* object_store = I->object_store();
+  Array& lazy_classes = Array::Handle(Z, object_store->lazy_kernel_classes());
+  if (lazy_classes.IsNull() || (klass.id() >= lazy_classes.Length())) {
+    const intptr_t length =
+        Utils::Maximum(I->class_table()->NumCids(),
+                       lazy_classes.IsNull() ? 0 : 2 * lazy_classes.Length());
+    ASSERT(klass.id() < length);
+    if (lazy_classes.IsNull()) {
+      lazy_classes = Array::New(length, Heap::kOld);
+    } else {
+      lazy_classes = Array::Grow(lazy_classes, length, Heap::kOld);
+    }
+    object_store->set_lazy_kernel_classes(lazy_classes);
+  }
+  const Array& class_info =
+      Array::Handle(Z, Array::New(kClassInfoSize, Heap::kOld));
+  class_info.SetAt(kClassProgramInfo, Array::Handle(Z, ProgramInfo()));
+  class_info.SetAt(kClassOffset, Smi::Handle(Z, Smi::New(class_offset)));
+  class_info.SetAt(kClassEnd, Smi::Handle(Z, Smi::New(class_end)));
+  lazy_classes.SetAt(klass.id(), class_info);
+  klass.set_has_pending_kernel_members(true);
+}
+
+void KernelLoader::FinishLoading(const Class& klass) {
+  Thread* thread = Thread::Current();
+  Zone* zone = thread->zone();
+  ASSERT(thread->IsMutatorThread());
+  ASSERT(klass.has_pending_kernel_members());
+  const int64_t start = OS::GetCurrentMonotonicMicros();
+
+  const Array& lazy_classes = Array::Handle(
+      zone, thread->isolate()->object_store()->lazy_kernel_classes());
+  const Array& class_info =
+      Array::Handle(zone, Array::RawCast(lazy_classes.At(klass.id())));
+  ASSERT(!class_info.IsNull());
+  lazy_classes.SetAt(klass.id(), Object::null_object());
+  klass.set_has_pending_kernel_members(false);
+
+  KernelLoader loader(
+      Array::Handle(zone, Array::RawCast(class_info.At(kClassProgramInfo))));
+  const intptr_t class_offset =
+      Smi::Value(Smi::RawCast(class_info.At(kClassOffset)));
+  const intptr_t class_end =
+      Smi::Value(Smi::RawCast(class_info.At(kClassEnd)));
+
+  // Skip the header read by LoadClass.
+  loader.builder_.SetOffset(class_offset);
+  ClassHelper class_helper(&loader.builder_);
+  class_helper.ReadUntilExcluding(ClassHelper::kTypeParameters);
+  intptr_t type_parameter_count = loader.builder_.ReadListLength();
+  for (intptr_t i = 0; i < type_parameter_count; ++i) {
+    loader.builder_.SkipStringReference();  // read ith name index.
+    loader.builder_.SkipDartType();         // read ith bound.
+  }
+  class_helper.SetJustRead(ClassHelper::kTypeParameters);
+
+  ActiveClassScope active_class_scope(&loader.active_class_, &klass);
+  loader.LoadClassMembers(Library::Handle(zone, klass.library()), klass,
+                          &class_helper, class_end);
+
+  if (FLAG_trace_lazy_kernel_loading) {
+    const intptr_t function_count =
+        Array::Handle(zone, klass.functions()).Length();
+    const intptr_t micros =
+        static_cast<intptr_t>(OS::GetCurrentMonotonicMicros() - start);
+    AtomicOperations::IncrementBy(&lazy_classes_loaded, 1);
+    AtomicOperations::IncrementBy(&lazy_functions_loaded, function_count);
+    AtomicOperations::IncrementBy(&lazy_load_micros, micros);
+    THR_Print("Loaded %" Pd " functions of %s in %" Pd
+              " us (total: %" Pd " classes, %" Pd " functions, %" Pd " us)\n",
+              function_count, klass.ToCString(), micros, lazy_classes_loaded,
+              lazy_functions_loaded, lazy_load_micros);
+  }
 }
 
 void KernelLoader::LoadProcedure(const Library& library,
@@ -98,15 +98,54 @@ class KernelLoader {
 
   uint8_t CharacterAt(StringIndex string_index, intptr_t index);
 
+  // With --lazy_kernel_loading, LoadProgram only reads the header of the
+  // classes of non-core libraries: their fields and functions are read by
+  // FinishLoading when the class is finalized, which happens on the first
+  // lookup of one of its members (see Class::EnsureIsFinalized).
+  static void FinishLoading(const Class& klass);
+
  private:
   friend class BuildingTranslationHelper;
 
+  // Layout of the arrays describing the Kernel binaries and the classes whose
+  // members have not been loaded yet (see ObjectStore::lazy_kernel_classes).
+  enum {
+    kProgramData,
+    kProgramScripts,
+    kProgramStringOffsets,
+    kProgramStringData,
+    kProgramCanonicalNames,
+    kProgramInfoSize,
+  };
+  enum {
+    kClassProgramInfo,
+    kClassOffset,
+    kClassEnd,
+    kClassInfoSize,
+  };
+
+  // Reads class members from a binary previously described by
+  // ProgramInfo().
+  explicit KernelLoader(const Array& program_info);
+
+  bool ShouldLoadLazily(const Library& library);
+  RawArray* ProgramInfo();
+  void AddLazyClass(const Class& klass,
+                    intptr_t class_offset,
+                    intptr_t class_end);
+
   void LoadPreliminaryClass(Class* klass,
                             ClassHelper* class_helper,
                             intptr_t type_parameter_count);
   Class& LoadClass(const Library& library,
                    const Class& toplevel_class,
                    intptr_t class_end);
+  // Reads the fields, constructors and procedures of |klass|. The reader is
+  // positioned right after the type parameters of the class.
+  void LoadClassMembers(const Library& library,
+                        const Class& klass,
+                        ClassHelper* class_helper,
+                        intptr_t class_end);
   void LoadProcedure(const Library& library,
                      const Class& owner,
                      bool in_class,
@@ -147,6 +186,8 @@ class KernelLoader {
   Isolate* isolate_;
   Array& scripts_;
   Array& patch_classes_;
+  // Describes the binary being read, if it has lazily loaded classes.
+  Array& program_info_;
   ActiveClass active_class_;
   BuildingTranslationHelper translation_helper_;
   StreamingFlowGraphBuilder builder_;
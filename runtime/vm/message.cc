@@ -4,6 +4,7 @@
 
 #include "vm/message.h"
 
+#include "vm/atomic.h"
 #include "vm/dart_entry.h"
 #include "vm/json_stream.h"
 #include "vm/object.h"
@@ -122,6 +123,99 @@ void MessageQueue::Clear() {
   }
 }
 
+intptr_t MessageQueue::MoveTo(MessageQueue* to, intptr_t limit) {
+  intptr_t moved = 0;
+  while ((head_ != NULL) && (moved < limit)) {
+    Message* msg = head_;
+    head_ = msg->next_;
+    msg->next_ = NULL;
+    to->Enqueue(msg, false);
+    moved++;
+  }
+  if (head_ == NULL) {
+    tail_ = NULL;
+  }
+  return moved;
+}
+
+void MessageQueue::PutBack(MessageQueue* from) {
+  if (from->head_ == NULL) {
+    return;
+  }
+  // Skip the isolate library control messages at the head.
+  Message* prev = NULL;
+  Message* cur = head_;
+  while ((cur != NULL) && (cur->dest_port() == Message::kIllegalPort)) {
+    prev = cur;
+    cur = cur->next_;
+  }
+  from->tail_->next_ = cur;
+  if (prev == NULL) {
+    head_ = from->head_;
+  } else {
+    prev->next_ = from->head_;
+  }
+  if (cur == NULL) {
+    tail_ = from->tail_;
+  }
+  from->head_ = NULL;
+  from->tail_ = NULL;
+}
+
+ConcurrentMessageQueue::~ConcurrentMessageQueue() {
+  // The owner takes all messages before deleting the queue.
+  ASSERT(IsEmpty());
+}
+
+bool ConcurrentMessageQueue::Enqueue(Message* msg) {
+  // Make sure messages are not reused.
+  ASSERT(msg->next_ == NULL);
+  uword head = AtomicOperations::LoadRelaxed(&head_);
+  while (true) {
+    msg->next_ = reinterpret_cast<Message*>(head);
+    const uword old_head = AtomicOperations::CompareAndSwapWord(
+        &head_, head, reinterpret_cast<uword>(msg));
+    if (old_head == head) {
+      return head == 0;
+    }
+    head = old_head;
+  }
+}
+
+intptr_t ConcurrentMessageQueue::TakeAll(MessageQueue* queue) {
+  uword head = AtomicOperations::LoadAcquire(&head_);
+  while (head != 0) {
+    const uword old_head =
+        AtomicOperations::CompareAndSwapWord(&head_, head, 0);
+    if (old_head == head) {
+      break;
+    }
+    head = old_head;
+  }
+  // The messages are linked newest first, reverse them.
+  Message* reversed = NULL;
+  Message* cur = reinterpret_cast<Message*>(head);
+  while (cur != NULL) {
+    Message* next = cur->next_;
+    cur->next_ = reversed;
+    reversed = cur;
+    cur = next;
+  }
+  intptr_t taken = 0;
+  while (reversed != NULL) {
+    Message* next = reversed->next_;
+    reversed->next_ = NULL;
+    queue->Enqueue(reversed, false);
+    reversed = next;
+    taken++;
+  }
+  return taken;
+}
+
+bool ConcurrentMessageQueue::IsEmpty() const {
+  return AtomicOperations::LoadRelaxed(&head_) == 0;
+}
+
 MessageQueue::Iterator::Iterator(const MessageQueue* queue) : next_(NULL) {
   Reset(queue);
 }
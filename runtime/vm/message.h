@@ -54,7 +54,9 @@ class Message {
         delivery_failure_port_(delivery_failure_port),
         data_(data),
         len_(len),
-        priority_(priority) {
+        priority_(priority),
+        post_micros_(0),
+        enqueue_micros_(0) {
     ASSERT((priority == kNormalPriority) ||
            (delivery_failure_port == kIllegalPort));
   }
@@ -70,7 +72,9 @@ class Message {
         delivery_failure_port_(delivery_failure_port),
         data_(reinterpret_cast<uint8_t*>(raw_obj)),
         len_(0),
-        priority_(priority) {
+        priority_(priority),
+        post_micros_(0),
+        enqueue_micros_(0) {
     ASSERT(!raw_obj->IsHeapObject() || raw_obj->IsVMHeapObject());
     ASSERT((priority == kNormalPriority) ||
            (delivery_failure_port == kIllegalPort));
@@ -99,12 +103,20 @@ class Message {
 
   bool RedirectToDeliveryFailurePort();
 
+  // Timestamps for the latency histograms of the message handler, or 0 when
+  // not recorded.
+  int64_t post_micros() const { return post_micros_; }
+  void set_post_micros(int64_t micros) { post_micros_ = micros; }
+  int64_t enqueue_micros() const { return enqueue_micros_; }
+  void set_enqueue_micros(int64_t micros) { enqueue_micros_ = micros; }
+
   intptr_t Id() const;
 
   static const char* PriorityAsString(Priority priority);
 
  private:
   friend class MessageQueue;
+  friend class ConcurrentMessageQueue;
 
   Message* next_;
   Dart_Port dest_port_;
@@ -112,6 +124,8 @@ class Message {
   uint8_t* data_;
   intptr_t len_;
   Priority priority_;
+  int64_t post_micros_;     // When the message was handed to the PortMap.
+  int64_t enqueue_micros_;  // When the message was put into a queue.
 
   DISALLOW_COPY_AND_ASSIGN(Message);
 };
@@ -133,6 +147,15 @@ class MessageQueue {
   // Clear all messages from the message queue.
   void Clear();
 
+  // Moves up to 'limit' messages from the head of this queue to the tail of
+  // 'to'. Returns the number of messages moved.
+  intptr_t MoveTo(MessageQueue* to, intptr_t limit);
+
+  // Moves all messages of 'from', which were taken from the head of this
+  // queue by MoveTo, back to the head. Messages that were enqueued before
+  // events in the meantime stay in front.
+  void PutBack(MessageQueue* from);
+
   // Iterator class.
   class Iterator : public ValueObject {
    public:
@@ -165,6 +188,29 @@ class MessageQueue {
   DISALLOW_COPY_AND_ASSIGN(MessageQueue);
 };
 
+// A queue of messages that any number of threads can enqueue to without
+// taking a lock. A single consumer at a time takes all messages at once.
+class ConcurrentMessageQueue {
+ public:
+  ConcurrentMessageQueue() : head_(0) {}
+  ~ConcurrentMessageQueue();
+
+  // Returns true if the queue was empty before.
+  bool Enqueue(Message* msg);
+
+  // Appends all messages to 'queue' in the order they were enqueued.
+  // Returns the number of messages moved.
+  intptr_t TakeAll(MessageQueue* queue);
+
+  bool IsEmpty() const;
+
+ private:
+  // The most recently enqueued message, linked to the earlier ones.
+  uword head_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageQueue);
+};
+
 }  // namespace dart
 
 #endif  // RUNTIME_VM_MESSAGE_H_
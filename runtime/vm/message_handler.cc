@@ -5,6 +5,7 @@
 #include "vm/message_handler.h"
 
 #include "vm/dart.h"
+#include "vm/json_stream.h"
 #include "vm/lockers.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
@@ -16,6 +17,16 @@ namespace dart {
 
 DECLARE_FLAG(bool, trace_service_pause_events);
 
+DEFINE_FLAG(bool,
+            message_latency_histograms,
+            false,
+            "Record per port histograms of how long messages take to be "
+            "enqueued and dequeued, for the VM service.");
+
+// Normal messages are handled in batches of up to this many messages without
+// acquiring the monitor in between.
+static const intptr_t kMaxMessageBatch = 64;
+
 class MessageHandlerTask : public ThreadPool::Task {
  public:
   explicit MessageHandlerTask(MessageHandler* handler) : handler_(handler) {
@@ -27,12 +38,75 @@ class MessageHandlerTask : public ThreadPool::Task {
     handler_->TaskCallback();
   }
 
+  // Handling messages may take long, but waits that can be long, like pauses
+  // in the debugger, are marked with ThreadPool::BlockingScope.
+  virtual bool IsBlocking() const { return false; }
+
  private:
   MessageHandler* handler_;
 
   DISALLOW_COPY_AND_ASSIGN(MessageHandlerTask);
 };
 
+#if !defined(PRODUCT)
+// The latencies of the messages for one port, in buckets of powers of two
+// microseconds: bucket 0 counts latencies below 1us, bucket i > 0 those in
+// [2^(i-1), 2^i)us, and the last bucket everything above.
+class MessageHandler::PortLatencies {
+ public:
+  static const intptr_t kNumBuckets = 24;
+
+  explicit PortLatencies(Dart_Port port) : port_(port) {
+    for (intptr_t i = 0; i < kNumBuckets; i++) {
+      enqueue_[i] = 0;
+      dequeue_[i] = 0;
+    }
+  }
+
+  Dart_Port port() const { return port_; }
+
+  void Record(Message* message, int64_t now) {
+    if (message->post_micros() != 0) {
+      Add(enqueue_, message->enqueue_micros() - message->post_micros());
+    }
+    Add(dequeue_, now - message->enqueue_micros());
+  }
+
+  void PrintJSON(JSONObject* jsobj) const {
+    JSONObject latencies(jsobj, "_latencies");
+    latencies.AddProperty("type", "_MessageLatencies");
+    {
+      JSONArray buckets(&latencies, "enqueue");
+      for (intptr_t i = 0; i < kNumBuckets; i++) {
+        buckets.AddValue64(enqueue_[i]);
+      }
+    }
+    {
+      JSONArray buckets(&latencies, "dequeue");
+      for (intptr_t i = 0; i < kNumBuckets; i++) {
+        buckets.AddValue64(dequeue_[i]);
+      }
+    }
+  }
+
+ private:
+  static void Add(int64_t* buckets, int64_t micros) {
+    intptr_t bucket = 0;
+    if (micros > 0) {
+      bucket = Utils::Minimum<intptr_t>(Utils::HighestBit(micros) + 1,
+                                        kNumBuckets - 1);
+    }
+    buckets[bucket]++;
+  }
+
+  const Dart_Port port_;
+  int64_t enqueue_[kNumBuckets];
+  int64_t dequeue_[kNumBuckets];
+
+  DISALLOW_COPY_AND_ASSIGN(PortLatencies);
+};
+#endif  // !defined(PRODUCT)
+
 // static
 const char* MessageHandler::MessageStatusString(MessageStatus status) {
   switch (status) {
@@ -53,6 +127,7 @@ const char* MessageHandler::MessageStatusString(MessageStatus status) {
 MessageHandler::MessageHandler()
     : queue_(new MessageQueue()),
       oob_queue_(new MessageQueue()),
+      incoming_queue_(new ConcurrentMessageQueue()),
       oob_message_handling_allowed_(true),
       live_ports_(0),
       paused_(0),
@@ -62,6 +137,7 @@ MessageHandler::MessageHandler()
       is_paused_on_start_(false),
       is_paused_on_exit_(false),
       paused_timestamp_(-1),
+      port_latencies_(),
 #endif
       delete_me_(false),
       pool_(NULL),
@@ -74,10 +150,16 @@ MessageHandler::MessageHandler()
 }
 
 MessageHandler::~MessageHandler() {
+  incoming_queue_->TakeAll(queue_);
+  delete incoming_queue_;
   delete queue_;
   delete oob_queue_;
+  incoming_queue_ = NULL;
   queue_ = NULL;
   oob_queue_ = NULL;
+#if !defined(PRODUCT)
+  DeletePortLatenciesLocked();
+#endif
   pool_ = NULL;
   task_ = NULL;
 }
@@ -119,45 +201,63 @@ void MessageHandler::Run(ThreadPool* pool,
   ASSERT(task_running);
 }
 
+bool MessageHandler::StartTaskLocked() {
+  if ((pool_ != NULL) && (task_ == NULL)) {
+    ASSERT(!delete_me_);
+    task_ = new MessageHandlerTask(this);
+    return pool_->Run(task_);
+  }
+  return true;
+}
+
 void MessageHandler::PostMessage(Message* message, bool before_events) {
-  Message::Priority saved_priority;
-  bool task_running = true;
-  {
-    MonitorLocker ml(&monitor_);
-    if (FLAG_trace_isolates) {
-      Isolate* source_isolate = Isolate::Current();
-      if (source_isolate) {
-        OS::Print(
-            "[>] Posting message:\n"
-            "\tlen:        %" Pd "\n\tsource:     (%" Pd64
-            ") %s\n\tdest:       %s\n"
-            "\tdest_port:  %" Pd64 "\n",
-            message->len(), static_cast<int64_t>(source_isolate->main_port()),
-            source_isolate->name(), name(), message->dest_port());
-      } else {
-        OS::Print(
-            "[>] Posting message:\n"
-            "\tlen:        %" Pd
-            "\n\tsource:     <native code>\n"
-            "\tdest:       %s\n"
-            "\tdest_port:  %" Pd64 "\n",
-            message->len(), name(), message->dest_port());
-      }
+  if (FLAG_trace_isolates) {
+    Isolate* source_isolate = Isolate::Current();
+    if (source_isolate) {
+      OS::Print(
+          "[>] Posting message:\n"
+          "\tlen:        %" Pd "\n\tsource:     (%" Pd64
+          ") %s\n\tdest:       %s\n"
+          "\tdest_port:  %" Pd64 "\n",
+          message->len(), static_cast<int64_t>(source_isolate->main_port()),
+          source_isolate->name(), name(), message->dest_port());
+    } else {
+      OS::Print(
+          "[>] Posting message:\n"
+          "\tlen:        %" Pd
+          "\n\tsource:     <native code>\n"
+          "\tdest:       %s\n"
+          "\tdest_port:  %" Pd64 "\n",
+          message->len(), name(), message->dest_port());
     }
+  }
+#if !defined(PRODUCT)
+  if (FLAG_message_latency_histograms) {
+    message->set_enqueue_micros(OS::GetCurrentMonotonicMicros());
+  }
+#endif
 
-    saved_priority = message->priority();
+  Message::Priority saved_priority = message->priority();
+  bool task_running = true;
+  if (!message->IsOOB() && !before_events) {
+    // Only the message that finds the incoming queue empty has to make sure
+    // that a task will handle it. The messages after it are taken from the
+    // incoming queue together with it.
+    const bool was_empty = incoming_queue_->Enqueue(message);
+    message = NULL;  // Do not access message.  May have been deleted.
+    if (was_empty) {
+      MonitorLocker ml(&monitor_);
+      task_running = StartTaskLocked();
+    }
+  } else {
+    MonitorLocker ml(&monitor_);
     if (message->IsOOB()) {
       oob_queue_->Enqueue(message, before_events);
     } else {
       queue_->Enqueue(message, before_events);
     }
     message = NULL;  // Do not access message.  May have been deleted.
-
-    if ((pool_ != NULL) && (task_ == NULL)) {
-      ASSERT(!delete_me_);
-      task_ = new MessageHandlerTask(this);
-      task_running = pool_->Run(task_);
-    }
+    task_running = StartTaskLocked();
   }
   ASSERT(task_running);
 
@@ -165,12 +265,26 @@ void MessageHandler::PostMessage(Message* message, bool before_events) {
   MessageNotify(saved_priority);
 }
 
+void MessageHandler::TakeIncomingMessagesLocked() {
+  ASSERT(monitor_.IsOwnedByCurrentThread());
+  incoming_queue_->TakeAll(queue_);
+}
+
 Message* MessageHandler::DequeueMessage(Message::Priority min_priority) {
   // TODO(turnidge): Add assert that monitor_ is held here.
   Message* message = oob_queue_->Dequeue();
   if ((message == NULL) && (min_priority < Message::kOOBPriority)) {
     message = queue_->Dequeue();
+    if (message == NULL) {
+      TakeIncomingMessagesLocked();
+      message = queue_->Dequeue();
+    }
+  }
+#if !defined(PRODUCT)
+  if (message != NULL) {
+    RecordDequeueLocked(message);
   }
+#endif
   return message;
 }
 
@@ -193,37 +307,43 @@ MessageHandler::MessageStatus MessageHandler::HandleMessages(
                                             : Message::kOOBPriority);
   Message* message = DequeueMessage(min_priority);
   while (message != NULL) {
-    intptr_t message_len = message->len();
-    if (FLAG_trace_isolates) {
-      OS::Print(
-          "[<] Handling message:\n"
-          "\tlen:        %" Pd
-          "\n"
-          "\thandler:    %s\n"
-          "\tport:       %" Pd64 "\n",
-          message_len, name(), message->dest_port());
+    Message::Priority saved_priority = message->priority();
+
+    // Take more normal messages along, so that a burst of them is handled
+    // without acquiring the monitor for every message.
+    MessageQueue batch;
+    if ((saved_priority == Message::kNormalPriority) &&
+        allow_multiple_normal_messages) {
+      TakeIncomingMessagesLocked();
+      queue_->MoveTo(&batch, kMaxMessageBatch - 1);
+#if !defined(PRODUCT)
+      MessageQueue::Iterator it(&batch);
+      while (it.HasNext()) {
+        RecordDequeueLocked(it.Next());
+      }
+#endif
     }
 
-    // Release the monitor_ temporarily while we handle the message.
+    // Release the monitor_ temporarily while we handle the messages.
     // The monitor was acquired in MessageHandler::TaskCallback().
     ml->Exit();
-    Message::Priority saved_priority = message->priority();
-    Dart_Port saved_dest_port = message->dest_port();
-    MessageStatus status = HandleMessage(message);
+    MessageStatus status = InvokeHandler(message);
+    message = NULL;  // May be deleted by now.
     if (status > max_status) {
       max_status = status;
     }
-    message = NULL;  // May be deleted by now.
-    ml->Enter();
-    if (FLAG_trace_isolates) {
-      OS::Print(
-          "[.] Message handled (%s):\n"
-          "\tlen:        %" Pd
-          "\n"
-          "\thandler:    %s\n"
-          "\tport:       %" Pd64 "\n",
-          MessageStatusString(status), message_len, name(), saved_dest_port);
+    // Stop early when the loop below has to look at the state, or when OOB
+    // messages are waiting.
+    while ((status == kOK) && !paused() && !batch.IsEmpty() &&
+           !HasOOBMessages()) {
+      status = InvokeHandler(batch.Dequeue());
+      if (status > max_status) {
+        max_status = status;
+      }
     }
+    ml->Enter();
+    queue_->PutBack(&batch);
+
     // If we are shutting down, do not process any more messages.
     if (status == kShutdown) {
       ClearOOBQueue();
@@ -252,6 +372,31 @@ MessageHandler::MessageStatus MessageHandler::HandleMessages(
   return max_status;
 }
 
+MessageHandler::MessageStatus MessageHandler::InvokeHandler(Message* message) {
+  const intptr_t message_len = message->len();
+  const Dart_Port saved_dest_port = message->dest_port();
+  if (FLAG_trace_isolates) {
+    OS::Print(
+        "[<] Handling message:\n"
+        "\tlen:        %" Pd
+        "\n"
+        "\thandler:    %s\n"
+        "\tport:       %" Pd64 "\n",
+        message_len, name(), saved_dest_port);
+  }
+  MessageStatus status = HandleMessage(message);
+  if (FLAG_trace_isolates) {
+    OS::Print(
+        "[.] Message handled (%s):\n"
+        "\tlen:        %" Pd
+        "\n"
+        "\thandler:    %s\n"
+        "\tport:       %" Pd64 "\n",
+        MessageStatusString(status), message_len, name(), saved_dest_port);
+  }
+  return status;
+}
+
 MessageHandler::MessageStatus MessageHandler::HandleNextMessage() {
   // We can only call HandleNextMessage when this handler is not
   // assigned to a thread pool.
@@ -459,6 +604,16 @@ void MessageHandler::ClosePort(Dart_Port port) {
         "\tports:      live(%" Pd ")\n",
         name(), port, live_ports_);
   }
+#if !defined(PRODUCT)
+  for (intptr_t i = 0; i < port_latencies_.length(); i++) {
+    if (port_latencies_[i]->port() == port) {
+      delete port_latencies_[i];
+      port_latencies_[i] = port_latencies_.Last();
+      port_latencies_.RemoveLast();
+      break;
+    }
+  }
+#endif
 }
 
 void MessageHandler::CloseAllPorts() {
@@ -469,8 +624,12 @@ void MessageHandler::CloseAllPorts() {
         "\thandler:    %s\n",
         name());
   }
+  TakeIncomingMessagesLocked();
   queue_->Clear();
   oob_queue_->Clear();
+#if !defined(PRODUCT)
+  DeletePortLatenciesLocked();
+#endif
 }
 
 void MessageHandler::RequestDeletion() {
@@ -505,6 +664,47 @@ void MessageHandler::decrement_live_ports() {
 }
 
 #if !defined(PRODUCT)
+MessageHandler::PortLatencies* MessageHandler::LookupPortLatenciesLocked(
+    Dart_Port port,
+    bool create) {
+  for (intptr_t i = 0; i < port_latencies_.length(); i++) {
+    if (port_latencies_[i]->port() == port) {
+      return port_latencies_[i];
+    }
+  }
+  if (!create) {
+    return NULL;
+  }
+  PortLatencies* latencies = new PortLatencies(port);
+  port_latencies_.Add(latencies);
+  return latencies;
+}
+
+void MessageHandler::RecordDequeueLocked(Message* message) {
+  if (message->enqueue_micros() == 0) {
+    // Not recorded, or recorded already when it was dequeued before.
+    return;
+  }
+  LookupPortLatenciesLocked(message->dest_port(), true)
+      ->Record(message, OS::GetCurrentMonotonicMicros());
+  message->set_enqueue_micros(0);
+}
+
+void MessageHandler::DeletePortLatenciesLocked() {
+  for (intptr_t i = 0; i < port_latencies_.length(); i++) {
+    delete port_latencies_[i];
+  }
+  port_latencies_.Clear();
+}
+
+void MessageHandler::PrintPortLatencies(Dart_Port port, JSONObject* jsobj) {
+  MonitorLocker ml(&monitor_);
+  PortLatencies* latencies = LookupPortLatenciesLocked(port, false);
+  if (latencies != NULL) {
+    latencies->PrintJSON(jsobj);
+  }
+}
+
 void MessageHandler::DebugDump() {
   PortMap::DebugDumpForMessageHandler(this);
 }
@@ -575,6 +775,7 @@ void MessageHandler::PausedOnExitLocked(MonitorLocker* ml, bool paused) {
 MessageHandler::AcquiredQueues::AcquiredQueues(MessageHandler* handler)
     : handler_(handler), ml_(&handler->monitor_) {
   ASSERT(handler != NULL);
+  handler_->TakeIncomingMessagesLocked();
   handler_->oob_message_handling_allowed_ = false;
 }
 
@@ -13,6 +13,8 @@
 
 namespace dart {
 
+class JSONObject;
+
 // A MessageHandler is an entity capable of accepting messages.
 class MessageHandler {
  protected:
@@ -175,6 +177,12 @@ class MessageHandler {
   // Notifies this handler that all ports are being closed.
   void CloseAllPorts();
 
+#if !defined(PRODUCT)
+  // Adds the latency histograms recorded for 'port' to 'jsobj', see
+  // --message_latency_histograms.
+  void PrintPortLatencies(Dart_Port port, JSONObject* jsobj);
+#endif
+
   // Returns true if the handler is owned by the PortMap.
   //
   // This is used to delete handlers when their last live port is closed.
@@ -207,9 +215,19 @@ class MessageHandler {
   friend class MessageHandlerTestPeer;
   friend class MessageHandlerTask;
 
+#if !defined(PRODUCT)
+  class PortLatencies;
+#endif
+
   // Called by MessageHandlerTask to process our task queue.
   void TaskCallback();
 
+  // Starts a task on the pool unless one is running already.
+  bool StartTaskLocked();
+
+  // Moves the messages posted without the monitor to queue_.
+  void TakeIncomingMessagesLocked();
+
   // NOTE: These two functions release and reacquire the monitor, you may
   // need to call HandleMessages to ensure all pending messages are handled.
   void PausedOnStartLocked(MonitorLocker* ml, bool paused);
@@ -221,6 +239,15 @@ class MessageHandler {
 
   void ClearOOBQueue();
 
+  // Handles one message that has been dequeued, without holding the monitor.
+  MessageStatus InvokeHandler(Message* message);
+
+#if !defined(PRODUCT)
+  PortLatencies* LookupPortLatenciesLocked(Dart_Port port, bool create);
+  void RecordDequeueLocked(Message* message);
+  void DeletePortLatenciesLocked();
+#endif
+
   // Handles any pending messages.
   MessageStatus HandleMessages(MonitorLocker* ml,
                                bool allow_normal_messages,
@@ -229,6 +256,9 @@ class MessageHandler {
   Monitor monitor_;  // Protects all fields in MessageHandler.
   MessageQueue* queue_;
   MessageQueue* oob_queue_;
+  // Normal messages that were not posted before events. They are moved to
+  // queue_ in batches, posting to it does not take the monitor.
+  ConcurrentMessageQueue* incoming_queue_;
   // This flag is not thread safe and can only reliably be accessed on a single
   // thread.
   bool oob_message_handling_allowed_;
@@ -240,6 +270,7 @@ class MessageHandler {
   bool is_paused_on_start_;
   bool is_paused_on_exit_;
   int64_t paused_timestamp_;
+  MallocGrowableArray<PortLatencies*> port_latencies_;
 #endif
   bool delete_me_;
   ThreadPool* pool_;
@@ -20,7 +20,11 @@ class MessageHandlerTestPeer {
   void increment_live_ports() { handler_->increment_live_ports(); }
   void decrement_live_ports() { handler_->decrement_live_ports(); }
 
-  MessageQueue* queue() const { return handler_->queue_; }
+  MessageQueue* queue() const {
+    MonitorLocker ml(&handler_->monitor_);
+    handler_->TakeIncomingMessagesLocked();
+    return handler_->queue_;
+  }
   MessageQueue* oob_queue() const { return handler_->oob_queue_; }
 
  private:
@@ -322,6 +326,55 @@ VM_UNIT_TEST_CASE(MessageHandler_HandleOOBMessages) {
   handler_peer.CloseAllPorts();
 }
 
+VM_UNIT_TEST_CASE(MessageHandler_HandleAllMessages_Batches) {
+  TestMessageHandler handler;
+  MessageHandlerTestPeer handler_peer(&handler);
+  // More messages than fit in one batch.
+  const int kNumMessages = 150;
+  Dart_Port port1 = PortMap::CreatePort(&handler);
+  Dart_Port port2 = PortMap::CreatePort(&handler);
+  for (int i = 0; i < kNumMessages; i++) {
+    Message* message = new Message(((i % 2) == 0) ? port1 : port2, NULL, 0,
+                                   Message::kNormalPriority);
+    handler_peer.PostMessage(message);
+  }
+
+  EXPECT_EQ(MessageHandler::kOK, handler.HandleAllMessages());
+  EXPECT_EQ(kNumMessages, handler.message_count());
+  Dart_Port* ports = handler.port_buffer();
+  for (int i = 0; i < kNumMessages; i++) {
+    EXPECT_EQ(((i % 2) == 0) ? port1 : port2, ports[i]);
+  }
+  PortMap::ClosePorts(&handler);
+}
+
+VM_UNIT_TEST_CASE(MessageHandler_HandleAllMessages_ErrorInBatch) {
+  TestMessageHandler handler;
+  MessageHandler::MessageStatus results[] = {
+      MessageHandler::kOK,     // message1
+      MessageHandler::kError,  // message2
+  };
+  handler.set_results(results);
+  MessageHandlerTestPeer handler_peer(&handler);
+  Dart_Port port1 = PortMap::CreatePort(&handler);
+  Dart_Port port2 = PortMap::CreatePort(&handler);
+  Dart_Port port3 = PortMap::CreatePort(&handler);
+  Message* message1 = new Message(port1, NULL, 0, Message::kNormalPriority);
+  handler_peer.PostMessage(message1);
+  Message* message2 = new Message(port2, NULL, 0, Message::kNormalPriority);
+  handler_peer.PostMessage(message2);
+  Message* message3 = new Message(port3, NULL, 0, Message::kNormalPriority);
+  handler_peer.PostMessage(message3);
+
+  // The rest of the batch is left in the queue after an error.
+  EXPECT_EQ(MessageHandler::kError, handler.HandleAllMessages());
+  EXPECT_EQ(2, handler.message_count());
+  EXPECT(message3 == handler_peer.queue()->Dequeue());
+  EXPECT(NULL == handler_peer.queue()->Dequeue());
+  delete message3;
+  PortMap::ClosePorts(&handler);
+}
+
 struct ThreadStartInfo {
   MessageHandler* handler;
   Dart_Port* ports;
@@ -145,4 +145,75 @@ TEST_CASE(MessageQueue_Clear) {
   // msg1 and msg2 already delete by FlushAll.
 }
 
+TEST_CASE(MessageQueue_MoveToAndPutBack) {
+  MessageQueue queue;
+  Dart_Port port = 1;
+  Message* msgs[4];
+  for (intptr_t i = 0; i < 4; i++) {
+    msgs[i] = new Message(port, NULL, 0, Message::kNormalPriority);
+    queue.Enqueue(msgs[i], false);
+  }
+
+  MessageQueue batch;
+  EXPECT_EQ(3, queue.MoveTo(&batch, 3));
+  EXPECT_EQ(1, queue.Length());
+  EXPECT_EQ(3, batch.Length());
+  EXPECT(batch.Dequeue() == msgs[0]);
+
+  // A control message that arrives in the meantime stays in front.
+  Message* control =
+      new Message(Message::kIllegalPort, NULL, 0, Message::kNormalPriority);
+  queue.Enqueue(control, true);
+  queue.PutBack(&batch);
+  EXPECT(batch.IsEmpty());
+  EXPECT(queue.Dequeue() == control);
+  EXPECT(queue.Dequeue() == msgs[1]);
+  EXPECT(queue.Dequeue() == msgs[2]);
+  EXPECT(queue.Dequeue() == msgs[3]);
+  EXPECT(queue.IsEmpty());
+
+  // Moving everything leaves the queue usable.
+  Message* msg = new Message(port, NULL, 0, Message::kNormalPriority);
+  queue.Enqueue(msg, false);
+  EXPECT_EQ(1, queue.MoveTo(&batch, 10));
+  EXPECT(queue.IsEmpty());
+  queue.PutBack(&batch);
+  EXPECT(queue.Dequeue() == msg);
+
+  for (intptr_t i = 0; i < 4; i++) {
+    delete msgs[i];
+  }
+  delete control;
+  delete msg;
+}
+
+TEST_CASE(ConcurrentMessageQueue_TakeAll) {
+  ConcurrentMessageQueue incoming;
+  MessageQueue queue;
+  Dart_Port port = 1;
+  EXPECT(incoming.IsEmpty());
+  EXPECT_EQ(0, incoming.TakeAll(&queue));
+
+  Message* msg1 = new Message(port, NULL, 0, Message::kNormalPriority);
+  Message* msg2 = new Message(port, NULL, 0, Message::kNormalPriority);
+  Message* msg3 = new Message(port, NULL, 0, Message::kNormalPriority);
+  // Only the first message finds the queue empty.
+  EXPECT(incoming.Enqueue(msg1));
+  EXPECT(!incoming.Enqueue(msg2));
+  EXPECT(!incoming.Enqueue(msg3));
+  EXPECT(!incoming.IsEmpty());
+
+  // Messages come out in the order they went in.
+  EXPECT_EQ(3, incoming.TakeAll(&queue));
+  EXPECT(incoming.IsEmpty());
+  EXPECT(queue.Dequeue() == msg1);
+  EXPECT(queue.Dequeue() == msg2);
+  EXPECT(queue.Dequeue() == msg3);
+  EXPECT(queue.IsEmpty());
+
+  delete msg1;
+  delete msg2;
+  delete msg3;
+}
+
 }  // namespace dart
@@ -6,12 +6,14 @@
 
 #include "vm/metrics.h"
 
+#include "vm/dart.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
 #include "vm/log.h"
 #include "vm/native_entry.h"
 #include "vm/object.h"
 #include "vm/runtime_entry.h"
+#include "vm/thread_pool.h"
 
 namespace dart {
 
@@ -279,6 +281,16 @@ int64_t MetricHeapNewExternal::Value() const {
   return isolate()->heap()->ExternalInWords(Heap::kNew) * kWordSize;
 }
 
+int64_t MetricHeapNewTenuringAge::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->heap()->new_space()->tenuring_age();
+}
+
+int64_t MetricHeapNewPauseEstimate::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->heap()->new_space()->pause_estimate_micros();
+}
+
 int64_t MetricHeapUsed::Value() const {
   ASSERT(isolate() == Isolate::Current());
   return isolate()->heap()->UsedInWords(Heap::kNew) * kWordSize +
@@ -297,6 +309,21 @@ int64_t MetricPeakRSS::Value() const {
   return Service::MaxRSS();
 }
 
+int64_t MetricThreadPoolWorkers::Value() const {
+  ThreadPool* pool = Dart::thread_pool();
+  return (pool == NULL) ? 0 : pool->fixed_workers();
+}
+
+int64_t MetricThreadPoolQueueDepth::Value() const {
+  ThreadPool* pool = Dart::thread_pool();
+  return (pool == NULL) ? 0 : pool->queue_depth();
+}
+
+int64_t MetricThreadPoolSteals::Value() const {
+  ThreadPool* pool = Dart::thread_pool();
+  return (pool == NULL) ? 0 : pool->tasks_stolen();
+}
+
 #define VM_METRIC_VARIABLE(type, variable, name, unit)                         \
   static type vm_metric_##variable##_;
 VM_METRIC_LIST(VM_METRIC_VARIABLE);
@@ -24,6 +24,10 @@ class JSONStream;
   V(MetricHeapNewCapacity, HeapNewCapacity, "heap.new.capacity", kByte)        \
   V(MaxMetric, HeapNewCapacityMax, "heap.new.capacity.max", kByte)             \
   V(MetricHeapNewExternal, HeapNewExternal, "heap.new.external", kByte)        \
+  V(MetricHeapNewTenuringAge, HeapNewTenuringAge, "heap.new.tenuringAge",      \
+    kCounter)                                                                  \
+  V(MetricHeapNewPauseEstimate, HeapNewPauseEstimate,                          \
+    "heap.new.pauseEstimate", kMicrosecond)                                    \
   V(MetricHeapUsed, HeapGlobalUsed, "heap.global.used", kByte)                 \
   V(MaxMetric, HeapGlobalUsedMax, "heap.global.used.max", kByte)               \
   V(Metric, RunnableLatency, "isolate.runnable.latency", kMicrosecond)         \
@@ -32,7 +36,12 @@ class JSONStream;
 #define VM_METRIC_LIST(V)                                                      \
   V(MetricIsolateCount, IsolateCount, "vm.isolate.count", kCounter)            \
   V(MetricCurrentRSS, CurrentRSS, "vm.memory.current", kByte)                  \
-  V(MetricPeakRSS, PeakRSS, "vm.memory.max", kByte)
+  V(MetricPeakRSS, PeakRSS, "vm.memory.max", kByte)                           \
+  V(MetricThreadPoolWorkers, ThreadPoolWorkers, "vm.threadpool.workers",       \
+    kCounter)                                                                  \
+  V(MetricThreadPoolQueueDepth, ThreadPoolQueueDepth,                          \
+    "vm.threadpool.queue.depth", kCounter)                                     \
+  V(MetricThreadPoolSteals, ThreadPoolSteals, "vm.threadpool.steals", kCounter)
 
 class Metric {
  public:
@@ -158,6 +167,18 @@ class MetricHeapNewExternal : public Metric {
   virtual int64_t Value() const;
 };
 
+// Decisions of the scavenger's tenuring policy, see
+// Scavenger::tenuring_age() and Scavenger::pause_estimate_micros().
+class MetricHeapNewTenuringAge : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+class MetricHeapNewPauseEstimate : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
 class MetricIsolateCount : public Metric {
  protected:
   virtual int64_t Value() const;
@@ -173,6 +194,23 @@ class MetricPeakRSS : public Metric {
   virtual int64_t Value() const;
 };
 
+// Stats of the fixed workers of the VM thread pool, see
+// ThreadPool::fixed_workers() and friends.
+class MetricThreadPoolWorkers : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+class MetricThreadPoolQueueDepth : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+class MetricThreadPoolSteals : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
 class MetricHeapUsed : public Metric {
  protected:
   virtual int64_t Value() const;
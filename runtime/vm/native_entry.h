@@ -112,6 +112,45 @@ void DartNativeThrowArgumentException(const Instance& instance);
   }                                                                            \
   name ^= value;
 
+// Describes a native that can also be called as a leaf native: a C function
+// that takes and returns unboxed values and is called directly from the
+// native function's code, without NativeArguments, an API scope or a
+// safepoint transition. The C function is a leaf runtime entry, so it must
+// not allocate, throw, call back into Dart or block.
+//
+// The signature has one character for the return type followed by one per
+// parameter of the Dart function:
+//   'v'  void, the native returns null (return type only).
+//   'i'  int64_t, from and to an int.
+//   'd'  double, from and to a double.
+//   'p'  void*, the data of an internal or external typed data object
+//        (parameter type only).
+// When a parameter does not have the expected type the regular native of the
+// same name is called instead, which reports the error.
+struct LeafNativeEntry {
+  enum Type {
+    kVoid = 'v',
+    kInt64 = 'i',
+    kDouble = 'd',
+    kData = 'p',
+  };
+
+  // All arguments are passed in registers on every supported platform.
+  static const intptr_t kMaxArguments = 4;
+
+  Type return_type() const { return static_cast<Type>(signature_[0]); }
+  intptr_t argument_count() const { return strlen(signature_) - 1; }
+  Type argument_type(intptr_t index) const {
+    ASSERT((index >= 0) && (index < argument_count()));
+    return static_cast<Type>(signature_[index + 1]);
+  }
+  const RuntimeEntry& entry() const { return *entry_; }
+
+  const char* name_;
+  const char* signature_;
+  const RuntimeEntry* entry_;
+};
+
 // Helper class for resolving and handling native functions.
 class NativeEntry : public AllStatic {
  public:
@@ -6,6 +6,7 @@
 
 #include "include/dart_api.h"
 #include "platform/assert.h"
+#include "vm/atomic.h"
 #include "vm/become.h"
 #include "vm/bit_vector.h"
 #include "vm/bootstrap.h"
@@ -40,6 +41,8 @@
 #include "vm/runtime_entry.h"
 #include "vm/scopes.h"
 #include "vm/stack_frame.h"
+#include "vm/string_hasher.h"
+#include "vm/string_search.h"
 #include "vm/symbols.h"
 #include "vm/tags.h"
 #include "vm/thread_registry.h"
@@ -80,6 +83,12 @@ DEFINE_FLAG(bool,
             false,
             "Remove script timestamps to allow for deterministic testing.");
 
+DEFINE_FLAG(bool,
+            string_append_buffers,
+            true,
+            "Build long one-byte strings appended to with '+' in a shared "
+            "buffer with spare capacity.");
+
 DECLARE_FLAG(bool, show_invisible_frames);
 DECLARE_FLAG(bool, strong);
 DECLARE_FLAG(bool, trace_deoptimization);
@@ -1961,7 +1970,17 @@ RawObject* Object::Allocate(intptr_t cls_id, intptr_t size, Heap::Space space) {
   ASSERT(thread->no_callback_scope_depth() == 0);
   Heap* heap = isolate->heap();
 
-  uword address = heap->Allocate(size, space);
+  bool pretenure = false;
+#ifndef PRODUCT
+  // Classes whose objects mostly survive their first scavenge are allocated
+  // directly in old space. Generated code takes this slow path for them.
+  if ((space == Heap::kNew) && isolate->class_table()->PretenureFor(cls_id)) {
+    pretenure = true;
+    space = Heap::kOld;
+  }
+#endif  // !PRODUCT
+  uword address = pretenure ? heap->AllocatePretenured(size)
+                            : heap->Allocate(size, space);
   if (address == 0) {
     // Use the preallocated out of memory exception to avoid calling
     // into dart code or allocating any code.
@@ -1986,6 +2005,11 @@ RawObject* Object::Allocate(intptr_t cls_id, intptr_t size, Heap::Space space) {
   InitializeObject(address, cls_id, size, (isolate == Dart::vm_isolate()));
   RawObject* raw_obj = reinterpret_cast<RawObject*>(address + kHeapObjectTag);
   ASSERT(cls_id == RawObject::ClassIdTag::decode(raw_obj->ptr()->tags_));
+  if (raw_obj->IsOldObject() && heap->old_space()->IsMarkingIncrementally()) {
+    // Allocate black: the incremental marker only visits objects it marked
+    // itself, or that were written to after it marked them.
+    raw_obj->SetMarkBitUnsynchronized();
+  }
   return raw_obj;
 }
 
@@ -2030,9 +2054,10 @@ RawObject* Object::Clone(const Object& orig, Heap::Space space) {
   intptr_t size = orig.raw()->Size();
   RawObject* raw_clone = Object::Allocate(cls.id(), size, space);
   NoSafepointScope no_safepoint;
-  // TODO(koda): This will trip when we start allocating black.
-  // Revisit code below at that point, to account for the new write barrier.
-  ASSERT(!raw_clone->IsMarked());
+  // A clone allocated black while marking incrementally is rescanned by the
+  // marker, as the copy below dirties its pages.
+  ASSERT(!raw_clone->IsMarked() ||
+         Isolate::Current()->heap()->old_space()->IsMarkingIncrementally());
   // Copy the body of the original into the clone.
   uword orig_addr = RawObject::ToAddr(orig.raw());
   uword clone_addr = RawObject::ToAddr(raw_clone);
@@ -3631,6 +3656,11 @@ void Class::set_is_allocated(bool value) const {
   set_state_bits(IsAllocatedBit::update(value, raw_ptr()->state_bits_));
 }
 
+void Class::set_has_pending_kernel_members(bool value) const {
+  set_state_bits(
+      PendingKernelMembersBit::update(value, raw_ptr()->state_bits_));
+}
+
 void Class::set_is_finalized() const {
   ASSERT(!is_finalized());
   set_state_bits(
@@ -19558,80 +19588,51 @@ const char* Bigint::ToCString() const {
   return ToDecCString(Thread::Current()->zone());
 }
 
-// Synchronize with implementation in compiler (intrinsifier).
-class StringHasher : ValueObject {
- public:
-  StringHasher() : hash_(0) {}
-  void Add(int32_t ch) { hash_ = CombineHashes(hash_, ch); }
-  void Add(const String& str, intptr_t begin_index, intptr_t len);
-
-  // Return a non-zero hash of at most 'bits' bits.
-  intptr_t Finalize(int bits) {
-    ASSERT(1 <= bits && bits <= (kBitsPerWord - 1));
-    hash_ = FinalizeHash(hash_, bits);
-    ASSERT(hash_ <= static_cast<uint32_t>(kMaxInt32));
-    return hash_;
+// Returns true if all code units of 'str[begin_index..begin_index + len)'
+// fit in one byte, i.e. whether StringHasher hashes them in Latin-1 form.
+static bool IsLatin1(const String& str, intptr_t begin_index, intptr_t len) {
+  if (str.CharSize() == String::kOneByteChar) {
+    return true;
   }
+  NoSafepointScope no_safepoint;
+  return StringSearch::IsLatin1(String::TwoByteDataStart(str) + begin_index,
+                                len);
+}
 
- private:
-  uint32_t hash_;
-};
-
-void StringHasher::Add(const String& str, intptr_t begin_index, intptr_t len) {
+static void AddCodeUnits(StringHasher* hasher,
+                         const String& str,
+                         intptr_t begin_index,
+                         intptr_t len) {
   ASSERT(begin_index >= 0);
   ASSERT(len >= 0);
   ASSERT((begin_index + len) <= str.Length());
   if (len == 0) {
     return;
   }
-  if (str.IsOneByteString()) {
-    NoSafepointScope no_safepoint;
-    uint8_t* str_addr = OneByteString::CharAddr(str, begin_index);
-    for (intptr_t i = 0; i < len; i++) {
-      Add(*str_addr);
-      str_addr++;
-    }
+  NoSafepointScope no_safepoint;
+  if (str.CharSize() == String::kOneByteChar) {
+    hasher->Add(String::OneByteDataStart(str) + begin_index, len);
   } else {
-    String::CodePointIterator it(str, begin_index, len);
-    while (it.Next()) {
-      Add(it.Current());
-    }
+    hasher->Add(String::TwoByteDataStart(str) + begin_index, len);
   }
 }
 
 intptr_t String::Hash(const String& str, intptr_t begin_index, intptr_t len) {
-  StringHasher hasher;
-  hasher.Add(str, begin_index, len);
+  StringHasher hasher(IsLatin1(str, begin_index, len));
+  AddCodeUnits(&hasher, str, begin_index, len);
   return hasher.Finalize(kHashBits);
 }
 
 intptr_t String::HashConcat(const String& str1, const String& str2) {
-  intptr_t len1 = str1.Length();
-  // Since String::Hash works at the code point (rune) level, a surrogate pair
-  // that crosses the boundary between str1 and str2 must be composed.
-  if (str1.IsTwoByteString() && Utf16::IsLeadSurrogate(str1.CharAt(len1 - 1))) {
-    const String& temp = String::Handle(String::Concat(str1, str2));
-    return temp.Hash();
-  } else {
-    StringHasher hasher;
-    hasher.Add(str1, 0, len1);
-    hasher.Add(str2, 0, str2.Length());
-    return hasher.Finalize(kHashBits);
-  }
-}
-
-template <typename T>
-static intptr_t HashImpl(const T* characters, intptr_t len) {
-  ASSERT(len >= 0);
-  StringHasher hasher;
-  for (intptr_t i = 0; i < len; i++) {
-    hasher.Add(characters[i]);
-  }
-  return hasher.Finalize(String::kHashBits);
+  const intptr_t len1 = str1.Length();
+  const intptr_t len2 = str2.Length();
+  StringHasher hasher(IsLatin1(str1, 0, len1) && IsLatin1(str2, 0, len2));
+  AddCodeUnits(&hasher, str1, 0, len1);
+  AddCodeUnits(&hasher, str2, 0, len2);
+  return hasher.Finalize(kHashBits);
 }
 
 intptr_t String::Hash(RawString* raw) {
-  StringHasher hasher;
   uword length = Smi::Value(raw->ptr()->length_);
   if (raw->IsOneByteString() || raw->IsExternalOneByteString()) {
     const uint8_t* data;
@@ -19659,24 +19660,49 @@ intptr_t String::Hash(RawString* raw) {
 }
 
 intptr_t String::Hash(const char* characters, intptr_t len) {
-  return HashImpl(characters, len);
+  return Hash(reinterpret_cast<const uint8_t*>(characters), len);
 }
 
 intptr_t String::Hash(const uint8_t* characters, intptr_t len) {
-  return HashImpl(characters, len);
+  StringHasher hasher(true);
+  hasher.Add(characters, len);
+  return hasher.Finalize(kHashBits);
 }
 
 intptr_t String::Hash(const uint16_t* characters, intptr_t len) {
-  StringHasher hasher;
-  intptr_t i = 0;
-  while (i < len) {
-    hasher.Add(Utf16::Next(characters, &i, len));
-  }
+  StringHasher hasher(StringSearch::IsLatin1(characters, len));
+  hasher.Add(characters, len);
   return hasher.Finalize(kHashBits);
 }
 
 intptr_t String::Hash(const int32_t* characters, intptr_t len) {
-  return HashImpl(characters, len);
+  // Hash the code units of the string the code points encode.
+  bool latin1 = true;
+  for (intptr_t i = 0; i < len; i++) {
+    if (characters[i] > 0xFF) {
+      latin1 = false;
+      break;
+    }
+  }
+  StringHasher hasher(latin1);
+  const intptr_t kBufferLength = 64;
+  uint16_t buffer[kBufferLength];
+  intptr_t used = 0;
+  for (intptr_t i = 0; i < len; i++) {
+    if (used > kBufferLength - 2) {
+      hasher.Add(buffer, used);
+      used = 0;
+    }
+    const int32_t ch = characters[i];
+    if (Utf::IsSupplementary(ch)) {
+      Utf16::Encode(ch, &buffer[used]);
+      used += 2;
+    } else {
+      buffer[used++] = static_cast<uint16_t>(ch);
+    }
+  }
+  hasher.Add(buffer, used);
+  return hasher.Finalize(kHashBits);
 }
 
 uint16_t String::CharAt(intptr_t index) const {
@@ -19755,15 +19781,23 @@ bool String::Equals(const String& str,
     return false;  // Lengths don't match.
   }
 
-  Scanner::CharAtFunc this_char_at_func = this->CharAtFunc();
-  Scanner::CharAtFunc str_char_at_func = str.CharAtFunc();
-  for (intptr_t i = 0; i < len; i++) {
-    if (this_char_at_func(*this, i) != str_char_at_func(str, begin_index + i)) {
-      return false;
+  NoSafepointScope no_safepoint;
+  if (this->CharSize() == kOneByteChar) {
+    const uint8_t* this_data = OneByteDataStart(*this);
+    if (str.CharSize() == kOneByteChar) {
+      return StringSearch::Matches(this_data,
+                                   OneByteDataStart(str) + begin_index, len);
     }
+    return StringSearch::Matches(this_data, TwoByteDataStart(str) + begin_index,
+                                 len);
   }
-
-  return true;
+  const uint16_t* this_data = TwoByteDataStart(*this);
+  if (str.CharSize() == kOneByteChar) {
+    return StringSearch::Matches(this_data, OneByteDataStart(str) + begin_index,
+                                 len);
+  }
+  return StringSearch::Matches(this_data, TwoByteDataStart(str) + begin_index,
+                               len);
 }
 
 bool String::Equals(const char* cstr) const {
@@ -19841,21 +19875,27 @@ bool String::EqualsConcat(const String& str1, const String& str2) const {
 
 intptr_t String::CompareTo(const String& other) const {
   const intptr_t this_len = this->Length();
-  const intptr_t other_len = other.IsNull() ? 0 : other.Length();
-  const intptr_t len = (this_len < other_len) ? this_len : other_len;
-  for (intptr_t i = 0; i < len; i++) {
-    uint16_t this_code_unit = this->CharAt(i);
-    uint16_t other_code_unit = other.CharAt(i);
-    if (this_code_unit < other_code_unit) {
-      return -1;
-    }
-    if (this_code_unit > other_code_unit) {
-      return 1;
+  if (other.IsNull()) {
+    return (this_len > 0) ? 1 : 0;
+  }
+  const intptr_t other_len = other.Length();
+  NoSafepointScope no_safepoint;
+  if (this->CharSize() == kOneByteChar) {
+    const uint8_t* this_data = OneByteDataStart(*this);
+    if (other.CharSize() == kOneByteChar) {
+      return StringSearch::Compare(this_data, this_len, OneByteDataStart(other),
+                                   other_len);
     }
+    return StringSearch::Compare(this_data, this_len, TwoByteDataStart(other),
+                                 other_len);
   }
-  if (this_len < other_len) return -1;
-  if (this_len > other_len) return 1;
-  return 0;
+  const uint16_t* this_data = TwoByteDataStart(*this);
+  if (other.CharSize() == kOneByteChar) {
+    return StringSearch::Compare(this_data, this_len, OneByteDataStart(other),
+                                 other_len);
+  }
+  return StringSearch::Compare(this_data, this_len, TwoByteDataStart(other),
+                               other_len);
 }
 
 bool String::StartsWith(const String& other) const {
@@ -19871,6 +19911,70 @@ bool String::StartsWith(const String& other) const {
   return true;
 }
 
+intptr_t String::IndexOf(const String& pattern, intptr_t start) const {
+  ASSERT(!pattern.IsNull());
+  ASSERT((0 <= start) && (start <= Length()));
+  const intptr_t len = Length();
+  const intptr_t pattern_len = pattern.Length();
+  NoSafepointScope no_safepoint;
+  if (CharSize() == kOneByteChar) {
+    const uint8_t* data = OneByteDataStart(*this);
+    if (pattern.CharSize() == kOneByteChar) {
+      return StringSearch::IndexOf(data, len, OneByteDataStart(pattern),
+                                   pattern_len, start);
+    }
+    return StringSearch::IndexOf(data, len, TwoByteDataStart(pattern),
+                                 pattern_len, start);
+  }
+  const uint16_t* data = TwoByteDataStart(*this);
+  if (pattern.CharSize() == kOneByteChar) {
+    return StringSearch::IndexOf(data, len, OneByteDataStart(pattern),
+                                 pattern_len, start);
+  }
+  return StringSearch::IndexOf(data, len, TwoByteDataStart(pattern),
+                               pattern_len, start);
+}
+
+intptr_t String::LastIndexOf(const String& pattern, intptr_t start) const {
+  ASSERT(!pattern.IsNull());
+  ASSERT((0 <= start) && (start <= Length()));
+  const intptr_t len = Length();
+  const intptr_t pattern_len = pattern.Length();
+  NoSafepointScope no_safepoint;
+  if (CharSize() == kOneByteChar) {
+    const uint8_t* data = OneByteDataStart(*this);
+    if (pattern.CharSize() == kOneByteChar) {
+      return StringSearch::LastIndexOf(data, len, OneByteDataStart(pattern),
+                                       pattern_len, start);
+    }
+    return StringSearch::LastIndexOf(data, len, TwoByteDataStart(pattern),
+                                     pattern_len, start);
+  }
+  const uint16_t* data = TwoByteDataStart(*this);
+  if (pattern.CharSize() == kOneByteChar) {
+    return StringSearch::LastIndexOf(data, len, OneByteDataStart(pattern),
+                                     pattern_len, start);
+  }
+  return StringSearch::LastIndexOf(data, len, TwoByteDataStart(pattern),
+                                   pattern_len, start);
+}
+
+const uint8_t* String::OneByteDataStart(const String& str) {
+  ASSERT(str.CharSize() == kOneByteChar);
+  if (str.IsOneByteString()) {
+    return OneByteString::raw(str)->ptr()->data();
+  }
+  return ExternalOneByteString::raw_ptr(str)->external_data_->data();
+}
+
+const uint16_t* String::TwoByteDataStart(const String& str) {
+  ASSERT(str.CharSize() == kTwoByteChar);
+  if (str.IsTwoByteString()) {
+    return TwoByteString::raw(str)->ptr()->data();
+  }
+  return ExternalTwoByteString::raw_ptr(str)->external_data_->data();
+}
+
 RawInstance* String::CheckAndCanonicalize(Thread* thread,
                                           const char** error_str) const {
   if (IsCanonical()) {
@@ -20269,6 +20373,101 @@ RawString* String::Concat(const String& str1,
   return OneByteString::Concat(str1, str2, space);
 }
 
+// Backing store of the external strings made by String::ConcatForAppend,
+// followed by 'capacity' characters. Every string sharing the buffer is a
+// prefix of its first 'used' characters, which are never written again, so
+// the characters past 'used' can be appended to without copying the prefix.
+struct StringAppendBuffer {
+  intptr_t ref_count;
+  intptr_t used;
+  intptr_t capacity;
+
+  uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+
+  static StringAppendBuffer* New(intptr_t capacity) {
+    StringAppendBuffer* buffer = reinterpret_cast<StringAppendBuffer*>(
+        malloc(sizeof(StringAppendBuffer) + capacity));
+    if (buffer != NULL) {
+      buffer->ref_count = 0;
+      buffer->used = 0;
+      buffer->capacity = capacity;
+    }
+    return buffer;
+  }
+
+  // Finalizer of each string sharing the buffer.
+  static void Release(void* peer) {
+    StringAppendBuffer* buffer = reinterpret_cast<StringAppendBuffer*>(peer);
+    if (AtomicOperations::FetchAndDecrement(&buffer->ref_count) == 1) {
+      free(buffer);
+    }
+  }
+};
+
+// Shorter strings are cheaper to copy than to finalize.
+static const intptr_t kMinAppendBufferLength = 256;
+
+RawString* String::ConcatForAppend(const String& str1,
+                                   const String& str2,
+                                   Heap::Space space) {
+  ASSERT(!str1.IsNull() && !str2.IsNull());
+  const intptr_t len1 = str1.Length();
+  const intptr_t len2 = str2.Length();
+  if (!FLAG_string_append_buffers || (len1 < kMinAppendBufferLength) ||
+      (len2 == 0) || (str1.CharSize() != kOneByteChar) ||
+      (str2.CharSize() != kOneByteChar)) {
+    return Concat(str1, str2, space);
+  }
+  if ((kMaxElements - len1) < len2) {
+    Exceptions::ThrowOOM();
+    UNREACHABLE();
+  }
+  const intptr_t len = len1 + len2;
+  StringAppendBuffer* buffer = NULL;
+  if (str1.IsAppendString()) {
+    NoSafepointScope no_safepoint;
+    ExternalStringData<uint8_t>* data =
+        ExternalOneByteString::raw_ptr(str1)->external_data_;
+    buffer = reinterpret_cast<StringAppendBuffer*>(data->peer());
+    if ((buffer->used != len1) || ((buffer->capacity - len1) < len2)) {
+      // Something was appended to 'str1' already, or the buffer is full.
+      buffer = NULL;
+    }
+  }
+  intptr_t external_size = 0;
+  if (buffer == NULL) {
+    // Leave room for appending as many characters again.
+    const intptr_t capacity = Utils::Minimum(2 * len, kMaxElements);
+    buffer = StringAppendBuffer::New(capacity);
+    if (buffer == NULL) {
+      return Concat(str1, str2, space);
+    }
+    NoSafepointScope no_safepoint;
+    memmove(buffer->data(), OneByteDataStart(str1), len1);
+    buffer->used = len1;
+    external_size = capacity;
+  }
+  {
+    NoSafepointScope no_safepoint;
+    memmove(buffer->data() + len1, OneByteDataStart(str2), len2);
+  }
+  buffer->used = len;
+  AtomicOperations::FetchAndIncrement(&buffer->ref_count);
+  return ExternalOneByteString::New(buffer->data(), len, buffer,
+                                    StringAppendBuffer::Release, external_size,
+                                    space);
+}
+
+bool String::IsAppendString(RawString* raw) {
+  if (!raw->IsHeapObject() ||
+      (raw->GetClassId() != kExternalOneByteStringCid)) {
+    return false;
+  }
+  ExternalStringData<uint8_t>* data =
+      reinterpret_cast<RawExternalOneByteString*>(raw)->ptr()->external_data_;
+  return data->callback() == StringAppendBuffer::Release;
+}
+
 RawString* String::ConcatAll(const Array& strings, Heap::Space space) {
   return ConcatAllRange(strings, 0, strings.Length(), space);
 }
@@ -20448,13 +20647,46 @@ RawString* String::Transform(int32_t (*mapping)(int32_t ch),
   return TwoByteString::Transform(mapping, str, space);
 }
 
+// Case maps an all-ASCII one-byte string a word at a time. Returns NULL if
+// 'str' is not such a string, in which case the generic code point mapping
+// has to be used.
+template <bool kToUpper>
+static RawString* AsciiCaseTransform(const String& str, Heap::Space space) {
+  if (str.CharSize() != String::kOneByteChar) {
+    return String::null();
+  }
+  const intptr_t len = str.Length();
+  {
+    NoSafepointScope no_safepoint;
+    const uint8_t* data = String::OneByteDataStart(str);
+    if (!StringSearch::IsAscii(data, len)) {
+      return String::null();
+    }
+    if (StringSearch::FirstAsciiCaseChange<kToUpper>(data, len) == len) {
+      return str.raw();
+    }
+  }
+  const String& result = String::Handle(OneByteString::New(len, space));
+  NoSafepointScope no_safepoint;
+  uint8_t* dst = const_cast<uint8_t*>(String::OneByteDataStart(result));
+  StringSearch::AsciiCaseCopy<kToUpper>(String::OneByteDataStart(str), dst,
+                                        len);
+  return result.raw();
+}
+
 RawString* String::ToUpperCase(const String& str, Heap::Space space) {
-  // TODO(cshapiro): create a fast-path for OneByteString instances.
+  RawString* result = AsciiCaseTransform<true>(str, space);
+  if (result != String::null()) {
+    return result;
+  }
   return Transform(CaseMapping::ToUpper, str, space);
 }
 
 RawString* String::ToLowerCase(const String& str, Heap::Space space) {
-  // TODO(cshapiro): create a fast-path for OneByteString instances.
+  RawString* result = AsciiCaseTransform<false>(str, space);
+  if (result != String::null()) {
+    return result;
+  }
   return Transform(CaseMapping::ToLower, str, space);
 }
 
@@ -21063,6 +21295,16 @@ RawExternalOneByteString* ExternalOneByteString::New(
     void* peer,
     Dart_PeerFinalizer callback,
     Heap::Space space) {
+  return New(data, len, peer, callback, len, space);
+}
+
+RawExternalOneByteString* ExternalOneByteString::New(
+    const uint8_t* data,
+    intptr_t len,
+    void* peer,
+    Dart_PeerFinalizer callback,
+    intptr_t external_size,
+    Heap::Space space) {
   ASSERT(Isolate::Current()->object_store()->external_one_byte_string_class() !=
          Class::null());
   if (len < 0 || len > kMaxElements) {
@@ -21083,7 +21325,6 @@ RawExternalOneByteString* ExternalOneByteString::New(
     result.SetHash(0);
     SetExternalData(result, external_data);
   }
-  intptr_t external_size = len;
   AddFinalizer(result, external_data, ExternalOneByteString::Finalize,
                external_size);
   return ExternalOneByteString::raw(result);
@@ -21216,10 +21457,15 @@ RawArray* Array::New(intptr_t class_id, intptr_t len, Heap::Space space) {
     FATAL1("Fatal error in Array::New: invalid len %" Pd "\n", len);
   }
   {
-    RawArray* raw = reinterpret_cast<RawArray*>(
-        Object::Allocate(class_id, Array::InstanceSize(len), space));
+    const intptr_t size = Array::InstanceSize(len);
+    RawArray* raw =
+        reinterpret_cast<RawArray*>(Object::Allocate(class_id, size, space));
     NoSafepointScope no_safepoint;
     raw->StoreSmi(&(raw->ptr()->length_), Smi::New(len));
+    if (raw->IsOldObject() && UseCardMarking(size)) {
+      // Scavenges only visit the written parts of the array.
+      raw->SetCardRememberedBitUnsynchronized();
+    }
     return raw;
   }
 }
@@ -22317,6 +22563,24 @@ void RegExp::set_bytecode(bool is_one_byte,
   }
 }
 
+void RegExp::set_code(bool is_one_byte,
+                      bool sticky,
+                      const Code& code) const {
+  if (sticky) {
+    if (is_one_byte) {
+      StorePointer(&raw_ptr()->one_byte_sticky_.code_, code.raw());
+    } else {
+      StorePointer(&raw_ptr()->two_byte_sticky_.code_, code.raw());
+    }
+  } else {
+    if (is_one_byte) {
+      StorePointer(&raw_ptr()->one_byte_.code_, code.raw());
+    } else {
+      StorePointer(&raw_ptr()->two_byte_.code_, code.raw());
+    }
+  }
+}
+
 void RegExp::set_num_bracket_expressions(intptr_t value) const {
   StoreSmi(&raw_ptr()->num_bracket_expressions_, Smi::New(value));
 }
@@ -1313,6 +1313,13 @@ class Class : public Object {
   }
   void set_is_allocated(bool value) const;
 
+  // Whether the fields and functions of this class are still to be read from
+  // a Kernel binary (see KernelLoader::FinishLoading).
+  bool has_pending_kernel_members() const {
+    return PendingKernelMembersBit::decode(raw_ptr()->state_bits_);
+  }
+  void set_has_pending_kernel_members(bool value) const;
+
   uint16_t num_native_fields() const { return raw_ptr()->num_native_fields_; }
   void set_num_native_fields(uint16_t value) const {
     StoreNonPointer(&raw_ptr()->num_native_fields_, value);
@@ -1440,6 +1447,7 @@ class Class : public Object {
     kFieldsMarkedNullableBit = 11,
     kCycleFreeBit = 12,
     kEnumBit = 13,
+    kPendingKernelMembersBit = 14,
     kIsAllocatedBit = 15,
   };
   class ConstBit : public BitField<uint16_t, bool, kConstBit, 1> {};
@@ -1464,6 +1472,8 @@ class Class : public Object {
       : public BitField<uint16_t, bool, kFieldsMarkedNullableBit, 1> {};
   class CycleFreeBit : public BitField<uint16_t, bool, kCycleFreeBit, 1> {};
   class EnumBit : public BitField<uint16_t, bool, kEnumBit, 1> {};
+  class PendingKernelMembersBit
+      : public BitField<uint16_t, bool, kPendingKernelMembersBit, 1> {};
   class IsAllocatedBit : public BitField<uint16_t, bool, kIsAllocatedBit, 1> {};
 
   void set_name(const String& value) const;
@@ -6839,6 +6849,12 @@ class String : public Instance {
 
   intptr_t CharSize() const;
 
+  // Returns the start of the code units of an internal or external string
+  // of the matching width. The result is only valid until the next
+  // safepoint.
+  static const uint8_t* OneByteDataStart(const String& str);
+  static const uint16_t* TwoByteDataStart(const String& str);
+
   inline bool Equals(const String& str) const;
 
   bool Equals(const String& str,
@@ -6878,6 +6894,11 @@ class String : public Instance {
 
   bool StartsWith(const String& other) const;
 
+  // Returns the index of the first (last) occurrence of 'pattern' at or
+  // after (before) 'start', or -1 if there is none.
+  intptr_t IndexOf(const String& pattern, intptr_t start) const;
+  intptr_t LastIndexOf(const String& pattern, intptr_t start) const;
+
   // Strings are canonicalized using the symbol table.
   virtual RawInstance* CheckAndCanonicalize(Thread* thread,
                                             const char** error_str) const;
@@ -6981,6 +7002,18 @@ class String : public Instance {
   static RawString* Concat(const String& str1,
                            const String& str2,
                            Heap::Space space = Heap::kNew);
+  // Like Concat, but meant for building a long string by repeated appending
+  // (s = s + x). Long one-byte results are external strings sharing a buffer
+  // with spare capacity, so appending to the last string built in a buffer
+  // only copies 'str2'.
+  static RawString* ConcatForAppend(const String& str1,
+                                    const String& str2,
+                                    Heap::Space space = Heap::kNew);
+  // Whether this is an external string made by ConcatForAppend. Its
+  // characters belong to the VM, so the embedding API treats it as an
+  // internal string.
+  bool IsAppendString() const { return IsAppendString(raw()); }
+  static bool IsAppendString(RawString* raw);
   static RawString* ConcatAll(const Array& strings,
                               Heap::Space space = Heap::kNew);
   // Concat all strings in 'strings' from 'start' to 'end' (excluding).
@@ -7217,7 +7250,6 @@ class OneByteString : public AllStatic {
   friend class Symbols;
   friend class ExternalOneByteString;
   friend class SnapshotReader;
-  friend class StringHasher;
 };
 
 class TwoByteString : public AllStatic {
@@ -7389,6 +7421,14 @@ class ExternalOneByteString : public AllStatic {
     return &(raw_ptr(str)->external_data_->data()[index]);
   }
 
+  // Reports 'external_size' bytes, rather than 'len', to the heap.
+  static RawExternalOneByteString* New(const uint8_t* characters,
+                                       intptr_t len,
+                                       void* peer,
+                                       Dart_PeerFinalizer callback,
+                                       intptr_t external_size,
+                                       Heap::Space space);
+
   static void SetExternalData(const String& str,
                               ExternalStringData<uint8_t>* data) {
     ASSERT(str.IsExternalOneByteString());
@@ -7593,6 +7633,14 @@ class Array : public Instance {
     return RoundedAllocationSize(sizeof(RawArray) + (len * kBytesPerElement));
   }
 
+  // Whether an old-space array of |size| bytes is card remembered (see
+  // RawObject::IsCardRemembered). Arrays this large are alone on a large
+  // page, whose card table remembers their slots pointing to new space.
+  // Arrays in new space are not card remembered until they are promoted.
+  static bool UseCardMarking(intptr_t size) {
+    return size >= PageSpace::kAllocatablePageSize;
+  }
+
   // Returns true if all elements are OK for canonicalization.
   virtual bool CheckAndCanonicalizeFields(Thread* thread,
                                           const char** error_str) const;
@@ -8597,6 +8645,16 @@ class RegExp : public Instance {
     }
   }
 
+  RawCode* code(bool is_one_byte, bool sticky) const {
+    if (sticky) {
+      return is_one_byte ? raw_ptr()->one_byte_sticky_.code_
+                         : raw_ptr()->two_byte_sticky_.code_;
+    } else {
+      return is_one_byte ? raw_ptr()->one_byte_.code_
+                         : raw_ptr()->two_byte_.code_;
+    }
+  }
+
   static intptr_t function_offset(intptr_t cid, bool sticky) {
     if (sticky) {
       switch (cid) {
@@ -8640,6 +8698,7 @@ class RegExp : public Instance {
   void set_bytecode(bool is_one_byte,
                     bool sticky,
                     const TypedData& bytecode) const;
+  void set_code(bool is_one_byte, bool sticky, const Code& code) const;
 
   void set_num_bracket_expressions(intptr_t value) const;
   void set_is_global() const { set_flags(flags() | kGlobal); }
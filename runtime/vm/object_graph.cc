@@ -506,24 +506,111 @@ intptr_t ObjectGraph::InboundReferences(Object* obj, const Array& references) {
   return visitor.length();
 }
 
-static void WritePtr(RawObject* raw, WriteStream* stream) {
-  ASSERT(raw->IsHeapObject());
-  ASSERT(raw->IsOldObject());
-  uword addr = RawObject::ToAddr(raw);
-  ASSERT(Utils::IsAligned(addr, kObjectAlignment));
-  // Using units of kObjectAlignment makes the ids fit into Smis when parsed
-  // in the Dart code of the Observatory.
-  // TODO(koda): Use delta-encoding/back-references to further compress this.
-  stream->WriteUnsigned(addr / kObjectAlignment);
-}
+// Writes the nodes of a serialized object graph, either to a stream holding
+// the whole graph, or in chunks to a Dart_StreamConsumer.
+class GraphWriter : public ValueObject {
+ public:
+  explicit GraphWriter(WriteStream* stream)
+      : stream_(stream),
+        consumer_(NULL),
+        user_data_(NULL),
+        delta_encoded_(false),
+        last_id_(0) {}
+
+  GraphWriter(WriteStream* stream,
+              Dart_StreamConsumer consumer,
+              void* user_data)
+      : stream_(stream),
+        consumer_(consumer),
+        user_data_(user_data),
+        delta_encoded_(true),
+        last_id_(0) {}
+
+  void WriteUnsigned(intptr_t value) {
+    stream_->WriteUnsigned(value);
+    if ((consumer_ != NULL) &&
+        (stream_->bytes_written() >= ObjectGraph::kStreamChunkSize)) {
+      Flush();
+    }
+  }
+
+  void WriteString(const char* str) {
+    const intptr_t length = strlen(str);
+    WriteUnsigned(length);
+    stream_->WriteBytes(reinterpret_cast<const uint8_t*>(str), length);
+  }
+
+  // The id of a node, or of the object of an external size.
+  void WriteId(RawObject* raw) {
+    const intptr_t id = IdOf(raw);
+    if (delta_encoded_) {
+      WriteDelta(id - last_id_);
+      last_id_ = id;
+    } else {
+      WriteUnsigned(id);
+    }
+  }
+
+  // The id of a neighbor of the last node written.
+  void WriteReference(RawObject* raw) {
+    const intptr_t id = IdOf(raw);
+    if (delta_encoded_) {
+      WriteDelta(id - last_id_);
+    } else {
+      WriteUnsigned(id);
+    }
+  }
+
+  void WriteHeader(RawObject* raw, intptr_t size, intptr_t cid) {
+    WriteId(raw);
+    ASSERT(Utils::IsAligned(size, kObjectAlignment));
+    WriteUnsigned(size);
+    WriteUnsigned(cid);
+  }
+
+  void Flush() {
+    ASSERT(consumer_ != NULL);
+    if (stream_->bytes_written() > 0) {
+      consumer_(Dart_StreamConsumer_kData, "heap_snapshot", stream_->buffer(),
+                stream_->bytes_written(), user_data_);
+      stream_->set_current(stream_->buffer());
+    }
+  }
+
+ private:
+  static intptr_t IdOf(RawObject* raw) {
+    ASSERT(raw->IsHeapObject());
+    ASSERT(raw->IsOldObject());
+    uword addr = RawObject::ToAddr(raw);
+    ASSERT(Utils::IsAligned(addr, kObjectAlignment));
+    // Using units of kObjectAlignment makes the ids fit into Smis when parsed
+    // in the Dart code of the Observatory.
+    return addr / kObjectAlignment;
+  }
+
+  void WriteDelta(intptr_t delta) {
+    // Zigzag encoding, shifted by one to keep 0 as the list terminator.
+    const uword zigzag = (static_cast<uword>(delta) << 1) ^
+                         static_cast<uword>(delta >> (kBitsPerWord - 1));
+    WriteUnsigned(static_cast<intptr_t>(zigzag + 1));
+  }
+
+  WriteStream* stream_;
+  Dart_StreamConsumer consumer_;
+  void* user_data_;
+  const bool delta_encoded_;
+  intptr_t last_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(GraphWriter);
+};
 
 class WritePointerVisitor : public ObjectPointerVisitor {
  public:
   WritePointerVisitor(Isolate* isolate,
-                      WriteStream* stream,
+                      GraphWriter* writer,
                       bool only_instances)
       : ObjectPointerVisitor(isolate),
-        stream_(stream),
+        writer_(writer),
         only_instances_(only_instances),
         count_(0) {}
   virtual void VisitPointers(RawObject** first, RawObject** last) {
@@ -539,7 +626,7 @@ class WritePointerVisitor : public ObjectPointerVisitor {
                               (object->GetClassId() == kTypeArgumentsCid))) {
         continue;
       }
-      WritePtr(object, stream_);
+      writer_->WriteReference(object);
       ++count_;
     }
   }
@@ -547,28 +634,18 @@ class WritePointerVisitor : public ObjectPointerVisitor {
   intptr_t count() const { return count_; }
 
  private:
-  WriteStream* stream_;
+  GraphWriter* writer_;
   bool only_instances_;
   intptr_t count_;
 };
 
-static void WriteHeader(RawObject* raw,
-                        intptr_t size,
-                        intptr_t cid,
-                        WriteStream* stream) {
-  WritePtr(raw, stream);
-  ASSERT(Utils::IsAligned(size, kObjectAlignment));
-  stream->WriteUnsigned(size);
-  stream->WriteUnsigned(cid);
-}
-
 class WriteGraphVisitor : public ObjectGraph::Visitor {
  public:
   WriteGraphVisitor(Isolate* isolate,
-                    WriteStream* stream,
+                    GraphWriter* writer,
                     ObjectGraph::SnapshotRoots roots)
-      : stream_(stream),
-        ptr_writer_(isolate, stream, roots == ObjectGraph::kUser),
+      : writer_(writer),
+        ptr_writer_(isolate, writer, roots == ObjectGraph::kUser),
         roots_(roots),
         count_(0) {}
 
@@ -581,9 +658,9 @@ class WriteGraphVisitor : public ObjectGraph::Visitor {
     if ((roots_ == ObjectGraph::kVM) || obj.IsField() || obj.IsInstance() ||
         obj.IsContext()) {
       // Each object is a header + a zero-terminated list of its neighbors.
-      WriteHeader(raw_obj, raw_obj->Size(), obj.GetClassId(), stream_);
+      writer_->WriteHeader(raw_obj, raw_obj->Size(), obj.GetClassId());
       raw_obj->VisitPointers(&ptr_writer_);
-      stream_->WriteUnsigned(0);
+      writer_->WriteUnsigned(0);
       ++count_;
     }
     return kProceed;
@@ -592,7 +669,7 @@ class WriteGraphVisitor : public ObjectGraph::Visitor {
   intptr_t count() const { return count_; }
 
  private:
-  WriteStream* stream_;
+  GraphWriter* writer_;
   WritePointerVisitor ptr_writer_;
   ObjectGraph::SnapshotRoots roots_;
   intptr_t count_;
@@ -600,8 +677,8 @@ class WriteGraphVisitor : public ObjectGraph::Visitor {
 
 class WriteGraphExternalSizesVisitor : public HandleVisitor {
  public:
-  WriteGraphExternalSizesVisitor(Thread* thread, WriteStream* stream)
-      : HandleVisitor(thread), stream_(stream) {}
+  WriteGraphExternalSizesVisitor(Thread* thread, GraphWriter* writer)
+      : HandleVisitor(thread), writer_(writer) {}
 
   void VisitHandle(uword addr) {
     FinalizablePersistentHandle* weak_persistent_handle =
@@ -610,17 +687,91 @@ class WriteGraphExternalSizesVisitor : public HandleVisitor {
       return;  // Free handle.
     }
 
-    WritePtr(weak_persistent_handle->raw(), stream_);
-    stream_->WriteUnsigned(weak_persistent_handle->external_size());
+    writer_->WriteId(weak_persistent_handle->raw());
+    writer_->WriteUnsigned(weak_persistent_handle->external_size());
   }
 
  private:
-  WriteStream* stream_;
+  GraphWriter* writer_;
 };
 
 intptr_t ObjectGraph::Serialize(WriteStream* stream,
                                 SnapshotRoots roots,
                                 bool collect_garbage) {
+  GraphWriter writer(stream);
+  return SerializeGraph(&writer, roots, collect_garbage);
+}
+
+static uint8_t* ReallocBuffer(uint8_t* ptr,
+                              intptr_t old_size,
+                              intptr_t new_size) {
+  void* new_ptr = realloc(reinterpret_cast<void*>(ptr), new_size);
+  if (new_ptr == NULL) {
+    OUT_OF_MEMORY();
+  }
+  return reinterpret_cast<uint8_t*>(new_ptr);
+}
+
+intptr_t ObjectGraph::Serialize(Dart_StreamConsumer consumer,
+                                void* user_data,
+                                SnapshotRoots roots,
+                                bool collect_garbage) {
+  ASSERT(consumer != NULL);
+  uint8_t* buffer = NULL;
+  // Chunks are flushed once they reach kStreamChunkSize, leave room for the
+  // value that crosses the limit.
+  WriteStream stream(&buffer, ReallocBuffer, kStreamChunkSize + KB);
+  GraphWriter writer(&stream, consumer, user_data);
+  consumer(Dart_StreamConsumer_kStart, "heap_snapshot", NULL, 0, user_data);
+  writer.WriteUnsigned(kStreamVersion);
+  SerializeClassTable(&writer);
+  const intptr_t object_count = SerializeGraph(&writer, roots, collect_garbage);
+  writer.Flush();
+  consumer(Dart_StreamConsumer_kFinish, "heap_snapshot", NULL, 0, user_data);
+  free(buffer);
+  return object_count;
+}
+
+void ObjectGraph::SerializeClassTable(GraphWriter* writer) {
+  Zone* zone = thread()->zone();
+  // The libraries, each url is written once.
+  const GrowableObjectArray& libraries = GrowableObjectArray::Handle(
+      zone, isolate()->object_store()->libraries());
+  Library& library = Library::Handle(zone);
+  String& str = String::Handle(zone);
+  writer->WriteUnsigned(libraries.Length());
+  for (intptr_t i = 0; i < libraries.Length(); i++) {
+    library ^= libraries.At(i);
+    str = library.url();
+    writer->WriteString(str.ToCString());
+  }
+
+  // The classes, with the index of their library plus one, or 0.
+  ClassTable* class_table = isolate()->class_table();
+  Class& cls = Class::Handle(zone);
+  intptr_t class_count = 0;
+  for (intptr_t cid = 1; cid < class_table->NumCids(); cid++) {
+    if (class_table->HasValidClassAt(cid)) {
+      class_count++;
+    }
+  }
+  writer->WriteUnsigned(class_count);
+  for (intptr_t cid = 1; cid < class_table->NumCids(); cid++) {
+    if (!class_table->HasValidClassAt(cid)) {
+      continue;
+    }
+    cls = class_table->At(cid);
+    writer->WriteUnsigned(cid);
+    str = cls.Name();
+    writer->WriteString(str.ToCString());
+    library = cls.library();
+    writer->WriteUnsigned(library.IsNull() ? 0 : library.index() + 1);
+  }
+}
+
+intptr_t ObjectGraph::SerializeGraph(GraphWriter* writer,
+                                     SnapshotRoots roots,
+                                     bool collect_garbage) {
   if (collect_garbage) {
     isolate()->heap()->CollectAllGarbage();
   }
@@ -633,43 +784,43 @@ intptr_t ObjectGraph::Serialize(WriteStream* stream,
   RawObject* kStackAddress =
       reinterpret_cast<RawObject*>(kObjectAlignment + kHeapObjectTag);
 
-  stream->WriteUnsigned(kObjectAlignment);
-  stream->WriteUnsigned(kStackCid);
-  stream->WriteUnsigned(kFieldCid);
-  stream->WriteUnsigned(isolate()->class_table()->NumCids());
+  writer->WriteUnsigned(kObjectAlignment);
+  writer->WriteUnsigned(kStackCid);
+  writer->WriteUnsigned(kFieldCid);
+  writer->WriteUnsigned(isolate()->class_table()->NumCids());
 
   if (roots == kVM) {
     // Write root "object".
-    WriteHeader(kRootAddress, 0, kRootCid, stream);
-    WritePointerVisitor ptr_writer(isolate(), stream, false);
+    writer->WriteHeader(kRootAddress, 0, kRootCid);
+    WritePointerVisitor ptr_writer(isolate(), writer, false);
     isolate()->VisitObjectPointers(&ptr_writer, false);
-    stream->WriteUnsigned(0);
+    writer->WriteUnsigned(0);
   } else {
     {
       // Write root "object".
-      WriteHeader(kRootAddress, 0, kRootCid, stream);
-      WritePointerVisitor ptr_writer(isolate(), stream, false);
+      writer->WriteHeader(kRootAddress, 0, kRootCid);
+      WritePointerVisitor ptr_writer(isolate(), writer, false);
       IterateUserFields(&ptr_writer);
-      WritePtr(kStackAddress, stream);
-      stream->WriteUnsigned(0);
+      writer->WriteReference(kStackAddress);
+      writer->WriteUnsigned(0);
     }
 
     {
       // Write stack "object".
-      WriteHeader(kStackAddress, 0, kStackCid, stream);
-      WritePointerVisitor ptr_writer(isolate(), stream, true);
+      writer->WriteHeader(kStackAddress, 0, kStackCid);
+      WritePointerVisitor ptr_writer(isolate(), writer, true);
       isolate()->VisitStackPointers(&ptr_writer, false);
-      stream->WriteUnsigned(0);
+      writer->WriteUnsigned(0);
     }
   }
 
-  WriteGraphVisitor visitor(isolate(), stream, roots);
+  WriteGraphVisitor visitor(isolate(), writer, roots);
   IterateObjects(&visitor);
-  stream->WriteUnsigned(0);
+  writer->WriteUnsigned(0);
 
-  WriteGraphExternalSizesVisitor external_visitor(Thread::Current(), stream);
+  WriteGraphExternalSizesVisitor external_visitor(Thread::Current(), writer);
   isolate()->VisitWeakPersistentHandles(&external_visitor);
-  stream->WriteUnsigned(0);
+  writer->WriteUnsigned(0);
 
   intptr_t object_count = visitor.count();
   if (roots == kVM) {
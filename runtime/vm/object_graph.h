@@ -5,11 +5,14 @@
 #ifndef RUNTIME_VM_OBJECT_GRAPH_H_
 #define RUNTIME_VM_OBJECT_GRAPH_H_
 
+#include "include/dart_tools_api.h"
+
 #include "vm/allocation.h"
 
 namespace dart {
 
 class Array;
+class GraphWriter;
 class Isolate;
 class Object;
 class RawObject;
@@ -108,7 +111,32 @@ class ObjectGraph : public StackResource {
                      SnapshotRoots roots,
                      bool collect_garbage);
 
+  // Like Serialize, but hands the graph to |consumer| in chunks of about
+  // kStreamChunkSize bytes as it is written, so memory use does not grow
+  // with the size of the heap. Returns the number of nodes.
+  //
+  // The stream starts with kStreamVersion and tables of the libraries and
+  // classes of the isolate, so that nodes only refer to them by index. The
+  // nodes and external sizes follow in the format of Serialize, except
+  // that object ids are delta encoded: the id of a node or an external
+  // size is relative to the id written before it, and the ids of the
+  // neighbors of a node are relative to the id of the node. Deltas are
+  // written as zigzag encoded unsigned values plus one, so that 0 still
+  // terminates lists.
+  intptr_t Serialize(Dart_StreamConsumer consumer,
+                     void* user_data,
+                     SnapshotRoots roots,
+                     bool collect_garbage);
+
+  static const intptr_t kStreamVersion = 1;
+  static const intptr_t kStreamChunkSize = 1 * MB;
+
  private:
+  intptr_t SerializeGraph(GraphWriter* writer,
+                          SnapshotRoots roots,
+                          bool collect_garbage);
+  void SerializeClassTable(GraphWriter* writer);
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(ObjectGraph);
 };
 
@@ -4,6 +4,7 @@
 
 #include "vm/object_graph.h"
 #include "platform/assert.h"
+#include "vm/datastream.h"
 #include "vm/unit_test.h"
 
 namespace dart {
@@ -138,4 +139,67 @@ ISOLATE_UNIT_TEST_CASE(ObjectGraph) {
   }
 }
 
+struct SnapshotOutput {
+  SnapshotOutput() : starts(0), finishes(0), max_chunk(0) {}
+
+  MallocGrowableArray<uint8_t> bytes;
+  intptr_t starts;
+  intptr_t finishes;
+  intptr_t max_chunk;
+};
+
+static void SnapshotConsumer(Dart_StreamConsumer_State state,
+                             const char* stream_name,
+                             const uint8_t* buffer,
+                             intptr_t buffer_length,
+                             void* user_data) {
+  SnapshotOutput* output = reinterpret_cast<SnapshotOutput*>(user_data);
+  if (state == Dart_StreamConsumer_kStart) {
+    output->starts++;
+  } else if (state == Dart_StreamConsumer_kFinish) {
+    output->finishes++;
+  } else {
+    for (intptr_t i = 0; i < buffer_length; i++) {
+      output->bytes.Add(buffer[i]);
+    }
+    output->max_chunk = Utils::Maximum(output->max_chunk, buffer_length);
+  }
+}
+
+static uint8_t* SnapshotAllocator(uint8_t* ptr,
+                                  intptr_t old_size,
+                                  intptr_t new_size) {
+  return reinterpret_cast<uint8_t*>(realloc(ptr, new_size));
+}
+
+ISOLATE_UNIT_TEST_CASE(ObjectGraph_StreamSerialize) {
+  Array& a = Array::Handle(Array::New(2, Heap::kOld));
+  Array& b = Array::Handle(Array::New(0, Heap::kOld));
+  a.SetAt(0, b);
+  a.SetAt(1, a);
+
+  ObjectGraph graph(thread);
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, SnapshotAllocator, KB);
+  const intptr_t node_count =
+      graph.Serialize(&stream, ObjectGraph::kVM, false);
+
+  SnapshotOutput output;
+  EXPECT_EQ(node_count, graph.Serialize(SnapshotConsumer, &output,
+                                        ObjectGraph::kVM, false));
+  EXPECT_EQ(1, output.starts);
+  EXPECT_EQ(1, output.finishes);
+  EXPECT_LE(output.max_chunk, ObjectGraph::kStreamChunkSize + KB);
+  // Delta encoded ids are smaller than absolute ones, even with the tables
+  // of libraries and classes.
+  EXPECT_LT(output.bytes.length(), stream.bytes_written());
+
+  ReadStream read_stream(output.bytes.data(), output.bytes.length());
+  EXPECT_EQ(ObjectGraph::kStreamVersion, read_stream.ReadUnsigned());
+  const GrowableObjectArray& libraries = GrowableObjectArray::Handle(
+      thread->isolate()->object_store()->libraries());
+  EXPECT_EQ(libraries.Length(), read_stream.ReadUnsigned());
+  free(buffer);
+}
+
 }  // namespace dart
@@ -6,6 +6,7 @@
 #include "vm/debugger.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
+#include "vm/regexp_assembler_native.h"
 #include "vm/stub_code.h"
 #include "vm/symbols.h"
 #include "vm/type_table.h"
@@ -1451,7 +1452,17 @@ void RegExp::PrintJSONImpl(JSONStream* stream, bool ref) const {
   jsobj.AddProperty("isCaseSensitive", !is_ignore_case());
   jsobj.AddProperty("isMultiLine", is_multi_line());
 
-  if (!FLAG_interpret_irregexp) {
+  if (NativeRegExpMacroAssembler::IsEnabled()) {
+    Code& code = Code::Handle();
+    code = this->code(/*is_one_byte=*/true, /*sticky=*/false);
+    jsobj.AddProperty("_oneByteCode", code);
+    code = this->code(/*is_one_byte=*/false, /*sticky=*/false);
+    jsobj.AddProperty("_twoByteCode", code);
+    code = this->code(/*is_one_byte=*/true, /*sticky=*/true);
+    jsobj.AddProperty("_oneByteCodeSticky", code);
+    code = this->code(/*is_one_byte=*/false, /*sticky=*/true);
+    jsobj.AddProperty("_twoByteCodeSticky", code);
+  } else if (!FLAG_interpret_irregexp) {
     Function& func = Function::Handle();
     func = function(kOneByteStringCid, /*sticky=*/false);
     jsobj.AddProperty("_oneByteFunction", func);
@@ -108,7 +108,8 @@ ObjectStore::ObjectStore()
       megamorphic_miss_code_(Code::null()),
       megamorphic_miss_function_(Function::null()),
       obfuscation_map_(Array::null()),
-      changed_in_last_reload_(GrowableObjectArray::null()) {
+      changed_in_last_reload_(GrowableObjectArray::null()),
+      lazy_kernel_classes_(Array::null()) {
   for (RawObject** current = from(); current <= to(); current++) {
     ASSERT(*current == Object::null());
   }
@@ -420,6 +420,11 @@ class ObjectStore {
     changed_in_last_reload_ = value.raw();
   }
 
+  RawArray* lazy_kernel_classes() const { return lazy_kernel_classes_; }
+  void set_lazy_kernel_classes(const Array& value) {
+    lazy_kernel_classes_ = value.raw();
+  }
+
   RawGrowableObjectArray* megamorphic_cache_table() const {
     return megamorphic_cache_table_;
   }
@@ -602,6 +607,7 @@ class ObjectStore {
   V(RawFunction*, megamorphic_miss_function_)                                  \
   V(RawArray*, obfuscation_map_)                                               \
   V(RawGrowableObjectArray*, changed_in_last_reload_)                          \
+  V(RawArray*, lazy_kernel_classes_)                                           \
   // Please remember the last entry must be referred in the 'to' function below.
 
   RawObject** from() { return reinterpret_cast<RawObject**>(&object_class_); }
@@ -609,7 +615,7 @@ class ObjectStore {
   OBJECT_STORE_FIELD_LIST(DECLARE_OBJECT_STORE_FIELD)
 #undef DECLARE_OBJECT_STORE_FIELD
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&changed_in_last_reload_);
+    return reinterpret_cast<RawObject**>(&lazy_kernel_classes_);
   }
   RawObject** to_snapshot(Snapshot::Kind kind) {
     switch (kind) {
@@ -1348,6 +1348,83 @@ ISOLATE_UNIT_TEST_CASE(StringConcat) {
   }
 }
 
+ISOLATE_UNIT_TEST_CASE(StringConcatForAppend) {
+  const intptr_t kPrefixLength = 300;
+  char* chars = thread->zone()->Alloc<char>(kPrefixLength + 3);
+  memset(chars, 'a', kPrefixLength);
+
+  // Short strings are concatenated as usual.
+  const String& a = String::Handle(String::New("a"));
+  String& str = String::Handle(String::ConcatForAppend(a, a));
+  EXPECT(str.IsOneByteString());
+  EXPECT(str.Equals("aa"));
+
+  // Appending to a long string moves it into a buffer.
+  chars[kPrefixLength] = '\0';
+  const String& prefix = String::Handle(String::New(chars));
+  const String& b = String::Handle(String::New("b"));
+  const String& c = String::Handle(String::New("c"));
+  const String& prefix_b =
+      String::Handle(String::ConcatForAppend(prefix, b, Heap::kOld));
+  EXPECT(prefix_b.IsExternalOneByteString());
+  EXPECT(prefix_b.IsAppendString());
+  EXPECT(!prefix.IsAppendString());
+  chars[kPrefixLength] = 'b';
+  chars[kPrefixLength + 1] = '\0';
+  EXPECT(prefix_b.Equals(chars));
+
+  // Appending to the last string of the buffer shares its characters.
+  const String& prefix_bc =
+      String::Handle(String::ConcatForAppend(prefix_b, c, Heap::kOld));
+  EXPECT(prefix_bc.IsExternalOneByteString());
+  chars[kPrefixLength + 1] = 'c';
+  EXPECT(prefix_bc.Equals(chars));
+  {
+    NoSafepointScope no_safepoint;
+    EXPECT_EQ(String::OneByteDataStart(prefix_b),
+              String::OneByteDataStart(prefix_bc));
+  }
+
+  // Appending to an earlier string of the buffer copies it, and leaves the
+  // strings sharing the buffer unchanged.
+  const String& prefix_bb =
+      String::Handle(String::ConcatForAppend(prefix_b, b, Heap::kOld));
+  EXPECT(prefix_bb.IsExternalOneByteString());
+  {
+    NoSafepointScope no_safepoint;
+    EXPECT(String::OneByteDataStart(prefix_b) !=
+           String::OneByteDataStart(prefix_bb));
+  }
+  chars[kPrefixLength + 1] = 'b';
+  EXPECT(prefix_bb.Equals(chars));
+  chars[kPrefixLength + 1] = 'c';
+  EXPECT(prefix_bc.Equals(chars));
+  chars[kPrefixLength + 1] = '\0';
+  EXPECT(prefix_b.Equals(chars));
+
+  // Repeated appending produces the concatenation.
+  str = prefix.raw();
+  for (intptr_t i = 0; i < 1000; i++) {
+    str = String::ConcatForAppend(str, (i % 2) == 0 ? b : c);
+  }
+  EXPECT(str.IsExternalOneByteString());
+  EXPECT_EQ(kPrefixLength + 1000, str.Length());
+  for (intptr_t i = 0; i < 1000; i++) {
+    EXPECT_EQ((i % 2) == 0 ? 'b' : 'c', str.CharAt(kPrefixLength + i));
+  }
+  const String& head =
+      String::Handle(String::SubString(str, 0, kPrefixLength + 2));
+  EXPECT(prefix_bc.Equals(head));
+
+  // Two-byte strings are concatenated as usual.
+  const uint16_t two_byte[] = {0x1234};
+  const String& two = String::Handle(String::FromUTF16(two_byte, 1));
+  str = String::ConcatForAppend(prefix_bc, two);
+  EXPECT(str.IsTwoByteString());
+  EXPECT_EQ(kPrefixLength + 3, str.Length());
+  EXPECT_EQ(0x1234, str.CharAt(kPrefixLength + 2));
+}
+
 ISOLATE_UNIT_TEST_CASE(StringHashConcat) {
   EXPECT_EQ(String::Handle(String::New("onebyte")).Hash(),
             String::HashConcat(String::Handle(String::New("one")),
@@ -4529,6 +4606,58 @@ TEST_CASE(LinkedHashMap_iteration) {
   EXPECT(!iterator.MoveNext());
 }
 
+TEST_CASE(LinkedHashMap_rehash) {
+  // Growing and compacting maps moves their entries in the VM where it can.
+  // Check that lookups and iteration order survive it for keys whose hash
+  // codes the VM knows, keys with a user defined hashCode, and a mix.
+  const char* kScript =
+      "class Key {\n"
+      "  final int id;\n"
+      "  Key(this.id);\n"
+      "  int get hashCode => id == 7 ? 0 : id * 31;\n"
+      "  bool operator ==(other) => other is Key && other.id == id;\n"
+      "}\n"
+      "check(List keys) {\n"
+      "  var map = {};\n"
+      "  for (int i = 0; i < keys.length; i++) {\n"
+      "    map[keys[i]] = i;\n"
+      "    if (i % 3 == 0) map.remove(keys[i ~/ 2]);\n"
+      "  }\n"
+      "  var expected = [];\n"
+      "  for (int i = 0; i < keys.length; i++) {\n"
+      "    if (map.containsKey(keys[i])) {\n"
+      "      if (map[keys[i]] != i) return false;\n"
+      "      expected.add(keys[i]);\n"
+      "    }\n"
+      "  }\n"
+      "  var actual = map.keys.toList();\n"
+      "  if (actual.length != expected.length) return false;\n"
+      "  for (int i = 0; i < actual.length; i++) {\n"
+      "    if (!identical(actual[i], expected[i])) return false;\n"
+      "  }\n"
+      "  return true;\n"
+      "}\n"
+      "test() {\n"
+      "  const n = 5000;\n"
+      "  var ints = new List.generate(n, (i) => i * 7 - 100);\n"
+      "  var mints = new List.generate(n, (i) => (i << 40) + i);\n"
+      "  var strings = new List.generate(n, (i) => 'key$i');\n"
+      "  var keys = new List.generate(n, (i) => new Key(i));\n"
+      "  var mixed =\n"
+      "      new List.generate(n, (i) => [i, 'm$i', new Key(i)][i % 3]);\n"
+      "  var literal = {1: 'a', 2: 'b', 3: 'c', 4: 'd', 5: 'e', 6: 'f',\n"
+      "                 7: 'g', 8: 'h', 9: 'i', 10: 'j', 11: 'k', 12: 'l'};\n"
+      "  return check(ints) && check(mints) && check(strings) &&\n"
+      "      check(keys) && check(mixed) && literal.length == 12 &&\n"
+      "      literal[12] == 'l' && literal.keys.first == 1;\n"
+      "}";
+  Dart_Handle h_lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(h_lib);
+  Dart_Handle h_result = Dart_Invoke(h_lib, NewString("test"), 0, NULL);
+  EXPECT_VALID(h_result);
+  EXPECT(Api::UnwrapHandle(h_result) == Bool::True().raw());
+}
+
 static void CheckConcatAll(const String* data[], intptr_t n) {
   Thread* thread = Thread::Current();
   Zone* zone = thread->zone();
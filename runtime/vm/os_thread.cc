@@ -31,6 +31,7 @@ OSThread::OSThread()
       name_(NULL),
       timeline_block_lock_(new Mutex()),
       timeline_block_(NULL),
+      timeline_records_(NULL),
       thread_list_next_(NULL),
       thread_interrupt_disabled_(1),  // Thread interrupts disabled by default.
       log_(new class Log()),
@@ -55,10 +56,11 @@ OSThread::~OSThread() {
   log_ = NULL;
   if (FLAG_support_timeline) {
     if (Timeline::recorder() != NULL) {
-      Timeline::recorder()->FinishBlock(timeline_block_);
+      Timeline::recorder()->ReleaseThreadBuffers(this);
     }
   }
   timeline_block_ = NULL;
+  timeline_records_ = NULL;
   delete timeline_block_lock_;
   free(name_);
 }
@@ -31,6 +31,7 @@ class Log;
 class Mutex;
 class Thread;
 class TimelineEventBlock;
+class TimelineRecordBuffer;
 
 class BaseThread {
  public:
@@ -90,6 +91,14 @@ class OSThread : public BaseThread {
     timeline_block_ = block;
   }
 
+  // Only safe to access when holding |timeline_block_lock_|.
+  TimelineRecordBuffer* timeline_records() const { return timeline_records_; }
+
+  // Only safe to access when holding |timeline_block_lock_|.
+  void set_timeline_records(TimelineRecordBuffer* records) {
+    timeline_records_ = records;
+  }
+
   Log* log() const { return log_; }
 
   uword stack_base() const { return stack_base_; }
@@ -230,6 +239,7 @@ class OSThread : public BaseThread {
 
   Mutex* timeline_block_lock_;
   TimelineEventBlock* timeline_block_;
+  TimelineRecordBuffer* timeline_records_;
 
   // All |Thread|s are registered in the thread list.
   OSThread* thread_list_next_;
@@ -303,6 +313,7 @@ class Mutex {
   friend class SafepointMutexLocker;
   friend class OSThreadIterator;
   friend class TimelineEventBlockIterator;
+  friend class TimelineEventFileRecorder;
   friend class TimelineEventRecorder;
   friend class PageSpace;
   friend void Dart_TestMutex();
@@ -14,6 +14,7 @@
 #include "vm/object_set.h"
 #include "vm/os_thread.h"
 #include "vm/safepoint.h"
+#include "vm/thread_registry.h"
 #include "vm/virtual_memory.h"
 
 namespace dart {
@@ -30,6 +31,11 @@ DEFINE_FLAG(int,
             old_gen_growth_rate,
             280,
             "The max number of pages the old generation can grow at a time");
+DEFINE_FLAG(int,
+            old_gen_thread_buffer_kb,
+            16,
+            "Size of the per-thread buffers small old-space objects are bump "
+            "allocated in, or 0 to allocate them from the freelist.");
 DEFINE_FLAG(bool,
             print_free_list_before_gc,
             false,
@@ -51,6 +57,14 @@ DEFINE_FLAG(bool,
             false,
             "Always try to drop code if the function's usage counter is >= 0");
 DEFINE_FLAG(bool, log_growth, false, "Log PageSpace growth policy decisions.");
+DEFINE_FLAG(bool,
+            incremental_marking,
+            false,
+            "Mark old space incrementally in idle time when a mark-sweep does "
+            "not fit the idle deadline. Only supported on Linux. Each marking "
+            "step clears the soft-dirty page bits of the whole process, which "
+            "breaks other users of these bits in the process, and makes the "
+            "next write to each page fault.");
 
 HeapPage* HeapPage::Initialize(VirtualMemory* memory,
                                PageType type,
@@ -69,6 +83,7 @@ HeapPage* HeapPage::Initialize(VirtualMemory* memory,
   result->next_ = NULL;
   result->used_in_bytes_ = 0;
   result->type_ = type;
+  result->card_table_ = NULL;
 
   LSAN_REGISTER_ROOT_REGION(result, sizeof(*result));
 
@@ -78,8 +93,8 @@ HeapPage* HeapPage::Initialize(VirtualMemory* memory,
 HeapPage* HeapPage::Allocate(intptr_t size_in_words,
                              PageType type,
                              const char* name) {
-  VirtualMemory* memory =
-      VirtualMemory::Reserve(size_in_words << kWordSizeLog2);
+  VirtualMemory* memory = VirtualMemory::ReserveHeap(
+      size_in_words << kWordSizeLog2, type == kExecutable);
   if (memory == NULL) {
     return NULL;
   }
@@ -94,6 +109,9 @@ HeapPage* HeapPage::Allocate(intptr_t size_in_words,
 void HeapPage::Deallocate() {
   bool image_page = is_image_page();
 
+  free(card_table_);
+  card_table_ = NULL;
+
   if (!image_page) {
     LSAN_UNREGISTER_ROOT_REGION(this, sizeof(*this));
   }
@@ -109,6 +127,42 @@ void HeapPage::Deallocate() {
   }
 }
 
+intptr_t HeapPage::VisitRememberedCards(ObjectPointerVisitor* visitor) {
+  ASSERT(HasCardRememberedObject());
+  const uword base = reinterpret_cast<uword>(this);
+  const uword obj_addr = object_start();
+  RawObject* raw_obj = RawObject::FromAddr(obj_addr);
+  ASSERT(raw_obj->IsArray() || raw_obj->IsImmutableArray());
+  RawSmi* raw_length =
+      *reinterpret_cast<RawSmi**>(obj_addr + Array::length_offset());
+  const intptr_t length = Smi::Value(raw_length);
+  RawObject** obj_from =
+      reinterpret_cast<RawObject**>(obj_addr + Array::type_arguments_offset());
+  RawObject** obj_to = reinterpret_cast<RawObject**>(
+      obj_addr + Array::data_offset() + (length - 1) * kWordSize);
+  const intptr_t first_card =
+      (reinterpret_cast<uword>(obj_from) - base) >> kBytesPerCardLog2;
+  const intptr_t last_card =
+      (reinterpret_cast<uword>(obj_to) - base) >> kBytesPerCardLog2;
+  intptr_t marked_cards = 0;
+  for (intptr_t i = first_card; i <= last_card; i++) {
+    if (card_table_[i] == 0) {
+      continue;
+    }
+    // The visitor marks the card again if it still points to new space.
+    card_table_[i] = 0;
+    marked_cards++;
+    RawObject** card_from =
+        reinterpret_cast<RawObject**>(base + (i << kBytesPerCardLog2));
+    RawObject** card_to =
+        reinterpret_cast<RawObject**>(base + ((i + 1) << kBytesPerCardLog2)) -
+        1;
+    visitor->VisitPointers(Utils::Maximum(card_from, obj_from),
+                           Utils::Minimum(card_to, obj_to));
+  }
+  return marked_cards;
+}
+
 void HeapPage::VisitObjects(ObjectVisitor* visitor) const {
   ASSERT(Thread::Current()->IsAtSafepoint());
   NoSafepointScope no_safepoint;
@@ -192,6 +246,11 @@ PageSpace::PageSpace(Heap* heap,
       max_external_in_words_(max_external_in_words),
       tasks_lock_(new Monitor()),
       tasks_(0),
+      sweep_next_(NULL),
+      sweep_last_(NULL),
+      sweep_pending_(0),
+      pages_swept_lazily_(0),
+      pages_swept_concurrently_(0),
 #if defined(DEBUG)
       iterating_thread_(NULL),
 #endif
@@ -201,7 +260,8 @@ PageSpace::PageSpace(Heap* heap,
                              FLAG_old_gen_growth_time_ratio),
       gc_time_micros_(0),
       collections_(0),
-      mark_sweep_words_per_micro_(kConservativeInitialMarkSweepSpeed) {
+      mark_sweep_words_per_micro_(kConservativeInitialMarkSweepSpeed),
+      incremental_marker_(NULL) {
   // We aren't holding the lock but no one can reference us yet.
   UpdateMaxCapacityLocked();
   UpdateMaxUsed();
@@ -214,6 +274,8 @@ PageSpace::~PageSpace() {
       ml.Wait();
     }
   }
+  // The mark bits are freed with the pages.
+  delete incremental_marker_;
   FreePages(pages_);
   FreePages(exec_pages_);
   FreePages(large_pages_);
@@ -281,6 +343,17 @@ HeapPage* PageSpace::AllocateLargePage(intptr_t size, HeapPage::PageType type) {
   if (page == NULL) {
     return NULL;
   }
+  if (type == HeapPage::kData) {
+    // Only needed if the page ends up holding a card remembered array.
+    const intptr_t card_table_size =
+        (page_size_in_words << kWordSizeLog2) >> HeapPage::kBytesPerCardLog2;
+    page->card_table_ =
+        reinterpret_cast<uint8_t*>(calloc(card_table_size, sizeof(uint8_t)));
+    if (page->card_table_ == NULL) {
+      page->Deallocate();
+      return NULL;
+    }
+  }
   page->set_next(large_pages_);
   large_pages_ = page;
   IncreaseCapacityInWords(page_size_in_words);
@@ -402,11 +475,22 @@ uword PageSpace::TryAllocateInternal(intptr_t size,
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
   uword result = 0;
   if (size < kAllocatablePageSize) {
+    if ((type == HeapPage::kData) && !is_locked && !is_protected) {
+      result = TryAllocateInThreadBuffer(size);
+      if (result != 0) {
+        // usage_ is updated when the buffer is refilled.
+        return result;
+      }
+    }
     if (is_locked) {
       result = freelist_[type].TryAllocateLocked(size, is_protected);
     } else {
       result = freelist_[type].TryAllocate(size, is_protected);
     }
+    if ((result == 0) && (type == HeapPage::kData)) {
+      // Sweep before growing.
+      result = TryAllocateSweepingLazily(size, is_protected, is_locked);
+    }
     if (result == 0) {
       result = TryAllocateInFreshPage(size, type, growth_policy, is_locked);
       // usage_ is updated by the call above.
@@ -440,6 +524,140 @@ uword PageSpace::TryAllocateInternal(intptr_t size,
   return result;
 }
 
+uword PageSpace::TryAllocateInThreadBuffer(intptr_t size) {
+  const intptr_t buffer_size = FLAG_old_gen_thread_buffer_kb * KB;
+  // Larger objects would waste too much of the buffer when refilling it.
+  if (size > (buffer_size >> 3)) {
+    return 0;
+  }
+  Thread* thread = Thread::Current();
+  if ((heap_ == NULL) || (thread == NULL) || (thread->heap() != heap_)) {
+    // Buffers are only abandoned by the threads of the owning isolate.
+    return 0;
+  }
+  uword top = thread->old_space_top();
+  uword end = thread->old_space_end();
+  if (static_cast<intptr_t>(end - top) < size) {
+    // One freelist lock acquisition pays for a whole buffer of allocations.
+    AbandonThreadBuffer(thread);
+    top = freelist_[HeapPage::kData].TryAllocate(buffer_size, false);
+    if (top == 0) {
+      return 0;
+    }
+    end = top + buffer_size;
+    AtomicOperations::IncrementBy(&(usage_.used_in_words),
+                                  (buffer_size >> kWordSizeLog2));
+    thread->set_old_space_end(end);
+  }
+  uword result = top;
+  thread->set_old_space_top(top + size);
+  // The remainder is unwalkable until MakeIterable or AbandonThreadBuffer.
+  ASSERT((result & kObjectAlignmentMask) == kOldObjectAlignmentOffset);
+  return result;
+}
+
+void PageSpace::AbandonThreadBuffer(Thread* thread) {
+  uword top = thread->old_space_top();
+  uword end = thread->old_space_end();
+  if (top < end) {
+    freelist_[HeapPage::kData].Free(top, end - top);
+    AtomicOperations::DecrementBy(&(usage_.used_in_words),
+                                  ((end - top) >> kWordSizeLog2));
+  }
+  thread->set_old_space_top(0);
+  thread->set_old_space_end(0);
+}
+
+void PageSpace::MakeThreadBufferIterable(Thread* thread) const {
+  uword top = thread->old_space_top();
+  uword end = thread->old_space_end();
+  if (top < end) {
+    FreeListElement::AsElement(top, end - top);
+  }
+}
+
+uword PageSpace::TryAllocateSweepingLazily(intptr_t size,
+                                           bool is_protected,
+                                           bool is_locked) {
+  FreeList* freelist = &freelist_[HeapPage::kData];
+  const bool is_lazy = true;
+  while (SweepNextPage(is_locked, is_lazy)) {
+    uword result = is_locked ? freelist->TryAllocateLocked(size, is_protected)
+                             : freelist->TryAllocate(size, is_protected);
+    if (result != 0) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+bool PageSpace::SweepNextPage(bool is_locked, bool is_lazy) {
+  HeapPage* page = NULL;
+  {
+    MutexLocker ml(pages_lock_);
+    page = sweep_next_;
+    if (page == NULL) {
+      return false;
+    }
+    sweep_next_ = (page == sweep_last_) ? NULL : page->next();
+  }
+  ASSERT(page->type() == HeapPage::kData);
+  GCSweeper sweeper;
+  sweeper.SweepPage(page, &freelist_[HeapPage::kData], is_locked);
+  AtomicOperations::IncrementBy(
+      is_lazy ? &pages_swept_lazily_ : &pages_swept_concurrently_, 1);
+  bool is_last_page = false;
+  {
+    MutexLocker ml(pages_lock_);
+    ASSERT(sweep_pending_ > 0);
+    sweep_pending_--;
+    is_last_page = (sweep_pending_ == 0);
+  }
+  if (is_last_page) {
+    FreeSweptEmptyPages();
+  }
+  return true;
+}
+
+void PageSpace::FreeSweptEmptyPages() {
+  // The sweepers leave the pages they find empty in the list, as they do not
+  // know their predecessors. Nothing is allocated in an empty page, so all
+  // pages up to sweep_last_ with nothing in use can be freed now.
+  HeapPage* empty_pages = NULL;
+  {
+    MutexLocker ml(pages_lock_);
+    ASSERT((sweep_next_ == NULL) && (sweep_pending_ == 0));
+    HeapPage* prev_page = NULL;
+    HeapPage* page = pages_;
+    while (true) {
+      HeapPage* next_page = page->next();
+      const bool is_last_page = (page == sweep_last_);
+      if (!page->is_image_page() && (page->used_in_bytes() == 0)) {
+        if (prev_page != NULL) {
+          prev_page->set_next(next_page);
+        } else {
+          pages_ = next_page;
+        }
+        if (page == pages_tail_) {
+          pages_tail_ = prev_page;
+        }
+        IncreaseCapacityInWordsLocked(
+            -(page->memory_->size() >> kWordSizeLog2));
+        page->set_next(empty_pages);
+        empty_pages = page;
+      } else {
+        prev_page = page;
+      }
+      if (is_last_page) {
+        break;
+      }
+      page = next_page;
+    }
+    sweep_last_ = NULL;
+  }
+  FreePages(empty_pages);
+}
+
 void PageSpace::AcquireDataLock() {
   freelist_[HeapPage::kData].mutex()->Lock();
 }
@@ -541,6 +759,9 @@ void PageSpace::MakeIterable() const {
   if (bump_top_ < bump_end_) {
     FreeListElement::AsElement(bump_top_, bump_end_ - bump_top_);
   }
+  if (heap_ != NULL) {
+    heap_->isolate()->thread_registry()->MakeOldSpaceBuffersIterable(this);
+  }
 }
 
 void PageSpace::AbandonBumpAllocation() {
@@ -650,6 +871,52 @@ void PageSpace::VisitObjectsImagePages(ObjectVisitor* visitor) const {
   }
 }
 
+void PageSpace::VisitObjectsOnDirtyPages(ObjectVisitor* visitor) const {
+  const intptr_t os_page_size = VirtualMemory::PageSize();
+  MallocGrowableArray<bool> dirty;
+  for (ExclusivePageIterator it(this); !it.Done(); it.Advance()) {
+    HeapPage* page = it.page();
+    if (page->is_image_page()) {
+      continue;
+    }
+    const uword start = page->memory_->start();
+    const intptr_t size = page->memory_->size();
+    const intptr_t count = size / os_page_size;
+    dirty.SetLength(count);
+    if (!VirtualMemory::GetDirtyPages(start, size, dirty.data())) {
+      // Assume every page was written.
+      for (intptr_t i = 0; i < count; i++) {
+        dirty[i] = true;
+      }
+    }
+    bool any_dirty = false;
+    for (intptr_t i = 0; i < count; i++) {
+      if (dirty[i]) {
+        any_dirty = true;
+        break;
+      }
+    }
+    if (!any_dirty) {
+      continue;
+    }
+    uword obj_addr = page->object_start();
+    const uword end_addr = page->object_end();
+    while (obj_addr < end_addr) {
+      RawObject* raw_obj = RawObject::FromAddr(obj_addr);
+      const uword next_obj_addr = obj_addr + raw_obj->Size();
+      const intptr_t last = (next_obj_addr - 1 - start) / os_page_size;
+      for (intptr_t i = (obj_addr - start) / os_page_size; i <= last; i++) {
+        if (dirty[i]) {
+          visitor->VisitObject(raw_obj);
+          break;
+        }
+      }
+      obj_addr = next_obj_addr;
+    }
+    ASSERT(obj_addr == end_addr);
+  }
+}
+
 void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
   for (ExclusivePageIterator it(this); !it.Done(); it.Advance()) {
     it.page()->VisitObjectPointers(visitor);
@@ -691,8 +958,12 @@ RawObject* PageSpace::FindObject(FindObjectVisitor* visitor,
 
 void PageSpace::WriteProtect(bool read_only) {
   if (read_only) {
-    // Avoid MakeIterable trying to write to the heap.
+    // Avoid MakeIterable trying to write to the heap, and the threads writing
+    // to it when they abandon their buffers.
     AbandonBumpAllocation();
+    if (heap_ != NULL) {
+      heap_->isolate()->thread_registry()->AbandonOldSpaceBuffers(this);
+    }
   }
   for (ExclusivePageIterator it(this); !it.Done(); it.Advance()) {
     if (!it.page()->is_image_page()) {
@@ -717,6 +988,8 @@ void PageSpace::PrintToJSONObject(JSONObject* object) const {
   space.AddProperty64("capacity", CapacityInWords() * kWordSize);
   space.AddProperty64("external", ExternalInWords() * kWordSize);
   space.AddProperty("time", MicrosecondsToSeconds(gc_time_micros()));
+  space.AddProperty("_pagesSweptLazily", pages_swept_lazily());
+  space.AddProperty("_pagesSweptConcurrently", pages_swept_concurrently());
   if (collections() > 0) {
     int64_t run_time = isolate->UptimeMicros();
     run_time = Utils::Maximum(run_time, static_cast<int64_t>(0));
@@ -850,6 +1123,98 @@ bool PageSpace::ShouldPerformIdleMarkSweep(int64_t deadline) {
   return estimated_mark_completion <= deadline;
 }
 
+bool PageSpace::ShouldStartIncrementalMarking() {
+  NoSafepointScope no_safepoint;
+
+  if (!FLAG_incremental_marking || IsMarkingIncrementally() ||
+      !page_space_controller_.NeedsIdleGarbageCollection(usage_)) {
+    return false;
+  }
+
+  {
+    MonitorLocker locker(tasks_lock());
+    if (tasks() > 0) {
+      // Marking would have to wait for the concurrent sweeper.
+      return false;
+    }
+  }
+  return VirtualMemory::SupportsDirtyPageTracking();
+}
+
+bool PageSpace::MarkIncrementally(int64_t deadline) {
+  Thread* thread = Thread::Current();
+  Isolate* isolate = heap_->isolate();
+  ASSERT(isolate == Isolate::Current());
+
+  {
+    MonitorLocker locker(tasks_lock());
+    while (tasks() > 0) {
+      locker.WaitWithSafepointCheck(thread);
+    }
+    set_tasks(1);
+  }
+
+  bool done = false;
+  {
+    SafepointOperationScope safepoint_scope(thread);
+    if (incremental_marker_ == NULL) {
+      incremental_marker_ = IncrementalMarker::TryCreate(heap_);
+#ifndef PRODUCT
+      if (incremental_marker_ != NULL) {
+        heap_->UpdateClassHeapStatsBeforeGC(Heap::kOld);
+      }
+#endif  // !PRODUCT
+    }
+    if (incremental_marker_ != NULL) {
+      NoSafepointScope no_safepoints;
+      WriteProtectCode(false);
+      done = incremental_marker_->Step(isolate, this, deadline);
+      WriteProtectCode(true);
+    }
+  }
+
+  {
+    MonitorLocker ml(tasks_lock());
+    set_tasks(tasks() - 1);
+    ml.NotifyAll();
+  }
+  return done;
+}
+
+void PageSpace::AbortIncrementalMarking() {
+  if (incremental_marker_ == NULL) {
+    return;
+  }
+  Thread* thread = Thread::Current();
+  {
+    MonitorLocker locker(tasks_lock());
+    while (tasks() > 0) {
+      locker.WaitWithSafepointCheck(thread);
+    }
+    set_tasks(1);
+  }
+  {
+    SafepointOperationScope safepoint_scope(thread);
+    AbortIncrementalMarkingAtSafepoint();
+  }
+  {
+    MonitorLocker ml(tasks_lock());
+    set_tasks(tasks() - 1);
+    ml.NotifyAll();
+  }
+}
+
+void PageSpace::AbortIncrementalMarkingAtSafepoint() {
+  if (incremental_marker_ == NULL) {
+    return;
+  }
+  WriteProtectCode(false);
+  incremental_marker_->Abort(this);
+  WriteProtectCode(true);
+  delete incremental_marker_;
+  incremental_marker_ = NULL;
+}
+
 void PageSpace::MarkSweep() {
   Thread* thread = Thread::Current();
   Isolate* isolate = heap_->isolate();
@@ -889,9 +1254,12 @@ void PageSpace::MarkSweep() {
       freelist_[HeapPage::kExecutable].Print();
     }
 
+    // Objects are already marked if we are finishing incremental marking.
+    const bool finish_incremental = IsMarkingIncrementally();
+
     if (FLAG_verify_before_gc) {
       OS::PrintErr("Verifying before marking...");
-      heap_->VerifyGC();
+      heap_->VerifyGC(finish_incremental ? kAllowMarked : kForbidMarked);
       OS::PrintErr(" done.\n");
     }
 
@@ -902,15 +1270,27 @@ void PageSpace::MarkSweep() {
     SpaceUsage usage_before = GetCurrentUsage();
 
     // Mark all reachable old-gen objects.
+    if (finish_incremental) {
+      incremental_marker_->Finish(isolate, this);
+      // Objects allocated while marking were allocated marked, but the marker
+      // did not count them.
+      const intptr_t allocated_in_words =
+          usage_.used_in_words - incremental_marker_->used_in_words_at_start();
+      usage_.used_in_words =
+          incremental_marker_->marked_words() + allocated_in_words;
+      delete incremental_marker_;
+      incremental_marker_ = NULL;
+    } else {
 #if defined(PRODUCT)
-    bool collect_code = FLAG_collect_code && ShouldCollectCode();
+      bool collect_code = FLAG_collect_code && ShouldCollectCode();
 #else
-    bool collect_code = FLAG_collect_code && ShouldCollectCode() &&
-                        !isolate->HasAttemptedReload();
+      bool collect_code = FLAG_collect_code && ShouldCollectCode() &&
+                          !isolate->HasAttemptedReload();
 #endif  // !defined(PRODUCT)
-    GCMarker marker(heap_);
-    marker.MarkObjects(isolate, this, collect_code);
-    usage_.used_in_words = marker.marked_words();
+      GCMarker marker(heap_);
+      marker.MarkObjects(isolate, this, collect_code);
+      usage_.used_in_words = marker.marked_words();
+    }
 
     int64_t mid1 = OS::GetCurrentMonotonicMicros();
 
@@ -990,10 +1370,20 @@ void PageSpace::MarkSweep() {
           heap_->VerifyGC(kForbidMarked);
           OS::PrintErr(" done.\n");
         }
-      } else {
-        // Start the concurrent sweeper task now.
-        GCSweeper::SweepConcurrent(isolate, pages_, pages_tail_,
-                                   &freelist_[HeapPage::kData]);
+      } else if (pages_ != NULL) {
+        // Start the concurrent sweeper tasks now. When the allocator runs out
+        // of free memory before they are done, it sweeps pages as well.
+        MutexLocker ml(pages_lock_);
+        ASSERT((sweep_next_ == NULL) && (sweep_last_ == NULL));
+        sweep_next_ = pages_;
+        sweep_last_ = pages_tail_;
+        sweep_pending_ = 0;
+        for (page = pages_; page != NULL; page = page->next()) {
+          sweep_pending_++;
+        }
+        const intptr_t num_tasks = Utils::Minimum(
+            sweep_pending_, Utils::Maximum<intptr_t>(1, FLAG_sweeper_tasks));
+        GCSweeper::SweepConcurrent(isolate, num_tasks);
       }
     }
 
@@ -1006,14 +1396,18 @@ void PageSpace::MarkSweep() {
     page_space_controller_.EvaluateGarbageCollection(
         usage_before, GetCurrentUsage(), start, end);
 
-    int64_t mark_sweep_micros = end - start;
-    if (mark_sweep_micros == 0) {
-      mark_sweep_micros = 1;
-    }
-    mark_sweep_words_per_micro_ =
-        usage_before.used_in_words / mark_sweep_micros;
-    if (mark_sweep_words_per_micro_ == 0) {
-      mark_sweep_words_per_micro_ = 1;
+    // The final phase of incremental marking says little about the speed of
+    // a whole mark-sweep.
+    if (!finish_incremental) {
+      int64_t mark_sweep_micros = end - start;
+      if (mark_sweep_micros == 0) {
+        mark_sweep_micros = 1;
+      }
+      mark_sweep_words_per_micro_ =
+          usage_before.used_in_words / mark_sweep_micros;
+      if (mark_sweep_words_per_micro_ == 0) {
+        mark_sweep_words_per_micro_ = 1;
+      }
     }
 
     heap_->RecordTime(kConcurrentSweep, pre_safe_point - pre_wait_for_sweepers);
@@ -1049,16 +1443,25 @@ uword PageSpace::TryAllocateDataBumpInternal(intptr_t size,
                                              bool is_locked) {
   ASSERT(size >= kObjectAlignment);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  if (size >= kAllocatablePageSize) {
+    // Large objects must get their own page, even if they fit in the bump
+    // block: card remembered arrays expect to be at the start of a large
+    // page (see HeapPage::OfLargeObject).
+    return is_locked ? TryAllocateDataLocked(size, growth_policy)
+                     : TryAllocate(size, HeapPage::kData, growth_policy);
+  }
   intptr_t remaining = bump_end_ - bump_top_;
   if (remaining < size) {
-    // Checking this first would be logical, but needlessly slow.
-    if (size >= kAllocatablePageSize) {
-      return is_locked ? TryAllocateDataLocked(size, growth_policy)
-                       : TryAllocate(size, HeapPage::kData, growth_policy);
-    }
     FreeListElement* block =
         is_locked ? freelist_[HeapPage::kData].TryAllocateLargeLocked(size)
                   : freelist_[HeapPage::kData].TryAllocateLarge(size);
+    const bool is_lazy = true;
+    while ((block == NULL) && SweepNextPage(is_locked, is_lazy)) {
+      // Sweep before growing.
+      block = is_locked
+                  ? freelist_[HeapPage::kData].TryAllocateLargeLocked(size)
+                  : freelist_[HeapPage::kData].TryAllocateLarge(size);
+    }
     if (block == NULL) {
       // Allocating from a new page (if growth policy allows) will have the
       // side-effect of populating the freelist with a large block. The next
@@ -1135,6 +1538,7 @@ void PageSpace::SetupImagePage(void* pointer, uword size, bool is_executable) {
   page->next_ = NULL;
   page->object_end_ = memory->end();
   page->used_in_bytes_ = page->object_end_ - page->object_start();
+  page->card_table_ = NULL;
 
   MutexLocker ml(pages_lock_);
   HeapPage **first, **tail;
@@ -21,6 +21,7 @@ DECLARE_FLAG(bool, write_protect_code);
 
 // Forward declarations.
 class Heap;
+class IncrementalMarker;
 class JSONObject;
 class ObjectPointerVisitor;
 class ObjectSet;
@@ -58,6 +59,38 @@ class HeapPage {
     return Utils::RoundUp(sizeof(HeapPage), OS::kMaxPreferredCodeAlignment);
   }
 
+  // Card marking for the card remembered array on a large data page (see
+  // RawObject::IsCardRemembered). The page keeps one byte per card, which is
+  // set when a pointer to new space is stored into the card.
+  static const intptr_t kBytesPerCardLog2 = 9;
+
+  static intptr_t card_table_offset() {
+    return OFFSET_OF(HeapPage, card_table_);
+  }
+
+  // The page of an object allocated on a large page.
+  static HeapPage* OfLargeObject(RawObject* raw_obj) {
+    return reinterpret_cast<HeapPage*>(RawObject::ToAddr(raw_obj) -
+                                       ObjectStartOffset());
+  }
+
+  bool HasCardRememberedObject() const {
+    return (card_table_ != NULL) &&
+           RawObject::FromAddr(object_start())->IsCardRemembered();
+  }
+
+  void RememberCard(RawObject* const* slot) {
+    ASSERT(HasCardRememberedObject());
+    const uword offset =
+        reinterpret_cast<uword>(slot) - reinterpret_cast<uword>(this);
+    ASSERT(offset < static_cast<uword>(memory_->size()));
+    card_table_[offset >> kBytesPerCardLog2] = 1;
+  }
+
+  // Visits the pointers in the marked cards of the card remembered array and
+  // clears them. Returns the number of marked cards.
+  intptr_t VisitRememberedCards(ObjectPointerVisitor* visitor);
+
  private:
   void set_object_end(uword value) {
     ASSERT((value & kObjectAlignmentMask) == kOldObjectAlignmentOffset);
@@ -81,6 +114,7 @@ class HeapPage {
   uword object_end_;
   uword used_in_bytes_;
   PageType type_;
+  uint8_t* card_table_;  // Only for large data pages.
 
   friend class PageSpace;
 
@@ -243,9 +277,15 @@ class PageSpace {
   bool DataContains(uword addr) const;
   bool IsValidAddress(uword addr) const { return Contains(addr); }
 
+  // Objects at least this large are allocated on their own large page.
+  static const intptr_t kAllocatablePageSize = 64 * KB;
+
   void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectsNoImagePages(ObjectVisitor* visitor) const;
   void VisitObjectsImagePages(ObjectVisitor* visitor) const;
+  // Visits the objects that overlap the pages written since the last
+  // VirtualMemory::ClearDirtyPages, excluding image pages.
+  void VisitObjectsOnDirtyPages(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
 
   RawObject* FindObject(FindObjectVisitor* visitor,
@@ -255,9 +295,19 @@ class PageSpace {
   // code.
   bool ShouldCollectCode();
 
-  // Collect the garbage in the page space using mark-sweep.
+  // Collect the garbage in the page space using mark-sweep. Completes any
+  // incremental marking in progress.
   void MarkSweep();
 
+  // Marks old space incrementally in the steps between mark-sweeps, see
+  // IncrementalMarker. Starts marking if needed, then marks until 'deadline'.
+  // Returns true if only the final phase of marking is left, which is done by
+  // the next MarkSweep.
+  bool MarkIncrementally(int64_t deadline);
+  // Discards the progress of incremental marking, if any.
+  void AbortIncrementalMarking();
+  bool IsMarkingIncrementally() const { return incremental_marker_ != NULL; }
+
   void AddRegionsToObjectSet(ObjectSet* set) const;
 
   void InitGrowthControl() {
@@ -286,6 +336,7 @@ class PageSpace {
   void WriteProtectCode(bool read_only);
 
   bool ShouldPerformIdleMarkSweep(int64_t deadline);
+  bool ShouldStartIncrementalMarking();
 
   void AddGCTime(int64_t micros) { gc_time_micros_ += micros; }
 
@@ -321,6 +372,18 @@ class PageSpace {
     tasks_ = val;
   }
 
+  // Data pages swept on demand by the allocator, and by the concurrent
+  // sweeper tasks.
+  intptr_t pages_swept_lazily() const { return pages_swept_lazily_; }
+  intptr_t pages_swept_concurrently() const {
+    return pages_swept_concurrently_;
+  }
+  // Data pages of the last mark-sweep not yet swept.
+  intptr_t pages_pending_sweep() const {
+    MutexLocker ml(pages_lock_);
+    return sweep_pending_;
+  }
+
   // Attempt to allocate from bump block rather than normal freelist.
   uword TryAllocateDataBump(intptr_t size, GrowthPolicy growth_policy);
   uword TryAllocateDataBumpLocked(intptr_t size, GrowthPolicy growth_policy);
@@ -338,6 +401,11 @@ class PageSpace {
   // Return any bump allocation block to the freelist.
   void AbandonBumpAllocation();
 
+  // Return the remainder of the thread's allocation buffer to the freelist.
+  void AbandonThreadBuffer(Thread* thread);
+  // Make the remainder of the thread's allocation buffer walkable.
+  void MakeThreadBufferIterable(Thread* thread) const;
+
  private:
   // Ids for time and data records in Heap::GCStats.
   enum {
@@ -355,8 +423,6 @@ class PageSpace {
     kAllowedGrowth = 3
   };
 
-  static const intptr_t kAllocatablePageSize = 64 * KB;
-
   uword TryAllocateInternal(intptr_t size,
                             HeapPage::PageType type,
                             GrowthPolicy growth_policy,
@@ -369,8 +435,23 @@ class PageSpace {
   uword TryAllocateDataBumpInternal(intptr_t size,
                                     GrowthPolicy growth_policy,
                                     bool is_locked);
-  // Makes bump block walkable; do not call concurrently with mutator.
+  // Bump allocates in the current thread's allocation buffer, refilling it
+  // from the data freelist when exhausted. Returns 0 for large objects, for
+  // threads of other isolates, or if the freelist has no block for a buffer.
+  uword TryAllocateInThreadBuffer(intptr_t size);
+  // Sweeps pages left by the concurrent sweepers until one frees enough
+  // memory for the allocation.
+  uword TryAllocateSweepingLazily(intptr_t size,
+                                  bool is_protected,
+                                  bool is_locked);
+  // Sweeps the next data page left by the last mark-sweep. Returns false if
+  // there was none left.
+  bool SweepNextPage(bool is_locked, bool is_lazy);
+  void FreeSweptEmptyPages();
+  // Makes bump block and thread buffers walkable; do not call concurrently
+  // with mutator.
   void MakeIterable() const;
+  void AbortIncrementalMarkingAtSafepoint();
   HeapPage* AllocatePage(HeapPage::PageType type);
   void FreePage(HeapPage* page, HeapPage* previous_page);
   HeapPage* AllocateLargePage(intptr_t size, HeapPage::PageType type);
@@ -429,6 +510,14 @@ class PageSpace {
   // Keep track of running MarkSweep tasks.
   Monitor* tasks_lock_;
   intptr_t tasks_;
+
+  // Data pages not yet claimed by a sweeper, from sweep_next_ to sweep_last_,
+  // and the number of pages not yet swept. Guarded by pages_lock_.
+  HeapPage* sweep_next_;
+  HeapPage* sweep_last_;
+  intptr_t sweep_pending_;
+  intptr_t pages_swept_lazily_;
+  intptr_t pages_swept_concurrently_;
 #if defined(DEBUG)
   Thread* iterating_thread_;
 #endif
@@ -438,11 +527,15 @@ class PageSpace {
   intptr_t collections_;
   intptr_t mark_sweep_words_per_micro_;
 
+  // Non-NULL while marking incrementally.
+  IncrementalMarker* incremental_marker_;
+
   friend class ExclusivePageIterator;
   friend class ExclusiveCodePageIterator;
   friend class ExclusiveLargePageIterator;
   friend class HeapIterationScope;
   friend class PageSpaceController;
+  friend class Scavenger;  // Card remembered arrays on large pages.
   friend class SweeperTask;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(PageSpace);
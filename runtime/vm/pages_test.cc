@@ -4,10 +4,16 @@
 
 #include "vm/pages.h"
 #include "platform/assert.h"
+#include "vm/benchmark_test.h"
+#include "vm/heap.h"
+#include "vm/object.h"
+#include "vm/timer.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(int, old_gen_thread_buffer_kb);
+
 TEST_CASE(Pages) {
   PageSpace* space = new PageSpace(NULL, 4 * MBInWords, 8 * MBInWords);
   EXPECT(!space->Contains(reinterpret_cast<uword>(&space)));
@@ -31,4 +37,76 @@ TEST_CASE(Pages) {
   delete space;
 }
 
+class FindFreeListElement : public ObjectVisitor {
+ public:
+  explicit FindFreeListElement(uword addr) : addr_(addr), found_(false) {}
+
+  virtual void VisitObject(RawObject* obj) {
+    if (RawObject::ToAddr(obj) == addr_) {
+      found_ = obj->IsFreeListElement();
+    }
+  }
+
+  bool found() const { return found_; }
+
+ private:
+  const uword addr_;
+  bool found_;
+};
+
+ISOLATE_UNIT_TEST_CASE(Pages_ThreadBuffer) {
+  Heap* heap = thread->isolate()->heap();
+  PageSpace* old_space = heap->old_space();
+  old_space->AbandonThreadBuffer(thread);
+  EXPECT(thread->old_space_top() == 0);
+  const intptr_t used_before = old_space->UsedInWords();
+
+  // Consecutive small objects are bump allocated in a fresh buffer.
+  const Array& first = Array::Handle(Array::New(1, Heap::kOld));
+  const Array& second = Array::Handle(Array::New(1, Heap::kOld));
+  const uword first_addr = RawObject::ToAddr(first.raw());
+  const uword second_addr = RawObject::ToAddr(second.raw());
+  EXPECT_EQ(first_addr + first.raw()->Size(), second_addr);
+  EXPECT_EQ(second_addr + second.raw()->Size(), thread->old_space_top());
+  EXPECT_EQ(first_addr + FLAG_old_gen_thread_buffer_kb * KB,
+            thread->old_space_end());
+  EXPECT_EQ(used_before + FLAG_old_gen_thread_buffer_kb * KBInWords,
+            old_space->UsedInWords());
+
+  // Heap walks see the unused part of the buffer as a free list element.
+  {
+    FindFreeListElement visitor(thread->old_space_top());
+    HeapIterationScope iteration(thread);
+    iteration.IterateOldObjects(&visitor);
+    EXPECT(visitor.found());
+  }
+
+  // A GC returns the unused part of the buffer to the freelist.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(thread->old_space_top() == 0);
+  EXPECT(thread->old_space_end() == 0);
+
+  // So does write protecting the heap, as the thread must not write to the
+  // heap when it exits the isolate.
+  Array::Handle(Array::New(1, Heap::kOld));
+  EXPECT(thread->old_space_top() != 0);
+  heap->WriteProtect(true);
+  EXPECT(thread->old_space_top() == 0);
+  EXPECT(thread->old_space_end() == 0);
+  heap->WriteProtect(false);
+}
+
+BENCHMARK(OldSpaceAllocateSmall) {
+  TransitionNativeToVM transition(thread);
+  const intptr_t kObjects = 1000000;
+  Array& array = Array::Handle();
+  Timer timer(true, "Old space small allocation benchmark");
+  timer.Start();
+  for (intptr_t i = 0; i < kObjects; i++) {
+    array = Array::New(4, Heap::kOld);
+  }
+  timer.Stop();
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
 }  // namespace dart
@@ -14,6 +14,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(bool, message_latency_histograms);
+
 Mutex* PortMap::mutex_ = NULL;
 PortMap::Entry* PortMap::map_ = NULL;
 MessageHandler* PortMap::deleted_entry_ = reinterpret_cast<MessageHandler*>(1);
@@ -237,6 +239,11 @@ void PortMap::ClosePorts(MessageHandler* handler) {
 }
 
 bool PortMap::PostMessage(Message* message) {
+#if !defined(PRODUCT)
+  if (FLAG_message_latency_histograms) {
+    message->set_post_micros(OS::GetCurrentMonotonicMicros());
+  }
+#endif
   MutexLocker ml(mutex_);
   intptr_t index = FindPort(message->dest_port());
   if (index < 0) {
@@ -310,6 +317,7 @@ void PortMap::PrintPortsForMessageHandler(MessageHandler* handler,
           port.AddPropertyF("name", "Isolate Port (%" Pd64 ")", map_[i].port);
           msg_handler = DartLibraryCalls::LookupHandler(map_[i].port);
           port.AddProperty("handler", msg_handler);
+          handler->PrintPortLatencies(map_[i].port, &port);
         }
       }
     }
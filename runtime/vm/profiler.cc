@@ -56,12 +56,35 @@ DEFINE_FLAG(bool,
             profile_vm_allocation,
             false,
             "Collect native stack traces when tracing Dart allocations.");
+DEFINE_FLAG(bool,
+            profile_continuous,
+            false,
+            "Run the profiler in its low-overhead mode: samples are collected "
+            "into per-thread blocks by walking frame pointers only, and the "
+            "sample period adapts to the time spent sampling.");
+DEFINE_FLAG(int,
+            profile_continuous_overhead,
+            1,
+            "Percentage of the time the continuous profiler may spend taking "
+            "samples before it increases the sample period.");
+DEFINE_FLAG(int,
+            profile_adaptation_period,
+            1000,
+            "Time between adaptations of the sample period of the continuous "
+            "profiler in milliseconds.");
 
 #ifndef PRODUCT
 
+// The sample period of the continuous profiler does not grow beyond this.
+static const intptr_t kMaxContinuousProfilePeriod = 100 * 1000;
+
 bool Profiler::initialized_ = false;
 SampleBuffer* Profiler::sample_buffer_ = NULL;
 AllocationSampleBuffer* Profiler::allocation_sample_buffer_ = NULL;
+SampleBlockBuffer* Profiler::sample_block_buffer_ = NULL;
+int64_t Profiler::last_adaptation_micros_ = 0;
+int64_t Profiler::last_sampling_micros_ = 0;
+intptr_t Profiler::continuous_period_ = 0;
 ProfilerCounters Profiler::counters_;
 
 void Profiler::InitOnce() {
@@ -73,7 +96,14 @@ void Profiler::InitOnce() {
     return;
   }
   ASSERT(!initialized_);
-  sample_buffer_ = new SampleBuffer();
+  if (FLAG_profile_continuous) {
+    sample_block_buffer_ = new SampleBlockBuffer();
+    sample_buffer_ = sample_block_buffer_;
+    last_adaptation_micros_ = OS::GetCurrentMonotonicMicros();
+    continuous_period_ = FLAG_profile_period;
+  } else {
+    sample_buffer_ = new SampleBuffer();
+  }
   Profiler::InitAllocationSampleBuffer();
   // Zero counters.
   memset(&counters_, 0, sizeof(counters_));
@@ -126,6 +156,44 @@ void Profiler::SetSamplePeriod(intptr_t period) {
   }
 }
 
+void Profiler::MaybeAdaptSamplePeriod() {
+  if (sample_block_buffer_ == NULL) {
+    return;
+  }
+  const int64_t now = OS::GetCurrentMonotonicMicros();
+  const int64_t elapsed = now - last_adaptation_micros_;
+  if (elapsed < FLAG_profile_adaptation_period * kMicrosecondsPerMillisecond) {
+    return;
+  }
+  const int64_t sampling_micros =
+      AtomicOperations::LoadRelaxed(&counters_.sampling_micros);
+  const int64_t overhead = (sampling_micros - last_sampling_micros_) * 100;
+  const int64_t budget = elapsed * FLAG_profile_continuous_overhead;
+  intptr_t period = continuous_period_;
+  if (overhead > budget) {
+    period = Utils::Minimum(period * 2, kMaxContinuousProfilePeriod);
+  } else if (overhead < budget / 2) {
+    period = Utils::Maximum(period / 2,
+                            static_cast<intptr_t>(FLAG_profile_period));
+  }
+  if (period != continuous_period_) {
+    if (FLAG_trace_profiler) {
+      OS::PrintErr("Continuous profiler sample period: %" Pd " us\n", period);
+    }
+    continuous_period_ = period;
+    ThreadInterrupter::SetInterruptPeriod(period);
+  }
+  last_adaptation_micros_ = now;
+  last_sampling_micros_ = sampling_micros;
+}
+
+void Profiler::ReleaseSampleBlock(Thread* thread) {
+  if (sample_block_buffer_ == NULL) {
+    return;
+  }
+  sample_block_buffer_->ReleaseBlock(thread);
+}
+
 intptr_t Sample::pcs_length_ = 0;
 intptr_t Sample::instance_size_ = 0;
 
@@ -266,6 +334,112 @@ Sample* AllocationSampleBuffer::ReserveSample() {
   return At(index);
 }
 
+SampleBlockBuffer::SampleBlockBuffer(intptr_t capacity)
+    : SampleBuffer(Utils::RoundUp(capacity, kSamplesPerBlock)),
+      block_count_(capacity_ / kSamplesPerBlock),
+      blocks_(new Block[block_count_]),
+      next_block_(0) {
+  for (intptr_t i = 0; i < block_count_; i++) {
+    blocks_[i].state = kFreeBlock;
+    blocks_[i].cursor = 0;
+  }
+}
+
+SampleBlockBuffer::~SampleBlockBuffer() {
+  delete[] blocks_;
+}
+
+Sample* SampleBlockBuffer::ReserveSample() {
+  UNREACHABLE();
+  return NULL;
+}
+
+Sample* SampleBlockBuffer::ReserveSampleForThread(Thread* thread) {
+  intptr_t block = thread->profiler_block();
+  if ((block < 0) || (blocks_[block].cursor == kSamplesPerBlock)) {
+    if (block >= 0) {
+      MarkFull(block);
+    }
+    block = ClaimBlock();
+    thread->set_profiler_block(block);
+    if (block < 0) {
+      return NULL;
+    }
+  }
+  const intptr_t index = block * kSamplesPerBlock + blocks_[block].cursor++;
+  return At(index);
+}
+
+Sample* SampleBlockBuffer::ReserveSampleAndLink(Sample* previous) {
+  ASSERT(previous != NULL);
+  const intptr_t previous_index = IndexOf(previous);
+  const intptr_t block = previous_index / kSamplesPerBlock;
+  ASSERT(blocks_[block].state == kOwnedBlock);
+  if (blocks_[block].cursor == kSamplesPerBlock) {
+    // Chains do not cross blocks, so that a full block only holds complete
+    // chains.
+    return NULL;
+  }
+  const intptr_t next_index =
+      block * kSamplesPerBlock + blocks_[block].cursor++;
+  Sample* next = At(next_index);
+  next->Init(previous->port(), previous->timestamp(), previous->tid());
+  next->set_head_sample(false);
+  // Mark that previous continues at next.
+  previous->SetContinuationIndex(next_index);
+  return next;
+}
+
+void SampleBlockBuffer::ReleaseBlock(Thread* thread) {
+  const intptr_t block = thread->profiler_block();
+  if (block < 0) {
+    return;
+  }
+  // A sample taken from here on must not use the block, which another
+  // thread may claim as soon as it is marked full. Such a sample claims a new
+  // block instead.
+  thread->set_profiler_block(-1);
+  MarkFull(block);
+}
+
+intptr_t SampleBlockBuffer::IndexOf(Sample* sample) const {
+  const intptr_t offset =
+      reinterpret_cast<uint8_t*>(sample) - reinterpret_cast<uint8_t*>(samples_);
+  return offset / Sample::instance_size();
+}
+
+intptr_t SampleBlockBuffer::ClaimBlock() {
+  // Blocks are claimed in order, so the next block is the oldest one unless
+  // it is still owned by a thread. Like SampleBuffer, the buffer keeps the
+  // most recent samples.
+  const uword start = AtomicOperations::LoadRelaxed(&next_block_);
+  for (intptr_t i = 0; i < block_count_; i++) {
+    const intptr_t block = (start + i) % block_count_;
+    if ((AtomicOperations::CompareAndSwapWord(&blocks_[block].state,
+                                              kFreeBlock,
+                                              kOwnedBlock) == kFreeBlock) ||
+        (AtomicOperations::CompareAndSwapWord(&blocks_[block].state,
+                                              kFullBlock,
+                                              kOwnedBlock) == kFullBlock)) {
+      // Only a hint, races are benign.
+      next_block_ = block + 1;
+      blocks_[block].cursor = 0;
+      return block;
+    }
+  }
+  AtomicOperations::IncrementInt64By(
+      &Profiler::counters_.failure_no_sample_block, 1);
+  return -1;
+}
+
+void SampleBlockBuffer::MarkFull(intptr_t block) {
+  // Publishes the samples of the block, which can be claimed again.
+  const uword old_state = AtomicOperations::CompareAndSwapWord(
+      &blocks_[block].state, kOwnedBlock, kFullBlock);
+  ASSERT(old_state == kOwnedBlock);
+  USE(old_state);
+}
+
 // Attempts to find the true return address when a Dart frame is being setup
 // or torn down.
 // NOTE: Architecture specific implementations below.
@@ -866,9 +1040,12 @@ static void CollectSample(Isolate* isolate,
   __try {
 #endif
 
-    if (in_dart_code) {
+    if (in_dart_code && !FLAG_profile_continuous) {
       // We can only trust the stack pointer if we are executing Dart code.
       // See http://dartbug.com/20421 for details.
+      // The continuous profiler only walks frame pointers and does not pay
+      // for the copy, which is only used to recover the caller of frameless
+      // stubs.
       CopyStackBuffer(sample, sp);
     }
 
@@ -1009,7 +1186,10 @@ static Sample* SetupSample(Thread* thread,
   ASSERT(thread != NULL);
   Isolate* isolate = thread->isolate();
   ASSERT(sample_buffer != NULL);
-  Sample* sample = sample_buffer->ReserveSample();
+  Sample* sample = sample_buffer->ReserveSampleForThread(thread);
+  if (sample == NULL) {
+    return NULL;
+  }
   sample->Init(isolate->main_port(), OS::GetCurrentMonotonicMicros(), tid);
   uword vm_tag = thread->vm_tag();
 #if defined(USING_SIMULATOR) && !defined(TARGET_ARCH_DBC)
@@ -1176,7 +1356,13 @@ void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
     return;
   }
 
+  // Reserving a sample in the block of the thread must not be interrupted
+  // by the signal handler, which reserves samples in the same block.
+  DisableThreadInterruptsScope dtis(thread);
   Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
+  if (sample == NULL) {
+    return;
+  }
   sample->SetAllocationCid(cid);
 
   if (FLAG_profile_vm_allocation) {
@@ -1193,6 +1379,9 @@ void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
     // Fall back.
     uintptr_t pc = OS::GetProgramCounter();
     Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
+    if (sample == NULL) {
+      return;
+    }
     sample->SetAllocationCid(cid);
     sample->SetAt(0, pc);
   }
@@ -1266,6 +1455,9 @@ void Profiler::SampleThreadSingleFrame(Thread* thread, uintptr_t pc) {
 
   // Setup sample.
   Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
+  if (sample == NULL) {
+    return;
+  }
   // Increment counter for vm tag.
   VMTagCounters* counters = isolate->vm_tag_counters();
   ASSERT(counters != NULL);
@@ -1277,12 +1469,35 @@ void Profiler::SampleThreadSingleFrame(Thread* thread, uintptr_t pc) {
   sample->SetAt(0, pc);
 }
 
+// Accounts for the time spent taking a sample in the continuous profiling
+// mode, which drives the adaptation of its sample period.
+class SamplingTimeScope : public ValueObject {
+ public:
+  explicit SamplingTimeScope(ProfilerCounters* counters)
+      : counters_(counters),
+        start_(FLAG_profile_continuous ? OS::GetCurrentMonotonicMicros() : 0) {
+  }
+
+  ~SamplingTimeScope() {
+    if (FLAG_profile_continuous) {
+      AtomicOperations::IncrementInt64By(
+          &counters_->sampling_micros,
+          OS::GetCurrentMonotonicMicros() - start_);
+    }
+  }
+
+ private:
+  ProfilerCounters* counters_;
+  const int64_t start_;
+};
+
 void Profiler::SampleThread(Thread* thread,
                             const InterruptedThreadState& state) {
   ASSERT(thread != NULL);
   OSThread* os_thread = thread->os_thread();
   ASSERT(os_thread != NULL);
   Isolate* isolate = thread->isolate();
+  SamplingTimeScope sampling_time_scope(&counters_);
 
   // Thread is not doing VM work.
   if (thread->task_kind() == Thread::kUnknownTask) {
@@ -1368,6 +1583,9 @@ void Profiler::SampleThread(Thread* thread,
 
   // Setup sample.
   Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
+  if (sample == NULL) {
+    return;
+  }
   // Increment counter for vm tag.
   VMTagCounters* counters = isolate->vm_tag_counters();
   ASSERT(counters != NULL);
@@ -1522,38 +1740,7 @@ ProcessedSampleBuffer* SampleBuffer::BuildProcessedSampleBuffer(
   const intptr_t length = capacity();
   for (intptr_t i = 0; i < length; i++) {
     Sample* sample = At(i);
-    if (sample->ignore_sample()) {
-      // Bad sample.
-      continue;
-    }
-    if (!sample->head_sample()) {
-      // An inner sample in a chain of samples.
-      continue;
-    }
-    // If we're requesting all the native allocation samples, we don't care
-    // whether or not we're in the same isolate as the sample.
-    if (sample->port() != filter->port()) {
-      // Another isolate.
-      continue;
-    }
-    if (sample->timestamp() == 0) {
-      // Empty.
-      continue;
-    }
-    if (sample->At(0) == 0) {
-      // No frames.
-      continue;
-    }
-    if (!filter->TimeFilterSample(sample)) {
-      // Did not pass time filter.
-      continue;
-    }
-    if (!filter->TaskFilterSample(sample)) {
-      // Did not pass task filter.
-      continue;
-    }
-    if (!filter->FilterSample(sample)) {
-      // Did not pass filter.
+    if (!IsProcessable(sample, filter)) {
       continue;
     }
     buffer->Add(BuildProcessedSample(sample, buffer->code_lookup_table()));
@@ -1561,6 +1748,62 @@ ProcessedSampleBuffer* SampleBuffer::BuildProcessedSampleBuffer(
   return buffer;
 }
 
+void SampleBuffer::VisitProcessedSamples(SampleFilter* filter,
+                                         const CodeLookupTable& clt,
+                                         ProcessedSampleVisitor* visitor) {
+  ASSERT(filter != NULL);
+  ASSERT(visitor != NULL);
+  Thread* thread = Thread::Current();
+  const intptr_t length = capacity();
+  for (intptr_t i = 0; i < length; i++) {
+    Sample* sample = At(i);
+    if (!IsProcessable(sample, filter)) {
+      continue;
+    }
+    StackZone zone(thread);
+    HANDLESCOPE(thread);
+    visitor->VisitProcessedSample(BuildProcessedSample(sample, clt));
+  }
+}
+
+bool SampleBuffer::IsProcessable(Sample* sample, SampleFilter* filter) {
+  if (sample->ignore_sample()) {
+    // Bad sample.
+    return false;
+  }
+  if (!sample->head_sample()) {
+    // An inner sample in a chain of samples.
+    return false;
+  }
+  // If we're requesting all the native allocation samples, we don't care
+  // whether or not we're in the same isolate as the sample.
+  if (sample->port() != filter->port()) {
+    // Another isolate.
+    return false;
+  }
+  if (sample->timestamp() == 0) {
+    // Empty.
+    return false;
+  }
+  if (sample->At(0) == 0) {
+    // No frames.
+    return false;
+  }
+  if (!filter->TimeFilterSample(sample)) {
+    // Did not pass time filter.
+    return false;
+  }
+  if (!filter->TaskFilterSample(sample)) {
+    // Did not pass task filter.
+    return false;
+  }
+  if (!filter->FilterSample(sample)) {
+    // Did not pass filter.
+    return false;
+  }
+  return true;
+}
+
 ProcessedSample* SampleBuffer::BuildProcessedSample(
     Sample* sample,
     const CodeLookupTable& clt) {
@@ -27,7 +27,9 @@ class ProcessedSampleBuffer;
 
 class Sample;
 class AllocationSampleBuffer;
+class SampleBlockBuffer;
 class SampleBuffer;
+class ProcessedSample;
 class ProfileTrieNode;
 
 struct ProfilerCounters {
@@ -46,6 +48,10 @@ struct ProfilerCounters {
   int64_t stack_walker_none;
   // Count of failed checks:
   int64_t failure_native_allocation_sample;
+  // Count of samples dropped because every sample block was owned:
+  int64_t failure_no_sample_block;
+  // Time spent taking samples in the continuous profiling mode:
+  int64_t sampling_micros;
 };
 
 class Profiler : public AllStatic {
@@ -85,6 +91,16 @@ class Profiler : public AllStatic {
     return counters_;
   }
 
+  // Called periodically by the thread interrupter. In the continuous
+  // profiling mode, adapts the sample period every
+  // FLAG_profile_adaptation_period milliseconds to keep the time spent
+  // sampling under FLAG_profile_continuous_overhead.
+  static void MaybeAdaptSamplePeriod();
+
+  // Marks the sample block of |thread| as full. Called when |thread| leaves
+  // its isolate.
+  static void ReleaseSampleBlock(Thread* thread);
+
  private:
   static void DumpStackTrace(uword sp, uword fp, uword pc, bool for_crash);
 
@@ -95,8 +111,16 @@ class Profiler : public AllStatic {
   static SampleBuffer* sample_buffer_;
   static AllocationSampleBuffer* allocation_sample_buffer_;
 
+  // Only set in the continuous profiling mode. |sample_block_buffer_| is
+  // also |sample_buffer_|.
+  static SampleBlockBuffer* sample_block_buffer_;
+  static int64_t last_adaptation_micros_;
+  static int64_t last_sampling_micros_;
+  static intptr_t continuous_period_;
+
   static ProfilerCounters counters_;
 
+  friend class SampleBlockBuffer;
   friend class Thread;
 };
 
@@ -157,6 +181,17 @@ class SampleFilter : public ValueObject {
   int64_t time_extent_micros_;
 };
 
+class ProcessedSampleVisitor : public ValueObject {
+ public:
+  ProcessedSampleVisitor() {}
+  virtual ~ProcessedSampleVisitor() {}
+
+  virtual void VisitProcessedSample(ProcessedSample* sample) = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(ProcessedSampleVisitor);
+};
+
 class ClearProfileVisitor : public SampleVisitor {
  public:
   explicit ClearProfileVisitor(Isolate* isolate);
@@ -518,6 +553,12 @@ class SampleBuffer {
   virtual Sample* ReserveSample();
   virtual Sample* ReserveSampleAndLink(Sample* previous);
 
+  // Reserves a sample taken on |thread|. Returns NULL if no sample is
+  // available.
+  virtual Sample* ReserveSampleForThread(Thread* thread) {
+    return ReserveSample();
+  }
+
   void VisitSamples(SampleVisitor* visitor) {
     ASSERT(visitor != NULL);
     const intptr_t length = capacity();
@@ -550,7 +591,19 @@ class SampleBuffer {
 
   ProcessedSampleBuffer* BuildProcessedSampleBuffer(SampleFilter* filter);
 
+  // Processes the samples passing |filter| one at a time and hands them to
+  // |visitor|, instead of collecting all of them like
+  // BuildProcessedSampleBuffer. Each processed sample is allocated in its own
+  // zone, which is released once the visitor returns.
+  void VisitProcessedSamples(SampleFilter* filter,
+                             const CodeLookupTable& clt,
+                             ProcessedSampleVisitor* visitor);
+
  protected:
+  // Returns |true| if |sample| is the head of a valid sample that passes
+  // |filter|.
+  bool IsProcessable(Sample* sample, SampleFilter* filter);
+
   ProcessedSample* BuildProcessedSample(Sample* sample,
                                         const CodeLookupTable& clt);
   Sample* Next(Sample* sample);
@@ -581,6 +634,62 @@ class AllocationSampleBuffer : public SampleBuffer {
   DISALLOW_COPY_AND_ASSIGN(AllocationSampleBuffer);
 };
 
+// Sample buffer of the continuous profiling mode. The samples are split in
+// blocks of kSamplesPerBlock samples, each of which is filled by a single
+// thread, so that reserving a sample only needs an atomic operation when a
+// thread claims a new block. Chains of samples never cross blocks. Full
+// blocks are reused oldest first, so that like SampleBuffer the buffer holds
+// the most recent samples, which are processed and symbolized by the same
+// consumers.
+class SampleBlockBuffer : public SampleBuffer {
+ public:
+  static const intptr_t kSamplesPerBlock = 64;
+
+  explicit SampleBlockBuffer(intptr_t capacity = kDefaultBufferCapacity);
+  virtual ~SampleBlockBuffer();
+
+  intptr_t block_count() const { return block_count_; }
+
+  // Samples are only reserved for a thread.
+  virtual Sample* ReserveSample();
+  virtual Sample* ReserveSampleAndLink(Sample* previous);
+
+  // Reserves a sample in the block owned by |thread|, claiming another block
+  // if |thread| owns none or its block is full. Returns NULL if every block
+  // is owned by a thread.
+  //
+  // Called from the signal handler: does not allocate or take locks.
+  virtual Sample* ReserveSampleForThread(Thread* thread);
+
+  // Marks the block owned by |thread|, if any, as full.
+  void ReleaseBlock(Thread* thread);
+
+ private:
+  enum BlockState {
+    kFreeBlock = 0,
+    kOwnedBlock,
+    kFullBlock,
+  };
+
+  struct Block {
+    uword state;
+    // The number of samples reserved in the block. Only accessed by the
+    // owning thread.
+    intptr_t cursor;
+  };
+
+  intptr_t IndexOf(Sample* sample) const;
+  intptr_t ClaimBlock();
+  void MarkFull(intptr_t block);
+
+  intptr_t block_count_;
+  Block* blocks_;
+  // Where to start looking for a block to claim.
+  uword next_block_;
+
+  DISALLOW_COPY_AND_ASSIGN(SampleBlockBuffer);
+};
+
 // A |ProcessedSample| is a combination of 1 (or more) |Sample|(s) that have
 // been merged into a logical sample. The raw data may have been processed to
 // improve the quality of the stack trace.
@@ -0,0 +1,464 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/profiler_pprof.h"
+
+#include "platform/utils.h"
+
+#include "vm/code_descriptors.h"
+#include "vm/hash_map.h"
+#include "vm/native_symbol.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/os_thread.h"
+#include "vm/protobuf.h"
+#include "vm/tags.h"
+#include "vm/thread_interrupter.h"
+
+namespace dart {
+
+#ifndef PRODUCT
+
+DECLARE_FLAG(int, profile_period);
+
+// Field numbers from profile.proto.
+enum {
+  kProfileSampleType = 1,
+  kProfileSample = 2,
+  kProfileMapping = 3,
+  kProfileLocation = 4,
+  kProfileFunction = 5,
+  kProfileStringTable = 6,
+  kProfileTimeNanos = 9,
+  kProfileDurationNanos = 10,
+  kProfilePeriodType = 11,
+  kProfilePeriod = 12,
+
+  kValueTypeType = 1,
+  kValueTypeUnit = 2,
+
+  kSampleLocationId = 1,
+  kSampleValue = 2,
+  kSampleLabel = 3,
+
+  kLabelKey = 1,
+  kLabelStr = 2,
+  kLabelNum = 3,
+
+  kMappingId = 1,
+  kMappingMemoryStart = 2,
+  kMappingFilename = 5,
+  kMappingHasFunctions = 7,
+
+  kLocationId = 1,
+  kLocationMappingId = 2,
+  kLocationAddress = 3,
+  kLocationLine = 4,
+
+  kLineFunctionId = 1,
+  kLineLine = 2,
+
+  kFunctionId = 1,
+  kFunctionName = 2,
+  kFunctionSystemName = 3,
+  kFunctionFilename = 4,
+};
+
+// Maps an address or a pair of string indices to the id of the entry written
+// for it.
+template <typename K>
+class IdKeyValueTrait {
+ public:
+  typedef K Key;
+  typedef uint64_t Value;
+
+  struct Pair {
+    Key key;
+    Value value;
+    Pair() : key(0), value(0) {}
+    Pair(const Key key, const Value& value) : key(key), value(value) {}
+    Pair(const Pair& other) : key(other.key), value(other.value) {}
+  };
+
+  static Key KeyOf(Pair kv) { return kv.key; }
+  static Value ValueOf(Pair kv) { return kv.value; }
+  static intptr_t Hashcode(Key key) {
+    const uint64_t bits = static_cast<uint64_t>(key);
+    return Utils::WordHash(static_cast<intptr_t>(bits ^ (bits >> 32)));
+  }
+  static bool IsKeyEqual(Pair kv, Key key) { return kv.key == key; }
+};
+
+class CStringIdKeyValueTrait {
+ public:
+  typedef const char* Key;
+  typedef uint64_t Value;
+
+  struct Pair {
+    Key key;
+    Value value;
+    Pair() : key(NULL), value(0) {}
+    Pair(const Key key, const Value& value) : key(key), value(value) {}
+    Pair(const Pair& other) : key(other.key), value(other.value) {}
+  };
+
+  static Key KeyOf(Pair kv) { return kv.key; }
+  static Value ValueOf(Pair kv) { return kv.value; }
+  static intptr_t Hashcode(Key key) {
+    return Utils::StringHash(key, strlen(key));
+  }
+  static bool IsKeyEqual(Pair kv, Key key) { return strcmp(kv.key, key) == 0; }
+};
+
+// The entries written so far. Ids start at 1, 0 means no entry.
+struct PprofTables {
+  PprofTables() : location_count(0), function_count(0), mapping_count(0) {}
+
+  ~PprofTables() {
+    for (intptr_t i = 0; i < strings_by_index.length(); i++) {
+      free(strings_by_index[i]);
+    }
+  }
+
+  // Keyed by the pc used to symbolize the location.
+  MallocDirectChainedHashMap<IdKeyValueTrait<uword> > locations;
+  // Keyed by the string indices of the name and the file name.
+  MallocDirectChainedHashMap<IdKeyValueTrait<uint64_t> > functions;
+  // Keyed by the base address of the shared object.
+  MallocDirectChainedHashMap<IdKeyValueTrait<uword> > mappings;
+  // Keyed by the string, the value is its index in the string table plus
+  // one, since the hash map reserves 0 for empty entries.
+  MallocDirectChainedHashMap<CStringIdKeyValueTrait> strings;
+  // Copies of the strings in the string table, owned by this table.
+  MallocGrowableArray<char*> strings_by_index;
+  uint64_t location_count;
+  uint64_t function_count;
+  uint64_t mapping_count;
+};
+
+bool CpuSampleFilter::FilterSample(Sample* sample) {
+  if (sample->is_allocation_sample()) {
+    return false;
+  }
+  return (thread_id_ == kNoThreadFilter) ||
+         (OSThread::ThreadIdToIntPtr(sample->tid()) == thread_id_);
+}
+
+class PprofSampleVisitor : public ProcessedSampleVisitor {
+ public:
+  PprofSampleVisitor(Thread* thread,
+                     const CodeLookupTable& clt,
+                     PprofExporter* exporter)
+      : thread_(thread), clt_(clt), exporter_(exporter), count_(0) {}
+
+  void VisitProcessedSample(ProcessedSample* sample) {
+    exporter_->WriteSample(thread_, clt_, sample);
+    count_++;
+  }
+
+  intptr_t count() const { return count_; }
+
+ private:
+  Thread* thread_;
+  const CodeLookupTable& clt_;
+  PprofExporter* exporter_;
+  intptr_t count_;
+};
+
+const char* PprofExporter::kStreamName = "profile.pb";
+
+PprofExporter::PprofExporter(Dart_StreamConsumer consumer, void* user_data)
+    : consumer_(consumer),
+      user_data_(user_data),
+      tables_(new PprofTables()),
+      output_(new ProtobufBuffer()),
+      message_(new ProtobufBuffer()),
+      entry_(new ProtobufBuffer()),
+      nested_(new ProtobufBuffer()),
+      packed_(new ProtobufBuffer()),
+      min_timestamp_(kMaxInt64),
+      max_timestamp_(kMinInt64) {
+  ASSERT(consumer_ != NULL);
+}
+
+PprofExporter::~PprofExporter() {
+  delete tables_;
+  delete output_;
+  delete message_;
+  delete entry_;
+  delete nested_;
+  delete packed_;
+}
+
+intptr_t PprofExporter::Export(Thread* thread,
+                               SampleBuffer* sample_buffer,
+                               SampleFilter* filter) {
+  ASSERT(sample_buffer != NULL);
+  // Disable thread interrupts while processing the buffer.
+  DisableThreadInterruptsScope dtis(thread);
+
+  consumer_(Dart_StreamConsumer_kStart, kStreamName, NULL, 0, user_data_);
+  WriteHeader();
+  intptr_t count = 0;
+  {
+    StackZone zone(thread);
+    HANDLESCOPE(thread);
+    CodeLookupTable* clt = new (zone.GetZone()) CodeLookupTable(thread);
+    PprofSampleVisitor visitor(thread, *clt, this);
+    sample_buffer->VisitProcessedSamples(filter, *clt, &visitor);
+    count = visitor.count();
+  }
+  WriteTrailer();
+  Flush();
+  consumer_(Dart_StreamConsumer_kFinish, kStreamName, NULL, 0, user_data_);
+  return count;
+}
+
+void PprofExporter::WriteHeader() {
+  // The first string of the table must be the empty string.
+  const int64_t empty = StringIndex("");
+  ASSERT(empty == 0);
+
+  nested_->Clear();
+  nested_->WriteInt(kValueTypeType, StringIndex("samples"));
+  nested_->WriteInt(kValueTypeUnit, StringIndex("count"));
+  output_->WriteMessage(kProfileSampleType, *nested_);
+
+  nested_->Clear();
+  nested_->WriteInt(kValueTypeType, StringIndex("cpu"));
+  nested_->WriteInt(kValueTypeUnit, StringIndex("nanoseconds"));
+  output_->WriteMessage(kProfileSampleType, *nested_);
+  output_->WriteMessage(kProfilePeriodType, *nested_);
+  output_->WriteInt(kProfilePeriod,
+                    FLAG_profile_period * kNanosecondsPerMicrosecond);
+}
+
+void PprofExporter::WriteTrailer() {
+  if (min_timestamp_ > max_timestamp_) {
+    // No samples.
+    return;
+  }
+  // Sample timestamps come from the monotonic clock, pprof expects the
+  // start of the profile in wall clock time.
+  const int64_t start_micros = min_timestamp_ +
+                               OS::GetCurrentTimeMicros() -
+                               OS::GetCurrentMonotonicMicros();
+  output_->WriteInt(kProfileTimeNanos,
+                    start_micros * kNanosecondsPerMicrosecond);
+  output_->WriteInt(
+      kProfileDurationNanos,
+      (max_timestamp_ - min_timestamp_ + FLAG_profile_period) *
+          kNanosecondsPerMicrosecond);
+}
+
+void PprofExporter::WriteSample(Thread* thread,
+                                const CodeLookupTable& clt,
+                                ProcessedSample* sample) {
+  if (sample->timestamp() < min_timestamp_) {
+    min_timestamp_ = sample->timestamp();
+  }
+  if (sample->timestamp() > max_timestamp_) {
+    max_timestamp_ = sample->timestamp();
+  }
+
+  // Resolving the frames may emit new locations, so the sample itself is
+  // only encoded afterwards.
+  packed_->Clear();
+  for (intptr_t i = 0; i < sample->length(); i++) {
+    packed_->WriteVarint(LocationId(thread, clt, sample, i));
+  }
+  message_->Clear();
+  message_->WriteMessage(kSampleLocationId, *packed_);
+
+  packed_->Clear();
+  packed_->WriteVarint(1);
+  packed_->WriteVarint(FLAG_profile_period * kNanosecondsPerMicrosecond);
+  message_->WriteMessage(kSampleValue, *packed_);
+
+  nested_->Clear();
+  nested_->WriteInt(kLabelKey, StringIndex("thread id"));
+  nested_->WriteInt(kLabelNum, OSThread::ThreadIdToIntPtr(sample->tid()));
+  message_->WriteMessage(kSampleLabel, *nested_);
+
+  nested_->Clear();
+  nested_->WriteInt(kLabelKey, StringIndex("vm tag"));
+  nested_->WriteInt(kLabelStr, StringIndex(VMTag::TagName(sample->vm_tag())));
+  message_->WriteMessage(kSampleLabel, *nested_);
+
+  output_->WriteMessage(kProfileSample, *message_);
+  MaybeFlush();
+}
+
+uint64_t PprofExporter::LocationId(Thread* thread,
+                                   const CodeLookupTable& clt,
+                                   ProcessedSample* sample,
+                                   intptr_t frame_index) {
+  const uword pc = sample->At(frame_index);
+  // Below the top frame, and in the top frame if the sample was taken at an
+  // exit frame, pcs are return addresses. Symbolize the call instead, which
+  // can belong to a different inlining interval or function.
+  const bool is_return_address =
+      (frame_index != 0) || !sample->first_frame_executing();
+  const uword lookup_pc = is_return_address ? pc - 1 : pc;
+
+  IdKeyValueTrait<uword>::Pair* pair = tables_->locations.Lookup(lookup_pc);
+  if (pair != NULL) {
+    return pair->value;
+  }
+  const uint64_t id = ++tables_->location_count;
+  tables_->locations.Insert(IdKeyValueTrait<uword>::Pair(lookup_pc, id));
+
+  message_->Clear();
+  message_->WriteInt(kLocationId, id);
+  message_->WriteInt(kLocationAddress, pc);
+  const CodeDescriptor* cd = clt.FindCode(lookup_pc);
+  if (cd != NULL) {
+    const Code& code = Code::Handle(thread->zone(), cd->code());
+    WriteDartLines(thread, code, lookup_pc);
+  } else {
+    WriteNativeLines(lookup_pc);
+  }
+  // The location is written to the output before the sample referencing it,
+  // which is fine since the order of entries in the profile is irrelevant.
+  output_->WriteMessage(kProfileLocation, *message_);
+  return id;
+}
+
+void PprofExporter::WriteDartLines(Thread* thread,
+                                   const Code& code,
+                                   uword lookup_pc) {
+  Zone* zone = thread->zone();
+  GrowableArray<const Function*> functions;
+  GrowableArray<TokenPosition> token_positions;
+  code.GetInlinedFunctionsAtInstruction(lookup_pc - code.PayloadStart(),
+                                        &functions, &token_positions);
+  if (functions.is_empty()) {
+    // A stub, or other code without source positions.
+    nested_->Clear();
+    nested_->WriteInt(kLineFunctionId, FunctionId(code.Name(), ""));
+    message_->WriteMessage(kLocationLine, *nested_);
+    return;
+  }
+
+  // The innermost inlined function comes first in pprof and last in
+  // |functions|.
+  String& str = String::Handle(zone);
+  Script& script = Script::Handle(zone);
+  for (intptr_t i = functions.length() - 1; i >= 0; i--) {
+    const Function& function = *functions[i];
+    str = function.QualifiedUserVisibleName();
+    const char* name = str.ToCString();
+    const char* filename = "";
+    intptr_t line = 0;
+    script = function.script();
+    if (!script.IsNull()) {
+      str = script.url();
+      filename = str.ToCString();
+      TokenPosition token_pos = token_positions[i];
+      if (token_pos.IsSourcePosition()) {
+        if (token_pos.IsSynthetic()) {
+          token_pos = token_pos.FromSynthetic();
+        }
+        intptr_t column = 0;
+        script.GetTokenLocation(token_pos, &line, &column);
+      }
+    }
+    const uint64_t function_id = FunctionId(name, filename);
+    nested_->Clear();
+    nested_->WriteInt(kLineFunctionId, function_id);
+    nested_->WriteInt(kLineLine, line);
+    message_->WriteMessage(kLocationLine, *nested_);
+  }
+}
+
+void PprofExporter::WriteNativeLines(uword lookup_pc) {
+  message_->WriteInt(kLocationMappingId, MappingId(lookup_pc));
+  uintptr_t start = 0;
+  char* native_name =
+      NativeSymbolResolver::LookupSymbolName(lookup_pc, &start);
+  if (native_name == NULL) {
+    // Left to pprof, which can symbolize the address with the mapping.
+    return;
+  }
+  const uint64_t function_id = FunctionId(native_name, "");
+  NativeSymbolResolver::FreeSymbolName(native_name);
+  nested_->Clear();
+  nested_->WriteInt(kLineFunctionId, function_id);
+  message_->WriteMessage(kLocationLine, *nested_);
+}
+
+uint64_t PprofExporter::FunctionId(const char* name, const char* filename) {
+  const uint64_t name_index = StringIndex(name);
+  const uint64_t filename_index = StringIndex(filename);
+  const uint64_t key = (name_index << 32) | filename_index;
+  IdKeyValueTrait<uint64_t>::Pair* pair = tables_->functions.Lookup(key);
+  if (pair != NULL) {
+    return pair->value;
+  }
+  const uint64_t id = ++tables_->function_count;
+  tables_->functions.Insert(IdKeyValueTrait<uint64_t>::Pair(key, id));
+
+  entry_->Clear();
+  entry_->WriteInt(kFunctionId, id);
+  entry_->WriteInt(kFunctionName, name_index);
+  entry_->WriteInt(kFunctionSystemName, name_index);
+  entry_->WriteInt(kFunctionFilename, filename_index);
+  output_->WriteMessage(kProfileFunction, *entry_);
+  return id;
+}
+
+uint64_t PprofExporter::MappingId(uword pc) {
+  uword dso_base = 0;
+  char* dso_name = NULL;
+  if (!NativeSymbolResolver::LookupSharedObject(pc, &dso_base, &dso_name)) {
+    return 0;
+  }
+  IdKeyValueTrait<uword>::Pair* pair = tables_->mappings.Lookup(dso_base);
+  if (pair != NULL) {
+    NativeSymbolResolver::FreeSymbolName(dso_name);
+    return pair->value;
+  }
+  const uint64_t id = ++tables_->mapping_count;
+  tables_->mappings.Insert(IdKeyValueTrait<uword>::Pair(dso_base, id));
+
+  entry_->Clear();
+  entry_->WriteInt(kMappingId, id);
+  entry_->WriteInt(kMappingMemoryStart, dso_base);
+  entry_->WriteInt(kMappingFilename, StringIndex(dso_name));
+  entry_->WriteInt(kMappingHasFunctions, 1);
+  output_->WriteMessage(kProfileMapping, *entry_);
+  NativeSymbolResolver::FreeSymbolName(dso_name);
+  return id;
+}
+
+int64_t PprofExporter::StringIndex(const char* str) {
+  CStringIdKeyValueTrait::Pair* pair = tables_->strings.Lookup(str);
+  if (pair != NULL) {
+    return pair->value - 1;
+  }
+  char* copy = strdup(str);
+  const int64_t index = tables_->strings_by_index.length();
+  tables_->strings_by_index.Add(copy);
+  tables_->strings.Insert(CStringIdKeyValueTrait::Pair(copy, index + 1));
+  output_->WriteString(kProfileStringTable, copy);
+  return index;
+}
+
+void PprofExporter::MaybeFlush() {
+  if (output_->length() >= kChunkSize) {
+    Flush();
+  }
+}
+
+void PprofExporter::Flush() {
+  if (output_->length() > 0) {
+    consumer_(Dart_StreamConsumer_kData, kStreamName, output_->data(),
+              output_->length(), user_data_);
+    output_->Clear();
+  }
+}
+
+#endif  // !PRODUCT
+
+}  // namespace dart
@@ -0,0 +1,117 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_PROFILER_PPROF_H_
+#define RUNTIME_VM_PROFILER_PPROF_H_
+
+#include "include/dart_tools_api.h"
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+#include "vm/profiler.h"
+
+// Export of profiler samples in the pprof profile format.
+// NOTE: For the Observatory profile model, see profiler_service.h.
+
+namespace dart {
+
+#ifndef PRODUCT
+
+struct PprofTables;
+class ProtobufBuffer;
+
+// Selects the CPU samples of one isolate, optionally restricted to a single
+// thread and a time range.
+class CpuSampleFilter : public SampleFilter {
+ public:
+  CpuSampleFilter(Dart_Port port,
+                  intptr_t thread_task_mask,
+                  int64_t thread_id,
+                  int64_t time_origin_micros,
+                  int64_t time_extent_micros)
+      : SampleFilter(port,
+                     thread_task_mask,
+                     time_origin_micros,
+                     time_extent_micros),
+        thread_id_(thread_id) {}
+
+  bool FilterSample(Sample* sample);
+
+  static const int64_t kNoThreadFilter = -1;
+
+ private:
+  // OSThread::ThreadIdToIntPtr of the sampled thread, or kNoThreadFilter.
+  const int64_t thread_id_;
+};
+
+// Writes samples in the pprof profile format
+// (https://github.com/google/pprof/blob/master/proto/profile.proto), without
+// compression.
+//
+// Samples are processed and encoded one at a time and the output is handed
+// to the consumer in chunks of kChunkSize bytes. Locations, functions,
+// mappings and strings are emitted the first time they are referenced, so
+// only the tables used to deduplicate them grow with the profile.
+//
+// Dart frames are symbolized with the code of the current isolate, including
+// the functions inlined at each pc. Other frames are symbolized with the
+// NativeSymbolResolver, and attributed to the mapping of the shared object
+// they belong to.
+class PprofExporter : public ValueObject {
+ public:
+  static const intptr_t kChunkSize = 64 * KB;
+  static const char* kStreamName;
+
+  PprofExporter(Dart_StreamConsumer consumer, void* user_data);
+  ~PprofExporter();
+
+  // Writes the samples of |sample_buffer| that pass |filter| as one stream.
+  // Returns the number of samples written.
+  intptr_t Export(Thread* thread,
+                  SampleBuffer* sample_buffer,
+                  SampleFilter* filter);
+
+ private:
+  friend class PprofSampleVisitor;
+
+  void WriteSample(Thread* thread,
+                   const CodeLookupTable& clt,
+                   ProcessedSample* sample);
+  uint64_t LocationId(Thread* thread,
+                      const CodeLookupTable& clt,
+                      ProcessedSample* sample,
+                      intptr_t frame_index);
+  // Add the lines of the location being written to |message_|.
+  void WriteDartLines(Thread* thread, const Code& code, uword lookup_pc);
+  void WriteNativeLines(uword lookup_pc);
+  uint64_t FunctionId(const char* name, const char* filename);
+  uint64_t MappingId(uword pc);
+  int64_t StringIndex(const char* str);
+
+  void WriteHeader();
+  void WriteTrailer();
+  void MaybeFlush();
+  void Flush();
+
+  Dart_StreamConsumer consumer_;
+  void* user_data_;
+  PprofTables* tables_;
+  ProtobufBuffer* output_;
+  // Scratch buffers for samples and locations, for functions and mappings,
+  // for their nested messages, and for packed repeated fields.
+  ProtobufBuffer* message_;
+  ProtobufBuffer* entry_;
+  ProtobufBuffer* nested_;
+  ProtobufBuffer* packed_;
+  int64_t min_timestamp_;
+  int64_t max_timestamp_;
+
+  DISALLOW_COPY_AND_ASSIGN(PprofExporter);
+};
+
+#endif  // !PRODUCT
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_PROFILER_PPROF_H_
@@ -8,6 +8,7 @@
 #include "vm/dart_api_state.h"
 #include "vm/globals.h"
 #include "vm/profiler.h"
+#include "vm/profiler_pprof.h"
 #include "vm/profiler_service.h"
 #include "vm/source_report.h"
 #include "vm/unit_test.h"
@@ -20,6 +21,7 @@ DECLARE_FLAG(bool, profile_vm);
 DECLARE_FLAG(int, max_profile_depth);
 DECLARE_FLAG(bool, enable_inlining_annotations);
 DECLARE_FLAG(int, optimization_counter_threshold);
+DECLARE_FLAG(int, profile_period);
 
 // Some tests are written assuming native stack trace profiling is disabled.
 class DisableNativeProfileScope : public ValueObject {
@@ -2944,6 +2946,488 @@ TEST_CASE(Profiler_ProfileCodeTableTest) {
   EXPECT_EQ(table->FindCodeForPC(50), code1);
 }
 
+static void FillBlockSample(Sample* sample, Dart_Port port, intptr_t i) {
+  sample->Init(port, 1000 + i, OSThread::GetCurrentThreadId());
+  sample->set_thread_task(Thread::kMutatorTask);
+  sample->SetAt(0, 0x1000 + i);
+}
+
+TEST_CASE(Profiler_SampleBlockBuffer) {
+  const intptr_t kSamplesPerBlock = SampleBlockBuffer::kSamplesPerBlock;
+  const Dart_Port port = Isolate::Current()->main_port();
+  const intptr_t saved_block = thread->profiler_block();
+  thread->set_profiler_block(-1);
+  SampleBlockBuffer* sample_buffer =
+      new SampleBlockBuffer(2 * kSamplesPerBlock);
+  EXPECT_EQ(2, sample_buffer->block_count());
+
+  // A thread fills its block before claiming the next one.
+  for (intptr_t i = 0; i < kSamplesPerBlock + 1; i++) {
+    Sample* sample = sample_buffer->ReserveSampleForThread(thread);
+    EXPECT(sample == sample_buffer->At(i));
+    FillBlockSample(sample, port, i);
+  }
+  EXPECT_EQ(1, thread->profiler_block());
+
+  // Chains do not cross blocks.
+  Sample* last = NULL;
+  for (intptr_t i = kSamplesPerBlock + 1; i < 2 * kSamplesPerBlock; i++) {
+    last = sample_buffer->ReserveSampleForThread(thread);
+    FillBlockSample(last, port, i);
+  }
+  EXPECT(sample_buffer->ReserveSampleAndLink(last) == NULL);
+  sample_buffer->ReleaseBlock(thread);
+  EXPECT_EQ(-1, thread->profiler_block());
+
+  // Once every block is full, the oldest one is reused and the samples of
+  // the others are kept.
+  Sample* sample = sample_buffer->ReserveSampleForThread(thread);
+  EXPECT(sample == sample_buffer->At(0));
+  FillBlockSample(sample, port, 2 * kSamplesPerBlock);
+  EXPECT_EQ(0, thread->profiler_block());
+  EXPECT_EQ(1000 + kSamplesPerBlock,
+            sample_buffer->At(kSamplesPerBlock)->timestamp());
+
+  // Samples are dropped while every block is owned by a thread. Pretend that
+  // another thread owns block 0.
+  thread->set_profiler_block(-1);
+  sample = sample_buffer->ReserveSampleForThread(thread);
+  EXPECT(sample == sample_buffer->At(kSamplesPerBlock));
+  EXPECT_EQ(1, thread->profiler_block());
+  thread->set_profiler_block(-1);
+  EXPECT(sample_buffer->ReserveSampleForThread(thread) == NULL);
+  EXPECT_EQ(-1, thread->profiler_block());
+
+  thread->set_profiler_block(0);
+  sample_buffer->ReleaseBlock(thread);
+  thread->set_profiler_block(1);
+  sample_buffer->ReleaseBlock(thread);
+  EXPECT(sample_buffer->ReserveSampleForThread(thread) != NULL);
+  sample_buffer->ReleaseBlock(thread);
+
+  delete sample_buffer;
+  thread->set_profiler_block(saved_block);
+}
+
+struct PprofOutput {
+  PprofOutput() : starts(0), finishes(0) {}
+
+  MallocGrowableArray<uint8_t> bytes;
+  intptr_t starts;
+  intptr_t finishes;
+};
+
+// Reads the fields of an encoded protocol buffer message.
+class ProtobufReader {
+ public:
+  ProtobufReader(const uint8_t* data, intptr_t length)
+      : data_(data), end_(data + length), wire_type_(-1) {}
+
+  // Reads the tag of the next field, or returns false at the end of the
+  // message.
+  bool NextField(intptr_t* field) {
+    if (data_ >= end_) {
+      return false;
+    }
+    const uint64_t tag = ReadVarint();
+    *field = static_cast<intptr_t>(tag >> 3);
+    wire_type_ = static_cast<intptr_t>(tag & 7);
+    return true;
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (intptr_t shift = 0; data_ < end_; shift += 7) {
+      const uint8_t byte = *data_++;
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    EXPECT(!"Truncated varint");
+    return value;
+  }
+
+  // Returns a reader for a nested message, string or packed field.
+  ProtobufReader ReadBytes() {
+    EXPECT_EQ(kLengthDelimited, wire_type_);
+    const intptr_t length = static_cast<intptr_t>(ReadVarint());
+    EXPECT(data_ + length <= end_);
+    ProtobufReader bytes(data_, length);
+    data_ += length;
+    return bytes;
+  }
+
+  uint64_t ReadInt() {
+    EXPECT_EQ(kVarint, wire_type_);
+    return ReadVarint();
+  }
+
+  const uint8_t* data() const { return data_; }
+  intptr_t length() const { return end_ - data_; }
+  bool AtEnd() const { return data_ >= end_; }
+
+  bool Equals(const char* str) const {
+    const intptr_t len = strlen(str);
+    return (len == length()) && (memcmp(data_, str, len) == 0);
+  }
+
+ private:
+  enum { kVarint = 0, kLengthDelimited = 2 };
+
+  const uint8_t* data_;
+  const uint8_t* end_;
+  intptr_t wire_type_;
+};
+
+struct PprofLocation {
+  uint64_t id;
+  uint64_t address;
+  uint64_t function_id;
+};
+
+struct PprofFunction {
+  uint64_t id;
+  uint64_t name;
+  uint64_t filename;
+};
+
+struct PprofLabel {
+  uint64_t key;
+  uint64_t str;
+  int64_t num;
+};
+
+struct PprofSample {
+  MallocGrowableArray<uint64_t> location_ids;
+  MallocGrowableArray<uint64_t> values;
+  MallocGrowableArray<PprofLabel> labels;
+};
+
+// The tables of a decoded pprof profile. String fields hold indices into
+// |strings|.
+struct PprofProfile {
+  PprofProfile() : period(0), time_nanos(0), duration_nanos(0) {}
+  ~PprofProfile() {
+    for (intptr_t i = 0; i < samples.length(); i++) {
+      delete samples[i];
+    }
+  }
+
+  void Decode(const PprofOutput& output) {
+    ProtobufReader reader(output.bytes.data(), output.bytes.length());
+    intptr_t field = 0;
+    while (reader.NextField(&field)) {
+      switch (field) {
+        case 1: {  // sample_type
+          ProtobufReader value_type = reader.ReadBytes();
+          uint64_t type = 0;
+          uint64_t unit = 0;
+          while (value_type.NextField(&field)) {
+            if (field == 1) {
+              type = value_type.ReadInt();
+            } else if (field == 2) {
+              unit = value_type.ReadInt();
+            }
+          }
+          sample_types.Add(type);
+          sample_types.Add(unit);
+          break;
+        }
+        case 2:
+          DecodeSample(reader.ReadBytes());
+          break;
+        case 3:  // mapping
+          reader.ReadBytes();
+          break;
+        case 4:
+          DecodeLocation(reader.ReadBytes());
+          break;
+        case 5:
+          DecodeFunction(reader.ReadBytes());
+          break;
+        case 6: {
+          ProtobufReader str = reader.ReadBytes();
+          strings.Add(str);
+          break;
+        }
+        case 9:
+          time_nanos = reader.ReadInt();
+          break;
+        case 10:
+          duration_nanos = reader.ReadInt();
+          break;
+        case 11:  // period_type
+          reader.ReadBytes();
+          break;
+        case 12:
+          period = reader.ReadInt();
+          break;
+        default:
+          EXPECT(!"Unexpected field");
+          return;
+      }
+    }
+  }
+
+  void DecodeSample(ProtobufReader reader) {
+    PprofSample* sample = new PprofSample();
+    intptr_t field = 0;
+    while (reader.NextField(&field)) {
+      if ((field == 1) || (field == 2)) {
+        ProtobufReader packed = reader.ReadBytes();
+        while (!packed.AtEnd()) {
+          if (field == 1) {
+            sample->location_ids.Add(packed.ReadVarint());
+          } else {
+            sample->values.Add(packed.ReadVarint());
+          }
+        }
+      } else if (field == 3) {
+        ProtobufReader label_reader = reader.ReadBytes();
+        PprofLabel label = {0, 0, 0};
+        while (label_reader.NextField(&field)) {
+          if (field == 1) {
+            label.key = label_reader.ReadInt();
+          } else if (field == 2) {
+            label.str = label_reader.ReadInt();
+          } else if (field == 3) {
+            label.num = static_cast<int64_t>(label_reader.ReadInt());
+          }
+        }
+        sample->labels.Add(label);
+      }
+    }
+    samples.Add(sample);
+  }
+
+  void DecodeLocation(ProtobufReader reader) {
+    PprofLocation location = {0, 0, 0};
+    intptr_t field = 0;
+    while (reader.NextField(&field)) {
+      if (field == 1) {
+        location.id = reader.ReadInt();
+      } else if (field == 2) {
+        reader.ReadInt();  // mapping_id
+      } else if (field == 3) {
+        location.address = reader.ReadInt();
+      } else if (field == 4) {
+        // Only the outermost function of a line is checked.
+        ProtobufReader line = reader.ReadBytes();
+        while (line.NextField(&field)) {
+          if (field == 1) {
+            location.function_id = line.ReadInt();
+          } else {
+            line.ReadInt();
+          }
+        }
+      }
+    }
+    locations.Add(location);
+  }
+
+  void DecodeFunction(ProtobufReader reader) {
+    PprofFunction function = {0, 0, 0};
+    intptr_t field = 0;
+    while (reader.NextField(&field)) {
+      if (field == 1) {
+        function.id = reader.ReadInt();
+      } else if (field == 2) {
+        function.name = reader.ReadInt();
+      } else if (field == 3) {
+        EXPECT_EQ(function.name, reader.ReadInt());
+      } else if (field == 4) {
+        function.filename = reader.ReadInt();
+      }
+    }
+    functions.Add(function);
+  }
+
+  bool StringEquals(uint64_t index, const char* str) const {
+    return (index < static_cast<uint64_t>(strings.length())) &&
+           strings[index].Equals(str);
+  }
+
+  const PprofLocation* FindLocation(uint64_t id) const {
+    for (intptr_t i = 0; i < locations.length(); i++) {
+      if (locations[i].id == id) {
+        return &locations[i];
+      }
+    }
+    return NULL;
+  }
+
+  const PprofFunction* FindFunction(uint64_t id) const {
+    for (intptr_t i = 0; i < functions.length(); i++) {
+      if (functions[i].id == id) {
+        return &functions[i];
+      }
+    }
+    return NULL;
+  }
+
+  MallocGrowableArray<ProtobufReader> strings;
+  // Pairs of the type and unit of each sample value.
+  MallocGrowableArray<uint64_t> sample_types;
+  MallocGrowableArray<PprofSample*> samples;
+  MallocGrowableArray<PprofLocation> locations;
+  MallocGrowableArray<PprofFunction> functions;
+  uint64_t period;
+  uint64_t time_nanos;
+  uint64_t duration_nanos;
+};
+
+static void PprofConsumer(Dart_StreamConsumer_State state,
+                          const char* stream_name,
+                          const uint8_t* buffer,
+                          intptr_t buffer_length,
+                          void* user_data) {
+  PprofOutput* output = reinterpret_cast<PprofOutput*>(user_data);
+  if (state == Dart_StreamConsumer_kStart) {
+    output->starts++;
+  } else if (state == Dart_StreamConsumer_kFinish) {
+    output->finishes++;
+  } else {
+    EXPECT(buffer != NULL);
+    for (intptr_t i = 0; i < buffer_length; i++) {
+      output->bytes.Add(buffer[i]);
+    }
+  }
+}
+
+TEST_CASE(Profiler_PprofExport) {
+  Isolate* isolate = Isolate::Current();
+  const Dart_Port port = isolate->main_port();
+  const ThreadId tid = OSThread::GetCurrentThreadId();
+  const uword pc = reinterpret_cast<uword>(&PprofConsumer);
+  SampleBuffer* sample_buffer = new SampleBuffer(4);
+
+  Sample* sample = sample_buffer->ReserveSample();
+  sample->Init(port, 1000, tid);
+  sample->set_thread_task(Thread::kMutatorTask);
+  sample->set_vm_tag(VMTag::kVMTagId);
+  sample->SetAt(0, pc);
+  sample->SetAt(1, pc + 8);
+
+  // The same stack in another sample shares its locations.
+  sample = sample_buffer->ReserveSample();
+  sample->Init(port, 2000, tid);
+  sample->set_thread_task(Thread::kMutatorTask);
+  sample->set_vm_tag(VMTag::kVMTagId);
+  sample->SetAt(0, pc);
+  sample->SetAt(1, pc + 8);
+
+  // Allocation samples are not CPU samples.
+  sample = sample_buffer->ReserveSample();
+  sample->Init(port, 3000, tid);
+  sample->set_thread_task(Thread::kMutatorTask);
+  sample->set_is_allocation_sample(true);
+  sample->SetAt(0, pc);
+
+  // Another isolate.
+  sample = sample_buffer->ReserveSample();
+  sample->Init(port + 1, 4000, tid);
+  sample->set_thread_task(Thread::kMutatorTask);
+  sample->SetAt(0, pc);
+
+  {
+    PprofOutput output;
+    CpuSampleFilter filter(port, Thread::kMutatorTask,
+                           CpuSampleFilter::kNoThreadFilter, -1, -1);
+    PprofExporter exporter(PprofConsumer, &output);
+    EXPECT_EQ(2, exporter.Export(thread, sample_buffer, &filter));
+    EXPECT_EQ(1, output.starts);
+    EXPECT_EQ(1, output.finishes);
+
+    PprofProfile profile;
+    profile.Decode(output);
+    EXPECT(profile.StringEquals(0, ""));
+    EXPECT_EQ(4, profile.sample_types.length());
+    EXPECT(profile.StringEquals(profile.sample_types[0], "samples"));
+    EXPECT(profile.StringEquals(profile.sample_types[1], "count"));
+    EXPECT(profile.StringEquals(profile.sample_types[2], "cpu"));
+    EXPECT(profile.StringEquals(profile.sample_types[3], "nanoseconds"));
+    const uint64_t period_nanos =
+        FLAG_profile_period * kNanosecondsPerMicrosecond;
+    EXPECT_EQ(period_nanos, profile.period);
+    EXPECT(profile.time_nanos > 0);
+    const uint64_t duration_nanos =
+        (1000 + FLAG_profile_period) * kNanosecondsPerMicrosecond;
+    EXPECT_EQ(duration_nanos, profile.duration_nanos);
+
+    // Both samples have the same two locations, with one entry each.
+    EXPECT_EQ(2, profile.samples.length());
+    EXPECT_EQ(2, profile.locations.length());
+    for (intptr_t i = 0; i < profile.samples.length(); i++) {
+      PprofSample* pprof_sample = profile.samples[i];
+      EXPECT_EQ(2, pprof_sample->location_ids.length());
+      EXPECT_EQ(profile.samples[0]->location_ids[0],
+                pprof_sample->location_ids[0]);
+      EXPECT_EQ(profile.samples[0]->location_ids[1],
+                pprof_sample->location_ids[1]);
+      EXPECT_EQ(2, pprof_sample->values.length());
+      EXPECT_EQ(1U, pprof_sample->values[0]);
+      EXPECT_EQ(period_nanos, pprof_sample->values[1]);
+
+      EXPECT_EQ(2, pprof_sample->labels.length());
+      const PprofLabel& thread_label = pprof_sample->labels[0];
+      EXPECT(profile.StringEquals(thread_label.key, "thread id"));
+      EXPECT_EQ(OSThread::ThreadIdToIntPtr(tid), thread_label.num);
+      const PprofLabel& tag_label = pprof_sample->labels[1];
+      EXPECT(profile.StringEquals(tag_label.key, "vm tag"));
+      EXPECT(profile.StringEquals(tag_label.str,
+                                  VMTag::TagName(VMTag::kVMTagId)));
+    }
+    const PprofLocation* top =
+        profile.FindLocation(profile.samples[0]->location_ids[0]);
+    const PprofLocation* caller =
+        profile.FindLocation(profile.samples[0]->location_ids[1]);
+    EXPECT(top != NULL);
+    EXPECT(caller != NULL);
+    EXPECT(top != caller);
+    if ((top != NULL) && (caller != NULL)) {
+      EXPECT_EQ(pc, top->address);
+      EXPECT_EQ(pc + 8, caller->address);
+    }
+
+    // Lines refer to functions, and functions to strings, that were written.
+    for (intptr_t i = 0; i < profile.locations.length(); i++) {
+      const uint64_t function_id = profile.locations[i].function_id;
+      if (function_id != 0) {
+        EXPECT(profile.FindFunction(function_id) != NULL);
+      }
+    }
+    for (intptr_t i = 0; i < profile.functions.length(); i++) {
+      const PprofFunction& function = profile.functions[i];
+      EXPECT(function.id != 0);
+      EXPECT(function.name < static_cast<uint64_t>(profile.strings.length()));
+      EXPECT(function.filename <
+             static_cast<uint64_t>(profile.strings.length()));
+    }
+  }
+
+  {
+    // Filtered by time.
+    PprofOutput output;
+    CpuSampleFilter filter(port, Thread::kMutatorTask,
+                           CpuSampleFilter::kNoThreadFilter, 1500, 1000);
+    PprofExporter exporter(PprofConsumer, &output);
+    EXPECT_EQ(1, exporter.Export(thread, sample_buffer, &filter));
+  }
+
+  {
+    // Filtered by thread.
+    PprofOutput output;
+    CpuSampleFilter filter(port, Thread::kMutatorTask,
+                           OSThread::ThreadIdToIntPtr(tid) + 1, -1, -1);
+    PprofExporter exporter(PprofConsumer, &output);
+    EXPECT_EQ(0, exporter.Export(thread, sample_buffer, &filter));
+    EXPECT_EQ(1, output.finishes);
+  }
+
+  delete sample_buffer;
+}
+
 #endif  // !PRODUCT
 
 }  // namespace dart
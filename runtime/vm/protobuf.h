@@ -0,0 +1,87 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_PROTOBUF_H_
+#define RUNTIME_VM_PROTOBUF_H_
+
+#include "platform/globals.h"
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+
+namespace dart {
+
+// Minimal protocol buffer encoder, used to write the pprof profile format
+// (see profiler_pprof.h) and the Perfetto trace format (see timeline.h).
+class ProtobufBuffer {
+ public:
+  ProtobufBuffer() : data_(256) {}
+
+  const uint8_t* data() const { return data_.data(); }
+  intptr_t length() const { return data_.length(); }
+  void Clear() { data_.Clear(); }
+
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      data_.Add(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    data_.Add(static_cast<uint8_t>(value));
+  }
+
+  // Zero is the default value of scalar fields and is not written.
+  void WriteInt(intptr_t field, int64_t value) {
+    if (value != 0) {
+      WriteTag(field, kVarint);
+      WriteVarint(static_cast<uint64_t>(value));
+    }
+  }
+
+  void WriteFixed64(intptr_t field, uint64_t value) {
+    WriteTag(field, kFixed64);
+    for (intptr_t i = 0; i < 8; i++) {
+      data_.Add(static_cast<uint8_t>(value >> (i * 8)));
+    }
+  }
+
+  void WriteDouble(intptr_t field, double value) {
+    WriteFixed64(field, bit_cast<uint64_t>(value));
+  }
+
+  void WriteBytes(intptr_t field, const uint8_t* bytes, intptr_t length) {
+    WriteTag(field, kLengthDelimited);
+    WriteVarint(length);
+    for (intptr_t i = 0; i < length; i++) {
+      data_.Add(bytes[i]);
+    }
+  }
+
+  void WriteString(intptr_t field, const char* str) {
+    WriteBytes(field, reinterpret_cast<const uint8_t*>(str), strlen(str));
+  }
+
+  // Writes |message|, or the varints of a packed repeated field.
+  void WriteMessage(intptr_t field, const ProtobufBuffer& message) {
+    WriteBytes(field, message.data(), message.length());
+  }
+
+ private:
+  enum WireType {
+    kVarint = 0,
+    kFixed64 = 1,
+    kLengthDelimited = 2,
+  };
+
+  void WriteTag(intptr_t field, WireType type) {
+    WriteVarint((static_cast<uint64_t>(field) << 3) | type);
+  }
+
+  MallocGrowableArray<uint8_t> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProtobufBuffer);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_PROTOBUF_H_
@@ -10,6 +10,7 @@
 #include "vm/freelist.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
+#include "vm/pages.h"
 #include "vm/visitor.h"
 
 namespace dart {
@@ -30,8 +31,7 @@ void RawObject::Validate(Isolate* isolate) const {
   }
   // Validate that the tags_ field is sensible.
   uint32_t tags = ptr()->tags_;
-  intptr_t reserved = ReservedBits::decode(tags);
-  if (reserved != 0) {
+  if (IsOldObject() && (AgeTag::decode(tags) != 0)) {
     FATAL1("Invalid tags field encountered %x\n", tags);
   }
   intptr_t class_id = ClassIdTag::decode(tags);
@@ -49,6 +49,11 @@ void RawObject::Validate(Isolate* isolate) const {
   }
 }
 
+void RawObject::RememberCard(RawObject* const* slot) {
+  ASSERT(IsOldObject());
+  HeapPage::OfLargeObject(this)->RememberCard(slot);
+}
+
 intptr_t RawObject::SizeFromClass() const {
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
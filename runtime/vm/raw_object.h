@@ -265,9 +265,10 @@ class RawObject {
     kCanonicalBit = 1,
     kVMHeapObjectBit = 2,
     kRememberedBit = 3,
-    kReservedTagPos = 4,  // kReservedBit{10K,100K,1M,10M}
-    kReservedTagSize = 4,
-    kSizeTagPos = kReservedTagPos + kReservedTagSize,  // = 8
+    kAgeTagPos = 4,
+    kAgeTagSize = 3,
+    kCardRememberedBit = kAgeTagPos + kAgeTagSize,  // = 7
+    kSizeTagPos = kCardRememberedBit + 1,  // = 8
     kSizeTagSize = 8,
     kClassIdTagPos = kSizeTagPos + kSizeTagSize,  // = 16
     kClassIdTagSize = 16,
@@ -314,6 +315,12 @@ class RawObject {
   class ClassIdTag
       : public BitField<uint32_t, intptr_t, kClassIdTagPos, kClassIdTagSize> {};
 
+  // The number of scavenges a new-space object has survived, saturating at
+  // kMaxAge. Always zero for old-space objects.
+  class AgeTag : public BitField<uint32_t, intptr_t, kAgeTagPos, kAgeTagSize> {
+  };
+  static const intptr_t kMaxAge = (1 << kAgeTagSize) - 1;
+
   bool IsWellFormed() const {
     uword value = reinterpret_cast<uword>(this);
     return (value & kSmiTagMask) == 0 ||
@@ -374,6 +381,13 @@ class RawObject {
   bool IsVMHeapObject() const { return VMHeapObjectTag::decode(ptr()->tags_); }
   void SetVMHeapObject() { UpdateTagBit<VMHeapObjectTag>(true); }
 
+  // Support for the scavenger's tenuring policy.
+  intptr_t Age() const { return AgeTag::decode(ptr()->tags_); }
+  void SetAgeUnsynchronized(intptr_t age) {
+    uint32_t tags = ptr()->tags_;
+    ptr()->tags_ = AgeTag::update(age, tags);
+  }
+
   // Support for GC remembered bit.
   bool IsRemembered() const { return RememberedBit::decode(ptr()->tags_); }
   void SetRememberedBit() {
@@ -394,6 +408,18 @@ class RawObject {
   // TODO(koda): Add "must use result" annotation here, after we add support.
   bool TryAcquireRememberedBit() { return TryAcquireTagBit<RememberedBit>(); }
 
+  // Support for card marking. Old-space pointers to new space in a card
+  // remembered array are recorded in the card table of its large page (see
+  // HeapPage::RememberCard) instead of remembering the whole array.
+  bool IsCardRemembered() const {
+    return CardRememberedBit::decode(ptr()->tags_);
+  }
+  void SetCardRememberedBitUnsynchronized() {
+    uint32_t tags = ptr()->tags_;
+    ptr()->tags_ = CardRememberedBit::update(true, tags);
+  }
+  void RememberCard(RawObject* const* slot);
+
 #define DEFINE_IS_CID(clazz)                                                   \
   bool Is##clazz() const { return ((GetClassId() == k##clazz##Cid)); }
   CLASS_LIST(DEFINE_IS_CID)
@@ -552,16 +578,15 @@ class RawObject {
 
   class RememberedBit : public BitField<uint32_t, bool, kRememberedBit, 1> {};
 
+  class CardRememberedBit
+      : public BitField<uint32_t, bool, kCardRememberedBit, 1> {};
+
   class CanonicalObjectTag : public BitField<uint32_t, bool, kCanonicalBit, 1> {
   };
 
   class VMHeapObjectTag : public BitField<uint32_t, bool, kVMHeapObjectBit, 1> {
   };
 
-  class ReservedBits
-      : public BitField<uint32_t, intptr_t, kReservedTagPos, kReservedTagSize> {
-  };
-
   // TODO(koda): After handling tags_, return const*, like Object::raw_ptr().
   RawObject* ptr() const {
     ASSERT(IsHeapObject());
@@ -619,9 +644,13 @@ class RawObject {
     *const_cast<type*>(addr) = value;
     // Filter stores based on source and target.
     if (!value->IsHeapObject()) return;
-    if (value->IsNewObject() && this->IsOldObject() && !this->IsRemembered()) {
-      this->SetRememberedBit();
-      Thread::Current()->StoreBufferAddObject(this);
+    if (value->IsNewObject() && this->IsOldObject()) {
+      if (this->IsCardRemembered()) {
+        RememberCard(reinterpret_cast<RawObject* const*>(addr));
+      } else if (!this->IsRemembered()) {
+        this->SetRememberedBit();
+        Thread::Current()->StoreBufferAddObject(this);
+      }
     }
   }
 
@@ -1956,6 +1985,7 @@ class ExternalStringData {
 
   const T* data() { return data_; }
   void* peer() { return peer_; }
+  Dart_PeerFinalizer callback() { return callback_; }
 
   static intptr_t data_offset() {
     return OFFSET_OF(ExternalStringData<T>, data_);
@@ -2211,20 +2241,24 @@ class RawRegExp : public RawInstance {
   union {
     RawFunction* function_;
     RawTypedData* bytecode_;
+    RawCode* code_;
   } one_byte_;
   union {
     RawFunction* function_;
     RawTypedData* bytecode_;
+    RawCode* code_;
   } two_byte_;
   RawFunction* external_one_byte_function_;
   RawFunction* external_two_byte_function_;
   union {
     RawFunction* function_;
     RawTypedData* bytecode_;
+    RawCode* code_;
   } one_byte_sticky_;
   union {
     RawFunction* function_;
     RawTypedData* bytecode_;
+    RawCode* code_;
   } two_byte_sticky_;
   RawFunction* external_one_byte_sticky_function_;
   RawFunction* external_two_byte_sticky_function_;
@@ -2254,6 +2288,7 @@ class RawWeakProperty : public RawInstance {
   uword next_;
 
   friend class GCMarker;
+  friend class IncrementalMarker;
   template <bool>
   friend class MarkingVisitorBase;
   friend class Scavenger;
@@ -2658,6 +2658,13 @@ void RawTypedData::WriteTo(SnapshotWriter* writer,
   writer->Write<RawObject*>(ptr()->length_);                                   \
   TYPED_EXT_DATA_WRITE(type)
 
+// Bytes are written as is, like for internal typed data.
+#define EXT_TYPED_DATA_WRITE_BYTES(cid)                                        \
+  writer->WriteIndexedObject(cid);                                             \
+  writer->WriteTags(writer->GetObjectTags(this));                              \
+  writer->Write<RawObject*>(ptr()->length_);                                   \
+  writer->WriteBytes(ptr()->data_, len);
+
 void RawExternalTypedData::WriteTo(SnapshotWriter* writer,
                                    intptr_t object_id,
                                    Snapshot::Kind kind,
@@ -2671,13 +2678,13 @@ void RawExternalTypedData::WriteTo(SnapshotWriter* writer,
 
   switch (cid) {
     case kExternalTypedDataInt8ArrayCid:
-      EXT_TYPED_DATA_WRITE(kTypedDataInt8ArrayCid, int8_t);
+      EXT_TYPED_DATA_WRITE_BYTES(kTypedDataInt8ArrayCid);
       break;
     case kExternalTypedDataUint8ArrayCid:
-      EXT_TYPED_DATA_WRITE(kTypedDataUint8ArrayCid, uint8_t);
+      EXT_TYPED_DATA_WRITE_BYTES(kTypedDataUint8ArrayCid);
       break;
     case kExternalTypedDataUint8ClampedArrayCid:
-      EXT_TYPED_DATA_WRITE(kTypedDataUint8ClampedArrayCid, uint8_t);
+      EXT_TYPED_DATA_WRITE_BYTES(kTypedDataUint8ClampedArrayCid);
       break;
     case kExternalTypedDataInt16ArrayCid:
       EXT_TYPED_DATA_WRITE(kTypedDataInt16ArrayCid, int16_t);
@@ -2709,6 +2716,7 @@ void RawExternalTypedData::WriteTo(SnapshotWriter* writer,
 }
 #undef TYPED_DATA_WRITE
 #undef EXT_TYPED_DATA_WRITE
+#undef EXT_TYPED_DATA_WRITE_BYTES
 
 RawCapability* Capability::ReadFrom(SnapshotReader* reader,
                                     intptr_t object_id,
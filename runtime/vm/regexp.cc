@@ -299,6 +299,14 @@ class RegExpCompiler : public ValueObject {
       intptr_t capture_count,
       const String& pattern);
 
+#if defined(DART_NATIVE_IRREGEXP)
+  RegExpEngine::CompilationResult Assemble(
+      NativeRegExpMacroAssembler* assembler,
+      RegExpNode* start,
+      intptr_t capture_count,
+      const String& pattern);
+#endif
+
   inline void AddWork(RegExpNode* node) { work_list_->Add(node); }
 
   static const intptr_t kImplementationOffset = 0;
@@ -430,6 +438,33 @@ RegExpEngine::CompilationResult RegExpCompiler::Assemble(
   return RegExpEngine::CompilationResult(&bytecode, next_register_);
 }
 
+#if defined(DART_NATIVE_IRREGEXP)
+RegExpEngine::CompilationResult RegExpCompiler::Assemble(
+    NativeRegExpMacroAssembler* macro_assembler,
+    RegExpNode* start,
+    intptr_t capture_count,
+    const String& pattern) {
+  macro_assembler->set_slow_safe(false /* use_slow_safe_regexp_compiler */);
+  macro_assembler_ = macro_assembler;
+
+  ZoneGrowableArray<RegExpNode*> work_list(0);
+  work_list_ = &work_list;
+  BlockLabel fail;
+  macro_assembler_->PushBacktrack(&fail);
+  Trace new_trace;
+  start->Emit(this, &new_trace);
+  macro_assembler_->BindBlock(&fail);
+  macro_assembler_->Fail();
+  while (!work_list.is_empty()) {
+    work_list.RemoveLast()->Emit(this, &new_trace);
+  }
+  if (reg_exp_too_big_) return IrregexpRegExpTooBig();
+
+  Code& code = Code::ZoneHandle(macro_assembler->GetCode(pattern));
+  return RegExpEngine::CompilationResult(&code, next_register_);
+}
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
 bool Trace::DeferredAction::Mentions(intptr_t that) {
   if (action_type() == ActionNode::CLEAR_CAPTURES) {
     Interval range = static_cast<DeferredClearCaptures*>(this)->range();
@@ -4741,13 +4776,16 @@ RegExpEngine::CompilationResult RegExpEngine::CompileIR(
 }
 #endif  // !defined(DART_PRECOMPILED_RUNTIME)
 
-RegExpEngine::CompilationResult RegExpEngine::CompileBytecode(
+// Shared by the backends that compile the regexp to a standalone artifact
+// rather than to IL.
+template <typename MacroAssembler>
+static RegExpEngine::CompilationResult CompileWithMacroAssembler(
     RegExpCompileData* data,
     const RegExp& regexp,
     bool is_one_byte,
     bool is_sticky,
+    MacroAssembler* macro_assembler,
     Zone* zone) {
-  ASSERT(FLAG_interpret_irregexp);
   const String& pattern = String::Handle(zone, regexp.pattern());
 
   ASSERT(!regexp.IsNull());
@@ -4809,15 +4847,9 @@ RegExpEngine::CompilationResult RegExpEngine::CompileBytecode(
   analysis.EnsureAnalyzed(node);
   if (analysis.has_failed()) {
     const char* error_message = analysis.error_message();
-    return CompilationResult(error_message);
+    return RegExpEngine::CompilationResult(error_message);
   }
 
-  // Bytecode regexp implementation.
-
-  ZoneGrowableArray<uint8_t> buffer(zone, 1024);
-  BytecodeRegExpMacroAssembler* macro_assembler =
-      new (zone) BytecodeRegExpMacroAssembler(&buffer, zone);
-
   // Inserted here, instead of in Assembler, because it depends on information
   // in the AST that isn't replicated in the Node structure.
   static const intptr_t kMaxBacksearchLimit = 1024;
@@ -4833,8 +4865,22 @@ RegExpEngine::CompilationResult RegExpEngine::CompileBytecode(
             : RegExpMacroAssembler::GLOBAL);
   }
 
-  RegExpEngine::CompilationResult result =
-      compiler.Assemble(macro_assembler, node, data->capture_count, pattern);
+  return compiler.Assemble(macro_assembler, node, data->capture_count,
+                           pattern);
+}
+
+RegExpEngine::CompilationResult RegExpEngine::CompileBytecode(
+    RegExpCompileData* data,
+    const RegExp& regexp,
+    bool is_one_byte,
+    bool is_sticky,
+    Zone* zone) {
+  ASSERT(FLAG_interpret_irregexp);
+  ZoneGrowableArray<uint8_t> buffer(zone, 1024);
+  BytecodeRegExpMacroAssembler* macro_assembler =
+      new (zone) BytecodeRegExpMacroAssembler(&buffer, zone);
+  RegExpEngine::CompilationResult result = CompileWithMacroAssembler(
+      data, regexp, is_one_byte, is_sticky, macro_assembler, zone);
 
   if (FLAG_trace_irregexp) {
     macro_assembler->PrintBlocks();
@@ -4843,6 +4889,23 @@ RegExpEngine::CompilationResult RegExpEngine::CompileBytecode(
   return result;
 }
 
+#if defined(DART_NATIVE_IRREGEXP)
+RegExpEngine::CompilationResult RegExpEngine::CompileNative(
+    RegExpCompileData* data,
+    const RegExp& regexp,
+    bool is_one_byte,
+    bool is_sticky,
+    bool use_far_branches,
+    Zone* zone) {
+  ASSERT(NativeRegExpMacroAssembler::IsEnabled());
+  Assembler assembler(use_far_branches);
+  NativeRegExpMacroAssembler* macro_assembler =
+      new (zone) NativeRegExpMacroAssembler(&assembler, is_one_byte, zone);
+  return CompileWithMacroAssembler(data, regexp, is_one_byte, is_sticky,
+                                   macro_assembler, zone);
+}
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
 static void CreateSpecializedFunction(Thread* thread,
                                       Zone* zone,
                                       const RegExp& regexp,
@@ -4911,7 +4974,7 @@ RawRegExp* RegExpEngine::CreateRegExp(Thread* thread,
   regexp.set_is_complex();
   regexp.set_is_global();  // All dart regexps are global.
 
-  if (!FLAG_interpret_irregexp) {
+  if (!FLAG_interpret_irregexp && !NativeRegExpMacroAssembler::IsEnabled()) {
     const Library& lib = Library::Handle(zone, Library::CoreLibrary());
     const Class& owner =
         Class::Handle(zone, lib.LookupClass(Symbols::RegExp()));
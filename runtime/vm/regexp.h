@@ -10,6 +10,7 @@
 #include "vm/compiler/backend/il.h"
 #include "vm/object.h"
 #include "vm/regexp_assembler.h"
+#include "vm/regexp_assembler_native.h"
 
 namespace dart {
 
@@ -1321,6 +1322,7 @@ class RegExpEngine : public AllStatic {
           graph_entry(NULL),
           num_blocks(-1),
           num_stack_locals(-1),
+          code(NULL),
 #endif
           bytecode(NULL),
           num_registers(-1) {
@@ -1333,6 +1335,7 @@ class RegExpEngine : public AllStatic {
           graph_entry(NULL),
           num_blocks(-1),
           num_stack_locals(-1),
+          code(NULL),
 #endif
           bytecode(bytecode),
           num_registers(num_registers) {
@@ -1349,7 +1352,18 @@ class RegExpEngine : public AllStatic {
           graph_entry(graph_entry),
           num_blocks(num_blocks),
           num_stack_locals(num_stack_locals),
+          code(NULL),
           bytecode(NULL) {}
+
+    CompilationResult(Code* code, intptr_t num_registers)
+        : error_message(NULL),
+          backtrack_goto(NULL),
+          graph_entry(NULL),
+          num_blocks(-1),
+          num_stack_locals(-1),
+          code(code),
+          bytecode(NULL),
+          num_registers(num_registers) {}
 #endif
 
     const char* error_message;
@@ -1358,6 +1372,7 @@ class RegExpEngine : public AllStatic {
     NOT_IN_PRECOMPILED(GraphEntryInstr* graph_entry);
     NOT_IN_PRECOMPILED(const intptr_t num_blocks);
     NOT_IN_PRECOMPILED(const intptr_t num_stack_locals);
+    NOT_IN_PRECOMPILED(Code* code);
 
     TypedData* bytecode;
     intptr_t num_registers;
@@ -1377,6 +1392,15 @@ class RegExpEngine : public AllStatic {
                                            bool sticky,
                                            Zone* zone);
 
+#if defined(DART_NATIVE_IRREGEXP)
+  static CompilationResult CompileNative(RegExpCompileData* data,
+                                         const RegExp& regexp,
+                                         bool is_one_byte,
+                                         bool sticky,
+                                         bool use_far_branches,
+                                         Zone* zone);
+#endif
+
   static RawRegExp* CreateRegExp(Thread* thread,
                                  const String& pattern,
                                  bool multi_line,
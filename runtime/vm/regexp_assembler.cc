@@ -6,6 +6,7 @@
 
 #include "vm/flags.h"
 #include "vm/regexp.h"
+#include "vm/regexp_assembler_native.h"
 #include "vm/unibrow-inl.h"
 
 namespace dart {
@@ -59,7 +60,7 @@ DEFINE_RAW_LEAF_RUNTIME_ENTRY(
 BlockLabel::BlockLabel()
     : block_(NULL), is_bound_(false), is_linked_(false), pos_(-1) {
 #if !defined(DART_PRECOMPILED_RUNTIME)
-  if (!FLAG_interpret_irregexp) {
+  if (!FLAG_interpret_irregexp && !NativeRegExpMacroAssembler::IsEnabled()) {
     // Only needed by the compiled IR backend.
     block_ = new JoinEntryInstr(-1, -1, Thread::Current()->GetNextDeoptId());
   }
@@ -73,6 +73,13 @@ class BlockLabel : public ValueObject {
 
  private:
   intptr_t pos_;
+
+  // Used by the native assembler.
+ public:
+  Label* label() { return &label_; }
+
+ private:
+  Label label_;
 };
 
 class RegExpMacroAssembler : public ZoneAllocated {
@@ -93,7 +100,11 @@ class RegExpMacroAssembler : public ZoneAllocated {
     kParamCount
   };
 
-  enum IrregexpImplementation { kBytecodeImplementation, kIRImplementation };
+  enum IrregexpImplementation {
+    kBytecodeImplementation,
+    kIRImplementation,
+    kNativeImplementation
+  };
 
   explicit RegExpMacroAssembler(Zone* zone);
   virtual ~RegExpMacroAssembler();
@@ -0,0 +1,247 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/regexp_assembler_native.h"
+
+#include "vm/flags.h"
+
+#if defined(DART_NATIVE_IRREGEXP)
+#include "vm/exceptions.h"
+#include "vm/longjump.h"
+#include "vm/object_store.h"
+#include "vm/regexp.h"
+#include "vm/regexp_interpreter.h"
+#include "vm/regexp_parser.h"
+#include "vm/timeline.h"
+#include "vm/unibrow-inl.h"
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
+namespace dart {
+
+DEFINE_FLAG(bool,
+            native_irregexp,
+            false,
+            "Compile regular expressions straight to machine code instead of "
+            "going through IL (x64 and arm64 only).");
+
+bool NativeRegExpMacroAssembler::IsEnabled() {
+#if defined(DART_NATIVE_IRREGEXP)
+  return FLAG_native_irregexp && !FLAG_interpret_irregexp;
+#else
+  return false;
+#endif
+}
+
+#if defined(DART_NATIVE_IRREGEXP)
+
+// Size of the backtracking stack in words, as in the bytecode interpreter.
+static const intptr_t kBacktrackStackSize = 10000;
+
+NativeRegExpMacroAssembler::~NativeRegExpMacroAssembler() {
+  if (backtrack_.is_linked()) backtrack_.Unuse();
+}
+
+NativeRegExpMacroAssembler::IrregexpImplementation
+NativeRegExpMacroAssembler::Implementation() {
+  return kNativeImplementation;
+}
+
+void NativeRegExpMacroAssembler::BindBlock(BlockLabel* label) {
+  ASSERT(!label->is_bound());
+  const intptr_t target = assembler_->CodeSize();
+  assembler_->Bind(label->label());
+  // Resolve the chain of backtrack targets pushed before the label was bound.
+  // A linked label that was only branched to has no chain.
+  intptr_t position = label->pos();
+  while (position > 0) {
+    const intptr_t next = BacktrackTargetAt(position);
+    SetBacktrackTargetAt(position, target);
+    position = next;
+  }
+  label->bind_to(target);
+}
+
+void NativeRegExpMacroAssembler::GoTo(BlockLabel* label) {
+  Jump(label);
+}
+
+intptr_t NativeRegExpMacroAssembler::CaseInsensitiveCompareLatin1(
+    const uint8_t* a,
+    const uint8_t* b,
+    intptr_t length) {
+  for (intptr_t i = 0; i < length; i++) {
+    unsigned int old_char = a[i];
+    unsigned int new_char = b[i];
+    if (old_char == new_char) continue;
+    // Convert both characters to lower case.
+    old_char |= 0x20;
+    new_char |= 0x20;
+    if (old_char != new_char) return 0;
+    // Not letters in the ASCII range and Latin-1 range.
+    if (!(old_char - 'a' <= 'z' - 'a') &&
+        !(old_char - 224 <= 254 - 224 && old_char != 247)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+intptr_t NativeRegExpMacroAssembler::CaseInsensitiveCompareUTF16(
+    const uint16_t* a,
+    const uint16_t* b,
+    intptr_t length) {
+  unibrow::Mapping<unibrow::Ecma262Canonicalize> canonicalize;
+  for (intptr_t i = 0; i < length; i++) {
+    int32_t old_char = a[i];
+    int32_t new_char = b[i];
+    if (old_char == new_char) continue;
+    int32_t old_string[1] = {old_char};
+    int32_t new_string[1] = {new_char};
+    canonicalize.get(old_char, '\0', old_string);
+    canonicalize.get(new_char, '\0', new_string);
+    if (old_string[0] != new_string[0]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+RawCode* NativeRegExpMacroAssembler::GetCode(const String& pattern) {
+  GenerateExits();
+  const char* name =
+      Thread::Current()->zone()->PrintToString("[Irregexp] %s",
+                                               pattern.ToCString());
+  return Code::FinalizeCode(name, assembler_, false /* optimized */);
+}
+
+static void Compile(const RegExp& regexp,
+                    bool is_one_byte,
+                    bool sticky,
+                    Zone* zone) {
+  Thread* thread = Thread::Current();
+  const String& pattern = String::Handle(zone, regexp.pattern());
+#if !defined(PRODUCT)
+  TimelineDurationScope tds(thread, Timeline::GetCompilerStream(),
+                            "CompileIrregexpNative");
+  if (tds.enabled()) {
+    tds.SetNumArguments(1);
+    tds.CopyArgument(0, "pattern", pattern.ToCString());
+  }
+#endif  // !defined(PRODUCT)
+
+  // Conditional branches have a limited range on some architectures. If the
+  // assembler runs out of range it bails out, and the pattern is compiled
+  // again from scratch with far branches.
+  volatile bool use_far_branches = false;
+  while (true) {
+    LongJumpScope jump;
+    if (setjmp(*jump.Set()) == 0) {
+      const bool multiline = regexp.is_multi_line();
+      RegExpCompileData* compile_data = new (zone) RegExpCompileData();
+      if (!RegExpParser::ParseRegExp(pattern, multiline, compile_data)) {
+        // Parsing failures are handled in the RegExp factory constructor.
+        UNREACHABLE();
+      }
+
+      regexp.set_num_bracket_expressions(compile_data->capture_count);
+      if (compile_data->simple) {
+        regexp.set_is_simple();
+      } else {
+        regexp.set_is_complex();
+      }
+
+      RegExpEngine::CompilationResult result = RegExpEngine::CompileNative(
+          compile_data, regexp, is_one_byte, sticky, use_far_branches, zone);
+      ASSERT(result.code != NULL);
+      ASSERT((regexp.num_registers() == -1) ||
+             (regexp.num_registers() == result.num_registers));
+      regexp.set_num_registers(result.num_registers);
+      regexp.set_code(is_one_byte, sticky, *(result.code));
+      return;
+    }
+    const Error& error = Error::Handle(zone, thread->sticky_error());
+    ASSERT(error.raw() == Object::branch_offset_error().raw());
+    ASSERT(!use_far_branches);
+    thread->clear_sticky_error();
+    use_far_branches = true;
+  }
+}
+
+RawInstance* NativeRegExpMacroAssembler::Execute(const RegExp& regexp,
+                                                 const String& subject,
+                                                 const Smi& start_index,
+                                                 bool sticky,
+                                                 Zone* zone) {
+  const bool is_one_byte =
+      subject.IsOneByteString() || subject.IsExternalOneByteString();
+  if (regexp.code(is_one_byte, sticky) == Code::null()) {
+    Compile(regexp, is_one_byte, sticky, zone);
+  }
+  ASSERT(regexp.num_registers() != -1);
+
+  const intptr_t capture_register_count =
+      (Smi::Value(regexp.num_bracket_expressions()) + 1) * 2;
+  ASSERT(regexp.num_registers() >= capture_register_count);
+  int32_t* registers = zone->Alloc<int32_t>(regexp.num_registers());
+  for (intptr_t i = 0; i < capture_register_count; i++) {
+    registers[i] = -1;
+  }
+  intptr_t* stack = zone->Alloc<intptr_t>(kBacktrackStackSize);
+
+  const Code& code = Code::Handle(zone, regexp.code(is_one_byte, sticky));
+  ASSERT(!code.IsNull());
+  typedef intptr_t (*MatchFunction)(MatchState* state);
+  MatchFunction match = reinterpret_cast<MatchFunction>(code.PayloadStart());
+
+  intptr_t status;
+  {
+    // The matcher works on the raw string data, so nothing may move while it
+    // runs.
+    NoSafepointScope no_safepoint;
+    MatchState state;
+    state.input =
+        is_one_byte
+            ? reinterpret_cast<uword>(String::OneByteDataStart(subject))
+            : reinterpret_cast<uword>(String::TwoByteDataStart(subject));
+    state.input_length = subject.Length();
+    state.start_index = start_index.Value();
+    state.registers = registers;
+    state.stack_base = stack;
+    state.stack_limit = stack + kBacktrackStackSize;
+    status = match(&state);
+  }
+
+  if (status == IrregexpInterpreter::RE_SUCCESS) {
+    const TypedData& result = TypedData::Handle(
+        TypedData::New(kTypedDataInt32ArrayCid, capture_register_count));
+    {
+#ifdef DEBUG
+      // These indices will be used with substring operations that don't check
+      // bounds, so sanity check them here.
+      for (intptr_t i = 0; i < capture_register_count; i++) {
+        int32_t val = registers[i];
+        ASSERT(val == -1 || (val >= 0 && val <= subject.Length()));
+      }
+#endif
+
+      NoSafepointScope no_safepoint;
+      memmove(result.DataAddr(0), registers,
+              capture_register_count * sizeof(int32_t));
+    }
+    return result.raw();
+  }
+  if (status == IrregexpInterpreter::RE_EXCEPTION) {
+    Thread* thread = Thread::Current();
+    const Instance& exception =
+        Instance::Handle(thread->isolate()->object_store()->stack_overflow());
+    Exceptions::Throw(thread, exception);
+    UNREACHABLE();
+  }
+  ASSERT(status == IrregexpInterpreter::RE_FAILURE);
+  return Instance::null();
+}
+
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
+}  // namespace dart
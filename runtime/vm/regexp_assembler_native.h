@@ -0,0 +1,194 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_REGEXP_ASSEMBLER_NATIVE_H_
+#define RUNTIME_VM_REGEXP_ASSEMBLER_NATIVE_H_
+
+#include "vm/compiler/assembler/assembler.h"
+#include "vm/object.h"
+#include "vm/regexp_assembler.h"
+
+// The native backend emits code for the machine it runs on, so it is not
+// available on the simulators or in the precompiled runtime.
+#if (defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)) &&               \
+    !defined(USING_SIMULATOR) && !defined(DART_PRECOMPILED_RUNTIME)
+#define DART_NATIVE_IRREGEXP 1
+#endif
+
+namespace dart {
+
+// Generates machine code for a regular expression directly with the
+// Assembler of the target, without going through IL and the optimizing
+// compiler (see IRRegExpMacroAssembler) or the bytecode interpreter (see
+// BytecodeRegExpMacroAssembler).
+//
+// The generated matcher is a C function taking a MatchState and returning an
+// IrregexpInterpreter::IrregexpResult. It follows the semantics of the
+// bytecode interpreter: positions are code unit indices into the subject,
+// registers are an array of int32_t in memory, and the backtracking stack is
+// a fixed size array that is checked on every push. Backtrack targets are
+// pushed as offsets from the start of the code, so the code itself is
+// position independent.
+//
+// Matching runs without safepoints on the raw string data, so the matcher
+// cannot be interrupted. Like the bytecode interpreter it relies on the
+// backtracking stack limit to terminate runaway matches.
+class NativeRegExpMacroAssembler : public RegExpMacroAssembler {
+ public:
+  // Argument passed to the generated code.
+  struct MatchState {
+    uword input;  // Address of the first code unit of the subject.
+    intptr_t input_length;
+    intptr_t start_index;
+    int32_t* registers;
+    intptr_t* stack_base;
+    intptr_t* stack_limit;  // End of the backtracking stack.
+  };
+
+  NativeRegExpMacroAssembler(Assembler* assembler,
+                             bool is_one_byte,
+                             Zone* zone);
+  virtual ~NativeRegExpMacroAssembler();
+
+  // Every push is checked against the stack limit.
+  virtual intptr_t stack_limit_slack() { return 1; }
+  virtual bool CanReadUnaligned() { return true; }
+  virtual void BindBlock(BlockLabel* label);
+  virtual void AdvanceCurrentPosition(intptr_t by);  // Signed cp change.
+  virtual void PopCurrentPosition();
+  virtual void PushCurrentPosition();
+  virtual void Backtrack();
+  virtual void GoTo(BlockLabel* label);
+  virtual void PushBacktrack(BlockLabel* label);
+  virtual bool Succeed();
+  virtual void Fail();
+  virtual void PopRegister(intptr_t register_index);
+  virtual void PushRegister(intptr_t register_index);
+  virtual void AdvanceRegister(intptr_t reg, intptr_t by);  // r[reg] += by.
+  virtual void SetCurrentPositionFromEnd(intptr_t by);
+  virtual void SetRegister(intptr_t register_index, intptr_t to);
+  virtual void WriteCurrentPositionToRegister(intptr_t reg, intptr_t cp_offset);
+  virtual void ClearRegisters(intptr_t reg_from, intptr_t reg_to);
+  virtual void ReadCurrentPositionFromRegister(intptr_t reg);
+  virtual void WriteStackPointerToRegister(intptr_t reg);
+  virtual void ReadStackPointerFromRegister(intptr_t reg);
+  virtual void LoadCurrentCharacter(intptr_t cp_offset,
+                                    BlockLabel* on_end_of_input,
+                                    bool check_bounds = true,
+                                    intptr_t characters = 1);
+  virtual void CheckCharacter(unsigned c, BlockLabel* on_equal);
+  virtual void CheckCharacterAfterAnd(unsigned c,
+                                      unsigned mask,
+                                      BlockLabel* on_equal);
+  virtual void CheckCharacterGT(uint16_t limit, BlockLabel* on_greater);
+  virtual void CheckCharacterLT(uint16_t limit, BlockLabel* on_less);
+  virtual void CheckGreedyLoop(BlockLabel* on_tos_equals_current_position);
+  virtual void CheckAtStart(BlockLabel* on_at_start);
+  virtual void CheckNotAtStart(BlockLabel* on_not_at_start);
+  virtual void CheckNotCharacter(unsigned c, BlockLabel* on_not_equal);
+  virtual void CheckNotCharacterAfterAnd(unsigned c,
+                                         unsigned mask,
+                                         BlockLabel* on_not_equal);
+  virtual void CheckNotCharacterAfterMinusAnd(uint16_t c,
+                                              uint16_t minus,
+                                              uint16_t mask,
+                                              BlockLabel* on_not_equal);
+  virtual void CheckCharacterInRange(uint16_t from,
+                                     uint16_t to,
+                                     BlockLabel* on_in_range);
+  virtual void CheckCharacterNotInRange(uint16_t from,
+                                        uint16_t to,
+                                        BlockLabel* on_not_in_range);
+  virtual void CheckBitInTable(const TypedData& table, BlockLabel* on_bit_set);
+  virtual void CheckNotBackReference(intptr_t start_reg,
+                                     BlockLabel* on_no_match);
+  virtual void CheckNotBackReferenceIgnoreCase(intptr_t start_reg,
+                                               BlockLabel* on_no_match);
+  virtual void IfRegisterLT(intptr_t register_index,
+                            intptr_t comparand,
+                            BlockLabel* if_lt);
+  virtual void IfRegisterGE(intptr_t register_index,
+                            intptr_t comparand,
+                            BlockLabel* if_ge);
+  virtual void IfRegisterEqPos(intptr_t register_index, BlockLabel* if_eq);
+
+  virtual IrregexpImplementation Implementation();
+
+  // Emits the shared exit paths and creates the Code object.
+  RawCode* GetCode(const String& pattern);
+
+  virtual bool IsClosed() const {
+    // Every path ends in a jump, like in the bytecode version.
+    return true;
+  }
+  virtual void Print(const char* str) { UNIMPLEMENTED(); }
+  virtual void PrintBlocks() { UNIMPLEMENTED(); }
+
+  // Whether regular expressions are compiled with this backend
+  // (--native_irregexp on a supported configuration).
+  static bool IsEnabled();
+
+  static RawInstance* Execute(const RegExp& regexp,
+                              const String& str,
+                              const Smi& start_index,
+                              bool is_sticky,
+                              Zone* zone);
+
+ private:
+  // Called from the generated code for case insensitive back references.
+  // Return 1 if the 'length' code units at 'a' and 'b' are equal ignoring
+  // case, and 0 otherwise.
+  static intptr_t CaseInsensitiveCompareLatin1(const uint8_t* a,
+                                               const uint8_t* b,
+                                               intptr_t length);
+  static intptr_t CaseInsensitiveCompareUTF16(const uint16_t* a,
+                                              const uint16_t* b,
+                                              intptr_t length);
+
+  static intptr_t RegisterOffset(intptr_t register_index) {
+    ASSERT(register_index >= 0);
+    ASSERT(register_index <= kMaxRegister);
+    return register_index * sizeof(int32_t);
+  }
+
+#if defined(DART_NATIVE_IRREGEXP)
+  // Branches to 'to' if 'condition' holds, or backtracks if 'to' is NULL.
+  void BranchOrBacktrack(Condition condition, BlockLabel* to);
+  void Jump(BlockLabel* to);
+
+  // Backtracking stack operations.
+  void Push(Register value);
+  void Pop(Register value);
+
+  // Loads 'characters' code units at 'cp_offset' into the current character.
+  void LoadCurrentCharacterUnchecked(intptr_t cp_offset, intptr_t characters);
+
+  // Shared part of the back reference checks. Leaves the start of the
+  // capture and its length in registers, and skips empty or unset captures.
+  void LoadBackReference(intptr_t start_reg,
+                         Label* fallthrough,
+                         BlockLabel* on_no_match);
+
+  // Emits the code shared by all exits from the matcher.
+  void GenerateExits();
+
+  // Reads and writes the code offset pushed by PushBacktrack at 'position'.
+  int32_t BacktrackTargetAt(intptr_t position);
+  void SetBacktrackTargetAt(intptr_t position, int32_t target);
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
+  Assembler* assembler_;
+  const intptr_t char_size_;
+
+  // Target of branches to a NULL label.
+  BlockLabel backtrack_;
+  Label exit_;
+  Label stack_overflow_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(NativeRegExpMacroAssembler);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_REGEXP_ASSEMBLER_NATIVE_H_
@@ -0,0 +1,484 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"  // Needed here to get TARGET_ARCH_ARM64.
+#if defined(TARGET_ARCH_ARM64)
+
+#include "vm/regexp_assembler_native.h"
+
+#if defined(DART_NATIVE_IRREGEXP)
+
+#include "vm/regexp_interpreter.h"
+
+namespace dart {
+
+#define __ assembler_->
+
+// Matcher state that lives in callee saved registers. R26 to R28 are free
+// here: the matcher is called from C++ and never runs Dart code.
+static const Register kCurrentPosition = R19;
+static const Register kInput = R20;
+static const Register kInputLength = R21;
+static const Register kRegisters = R22;
+static const Register kStackPointer = R23;
+static const Register kStackLimit = R24;
+static const Register kCodeStart = R25;
+static const Register kCurrentCharacter = R26;
+static const Register kStackBase = R27;
+
+NativeRegExpMacroAssembler::NativeRegExpMacroAssembler(Assembler* assembler,
+                                                       bool is_one_byte,
+                                                       Zone* zone)
+    : RegExpMacroAssembler(zone),
+      assembler_(assembler),
+      char_size_(is_one_byte ? 1 : 2) {
+  __ stp(FP, LR, Address(CSP, -2 * kWordSize, Address::PairPreIndex));
+  __ mov(FP, CSP);
+  __ stp(R19, R20, Address(CSP, -2 * kWordSize, Address::PairPreIndex));
+  __ stp(R21, R22, Address(CSP, -2 * kWordSize, Address::PairPreIndex));
+  __ stp(R23, R24, Address(CSP, -2 * kWordSize, Address::PairPreIndex));
+  __ stp(R25, R26, Address(CSP, -2 * kWordSize, Address::PairPreIndex));
+  __ stp(R27, R28, Address(CSP, -2 * kWordSize, Address::PairPreIndex));
+
+  const Register state = R0;
+  __ ldr(kInput, Address(state, OFFSET_OF(MatchState, input)));
+  __ ldr(kInputLength, Address(state, OFFSET_OF(MatchState, input_length)));
+  __ ldr(kCurrentPosition, Address(state, OFFSET_OF(MatchState, start_index)));
+  __ ldr(kRegisters, Address(state, OFFSET_OF(MatchState, registers)));
+  __ ldr(kStackBase, Address(state, OFFSET_OF(MatchState, stack_base)));
+  __ ldr(kStackLimit, Address(state, OFFSET_OF(MatchState, stack_limit)));
+  __ mov(kStackPointer, kStackBase);
+  __ adr(kCodeStart, Immediate(-__ CodeSize()));
+
+  // Like the interpreter, start with the character before the start position
+  // loaded, or a newline at the start of the input.
+  Label at_start;
+  __ LoadImmediate(kCurrentCharacter, '\n');
+  __ cbz(&at_start, kCurrentPosition);
+  LoadCurrentCharacterUnchecked(-1, 1);
+  __ Bind(&at_start);
+}
+
+void NativeRegExpMacroAssembler::GenerateExits() {
+  // Target of branches to a NULL label.
+  BindBlock(&backtrack_);
+  Backtrack();
+
+  __ Bind(&stack_overflow_);
+  __ LoadImmediate(R0, IrregexpInterpreter::RE_EXCEPTION);
+  __ Bind(&exit_);
+  __ ldp(R27, R28, Address(CSP, 2 * kWordSize, Address::PairPostIndex));
+  __ ldp(R25, R26, Address(CSP, 2 * kWordSize, Address::PairPostIndex));
+  __ ldp(R23, R24, Address(CSP, 2 * kWordSize, Address::PairPostIndex));
+  __ ldp(R21, R22, Address(CSP, 2 * kWordSize, Address::PairPostIndex));
+  __ ldp(R19, R20, Address(CSP, 2 * kWordSize, Address::PairPostIndex));
+  __ ldp(FP, LR, Address(CSP, 2 * kWordSize, Address::PairPostIndex));
+  __ ret();
+}
+
+void NativeRegExpMacroAssembler::BranchOrBacktrack(Condition condition,
+                                                   BlockLabel* to) {
+  BlockLabel* target = (to == NULL) ? &backtrack_ : to;
+  if (!target->is_bound()) {
+    target->SetLinked();
+  }
+  __ b(target->label(), condition);
+}
+
+void NativeRegExpMacroAssembler::Jump(BlockLabel* to) {
+  BranchOrBacktrack(AL, to);
+}
+
+void NativeRegExpMacroAssembler::Push(Register value) {
+  __ cmp(kStackPointer, Operand(kStackLimit));
+  __ b(&stack_overflow_, CS);
+  __ str(value, Address(kStackPointer, kWordSize, Address::PostIndex));
+}
+
+void NativeRegExpMacroAssembler::Pop(Register value) {
+  __ ldr(value, Address(kStackPointer, -kWordSize, Address::PreIndex));
+}
+
+// PushBacktrack loads code offsets with a movz/movk pair.
+int32_t NativeRegExpMacroAssembler::BacktrackTargetAt(intptr_t position) {
+  const int32_t* instr =
+      reinterpret_cast<const int32_t*>(__ CodeAddress(position));
+  const int32_t low = (instr[0] & kImm16Mask) >> kImm16Shift;
+  const int32_t high = (instr[1] & kImm16Mask) >> kImm16Shift;
+  return (high << 16) | low;
+}
+
+void NativeRegExpMacroAssembler::SetBacktrackTargetAt(intptr_t position,
+                                                      int32_t target) {
+  int32_t* instr = reinterpret_cast<int32_t*>(__ CodeAddress(position));
+  instr[0] = (instr[0] & ~kImm16Mask) | ((target & 0xffff) << kImm16Shift);
+  instr[1] = (instr[1] & ~kImm16Mask) |
+             (((target >> 16) & 0xffff) << kImm16Shift);
+}
+
+void NativeRegExpMacroAssembler::LoadCurrentCharacterUnchecked(
+    intptr_t cp_offset,
+    intptr_t characters) {
+  Register index = kCurrentPosition;
+  if (cp_offset != 0) {
+    __ AddImmediate(R0, kCurrentPosition, cp_offset);
+    index = R0;
+  }
+  if (char_size_ == 1) {
+    __ add(R0, kInput, Operand(index));
+  } else {
+    __ add(R0, kInput, Operand(index, LSL, 1));
+  }
+  switch (characters * char_size_) {
+    case 1:
+      __ ldr(kCurrentCharacter, Address(R0), kUnsignedByte);
+      break;
+    case 2:
+      __ ldr(kCurrentCharacter, Address(R0), kUnsignedHalfword);
+      break;
+    case 4:
+      __ ldr(kCurrentCharacter, Address(R0), kUnsignedWord);
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+void NativeRegExpMacroAssembler::AdvanceCurrentPosition(intptr_t by) {
+  ASSERT(by >= kMinCPOffset);
+  ASSERT(by <= kMaxCPOffset);
+  if (by != 0) {
+    __ AddImmediate(kCurrentPosition, by);
+  }
+}
+
+void NativeRegExpMacroAssembler::AdvanceRegister(intptr_t reg, intptr_t by) {
+  if (by != 0) {
+    __ LoadFromOffset(R0, kRegisters, RegisterOffset(reg), kWord);
+    __ AddImmediate(R0, by);
+    __ StoreToOffset(R0, kRegisters, RegisterOffset(reg), kWord);
+  }
+}
+
+void NativeRegExpMacroAssembler::Backtrack() {
+  Pop(R0);
+  __ add(R0, R0, Operand(kCodeStart));
+  __ br(R0);
+}
+
+void NativeRegExpMacroAssembler::PushBacktrack(BlockLabel* label) {
+  BlockLabel* target = (label == NULL) ? &backtrack_ : label;
+  int32_t offset;
+  if (target->is_bound()) {
+    offset = target->pos();
+  } else {
+    // Link the instructions into the chain of the label. BindBlock replaces
+    // them with the code offset of the label.
+    offset = (target->pos() > 0) ? target->pos() : 0;
+    target->link_to(__ CodeSize());
+  }
+  __ movz(R0, Immediate(offset & 0xffff), 0);
+  __ movk(R0, Immediate((offset >> 16) & 0xffff), 1);
+  Push(R0);
+}
+
+bool NativeRegExpMacroAssembler::Succeed() {
+  __ LoadImmediate(R0, IrregexpInterpreter::RE_SUCCESS);
+  __ b(&exit_);
+  return false;  // Restart matching for global regexp not supported.
+}
+
+void NativeRegExpMacroAssembler::Fail() {
+  __ LoadImmediate(R0, IrregexpInterpreter::RE_FAILURE);
+  __ b(&exit_);
+}
+
+void NativeRegExpMacroAssembler::PopCurrentPosition() {
+  Pop(kCurrentPosition);
+}
+
+void NativeRegExpMacroAssembler::PushCurrentPosition() {
+  Push(kCurrentPosition);
+}
+
+void NativeRegExpMacroAssembler::PopRegister(intptr_t register_index) {
+  Pop(R0);
+  __ StoreToOffset(R0, kRegisters, RegisterOffset(register_index), kWord);
+}
+
+void NativeRegExpMacroAssembler::PushRegister(intptr_t register_index) {
+  __ LoadFromOffset(R0, kRegisters, RegisterOffset(register_index), kWord);
+  Push(R0);
+}
+
+void NativeRegExpMacroAssembler::SetCurrentPositionFromEnd(intptr_t by) {
+  Label after_position;
+  __ sub(R0, kInputLength, Operand(kCurrentPosition));
+  __ CompareImmediate(R0, by);
+  __ b(&after_position, LE);
+  __ AddImmediate(kCurrentPosition, kInputLength, -by);
+  // The character before the new position is the current character.
+  LoadCurrentCharacterUnchecked(-1, 1);
+  __ Bind(&after_position);
+}
+
+void NativeRegExpMacroAssembler::SetRegister(intptr_t register_index,
+                                             intptr_t to) {
+  __ LoadImmediate(R0, to);
+  __ StoreToOffset(R0, kRegisters, RegisterOffset(register_index), kWord);
+}
+
+void NativeRegExpMacroAssembler::WriteCurrentPositionToRegister(
+    intptr_t reg,
+    intptr_t cp_offset) {
+  __ AddImmediate(R0, kCurrentPosition, cp_offset);
+  __ StoreToOffset(R0, kRegisters, RegisterOffset(reg), kWord);
+}
+
+void NativeRegExpMacroAssembler::ClearRegisters(intptr_t reg_from,
+                                                intptr_t reg_to) {
+  ASSERT(reg_from <= reg_to);
+  __ LoadImmediate(R0, -1);
+  for (intptr_t reg = reg_from; reg <= reg_to; reg++) {
+    __ StoreToOffset(R0, kRegisters, RegisterOffset(reg), kWord);
+  }
+}
+
+void NativeRegExpMacroAssembler::ReadCurrentPositionFromRegister(
+    intptr_t reg) {
+  __ LoadFromOffset(kCurrentPosition, kRegisters, RegisterOffset(reg), kWord);
+}
+
+void NativeRegExpMacroAssembler::WriteStackPointerToRegister(intptr_t reg) {
+  // Stored as a number of entries, like in the interpreter.
+  __ sub(R0, kStackPointer, Operand(kStackBase));
+  __ LsrImmediate(R0, R0, kWordSizeLog2);
+  __ StoreToOffset(R0, kRegisters, RegisterOffset(reg), kWord);
+}
+
+void NativeRegExpMacroAssembler::ReadStackPointerFromRegister(intptr_t reg) {
+  __ LoadFromOffset(R0, kRegisters, RegisterOffset(reg), kWord);
+  __ add(kStackPointer, kStackBase, Operand(R0, LSL, kWordSizeLog2));
+}
+
+void NativeRegExpMacroAssembler::LoadCurrentCharacter(
+    intptr_t cp_offset,
+    BlockLabel* on_end_of_input,
+    bool check_bounds,
+    intptr_t characters) {
+  ASSERT(cp_offset >= kMinCPOffset);
+  ASSERT(cp_offset <= kMaxCPOffset);
+  if (check_bounds) {
+    __ AddImmediate(R0, kCurrentPosition, cp_offset + characters - 1);
+    __ cmp(R0, Operand(kInputLength));
+    BranchOrBacktrack(GE, on_end_of_input);
+  }
+  LoadCurrentCharacterUnchecked(cp_offset, characters);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacter(unsigned c,
+                                                BlockLabel* on_equal) {
+  __ CompareImmediate(kCurrentCharacter, c);
+  BranchOrBacktrack(EQ, on_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterAfterAnd(unsigned c,
+                                                        unsigned mask,
+                                                        BlockLabel* on_equal) {
+  __ AndImmediate(R0, kCurrentCharacter, mask);
+  __ CompareImmediate(R0, c);
+  BranchOrBacktrack(EQ, on_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterGT(uint16_t limit,
+                                                  BlockLabel* on_greater) {
+  __ CompareImmediate(kCurrentCharacter, limit);
+  BranchOrBacktrack(HI, on_greater);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterLT(uint16_t limit,
+                                                  BlockLabel* on_less) {
+  __ CompareImmediate(kCurrentCharacter, limit);
+  BranchOrBacktrack(CC, on_less);
+}
+
+void NativeRegExpMacroAssembler::CheckGreedyLoop(
+    BlockLabel* on_tos_equals_current_position) {
+  Label fallthrough;
+  __ ldr(R0, Address(kStackPointer, -kWordSize));
+  __ cmp(kCurrentPosition, Operand(R0));
+  __ b(&fallthrough, NE);
+  __ sub(kStackPointer, kStackPointer, Operand(kWordSize));
+  Jump(on_tos_equals_current_position);
+  __ Bind(&fallthrough);
+}
+
+void NativeRegExpMacroAssembler::CheckAtStart(BlockLabel* on_at_start) {
+  __ CompareImmediate(kCurrentPosition, 0);
+  BranchOrBacktrack(EQ, on_at_start);
+}
+
+void NativeRegExpMacroAssembler::CheckNotAtStart(BlockLabel* on_not_at_start) {
+  __ CompareImmediate(kCurrentPosition, 0);
+  BranchOrBacktrack(NE, on_not_at_start);
+}
+
+void NativeRegExpMacroAssembler::CheckNotCharacter(unsigned c,
+                                                   BlockLabel* on_not_equal) {
+  __ CompareImmediate(kCurrentCharacter, c);
+  BranchOrBacktrack(NE, on_not_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckNotCharacterAfterAnd(
+    unsigned c,
+    unsigned mask,
+    BlockLabel* on_not_equal) {
+  __ AndImmediate(R0, kCurrentCharacter, mask);
+  __ CompareImmediate(R0, c);
+  BranchOrBacktrack(NE, on_not_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckNotCharacterAfterMinusAnd(
+    uint16_t c,
+    uint16_t minus,
+    uint16_t mask,
+    BlockLabel* on_not_equal) {
+  __ AddImmediate(R0, kCurrentCharacter, -minus);
+  __ AndImmediate(R0, R0, mask);
+  __ CompareImmediate(R0, c);
+  BranchOrBacktrack(NE, on_not_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterInRange(
+    uint16_t from,
+    uint16_t to,
+    BlockLabel* on_in_range) {
+  __ AddImmediate(R0, kCurrentCharacter, -from);
+  __ CompareImmediate(R0, to - from);
+  BranchOrBacktrack(LS, on_in_range);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterNotInRange(
+    uint16_t from,
+    uint16_t to,
+    BlockLabel* on_not_in_range) {
+  __ AddImmediate(R0, kCurrentCharacter, -from);
+  __ CompareImmediate(R0, to - from);
+  BranchOrBacktrack(HI, on_not_in_range);
+}
+
+void NativeRegExpMacroAssembler::CheckBitInTable(const TypedData& table,
+                                                 BlockLabel* on_bit_set) {
+  // The 128 entry table is folded into two 64-bit immediates.
+  uint64_t bits[2] = {0, 0};
+  for (intptr_t i = 0; i < kTableSize; i++) {
+    if (table.GetUint8(i) != 0) {
+      bits[i >> 6] |= static_cast<uint64_t>(1) << (i & 63);
+    }
+  }
+  __ AndImmediate(R0, kCurrentCharacter, kTableMask);
+  __ LoadImmediate(R1, static_cast<int64_t>(bits[0]));
+  __ LoadImmediate(R2, static_cast<int64_t>(bits[1]));
+  __ CompareImmediate(R0, 64);
+  __ csel(R1, R2, R1, CS);
+  __ lsrv(R1, R1, R0);  // Uses the index modulo 64.
+  __ TestImmediate(R1, 1);
+  BranchOrBacktrack(NE, on_bit_set);
+}
+
+void NativeRegExpMacroAssembler::LoadBackReference(intptr_t start_reg,
+                                                   Label* fallthrough,
+                                                   BlockLabel* on_no_match) {
+  // R0: start of the capture, R1: its length.
+  __ LoadFromOffset(R0, kRegisters, RegisterOffset(start_reg), kWord);
+  __ LoadFromOffset(R1, kRegisters, RegisterOffset(start_reg + 1), kWord);
+  __ sub(R1, R1, Operand(R0));
+  __ CompareImmediate(R0, 0);
+  __ b(fallthrough, LT);
+  __ CompareImmediate(R1, 0);
+  __ b(fallthrough, LE);
+  __ add(R2, kCurrentPosition, Operand(R1));
+  __ cmp(R2, Operand(kInputLength));
+  BranchOrBacktrack(GT, on_no_match);
+}
+
+void NativeRegExpMacroAssembler::CheckNotBackReference(
+    intptr_t start_reg,
+    BlockLabel* on_no_match) {
+  ASSERT(start_reg >= 0);
+  ASSERT(start_reg <= kMaxRegister);
+  Label fallthrough, loop;
+  LoadBackReference(start_reg, &fallthrough, on_no_match);
+  const intptr_t shift = (char_size_ == 1) ? 0 : 1;
+  const OperandSize size =
+      (char_size_ == 1) ? kUnsignedByte : kUnsignedHalfword;
+  __ add(R2, kInput, Operand(R0, LSL, shift));
+  __ add(R3, kInput, Operand(kCurrentPosition, LSL, shift));
+  __ mov(R4, R1);
+  __ Bind(&loop);
+  __ ldr(R5, Address(R2, char_size_, Address::PostIndex), size);
+  __ ldr(R6, Address(R3, char_size_, Address::PostIndex), size);
+  __ cmp(R5, Operand(R6));
+  BranchOrBacktrack(NE, on_no_match);
+  __ subs(R4, R4, Operand(1));
+  __ b(&loop, NE);
+  __ add(kCurrentPosition, kCurrentPosition, Operand(R1));
+  __ Bind(&fallthrough);
+}
+
+void NativeRegExpMacroAssembler::CheckNotBackReferenceIgnoreCase(
+    intptr_t start_reg,
+    BlockLabel* on_no_match) {
+  ASSERT(start_reg >= 0);
+  ASSERT(start_reg <= kMaxRegister);
+  Label fallthrough;
+  LoadBackReference(start_reg, &fallthrough, on_no_match);
+  const intptr_t shift = (char_size_ == 1) ? 0 : 1;
+  const uword compare =
+      (char_size_ == 1)
+          ? reinterpret_cast<uword>(&CaseInsensitiveCompareLatin1)
+          : reinterpret_cast<uword>(&CaseInsensitiveCompareUTF16);
+  // The matcher state is in callee saved registers, only the length of the
+  // capture has to be kept across the call.
+  __ mov(R2, R1);
+  __ str(R1, Address(CSP, -2 * kWordSize, Address::PreIndex));
+  __ add(R0, kInput, Operand(R0, LSL, shift));
+  __ add(R1, kInput, Operand(kCurrentPosition, LSL, shift));
+  __ LoadImmediate(R3, compare);
+  __ blr(R3);
+  __ ldr(R1, Address(CSP, 2 * kWordSize, Address::PostIndex));
+  __ CompareImmediate(R0, 0);
+  BranchOrBacktrack(EQ, on_no_match);
+  __ add(kCurrentPosition, kCurrentPosition, Operand(R1));
+  __ Bind(&fallthrough);
+}
+
+void NativeRegExpMacroAssembler::IfRegisterLT(intptr_t register_index,
+                                              intptr_t comparand,
+                                              BlockLabel* if_lt) {
+  __ LoadFromOffset(R0, kRegisters, RegisterOffset(register_index), kWord);
+  __ CompareImmediate(R0, comparand);
+  BranchOrBacktrack(LT, if_lt);
+}
+
+void NativeRegExpMacroAssembler::IfRegisterGE(intptr_t register_index,
+                                              intptr_t comparand,
+                                              BlockLabel* if_ge) {
+  __ LoadFromOffset(R0, kRegisters, RegisterOffset(register_index), kWord);
+  __ CompareImmediate(R0, comparand);
+  BranchOrBacktrack(GE, if_ge);
+}
+
+void NativeRegExpMacroAssembler::IfRegisterEqPos(intptr_t register_index,
+                                                 BlockLabel* if_eq) {
+  __ LoadFromOffset(R0, kRegisters, RegisterOffset(register_index), kWord);
+  __ cmp(kCurrentPosition, Operand(R0));
+  BranchOrBacktrack(EQ, if_eq);
+}
+
+}  // namespace dart
+
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
+#endif  // defined(TARGET_ARCH_ARM64)
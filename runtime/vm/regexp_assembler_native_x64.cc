@@ -0,0 +1,520 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"  // Needed here to get TARGET_ARCH_X64.
+#if defined(TARGET_ARCH_X64)
+
+#include "vm/regexp_assembler_native.h"
+
+#if defined(DART_NATIVE_IRREGEXP)
+
+#include "vm/regexp_interpreter.h"
+
+namespace dart {
+
+#define __ assembler_->
+
+// Matcher state that lives in registers. These are all callee saved in both
+// the System V and the Windows calling convention, so they survive calls
+// into C.
+static const Register kCurrentPosition = RBX;
+static const Register kInput = R12;
+static const Register kInputLength = R13;
+static const Register kRegisters = R14;
+static const Register kStackPointer = R15;
+
+// Caller saved. Spilled around calls into C.
+static const Register kCurrentCharacter = R10;
+
+// The frame holds the saved callee saved registers followed by these slots.
+enum {
+  kStackBaseSlot,
+  kStackLimitSlot,
+  kCodeStartSlot,
+  kSavedCharacterSlot,
+  kNumFrameSlots,
+};
+
+static intptr_t SavedRegistersSize() {
+  const intptr_t count =
+      RegisterSet::RegisterCount(CallingConventions::kCalleeSaveCpuRegisters);
+  return count * kWordSize;
+}
+
+static Address FrameSlot(intptr_t slot) {
+  return Address(RBP, -SavedRegistersSize() - (slot + 1) * kWordSize);
+}
+
+static Address RegisterAddress(intptr_t offset) {
+  return Address(kRegisters, offset);
+}
+
+static Immediate CharacterImmediate(unsigned c) {
+  return Immediate(static_cast<int32_t>(c));
+}
+
+NativeRegExpMacroAssembler::NativeRegExpMacroAssembler(Assembler* assembler,
+                                                       bool is_one_byte,
+                                                       Zone* zone)
+    : RegExpMacroAssembler(zone),
+      assembler_(assembler),
+      char_size_(is_one_byte ? 1 : 2) {
+  __ pushq(RBP);
+  __ movq(RBP, RSP);
+  __ PushRegisters(CallingConventions::kCalleeSaveCpuRegisters, 0);
+  __ subq(RSP, Immediate(kNumFrameSlots * kWordSize));
+  __ ReserveAlignedFrameSpace(CallingConventions::kShadowSpaceBytes);
+
+  const Register state = RAX;
+  __ movq(state, CallingConventions::kArg1Reg);
+  __ movq(kInput, Address(state, OFFSET_OF(MatchState, input)));
+  __ movq(kInputLength, Address(state, OFFSET_OF(MatchState, input_length)));
+  __ movq(kCurrentPosition,
+          Address(state, OFFSET_OF(MatchState, start_index)));
+  __ movq(kRegisters, Address(state, OFFSET_OF(MatchState, registers)));
+  __ movq(kStackPointer, Address(state, OFFSET_OF(MatchState, stack_base)));
+  __ movq(FrameSlot(kStackBaseSlot), kStackPointer);
+  __ movq(RCX, Address(state, OFFSET_OF(MatchState, stack_limit)));
+  __ movq(FrameSlot(kStackLimitSlot), RCX);
+  {
+    const intptr_t kRIPRelativeLeaqSize = 7;
+    const intptr_t code_start_to_rip_offset =
+        __ CodeSize() + kRIPRelativeLeaqSize;
+    __ leaq(RCX, Address::AddressRIPRelative(-code_start_to_rip_offset));
+    ASSERT(__ CodeSize() == code_start_to_rip_offset);
+  }
+  __ movq(FrameSlot(kCodeStartSlot), RCX);
+
+  // Like the interpreter, start with the character before the start position
+  // loaded, or a newline at the start of the input.
+  Label at_start;
+  __ movl(kCurrentCharacter, Immediate('\n'));
+  __ testq(kCurrentPosition, kCurrentPosition);
+  __ j(ZERO, &at_start, Assembler::kNearJump);
+  LoadCurrentCharacterUnchecked(-1, 1);
+  __ Bind(&at_start);
+}
+
+void NativeRegExpMacroAssembler::GenerateExits() {
+  // Target of branches to a NULL label.
+  BindBlock(&backtrack_);
+  Backtrack();
+
+  __ Bind(&stack_overflow_);
+  __ movq(RAX, Immediate(IrregexpInterpreter::RE_EXCEPTION));
+  __ Bind(&exit_);
+  __ leaq(RSP, Address(RBP, -SavedRegistersSize()));
+  __ PopRegisters(CallingConventions::kCalleeSaveCpuRegisters, 0);
+  __ popq(RBP);
+  __ ret();
+}
+
+void NativeRegExpMacroAssembler::BranchOrBacktrack(Condition condition,
+                                                   BlockLabel* to) {
+  BlockLabel* target = (to == NULL) ? &backtrack_ : to;
+  if (!target->is_bound()) {
+    target->SetLinked();
+  }
+  __ j(condition, target->label());
+}
+
+void NativeRegExpMacroAssembler::Jump(BlockLabel* to) {
+  BlockLabel* target = (to == NULL) ? &backtrack_ : to;
+  if (!target->is_bound()) {
+    target->SetLinked();
+  }
+  __ jmp(target->label());
+}
+
+void NativeRegExpMacroAssembler::Push(Register value) {
+  __ cmpq(kStackPointer, FrameSlot(kStackLimitSlot));
+  __ j(ABOVE_EQUAL, &stack_overflow_);
+  __ movq(Address(kStackPointer, 0), value);
+  __ addq(kStackPointer, Immediate(kWordSize));
+}
+
+void NativeRegExpMacroAssembler::Pop(Register value) {
+  __ subq(kStackPointer, Immediate(kWordSize));
+  __ movq(value, Address(kStackPointer, 0));
+}
+
+int32_t NativeRegExpMacroAssembler::BacktrackTargetAt(intptr_t position) {
+  return *reinterpret_cast<int32_t*>(__ CodeAddress(position));
+}
+
+void NativeRegExpMacroAssembler::SetBacktrackTargetAt(intptr_t position,
+                                                      int32_t target) {
+  *reinterpret_cast<int32_t*>(__ CodeAddress(position)) = target;
+}
+
+void NativeRegExpMacroAssembler::LoadCurrentCharacterUnchecked(
+    intptr_t cp_offset,
+    intptr_t characters) {
+  const Address address(kInput, kCurrentPosition,
+                        (char_size_ == 1) ? TIMES_1 : TIMES_2,
+                        cp_offset * char_size_);
+  switch (characters * char_size_) {
+    case 1:
+      __ movzxb(kCurrentCharacter, address);
+      break;
+    case 2:
+      __ movzxw(kCurrentCharacter, address);
+      break;
+    case 4:
+      __ movl(kCurrentCharacter, address);
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+void NativeRegExpMacroAssembler::AdvanceCurrentPosition(intptr_t by) {
+  ASSERT(by >= kMinCPOffset);
+  ASSERT(by <= kMaxCPOffset);
+  if (by != 0) {
+    __ addq(kCurrentPosition, Immediate(by));
+  }
+}
+
+void NativeRegExpMacroAssembler::AdvanceRegister(intptr_t reg, intptr_t by) {
+  if (by != 0) {
+    __ movl(RAX, Immediate(by));
+    __ addl(RegisterAddress(RegisterOffset(reg)), RAX);
+  }
+}
+
+void NativeRegExpMacroAssembler::Backtrack() {
+  Pop(RAX);
+  __ addq(RAX, FrameSlot(kCodeStartSlot));
+  __ jmp(RAX);
+}
+
+void NativeRegExpMacroAssembler::PushBacktrack(BlockLabel* label) {
+  BlockLabel* target = (label == NULL) ? &backtrack_ : label;
+  if (target->is_bound()) {
+    __ movl(RAX, Immediate(target->pos()));
+  } else {
+    // Link the immediate into the chain of the label. BindBlock replaces it
+    // with the code offset of the label.
+    __ movl(RAX, Immediate((target->pos() > 0) ? target->pos() : 0));
+    target->link_to(__ CodeSize() - sizeof(int32_t));
+  }
+  Push(RAX);
+}
+
+bool NativeRegExpMacroAssembler::Succeed() {
+  __ movq(RAX, Immediate(IrregexpInterpreter::RE_SUCCESS));
+  __ jmp(&exit_);
+  return false;  // Restart matching for global regexp not supported.
+}
+
+void NativeRegExpMacroAssembler::Fail() {
+  __ movq(RAX, Immediate(IrregexpInterpreter::RE_FAILURE));
+  __ jmp(&exit_);
+}
+
+void NativeRegExpMacroAssembler::PopCurrentPosition() {
+  Pop(kCurrentPosition);
+}
+
+void NativeRegExpMacroAssembler::PushCurrentPosition() {
+  Push(kCurrentPosition);
+}
+
+void NativeRegExpMacroAssembler::PopRegister(intptr_t register_index) {
+  Pop(RAX);
+  __ movl(RegisterAddress(RegisterOffset(register_index)), RAX);
+}
+
+void NativeRegExpMacroAssembler::PushRegister(intptr_t register_index) {
+  __ movsxd(RAX, RegisterAddress(RegisterOffset(register_index)));
+  Push(RAX);
+}
+
+void NativeRegExpMacroAssembler::SetCurrentPositionFromEnd(intptr_t by) {
+  Label after_position;
+  __ movq(RAX, kInputLength);
+  __ subq(RAX, kCurrentPosition);
+  __ cmpq(RAX, Immediate(by));
+  __ j(LESS_EQUAL, &after_position, Assembler::kNearJump);
+  __ leaq(kCurrentPosition, Address(kInputLength, -by));
+  // The character before the new position is the current character.
+  LoadCurrentCharacterUnchecked(-1, 1);
+  __ Bind(&after_position);
+}
+
+void NativeRegExpMacroAssembler::SetRegister(intptr_t register_index,
+                                             intptr_t to) {
+  __ movl(RegisterAddress(RegisterOffset(register_index)), Immediate(to));
+}
+
+void NativeRegExpMacroAssembler::WriteCurrentPositionToRegister(
+    intptr_t reg,
+    intptr_t cp_offset) {
+  __ leaq(RAX, Address(kCurrentPosition, cp_offset));
+  __ movl(RegisterAddress(RegisterOffset(reg)), RAX);
+}
+
+void NativeRegExpMacroAssembler::ClearRegisters(intptr_t reg_from,
+                                                intptr_t reg_to) {
+  ASSERT(reg_from <= reg_to);
+  for (intptr_t reg = reg_from; reg <= reg_to; reg++) {
+    SetRegister(reg, -1);
+  }
+}
+
+void NativeRegExpMacroAssembler::ReadCurrentPositionFromRegister(
+    intptr_t reg) {
+  __ movsxd(kCurrentPosition, RegisterAddress(RegisterOffset(reg)));
+}
+
+void NativeRegExpMacroAssembler::WriteStackPointerToRegister(intptr_t reg) {
+  // Stored as a number of entries, like in the interpreter.
+  __ movq(RAX, kStackPointer);
+  __ subq(RAX, FrameSlot(kStackBaseSlot));
+  __ shrq(RAX, Immediate(kWordSizeLog2));
+  __ movl(RegisterAddress(RegisterOffset(reg)), RAX);
+}
+
+void NativeRegExpMacroAssembler::ReadStackPointerFromRegister(intptr_t reg) {
+  __ movsxd(RAX, RegisterAddress(RegisterOffset(reg)));
+  __ movq(kStackPointer, FrameSlot(kStackBaseSlot));
+  __ leaq(kStackPointer, Address(kStackPointer, RAX, TIMES_8, 0));
+}
+
+void NativeRegExpMacroAssembler::LoadCurrentCharacter(
+    intptr_t cp_offset,
+    BlockLabel* on_end_of_input,
+    bool check_bounds,
+    intptr_t characters) {
+  ASSERT(cp_offset >= kMinCPOffset);
+  ASSERT(cp_offset <= kMaxCPOffset);
+  if (check_bounds) {
+    __ leaq(RAX, Address(kCurrentPosition, cp_offset + characters - 1));
+    __ cmpq(RAX, kInputLength);
+    BranchOrBacktrack(GREATER_EQUAL, on_end_of_input);
+  }
+  LoadCurrentCharacterUnchecked(cp_offset, characters);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacter(unsigned c,
+                                                BlockLabel* on_equal) {
+  __ cmpl(kCurrentCharacter, CharacterImmediate(c));
+  BranchOrBacktrack(EQUAL, on_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterAfterAnd(unsigned c,
+                                                        unsigned mask,
+                                                        BlockLabel* on_equal) {
+  __ movl(RAX, kCurrentCharacter);
+  __ andl(RAX, CharacterImmediate(mask));
+  __ cmpl(RAX, CharacterImmediate(c));
+  BranchOrBacktrack(EQUAL, on_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterGT(uint16_t limit,
+                                                  BlockLabel* on_greater) {
+  __ cmpl(kCurrentCharacter, Immediate(limit));
+  BranchOrBacktrack(ABOVE, on_greater);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterLT(uint16_t limit,
+                                                  BlockLabel* on_less) {
+  __ cmpl(kCurrentCharacter, Immediate(limit));
+  BranchOrBacktrack(BELOW, on_less);
+}
+
+void NativeRegExpMacroAssembler::CheckGreedyLoop(
+    BlockLabel* on_tos_equals_current_position) {
+  Label fallthrough;
+  __ cmpq(kCurrentPosition, Address(kStackPointer, -kWordSize));
+  __ j(NOT_EQUAL, &fallthrough, Assembler::kNearJump);
+  __ subq(kStackPointer, Immediate(kWordSize));
+  Jump(on_tos_equals_current_position);
+  __ Bind(&fallthrough);
+}
+
+void NativeRegExpMacroAssembler::CheckAtStart(BlockLabel* on_at_start) {
+  __ testq(kCurrentPosition, kCurrentPosition);
+  BranchOrBacktrack(ZERO, on_at_start);
+}
+
+void NativeRegExpMacroAssembler::CheckNotAtStart(BlockLabel* on_not_at_start) {
+  __ testq(kCurrentPosition, kCurrentPosition);
+  BranchOrBacktrack(NOT_ZERO, on_not_at_start);
+}
+
+void NativeRegExpMacroAssembler::CheckNotCharacter(unsigned c,
+                                                   BlockLabel* on_not_equal) {
+  __ cmpl(kCurrentCharacter, CharacterImmediate(c));
+  BranchOrBacktrack(NOT_EQUAL, on_not_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckNotCharacterAfterAnd(
+    unsigned c,
+    unsigned mask,
+    BlockLabel* on_not_equal) {
+  __ movl(RAX, kCurrentCharacter);
+  __ andl(RAX, CharacterImmediate(mask));
+  __ cmpl(RAX, CharacterImmediate(c));
+  BranchOrBacktrack(NOT_EQUAL, on_not_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckNotCharacterAfterMinusAnd(
+    uint16_t c,
+    uint16_t minus,
+    uint16_t mask,
+    BlockLabel* on_not_equal) {
+  __ movl(RAX, kCurrentCharacter);
+  __ subl(RAX, Immediate(minus));
+  __ andl(RAX, Immediate(mask));
+  __ cmpl(RAX, Immediate(c));
+  BranchOrBacktrack(NOT_EQUAL, on_not_equal);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterInRange(
+    uint16_t from,
+    uint16_t to,
+    BlockLabel* on_in_range) {
+  __ movl(RAX, kCurrentCharacter);
+  __ subl(RAX, Immediate(from));
+  __ cmpl(RAX, Immediate(to - from));
+  BranchOrBacktrack(BELOW_EQUAL, on_in_range);
+}
+
+void NativeRegExpMacroAssembler::CheckCharacterNotInRange(
+    uint16_t from,
+    uint16_t to,
+    BlockLabel* on_not_in_range) {
+  __ movl(RAX, kCurrentCharacter);
+  __ subl(RAX, Immediate(from));
+  __ cmpl(RAX, Immediate(to - from));
+  BranchOrBacktrack(ABOVE, on_not_in_range);
+}
+
+void NativeRegExpMacroAssembler::CheckBitInTable(const TypedData& table,
+                                                 BlockLabel* on_bit_set) {
+  // The 128 entry table is folded into two 64-bit immediates.
+  uint64_t bits[2] = {0, 0};
+  for (intptr_t i = 0; i < kTableSize; i++) {
+    if (table.GetUint8(i) != 0) {
+      bits[i >> 6] |= static_cast<uint64_t>(1) << (i & 63);
+    }
+  }
+  Label high_half, test;
+  __ movl(RAX, kCurrentCharacter);
+  __ andl(RAX, Immediate(kTableMask));
+  __ cmpl(RAX, Immediate(64));
+  __ j(ABOVE_EQUAL, &high_half, Assembler::kNearJump);
+  __ movq(RCX, Immediate(static_cast<int64_t>(bits[0])));
+  __ jmp(&test, Assembler::kNearJump);
+  __ Bind(&high_half);
+  __ movq(RCX, Immediate(static_cast<int64_t>(bits[1])));
+  __ Bind(&test);
+  __ btq(RCX, RAX);  // Uses the index modulo 64.
+  BranchOrBacktrack(CARRY, on_bit_set);
+}
+
+void NativeRegExpMacroAssembler::LoadBackReference(intptr_t start_reg,
+                                                   Label* fallthrough,
+                                                   BlockLabel* on_no_match) {
+  // RAX: start of the capture, RCX: its length.
+  __ movsxd(RAX, RegisterAddress(RegisterOffset(start_reg)));
+  __ movsxd(RCX, RegisterAddress(RegisterOffset(start_reg + 1)));
+  __ subq(RCX, RAX);
+  __ testq(RAX, RAX);
+  __ j(LESS, fallthrough);
+  __ testq(RCX, RCX);
+  __ j(LESS_EQUAL, fallthrough);
+  __ leaq(RDX, Address(kCurrentPosition, RCX, TIMES_1, 0));
+  __ cmpq(RDX, kInputLength);
+  BranchOrBacktrack(GREATER, on_no_match);
+}
+
+void NativeRegExpMacroAssembler::CheckNotBackReference(
+    intptr_t start_reg,
+    BlockLabel* on_no_match) {
+  ASSERT(start_reg >= 0);
+  ASSERT(start_reg <= kMaxRegister);
+  Label fallthrough, loop;
+  LoadBackReference(start_reg, &fallthrough, on_no_match);
+  const ScaleFactor scale = (char_size_ == 1) ? TIMES_1 : TIMES_2;
+  __ leaq(R8, Address(kInput, RAX, scale, 0));
+  __ leaq(R9, Address(kInput, kCurrentPosition, scale, 0));
+  __ movq(RDX, RCX);
+  __ Bind(&loop);
+  if (char_size_ == 1) {
+    __ movzxb(RAX, Address(R8, 0));
+    __ movzxb(RSI, Address(R9, 0));
+  } else {
+    __ movzxw(RAX, Address(R8, 0));
+    __ movzxw(RSI, Address(R9, 0));
+  }
+  __ cmpl(RAX, RSI);
+  BranchOrBacktrack(NOT_EQUAL, on_no_match);
+  __ addq(R8, Immediate(char_size_));
+  __ addq(R9, Immediate(char_size_));
+  __ decq(RCX);
+  __ j(NOT_ZERO, &loop);
+  __ addq(kCurrentPosition, RDX);
+  __ Bind(&fallthrough);
+}
+
+void NativeRegExpMacroAssembler::CheckNotBackReferenceIgnoreCase(
+    intptr_t start_reg,
+    BlockLabel* on_no_match) {
+  ASSERT(start_reg >= 0);
+  ASSERT(start_reg <= kMaxRegister);
+  Label fallthrough;
+  LoadBackReference(start_reg, &fallthrough, on_no_match);
+  const ScaleFactor scale = (char_size_ == 1) ? TIMES_1 : TIMES_2;
+  const uword compare =
+      (char_size_ == 1)
+          ? reinterpret_cast<uword>(&CaseInsensitiveCompareLatin1)
+          : reinterpret_cast<uword>(&CaseInsensitiveCompareUTF16);
+  __ movq(FrameSlot(kSavedCharacterSlot), kCurrentCharacter);
+  // The length goes first: RCX is the first argument register on Windows.
+  __ movq(CallingConventions::kArg3Reg, RCX);
+  __ leaq(CallingConventions::kArg1Reg, Address(kInput, RAX, scale, 0));
+  __ leaq(CallingConventions::kArg2Reg,
+          Address(kInput, kCurrentPosition, scale, 0));
+  __ movq(RAX, Immediate(compare));
+  __ call(RAX);
+  __ movq(kCurrentCharacter, FrameSlot(kSavedCharacterSlot));
+  __ testq(RAX, RAX);
+  BranchOrBacktrack(ZERO, on_no_match);
+  __ movsxd(RAX, RegisterAddress(RegisterOffset(start_reg)));
+  __ movsxd(RCX, RegisterAddress(RegisterOffset(start_reg + 1)));
+  __ subq(RCX, RAX);
+  __ addq(kCurrentPosition, RCX);
+  __ Bind(&fallthrough);
+}
+
+void NativeRegExpMacroAssembler::IfRegisterLT(intptr_t register_index,
+                                              intptr_t comparand,
+                                              BlockLabel* if_lt) {
+  __ cmpl(RegisterAddress(RegisterOffset(register_index)),
+          Immediate(comparand));
+  BranchOrBacktrack(LESS, if_lt);
+}
+
+void NativeRegExpMacroAssembler::IfRegisterGE(intptr_t register_index,
+                                              intptr_t comparand,
+                                              BlockLabel* if_ge) {
+  __ cmpl(RegisterAddress(RegisterOffset(register_index)),
+          Immediate(comparand));
+  BranchOrBacktrack(GREATER_EQUAL, if_ge);
+}
+
+void NativeRegExpMacroAssembler::IfRegisterEqPos(intptr_t register_index,
+                                                 BlockLabel* if_eq) {
+  __ cmpl(kCurrentPosition, RegisterAddress(RegisterOffset(register_index)));
+  BranchOrBacktrack(EQUAL, if_eq);
+}
+
+}  // namespace dart
+
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
+#endif  // defined(TARGET_ARCH_X64)
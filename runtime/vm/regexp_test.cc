@@ -7,11 +7,15 @@
 #include "vm/isolate.h"
 #include "vm/object.h"
 #include "vm/regexp.h"
+#include "vm/regexp_assembler_bytecode.h"
 #include "vm/regexp_assembler_ir.h"
+#include "vm/regexp_assembler_native.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, native_irregexp);
+
 static RawArray* Match(const String& pat, const String& str) {
   Thread* thread = Thread::Current();
   Zone* zone = thread->zone();
@@ -106,4 +110,190 @@ TEST_CASE(RegExp_ExternalTwoByteString) {
   EXPECT_EQ(3, smi_2.Value());
 }
 
+#if defined(DART_NATIVE_IRREGEXP)
+
+// Regexps are compiled with the native backend while this scope is alive.
+class NativeRegExpScope : public ValueObject {
+ public:
+  NativeRegExpScope()
+      : saved_interpret_(FLAG_interpret_irregexp),
+        saved_native_(FLAG_native_irregexp) {
+    FLAG_interpret_irregexp = false;
+    FLAG_native_irregexp = true;
+  }
+  ~NativeRegExpScope() {
+    FLAG_interpret_irregexp = saved_interpret_;
+    FLAG_native_irregexp = saved_native_;
+  }
+
+ private:
+  const bool saved_interpret_;
+  const bool saved_native_;
+};
+
+// Matches 'pattern' against 'subject' from every start index with the native
+// backend, and expects the same capture registers as the bytecode
+// interpreter.
+static void ExpectSameMatches(const char* pattern,
+                              const String& subject,
+                              bool ignore_case) {
+  NativeRegExpScope scope;
+  Thread* thread = Thread::Current();
+  const String& pat = String::Handle(String::New(pattern));
+  const RegExp& native = RegExp::Handle(RegExpEngine::CreateRegExp(
+      thread, pat, /*multi_line=*/true, ignore_case));
+  const RegExp& bytecode = RegExp::Handle(RegExpEngine::CreateRegExp(
+      thread, pat, /*multi_line=*/true, ignore_case));
+  Smi& start_index = Smi::Handle();
+  Instance& expected = Instance::Handle();
+  Instance& actual = Instance::Handle();
+  for (intptr_t sticky = 0; sticky <= 1; sticky++) {
+    for (intptr_t i = 0; i <= subject.Length(); i++) {
+      StackZone stack_zone(thread);
+      Zone* zone = stack_zone.GetZone();
+      start_index = Smi::New(i);
+      expected = BytecodeRegExpMacroAssembler::Interpret(
+          bytecode, subject, start_index, sticky != 0, zone);
+      actual = NativeRegExpMacroAssembler::Execute(native, subject,
+                                                   start_index, sticky != 0,
+                                                   zone);
+      if (expected.IsNull() || actual.IsNull()) {
+        if (!expected.IsNull() || !actual.IsNull()) {
+          dart::Expect(__FILE__, __LINE__)
+              .Fail("/%s/ from %" Pd ": %s by the native backend only",
+                    pattern, i, expected.IsNull() ? "matched" : "failed");
+        }
+        continue;
+      }
+      const TypedData& expected_registers = TypedData::Cast(expected);
+      const TypedData& actual_registers = TypedData::Cast(actual);
+      EXPECT_EQ(expected_registers.Length(), actual_registers.Length());
+      for (intptr_t j = 0; j < expected_registers.Length(); j++) {
+        const int32_t expected_value =
+            expected_registers.GetInt32(j * sizeof(int32_t));
+        const int32_t actual_value =
+            actual_registers.GetInt32(j * sizeof(int32_t));
+        if (expected_value != actual_value) {
+          dart::Expect(__FILE__, __LINE__)
+              .Fail("/%s/ from %" Pd ": register %" Pd " is %d, not %d",
+                    pattern, i, j, actual_value, expected_value);
+        }
+      }
+    }
+  }
+}
+
+static const char* kBacktrackingPatterns[] = {
+    "(a+)+b",
+    "a*?b",
+    "^(?:a|ab)*c$",
+    "(a|ab)(c|bcd)(d*)",
+    "a{2,3}?b",
+    "(?:x|xy){3}z",
+    "[a-c]+?c",
+    "(?=(a+))a*b\\1",
+    "(?!ab)a.",
+    "\\bfoo\\b",
+};
+static const intptr_t kNumBacktrackingPatterns =
+    ARRAY_SIZE(kBacktrackingPatterns);
+
+static const char* kCapturePatterns[] = {
+    "(\\d+)-(\\d+)-(\\d+)",
+    "((a)|b)+",
+    "(a)|(b)",
+    "(x)?y",
+    "(a*)*",
+    "(a*)+?b",
+    "(\\w)\\1",
+    "(?:(a)|(b))*c",
+    "((((((((((a))))))))))\\10",
+    "^(\\w+)\\s(\\w+)$",
+};
+static const intptr_t kNumCapturePatterns = ARRAY_SIZE(kCapturePatterns);
+
+ISOLATE_UNIT_TEST_CASE(RegExp_NativeBacktrackingAndCaptures) {
+  const String& subject = String::Handle(String::New(
+      "aaaaaaab abcd aabcdd xyxyxz xxyxz aaab aab caa foo.foobar\n"
+      "12-345-6789 aaaaa ab abab aacbc xy y bbaac abab\n"
+      "first second"));
+  for (intptr_t i = 0; i < kNumBacktrackingPatterns; i++) {
+    ExpectSameMatches(kBacktrackingPatterns[i], subject,
+                      /*ignore_case=*/false);
+  }
+  for (intptr_t i = 0; i < kNumCapturePatterns; i++) {
+    ExpectSameMatches(kCapturePatterns[i], subject, /*ignore_case=*/false);
+  }
+}
+
+ISOLATE_UNIT_TEST_CASE(RegExp_NativeIgnoreCase) {
+  const String& subject =
+      String::Handle(String::New("ABC abc AbC aA Aa xYz-XyZ \xc3\xa9\xc3\x89"));
+  const char* kPatterns[] = {
+      "abc", "[a-z]+", "(a)\\1", "(\\w)\\1", "x[y]z", "\\u00e9+", "[^a-c ]+",
+  };
+  const intptr_t kNumPatterns = ARRAY_SIZE(kPatterns);
+  for (intptr_t i = 0; i < kNumPatterns; i++) {
+    ExpectSameMatches(kPatterns[i], subject, /*ignore_case=*/true);
+    ExpectSameMatches(kPatterns[i], subject, /*ignore_case=*/false);
+  }
+}
+
+ISOLATE_UNIT_TEST_CASE(RegExp_NativeTwoByteString) {
+  // Greek sigmas, Latin A with macron and CJK characters make the subject a
+  // two-byte string.
+  const uint16_t chars[] = {
+      0x3A3, 0x3C3, 0x3C2, ' ', 0x100,  0x101,  0x100,  ' ', 'a',   'b',   'c',
+      ' ',   0x3A3, 0x3A3, ' ', 0x65E5, 0x672C, 0x8A9E, ' ', 0x3C3, 0x3C3,
+  };
+  const String& subject =
+      String::Handle(String::FromUTF16(chars, ARRAY_SIZE(chars)));
+  EXPECT(subject.IsTwoByteString());
+  const char* kPatterns[] = {
+      "\\u03c3+",
+      "(\\u03a3)\\1",
+      "[\\u0100-\\u01ff]+",
+      "\\u0101{2}",
+      "[^\\u0000-\\u00ff]+",
+      "(\\w+)",
+      "\\u65e5(.)\\u8a9e",
+      "(\\u03c3|\\u03c2)+$",
+  };
+  const intptr_t kNumPatterns = ARRAY_SIZE(kPatterns);
+  for (intptr_t i = 0; i < kNumPatterns; i++) {
+    ExpectSameMatches(kPatterns[i], subject, /*ignore_case=*/true);
+    ExpectSameMatches(kPatterns[i], subject, /*ignore_case=*/false);
+  }
+}
+
+// The native backend has the same bounded backtracking stack as the bytecode
+// interpreter. Running out of it throws a StackOverflowError, after which
+// the isolate keeps matching.
+TEST_CASE(RegExp_NativeStackOverflow) {
+  const char* kScript =
+      "main() {\n"
+      "  var subject = 'ab' * 100000;\n"
+      "  var overflowed = false;\n"
+      "  try {\n"
+      "    new RegExp(r'^(a|b)*c').firstMatch(subject);\n"
+      "  } on StackOverflowError {\n"
+      "    overflowed = true;\n"
+      "  }\n"
+      "  var match = new RegExp(r'(a)(b)$').firstMatch(subject);\n"
+      "  return overflowed && match.start == subject.length - 2 &&\n"
+      "      match.group(1) == 'a' && match.group(2) == 'b';\n"
+      "}\n";
+  NativeRegExpScope scope;
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  EXPECT(Dart_IsBoolean(result));
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+}
+
+#endif  // defined(DART_NATIVE_IRREGEXP)
+
 }  // namespace dart
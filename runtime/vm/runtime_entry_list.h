@@ -67,6 +67,13 @@ namespace dart {
   V(double, LibcAsin, double)                                                  \
   V(double, LibcAtan, double)                                                  \
   V(double, LibcAtan2, double, double)                                         \
+  V(double, LibcSqrt, double)                                                  \
+  V(double, LibcExp, double)                                                   \
+  V(double, LibcLog, double)                                                   \
+  V(int64_t, StopwatchNow, void)                                               \
+  V(int64_t, StopwatchFrequency, void)                                         \
+  V(int64_t, TimelineGetTraceClock, void)                                      \
+  V(int64_t, TimelineGetThreadCpuClock, void)                                  \
   V(RawBool*, CaseInsensitiveCompareUC16, RawString*, RawSmi*, RawSmi*, RawSmi*)
 
 }  // namespace dart
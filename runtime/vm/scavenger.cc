@@ -26,12 +26,18 @@ DEFINE_FLAG(int,
             early_tenuring_threshold,
             66,
             "When more than this percentage of promotion candidates survive, "
-            "promote all survivors of next scavenge.");
+            "promote all survivors of next scavenge. Ignored with "
+            "--new_gen_pause_target_micros.");
 DEFINE_FLAG(int,
             new_gen_garbage_threshold,
             90,
             "Grow new gen when less than this percentage is garbage.");
 DEFINE_FLAG(int, new_gen_growth_factor, 4, "Grow new gen by this factor.");
+DEFINE_FLAG(int,
+            new_gen_pause_target_micros,
+            0,
+            "When positive, size new gen and choose the age at which objects "
+            "are promoted to keep scavenges below this many microseconds.");
 
 // Scavenger uses RawObject::kMarkBit to distinguish forwarded and non-forwarded
 // objects. The kMarkBit does not intersect with the target address because of
@@ -70,6 +76,7 @@ class ScavengerVisitor : public ObjectPointerVisitor {
         from_(from),
         heap_(scavenger->heap_),
         page_space_(scavenger->heap_->old_space()),
+        promote_marked_(page_space_->IsMarkingIncrementally()),
         bytes_promoted_(0),
         visiting_old_object_(NULL) {}
 
@@ -100,7 +107,15 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       ASSERT(heap_->DataContains(ptr));
     }
     // If the newly written object is not a new object, drop it immediately.
-    if (!obj->IsNewObject() || visiting_old_object_->IsRemembered()) {
+    if (!obj->IsNewObject()) {
+      return;
+    }
+    if (visiting_old_object_->IsCardRemembered()) {
+      // Also converts card remembered arrays found in the store buffer.
+      visiting_old_object_->RememberCard(p);
+      return;
+    }
+    if (visiting_old_object_->IsRemembered()) {
       return;
     }
     visiting_old_object_->SetRememberedBit();
@@ -127,27 +142,33 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       new_addr = ForwardedAddr(header);
     } else {
       intptr_t size = raw_obj->Size();
+      intptr_t age = RawObject::AgeTag::decode(static_cast<uint32_t>(header));
+      scavenger_->survived_words_by_age_[age] += size >> kWordSizeLog2;
       NOT_IN_PRODUCT(intptr_t cid = raw_obj->GetClassId());
       NOT_IN_PRODUCT(ClassTable* class_table = isolate()->class_table());
+#ifndef PRODUCT
+      if (age == 0) {
+        // Feedback for pretenuring, see ClassHeapStats::pretenure.
+        class_table->UpdateSurvivedNew(cid);
+      }
+#endif  // !PRODUCT
+      bool promoted = false;
       // Check whether object should be promoted.
-      if (scavenger_->survivor_end_ <= raw_addr) {
-        // Not a survivor of a previous scavenge. Just copy the object into the
-        // to space.
+      if (age < scavenger_->tenuring_age_) {
+        // Not old enough to be promoted. Just copy the object into the to
+        // space.
         new_addr = scavenger_->AllocateGC(size);
         NOT_IN_PRODUCT(class_table->UpdateLiveNew(cid, size));
       } else {
-        // TODO(iposva): Experiment with less aggressive promotion. For example
-        // a coin toss determines if an object is promoted or whether it should
-        // survive in this generation.
-        //
-        // This object is a survivor of a previous scavenge. Attempt to promote
-        // the object.
+        // This object survived enough scavenges. Attempt to promote the
+        // object.
         new_addr =
             page_space_->TryAllocatePromoLocked(size, PageSpace::kForceGrowth);
         if (new_addr != 0) {
           // If promotion succeeded then we need to remember it so that it can
           // be traversed later.
           scavenger_->PushToPromotedStack(new_addr);
+          promoted = true;
           bytes_promoted_ += size;
           NOT_IN_PRODUCT(class_table->UpdateAllocatedOld(cid, size));
         } else {
@@ -163,6 +184,26 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       // Copy the object to the new location.
       memmove(reinterpret_cast<void*>(new_addr),
               reinterpret_cast<void*>(raw_addr), size);
+      // Age the copy, or clear the age of a promoted object.
+      if (promoted) {
+        RawObject::FromAddr(new_addr)->SetAgeUnsynchronized(0);
+        // Large arrays are promoted to their own large page, see
+        // Array::UseCardMarking.
+        const intptr_t promoted_cid = raw_obj->GetClassId();
+        if (((promoted_cid == kArrayCid) ||
+             (promoted_cid == kImmutableArrayCid)) &&
+            Array::UseCardMarking(size)) {
+          RawObject::FromAddr(new_addr)->SetCardRememberedBitUnsynchronized();
+        }
+        // Promote black while marking incrementally, see Object::Allocate.
+        if (promote_marked_) {
+          RawObject::FromAddr(new_addr)->SetMarkBitUnsynchronized();
+        }
+      } else {
+        age = Utils::Minimum(age + 1, RawObject::kMaxAge);
+        RawObject::FromAddr(new_addr)->SetAgeUnsynchronized(age);
+        scavenger_->new_words_by_age_[age] += size >> kWordSizeLog2;
+      }
       // Remember forwarding address.
       ForwardTo(raw_addr, new_addr);
     }
@@ -180,6 +221,7 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   SemiSpace* from_;
   Heap* heap_;
   PageSpace* page_space_;
+  const bool promote_marked_;
   RawWeakProperty* delayed_weak_properties_;
   intptr_t bytes_promoted_;
   RawObject* visiting_old_object_;
@@ -287,8 +329,9 @@ SemiSpace* SemiSpace::New(intptr_t size_in_words, const char* name) {
     return new SemiSpace(NULL);
   } else {
     intptr_t size_in_bytes = size_in_words << kWordSizeLog2;
-    VirtualMemory* reserved = VirtualMemory::Reserve(size_in_bytes);
     const bool kExecutable = false;
+    VirtualMemory* reserved =
+        VirtualMemory::ReserveHeap(size_in_bytes, kExecutable);
     if ((reserved == NULL) || !reserved->Commit(kExecutable, name)) {
       // TODO(koda): If cache_ is not empty, we could try to delete it.
       delete reserved;
@@ -317,6 +360,13 @@ void SemiSpace::Delete() {
   delete old_cache;
 }
 
+void SemiSpace::Truncate(intptr_t size_in_words) {
+  ASSERT(reserved_ != NULL);
+  ASSERT(size_in_words <= this->size_in_words());
+  reserved_->Truncate(size_in_words << kWordSizeLog2);
+  region_ = MemoryRegion(reserved_->address(), reserved_->size());
+}
+
 void SemiSpace::WriteProtect(bool read_only) {
   if (reserved_ != NULL) {
     bool success = reserved_->Protect(read_only ? VirtualMemory::kReadOnly
@@ -335,6 +385,7 @@ Scavenger::Scavenger(Heap* heap,
                      intptr_t max_semi_capacity_in_words,
                      uword object_alignment)
     : heap_(heap),
+      tenuring_age_(1),
       max_semi_capacity_in_words_(max_semi_capacity_in_words),
       object_alignment_(object_alignment),
       scavenging_(false),
@@ -349,6 +400,12 @@ Scavenger::Scavenger(Heap* heap,
   // going to use for forwarding pointers.
   ASSERT(Object::tags_offset() == 0);
 
+  for (intptr_t age = 0; age <= RawObject::kMaxAge; age++) {
+    cohort_words_by_age_[age] = 0;
+    survived_words_by_age_[age] = 0;
+    new_words_by_age_[age] = 0;
+  }
+
   // Set initial size resulting in a total of three different levels.
   const intptr_t initial_semi_capacity_in_words =
       max_semi_capacity_in_words /
@@ -366,7 +423,9 @@ Scavenger::Scavenger(Heap* heap,
   resolved_top_ = top_;
   end_ = to_->end();
 
-  survivor_end_ = FirstObjectStart();
+  min_semi_capacity_in_words_ = initial_semi_capacity_in_words;
+  target_semi_capacity_in_words_ = initial_semi_capacity_in_words;
+  pause_estimate_micros_ = 0;
   idle_scavenge_threshold_in_words_ = initial_semi_capacity_in_words;
 
   UpdateMaxHeapCapacity();
@@ -379,6 +438,10 @@ Scavenger::~Scavenger() {
 }
 
 intptr_t Scavenger::NewSizeInWords(intptr_t old_size_in_words) const {
+  if (FLAG_new_gen_pause_target_micros > 0) {
+    // Everything in the from space may survive. See ShrinkToTarget.
+    return Utils::Maximum(target_semi_capacity_in_words_, old_size_in_words);
+  }
   if (stats_history_.Size() == 0) {
     return old_size_in_words;
   }
@@ -391,6 +454,132 @@ intptr_t Scavenger::NewSizeInWords(intptr_t old_size_in_words) const {
   }
 }
 
+// Fraction of the allocated words copied by a scavenge in the steady state,
+// when objects are promoted once they survived |tenuring_age| scavenges: each
+// object is copied by every scavenge it survives, up to and including the one
+// promoting it.
+static double CopiedFraction(const double* survival_by_age,
+                             intptr_t tenuring_age) {
+  double copied = 0.0;
+  double surviving = 1.0;
+  for (intptr_t age = 0; age <= tenuring_age; age++) {
+    surviving *= survival_by_age[age];
+    copied += surviving;
+  }
+  return copied;
+}
+
+void Scavenger::StartAgeAccounting(intptr_t used_in_words) {
+  // Everything but the survivors of the last scavenge was allocated since and
+  // has age zero.
+  intptr_t survivor_words = 0;
+  for (intptr_t age = 1; age <= RawObject::kMaxAge; age++) {
+    cohort_words_by_age_[age] = new_words_by_age_[age];
+    survivor_words += new_words_by_age_[age];
+  }
+  cohort_words_by_age_[0] =
+      Utils::Maximum<intptr_t>(0, used_in_words - survivor_words);
+  for (intptr_t age = 0; age <= RawObject::kMaxAge; age++) {
+    survived_words_by_age_[age] = 0;
+    new_words_by_age_[age] = 0;
+  }
+}
+
+void Scavenger::UpdateTenuringPolicy() {
+  // Fraction of the objects of each age that survived the last scavenge.
+  // Without objects of some age, assume they survive like younger ones.
+  double survival_by_age[RawObject::kMaxAge + 1];
+  for (intptr_t age = 0; age <= RawObject::kMaxAge; age++) {
+    const intptr_t cohort_words = cohort_words_by_age_[age];
+    if (cohort_words > 0) {
+      survival_by_age[age] = Utils::Minimum(
+          1.0, survived_words_by_age_[age] / static_cast<double>(cohort_words));
+    } else {
+      survival_by_age[age] = (age > 0) ? survival_by_age[age - 1] : 0.0;
+    }
+  }
+
+  // Copying speed of the recent scavenges.
+  intptr_t history_survived = 0;
+  int64_t history_micros = 0;
+  for (intptr_t i = 0; i < stats_history_.Size(); i++) {
+    history_survived += stats_history_.Get(i).SurvivedInWords();
+    history_micros += stats_history_.Get(i).DurationMicros();
+  }
+  if (history_micros == 0) {
+    history_micros = 1;
+  }
+  const double copied_words_per_micro = Utils::Maximum(
+      1.0, history_survived / static_cast<double>(history_micros));
+
+  if (FLAG_new_gen_pause_target_micros > 0) {
+    AdaptToPauseTarget(survival_by_age, copied_words_per_micro);
+  } else {
+    double avg_frac = stats_history_.Get(0).PromoCandidatesSuccessFraction();
+    if (stats_history_.Size() >= 2) {
+      // Previous scavenge is only given half as much weight.
+      avg_frac += 0.5 * stats_history_.Get(1).PromoCandidatesSuccessFraction();
+      avg_frac /= 1.0 + 0.5;  // Normalize.
+    }
+    // Promote the survivors of a previous scavenge, or when most of them
+    // survive again, everything surviving the next scavenge.
+    tenuring_age_ =
+        (avg_frac < (FLAG_early_tenuring_threshold / 100.0)) ? 1 : 0;
+  }
+
+  pause_estimate_micros_ = static_cast<int64_t>(
+      to_->size_in_words() * CopiedFraction(survival_by_age, tenuring_age_) /
+      copied_words_per_micro);
+}
+
+void Scavenger::AdaptToPauseTarget(const double* survival_by_age,
+                                   double copied_words_per_micro) {
+  // The most words a scavenge can copy within the pause target.
+  const double budget_in_words =
+      FLAG_new_gen_pause_target_micros * copied_words_per_micro;
+
+  // Grow new gen as long as promoting the survivors of one scavenge stays
+  // within the budget, and shrink it as soon as it does not. A larger new gen
+  // gives objects more time to die before they are copied.
+  const double kMinCopiedFraction = CopiedFraction(survival_by_age, 1);
+  const intptr_t growth_limit =
+      Utils::Minimum(max_semi_capacity_in_words_,
+                     to_->size_in_words() * FLAG_new_gen_growth_factor);
+  intptr_t capacity = min_semi_capacity_in_words_;
+  while ((capacity > 0) && ((2 * capacity) <= growth_limit) &&
+         ((2 * capacity * kMinCopiedFraction) <= budget_in_words)) {
+    capacity *= 2;
+  }
+  target_semi_capacity_in_words_ = capacity;
+
+  // Keep objects in new space for as many scavenges as the budget allows, so
+  // that short-lived objects die before being promoted. Survivors must also
+  // leave at least half of the to space for new allocation.
+  const double kMaxRetainedFraction = 0.5;
+  intptr_t age = 1;
+  while ((age < RawObject::kMaxAge) &&
+         ((capacity * CopiedFraction(survival_by_age, age + 1)) <=
+          budget_in_words) &&
+         (CopiedFraction(survival_by_age, age) <= kMaxRetainedFraction)) {
+    age++;
+  }
+  tenuring_age_ = age;
+}
+
+void Scavenger::ShrinkToTarget() {
+  const intptr_t page_size_in_words =
+      VirtualMemory::PageSize() >> kWordSizeLog2;
+  const intptr_t capacity =
+      Utils::RoundUp(target_semi_capacity_in_words_, page_size_in_words);
+  if ((capacity >= to_->size_in_words()) ||
+      (top_ > (to_->start() + (capacity << kWordSizeLog2)))) {
+    return;
+  }
+  to_->Truncate(capacity);
+  end_ = to_->end();
+  UpdateMaxHeapCapacity();
+}
+
 SemiSpace* Scavenger::Prologue(Isolate* isolate) {
   isolate->PrepareForGC();
 
@@ -426,6 +615,11 @@ void Scavenger::Epilogue(Isolate* isolate, SemiSpace* from) {
   // All objects in the to space have been copied from the from space at this
   // moment.
 
+  UpdateTenuringPolicy();
+  if (FLAG_new_gen_pause_target_micros > 0) {
+    ShrinkToTarget();
+  }
+
   // Ensure the mutator thread now has the up-to-date top_ and end_ of the
   // semispace
   if (isolate->IsMutatorThreadScheduled()) {
@@ -434,21 +628,6 @@ void Scavenger::Epilogue(Isolate* isolate, SemiSpace* from) {
     thread->set_end(end_);
   }
 
-  double avg_frac = stats_history_.Get(0).PromoCandidatesSuccessFraction();
-  if (stats_history_.Size() >= 2) {
-    // Previous scavenge is only given half as much weight.
-    avg_frac += 0.5 * stats_history_.Get(1).PromoCandidatesSuccessFraction();
-    avg_frac /= 1.0 + 0.5;  // Normalize.
-  }
-  if (avg_frac < (FLAG_early_tenuring_threshold / 100.0)) {
-    // Remember the limit to which objects have been copied.
-    survivor_end_ = top_;
-  } else {
-    // Move survivor end to the end of the to_ space, making all surviving
-    // objects candidates for promotion next time.
-    survivor_end_ = end_;
-  }
-
   // Update estimate of scavenger speed. This statistic assumes survivorship
   // rates don't change much.
   intptr_t history_used = 0;
@@ -553,12 +732,27 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
     pending = next;
   }
   heap_->RecordData(kStoreBufferEntries, total_count);
-  heap_->RecordData(kDataUnused1, 0);
   heap_->RecordData(kDataUnused2, 0);
   // Done iterating through old objects remembered in the store buffers.
   visitor->VisitingOldObject(NULL);
 }
 
+void Scavenger::IterateRememberedCards(ScavengerVisitor* visitor) {
+  intptr_t total_count = 0;
+  // Promotion below may allocate large pages, which are added to the front
+  // of the list. Arrays promoted into them are visited as promoted objects.
+  HeapPage* page = heap_->old_space()->large_pages_;
+  while (page != NULL) {
+    if (page->HasCardRememberedObject()) {
+      visitor->VisitingOldObject(RawObject::FromAddr(page->object_start()));
+      total_count += page->VisitRememberedCards(visitor);
+    }
+    page = page->next();
+  }
+  heap_->RecordData(kRememberedCards, total_count);
+  visitor->VisitingOldObject(NULL);
+}
+
 void Scavenger::IterateObjectIdTable(Isolate* isolate,
                                      ScavengerVisitor* visitor) {
 #ifndef PRODUCT
@@ -580,6 +774,8 @@ void Scavenger::IterateRoots(Isolate* isolate, ScavengerVisitor* visitor) {
   isolate->VisitObjectPointers(visitor,
                                StackFrameIterator::kDontValidateFrames);
   int64_t middle = OS::GetCurrentMonotonicMicros();
+  // Visit the cards first, the store buffers may mark more of them.
+  IterateRememberedCards(visitor);
   IterateStoreBuffers(isolate, visitor);
   IterateObjectIdTable(isolate, visitor);
   int64_t end = OS::GetCurrentMonotonicMicros();
@@ -877,8 +1073,11 @@ void Scavenger::Scavenge() {
 
   // Prepare for a scavenge.
   SpaceUsage usage_before = GetCurrentUsage();
-  intptr_t promo_candidate_words =
-      (survivor_end_ - FirstObjectStart()) / kWordSize;
+  StartAgeAccounting(usage_before.used_in_words);
+  intptr_t promo_candidate_words = 0;
+  for (intptr_t age = tenuring_age_; age <= RawObject::kMaxAge; age++) {
+    promo_candidate_words += cohort_words_by_age_[age];
+  }
   SemiSpace* from = Prologue(isolate);
   // The API prologue/epilogue may create/destroy zones, so we must not
   // depend on zone allocations surviving beyond the epilogue callback.
@@ -979,12 +1178,7 @@ void Scavenger::Evacuate() {
   SafepointOperationScope scope(Thread::Current());
 
   // Forces the next scavenge to promote all the objects in the new space.
-  survivor_end_ = top_;
-
-  if (heap_->isolate()->IsMutatorThreadScheduled()) {
-    Thread* mutator_thread = heap_->isolate()->mutator_thread();
-    survivor_end_ = mutator_thread->top();
-  }
+  tenuring_age_ = 0;
 
   Scavenge();
 
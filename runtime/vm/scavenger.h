@@ -39,6 +39,9 @@ class SemiSpace {
   // Hand back an unused space.
   void Delete();
 
+  // Give back the memory past the first 'size_in_words'.
+  void Truncate(intptr_t size_in_words);
+
   void* pointer() const { return region_.pointer(); }
   uword start() const { return region_.start(); }
   uword end() const { return region_.end(); }
@@ -99,6 +102,11 @@ class ScavengeStats {
 
   intptr_t UsedBeforeInWords() const { return before_.used_in_words; }
 
+  // Words copied by this scavenge, either within new space or by promotion.
+  intptr_t SurvivedInWords() const {
+    return after_.used_in_words + promoted_in_words_;
+  }
+
   int64_t DurationMicros() const { return end_micros_ - start_micros_; }
 
  private:
@@ -209,6 +217,14 @@ class Scavenger {
 
   int64_t gc_time_micros() const { return gc_time_micros_; }
 
+  // Objects that survived at least this many scavenges are promoted by the
+  // next scavenge.
+  intptr_t tenuring_age() const { return tenuring_age_; }
+
+  // Expected duration of the next scavenges under the current policy, based
+  // on the survival rate of each age and the measured copying speed.
+  int64_t pause_estimate_micros() const { return pause_estimate_micros_; }
+
   void IncrementCollections() { collections_++; }
 
   intptr_t collections() const { return collections_; }
@@ -234,7 +250,7 @@ class Scavenger {
     kIterateWeaks = 5,
     // Data
     kStoreBufferEntries = 0,
-    kDataUnused1 = 1,
+    kRememberedCards = 1,
     kDataUnused2 = 2,
     kToKBAfterStoreBuffer = 3
   };
@@ -242,6 +258,7 @@ class Scavenger {
   uword FirstObjectStart() const { return to_->start() | object_alignment_; }
   SemiSpace* Prologue(Isolate* isolate);
   void IterateStoreBuffers(Isolate* isolate, ScavengerVisitor* visitor);
+  void IterateRememberedCards(ScavengerVisitor* visitor);
   void IterateObjectIdTable(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateRoots(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateWeakProperties(Isolate* isolate, ScavengerVisitor* visitor);
@@ -283,6 +300,13 @@ class Scavenger {
   void ProcessWeakReferences();
 
   intptr_t NewSizeInWords(intptr_t old_size_in_words) const;
+  void StartAgeAccounting(intptr_t used_in_words);
+  void UpdateTenuringPolicy();
+  void AdaptToPauseTarget(const double* survival_by_age,
+                          double copied_words_per_micro);
+  // Shrink the to space to target_semi_capacity_in_words_ if the survivors
+  // of the last scavenge fit.
+  void ShrinkToTarget();
 
   uword top_;
   uword end_;
@@ -295,10 +319,23 @@ class Scavenger {
   // this value meets the allocation top.
   uword resolved_top_;
 
-  // Objects below this address have survived a scavenge.
-  uword survivor_end_;
+  // Objects of at least this age are promoted by the next scavenge.
+  intptr_t tenuring_age_;
+
+  // Words of the objects of each age in new space at the start of the current
+  // or last scavenge, of those that survived it, and of those left in new
+  // space after it.
+  intptr_t cohort_words_by_age_[RawObject::kMaxAge + 1];
+  intptr_t survived_words_by_age_[RawObject::kMaxAge + 1];
+  intptr_t new_words_by_age_[RawObject::kMaxAge + 1];
 
+  intptr_t min_semi_capacity_in_words_;
   intptr_t max_semi_capacity_in_words_;
+  // Semispace size for the next scavenge with --new_gen_pause_target_micros.
+  // The to space is never smaller than the from space, which is only shrunk
+  // to this size after a scavenge whose survivors fit.
+  intptr_t target_semi_capacity_in_words_;
+  int64_t pause_estimate_micros_;
 
   // All object are aligned to this value.
   uword object_alignment_;
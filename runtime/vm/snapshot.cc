@@ -740,6 +740,8 @@ void ImageWriter::WriteROData(WriteStream* stream) {
     uword marked_tags = obj.raw()->ptr()->tags_;
     marked_tags = RawObject::VMHeapObjectTag::update(true, marked_tags);
     marked_tags = RawObject::MarkBit::update(true, marked_tags);
+    marked_tags = RawObject::AgeTag::update(0, marked_tags);
+    marked_tags = RawObject::CardRememberedBit::update(false, marked_tags);
 #if defined(HASH_IN_OBJECT_HEADER)
     marked_tags |= static_cast<uword>(obj.raw()->ptr()->hash_) << 32;
 #endif
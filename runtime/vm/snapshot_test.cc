@@ -689,6 +689,69 @@ TEST_CASE(FailSerializeLargeExternalTypedData) {
   ExpectEncodeFail(&root);
 }
 
+static void NoopFinalizer(void* isolate_callback_data,
+                          Dart_WeakPersistentHandle handle,
+                          void* peer) {}
+
+TEST_CASE(SerializeCExternalTypedData) {
+  // External typed data is passed by reference to native ports.
+  int32_t data[] = {1, 2, 3, 4};
+  Dart_CObject root;
+  root.type = Dart_CObject_kExternalTypedData;
+  root.value.as_external_typed_data.type = Dart_TypedData_kInt32;
+  root.value.as_external_typed_data.length = ARRAY_SIZE(data);
+  root.value.as_external_typed_data.data = reinterpret_cast<uint8_t*>(data);
+  root.value.as_external_typed_data.peer = &root;
+  root.value.as_external_typed_data.callback = NoopFinalizer;
+
+  uint8_t* buffer = NULL;
+  ApiMessageWriter writer(&buffer, &malloc_allocator);
+  EXPECT(writer.WriteCMessage(&root));
+
+  ApiNativeScope scope;
+  ApiMessageReader api_reader(buffer, writer.BytesWritten());
+  Dart_CObject* new_root = api_reader.ReadMessage();
+  EXPECT_EQ(Dart_CObject_kExternalTypedData, new_root->type);
+  EXPECT_EQ(Dart_TypedData_kInt32, new_root->value.as_external_typed_data.type);
+  EXPECT_EQ(static_cast<intptr_t>(ARRAY_SIZE(data)),
+            new_root->value.as_external_typed_data.length);
+  EXPECT(new_root->value.as_external_typed_data.data ==
+         reinterpret_cast<uint8_t*>(data));
+  EXPECT(new_root->value.as_external_typed_data.peer == &root);
+  EXPECT(new_root->value.as_external_typed_data.callback == NoopFinalizer);
+  free(buffer);
+}
+
+TEST_CASE(SerializeCTypedDataInPlace) {
+  // Bytes are decoded in place in the message buffer.
+  const intptr_t kLength = 100;
+  uint8_t data[kLength];
+  for (intptr_t i = 0; i < kLength; i++) {
+    data[i] = i;
+  }
+  Dart_CObject root;
+  root.type = Dart_CObject_kTypedData;
+  root.value.as_typed_data.type = Dart_TypedData_kUint8;
+  root.value.as_typed_data.length = kLength;
+  root.value.as_typed_data.values = data;
+
+  uint8_t* buffer = NULL;
+  ApiMessageWriter writer(&buffer, &malloc_allocator);
+  EXPECT(writer.WriteCMessage(&root));
+  const intptr_t buffer_length = writer.BytesWritten();
+
+  ApiNativeScope scope;
+  ApiMessageReader api_reader(buffer, buffer_length);
+  Dart_CObject* new_root = api_reader.ReadMessage();
+  EXPECT_EQ(Dart_CObject_kTypedData, new_root->type);
+  EXPECT_EQ(kLength, new_root->value.as_typed_data.length);
+  EXPECT(new_root->value.as_typed_data.values >= buffer);
+  EXPECT(new_root->value.as_typed_data.values + kLength <=
+         buffer + buffer_length);
+  EXPECT_EQ(0, memcmp(data, new_root->value.as_typed_data.values, kLength));
+  free(buffer);
+}
+
 TEST_CASE(SerializeEmptyArray) {
   // Write snapshot with object content.
   const int kArrayLength = 0;
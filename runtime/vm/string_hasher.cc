@@ -0,0 +1,31 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/string_hasher.h"
+
+#include "vm/flags.h"
+#include "vm/random.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool,
+            randomize_string_hashes,
+            false,
+            "Seed string hash codes with a random value per process to "
+            "harden hash tables against hash flooding. Snapshots cannot be "
+            "written and snapshots containing code cannot be read.");
+
+uint64_t StringHasher::seed_ = 0;
+
+void StringHasher::InitOnce() {
+  seed_ = 0;
+  if (FLAG_randomize_string_hashes) {
+    Random random;
+    while (seed_ == 0) {
+      seed_ = random.NextUInt64();
+    }
+  }
+}
+
+}  // namespace dart
@@ -0,0 +1,162 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_STRING_HASHER_H_
+#define RUNTIME_VM_STRING_HASHER_H_
+
+#include <string.h>
+
+#include "platform/assert.h"
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Incremental word-at-a-time hash function for strings.
+//
+// Equal strings must hash the same regardless of their representation, so
+// the hash is defined over a canonical byte sequence: the Latin-1 bytes of
+// the string if all its code units fit in one byte, and the little-endian
+// UTF-16 code units otherwise. Callers choose the form up front (see
+// StringSearch::IsLatin1) and may then add the code units in any number of
+// pieces of either width.
+//
+// Input is consumed eight bytes at a time by a multiply-rotate mixer in the
+// style of MurmurHash3, and the final state is fully avalanched so that all
+// bits of the result depend on all input bytes.
+//
+// All hashers start from a process wide seed. It is zero unless the VM runs
+// with --randomize_string_hashes, in which case hash codes differ between
+// processes and cannot be precomputed to flood hash tables.
+class StringHasher : public ValueObject {
+ public:
+  explicit StringHasher(bool latin1)
+      : latin1_(latin1),
+        pending_length_(0),
+        hash_(seed_),
+        pending_(0),
+        length_(0) {}
+
+  // Adds one-byte code units.
+  void Add(const uint8_t* data, intptr_t len) {
+    ASSERT(len >= 0);
+    if (latin1_) {
+      AddBytes(data, len);
+      return;
+    }
+    uint16_t buffer[kBufferLength];
+    while (len > 0) {
+      const intptr_t chunk = (len < kBufferLength) ? len : kBufferLength;
+      for (intptr_t i = 0; i < chunk; i++) {
+        buffer[i] = data[i];
+      }
+      AddBytes(reinterpret_cast<const uint8_t*>(buffer),
+               chunk * sizeof(uint16_t));
+      data += chunk;
+      len -= chunk;
+    }
+  }
+
+  // Adds two-byte code units. In the Latin-1 form they must all be below
+  // 0x100.
+  void Add(const uint16_t* data, intptr_t len) {
+    ASSERT(len >= 0);
+    if (!latin1_) {
+      AddBytes(reinterpret_cast<const uint8_t*>(data), len * sizeof(uint16_t));
+      return;
+    }
+    uint8_t buffer[kBufferLength];
+    while (len > 0) {
+      const intptr_t chunk = (len < kBufferLength) ? len : kBufferLength;
+      for (intptr_t i = 0; i < chunk; i++) {
+        ASSERT(data[i] <= 0xFF);
+        buffer[i] = static_cast<uint8_t>(data[i]);
+      }
+      AddBytes(buffer, chunk);
+      data += chunk;
+      len -= chunk;
+    }
+  }
+
+  // Returns a non-zero hash of at most 'bits' bits.
+  intptr_t Finalize(int bits) {
+    ASSERT((1 <= bits) && (bits <= 31));
+    uint64_t hash = hash_;
+    if (pending_length_ != 0) {
+      hash ^= Scramble(pending_);
+    }
+    hash ^= length_;
+    hash ^= hash >> 33;
+    hash *= DART_UINT64_C(0xff51afd7ed558ccd);
+    hash ^= hash >> 33;
+    hash *= DART_UINT64_C(0xc4ceb9fe1a85ec53);
+    hash ^= hash >> 33;
+    const intptr_t result =
+        static_cast<intptr_t>(hash & ((static_cast<uint64_t>(1) << bits) - 1));
+    return (result == 0) ? 1 : result;
+  }
+
+  static void InitOnce();
+
+  static bool IsSeeded() { return seed_ != 0; }
+
+ private:
+  static const intptr_t kBufferLength = 64;
+  static const intptr_t kBlockSize = sizeof(uint64_t);
+
+  void AddBytes(const uint8_t* data, intptr_t len) {
+    length_ += len;
+    if (pending_length_ != 0) {
+      while ((pending_length_ < kBlockSize) && (len > 0)) {
+        pending_ |= static_cast<uint64_t>(*data++) << (8 * pending_length_++);
+        len--;
+      }
+      if (pending_length_ < kBlockSize) {
+        return;
+      }
+      Mix(pending_);
+      pending_ = 0;
+      pending_length_ = 0;
+    }
+    for (; len >= kBlockSize; len -= kBlockSize, data += kBlockSize) {
+      uint64_t block;
+      memmove(&block, data, sizeof(block));
+      Mix(block);
+    }
+    for (intptr_t i = 0; i < len; i++) {
+      pending_ |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    pending_length_ = len;
+  }
+
+  void Mix(uint64_t block) {
+    hash_ ^= Scramble(block);
+    hash_ = RotateLeft(hash_, 27) * 5 + 0x52dce729;
+  }
+
+  static uint64_t Scramble(uint64_t block) {
+    block *= DART_UINT64_C(0x87c37b91114253d5);
+    block = RotateLeft(block, 31);
+    block *= DART_UINT64_C(0x4cf5ad432745937f);
+    return block;
+  }
+
+  static uint64_t RotateLeft(uint64_t value, int amount) {
+    return (value << amount) | (value >> (64 - amount));
+  }
+
+  const bool latin1_;
+  intptr_t pending_length_;  // Number of bytes in 'pending_'.
+  uint64_t hash_;
+  uint64_t pending_;  // Bytes not yet mixed in, lowest first.
+  uint64_t length_;   // Number of bytes added.
+
+  static uint64_t seed_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringHasher);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_STRING_HASHER_H_
@@ -0,0 +1,118 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/string_hasher.h"
+#include "platform/assert.h"
+#include "vm/object.h"
+#include "vm/string_search.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static intptr_t HashLatin1(const uint8_t* data, intptr_t len) {
+  StringHasher hasher(true);
+  hasher.Add(data, len);
+  return hasher.Finalize(String::kHashBits);
+}
+
+VM_UNIT_TEST_CASE(StringHasher_Pieces) {
+  const char* kText =
+      "https://www.example.com/search?q=string+hashing&lang=en#results";
+  const intptr_t len = strlen(kText);
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(kText);
+  uint16_t wide[128];
+  for (intptr_t i = 0; i < len; i++) {
+    wide[i] = data[i];
+  }
+  for (intptr_t n = 0; n <= len; n++) {
+    const intptr_t expected = HashLatin1(data, n);
+    EXPECT(expected > 0);
+    EXPECT(expected < (static_cast<intptr_t>(1) << String::kHashBits));
+    for (intptr_t split = 0; split <= n; split++) {
+      // Any split of the input and any mix of code unit widths.
+      StringHasher hasher(true);
+      hasher.Add(data, split);
+      hasher.Add(wide + split, n - split);
+      EXPECT_EQ(expected, hasher.Finalize(String::kHashBits));
+    }
+  }
+
+  // Two-byte form.
+  wide[len / 2] = 0x3b1;
+  StringHasher whole(false);
+  whole.Add(wide, len);
+  const intptr_t expected = whole.Finalize(String::kHashBits);
+  for (intptr_t split = 0; split <= len / 2; split++) {
+    StringHasher hasher(false);
+    hasher.Add(data, split);
+    hasher.Add(wide + split, len - split);
+    EXPECT_EQ(expected, hasher.Finalize(String::kHashBits));
+  }
+}
+
+VM_UNIT_TEST_CASE(StringHasher_Distinct) {
+  const uint8_t kZeros[16] = {0};
+  // Lengths are mixed in, so runs of zero bytes all hash differently.
+  for (intptr_t i = 0; i < 16; i++) {
+    EXPECT(HashLatin1(kZeros, i) != HashLatin1(kZeros, i + 1));
+  }
+  const uint8_t kAbc[] = {'a', 'b', 'c'};
+  const uint8_t kAcb[] = {'a', 'c', 'b'};
+  EXPECT(HashLatin1(kAbc, 3) != HashLatin1(kAcb, 3));
+  StringHasher narrow(true);
+  narrow.Add(kAbc, 3);
+  EXPECT_EQ(HashLatin1(kAbc, 3), narrow.Finalize(String::kHashBits));
+  StringHasher small(true);
+  small.Add(kAbc, 3);
+  EXPECT(small.Finalize(1) == 1);
+}
+
+ISOLATE_UNIT_TEST_CASE(StringHasher_Representations) {
+  const uint8_t kLatin1[] = {'K', 0xF6, 'l', 'n', ' ', 'c', 'a', 'f', 0xE9,
+                             ' ', 'S', 't', 'r', 'a', 0xDF, 'e', '!'};
+  const intptr_t len = ARRAY_SIZE(kLatin1);
+  uint16_t wide[len];
+  int32_t code_points[len];
+  for (intptr_t i = 0; i < len; i++) {
+    wide[i] = kLatin1[i];
+    code_points[i] = kLatin1[i];
+  }
+  EXPECT(StringSearch::IsLatin1(wide, len));
+
+  const String& one_byte =
+      String::Handle(OneByteString::New(kLatin1, len, Heap::kNew));
+  const String& two_byte =
+      String::Handle(TwoByteString::New(wide, len, Heap::kNew));
+  const String& external_one_byte = String::Handle(
+      ExternalOneByteString::New(kLatin1, len, NULL, NULL, Heap::kNew));
+  const String& external_two_byte = String::Handle(
+      ExternalTwoByteString::New(wide, len, NULL, NULL, Heap::kNew));
+  EXPECT(two_byte.IsTwoByteString());
+  const intptr_t hash = one_byte.Hash();
+  EXPECT_EQ(hash, two_byte.Hash());
+  EXPECT_EQ(hash, external_one_byte.Hash());
+  EXPECT_EQ(hash, external_two_byte.Hash());
+  EXPECT_EQ(hash, String::Hash(wide, len));
+  EXPECT_EQ(hash, String::Hash(code_points, len));
+  EXPECT_EQ(hash, String::Hash(two_byte, 0, len));
+  const String& prefix = String::Handle(String::SubString(two_byte, 0, 5));
+  const String& suffix = String::Handle(String::SubString(one_byte, 5));
+  EXPECT_EQ(hash, String::HashConcat(prefix, suffix));
+  EXPECT_EQ(prefix.Hash(), String::Hash(one_byte, 0, 5));
+
+  // Supplementary code points, split across a concatenation.
+  const int32_t kWide[] = {'x', 0x1D11E, 0x3b1, 'y', 0x10FFFF};
+  const String& str = String::Handle(String::FromUTF32(kWide, 5));
+  EXPECT(str.IsTwoByteString());
+  EXPECT_EQ(str.Hash(), String::Hash(kWide, 5));
+  const String& lead = String::Handle(String::SubString(str, 0, 2));
+  const String& trail = String::Handle(String::SubString(str, 2));
+  EXPECT_EQ(str.Hash(), String::HashConcat(lead, trail));
+  const String& symbol = String::Handle(Symbols::New(thread, str));
+  EXPECT_EQ(symbol.raw(), Symbols::FromConcat(thread, lead, trail));
+  EXPECT(str.Hash() != hash);
+}
+
+}  // namespace dart
@@ -0,0 +1,340 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_STRING_SEARCH_H_
+#define RUNTIME_VM_STRING_SEARCH_H_
+
+#include <string.h>
+
+#include "platform/assert.h"
+#include "platform/utils.h"
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Search, comparison and ASCII case mapping kernels over raw one-byte
+// (Latin-1) and two-byte (UTF-16) code unit arrays.
+//
+// The kernels process a machine word of code units at a time (SWAR) and
+// defer to the C library's memchr/memcmp where the code unit widths allow it,
+// since those are vectorized on all the hosts we support. All functions
+// operate on code units, not code points, which matches the semantics of
+// the corresponding Dart String methods.
+//
+// The word-at-a-time lane arithmetic assumes a little-endian host, like the
+// rest of the VM.
+//
+// Callers are responsible for keeping the arrays alive and in place
+// (i.e. holding a NoSafepointScope when they point into the Dart heap).
+class StringSearch : public AllStatic {
+ public:
+  // Returns the index of the first occurrence of 'ch' in 'data[start..len)',
+  // or -1 if there is none.
+  static intptr_t IndexOfChar(const uint8_t* data,
+                              intptr_t len,
+                              uint16_t ch,
+                              intptr_t start) {
+    ASSERT((0 <= start) && (start <= len));
+    if (ch > 0xFF) {
+      return -1;
+    }
+    const void* found = memchr(data + start, ch, len - start);
+    if (found == NULL) {
+      return -1;
+    }
+    return reinterpret_cast<const uint8_t*>(found) - data;
+  }
+
+  static intptr_t IndexOfChar(const uint16_t* data,
+                              intptr_t len,
+                              uint16_t ch,
+                              intptr_t start) {
+    ASSERT((0 <= start) && (start <= len));
+    intptr_t i = start;
+    const uword pattern = kOnes16 * ch;
+    for (; i + kUnitsPerWord16 <= len; i += kUnitsPerWord16) {
+      const uword match = ZeroHalfWords(LoadWord(data + i) ^ pattern);
+      if (match != 0) {
+        return i + (Utils::CountTrailingZeros(match) >> 4);
+      }
+    }
+    for (; i < len; i++) {
+      if (data[i] == ch) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Returns the index of the first occurrence of 'pattern' in 'data' at or
+  // after 'start', or -1 if there is none.
+  template <typename S, typename P>
+  static intptr_t IndexOf(const S* data,
+                          intptr_t len,
+                          const P* pattern,
+                          intptr_t pattern_len,
+                          intptr_t start) {
+    ASSERT((0 <= start) && (start <= len));
+    if (pattern_len == 0) {
+      return start;
+    }
+    const intptr_t max_index = len - pattern_len;
+    const uint16_t first = pattern[0];
+    intptr_t i = start;
+    while (i <= max_index) {
+      // Scan for the first code unit of the pattern only up to the last
+      // position the pattern can still start at.
+      i = IndexOfChar(data, max_index + 1, first, i);
+      if (i < 0) {
+        return -1;
+      }
+      if (Matches(data + i + 1, pattern + 1, pattern_len - 1)) {
+        return i;
+      }
+      i++;
+    }
+    return -1;
+  }
+
+  // Returns the index of the last occurrence of 'pattern' in 'data' at or
+  // before 'start', or -1 if there is none.
+  template <typename S, typename P>
+  static intptr_t LastIndexOf(const S* data,
+                              intptr_t len,
+                              const P* pattern,
+                              intptr_t pattern_len,
+                              intptr_t start) {
+    ASSERT(start >= 0);
+    intptr_t i = Utils::Minimum(start, len - pattern_len);
+    if (pattern_len == 0) {
+      return i;
+    }
+    const uint16_t first = pattern[0];
+    for (; i >= 0; i--) {
+      if ((data[i] == first) &&
+          Matches(data + i + 1, pattern + 1, pattern_len - 1)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Returns true if 'a[0..len)' and 'b[0..len)' hold the same code units.
+  static bool Matches(const uint8_t* a, const uint8_t* b, intptr_t len) {
+    return memcmp(a, b, len) == 0;
+  }
+
+  static bool Matches(const uint16_t* a, const uint16_t* b, intptr_t len) {
+    return memcmp(a, b, len * sizeof(uint16_t)) == 0;
+  }
+
+  static bool Matches(const uint16_t* a, const uint8_t* b, intptr_t len) {
+    return Matches(b, a, len);
+  }
+
+  static bool Matches(const uint8_t* a, const uint16_t* b, intptr_t len) {
+    intptr_t i = 0;
+    for (; i + kUnitsPerWord16 <= len; i += kUnitsPerWord16) {
+      if (WidenHalfWord(LoadHalfWord(a + i)) != LoadWord(b + i)) {
+        return false;
+      }
+    }
+    for (; i < len; i++) {
+      if (a[i] != b[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Lexicographically compares the code units of 'a' and 'b', returning
+  // -1, 0 or 1 like String.compareTo.
+  static intptr_t Compare(const uint8_t* a,
+                          intptr_t a_len,
+                          const uint8_t* b,
+                          intptr_t b_len) {
+    const int result = memcmp(a, b, Utils::Minimum(a_len, b_len));
+    if (result != 0) {
+      return (result < 0) ? -1 : 1;
+    }
+    return CompareLengths(a_len, b_len);
+  }
+
+  template <typename A, typename B>
+  static intptr_t Compare(const A* a,
+                          intptr_t a_len,
+                          const B* b,
+                          intptr_t b_len) {
+    const intptr_t len = Utils::Minimum(a_len, b_len);
+    const intptr_t mismatch = FirstMismatch(a, b, len);
+    if (mismatch < len) {
+      return (a[mismatch] < b[mismatch]) ? -1 : 1;
+    }
+    return CompareLengths(a_len, b_len);
+  }
+
+  // Returns true if all of 'data[0..len)' are ASCII code units.
+  static bool IsAscii(const uint8_t* data, intptr_t len) {
+    intptr_t i = 0;
+    for (; i + kWordSize <= len; i += kWordSize) {
+      if ((LoadWord(data + i) & kHigh8) != 0) {
+        return false;
+      }
+    }
+    for (; i < len; i++) {
+      if (data[i] > 0x7F) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns true if all of 'data[0..len)' fit in one byte (Latin-1).
+  static bool IsLatin1(const uint16_t* data, intptr_t len) {
+    intptr_t i = 0;
+    for (; i + kUnitsPerWord16 <= len; i += kUnitsPerWord16) {
+      if ((LoadWord(data + i) & kHighBytes16) != 0) {
+        return false;
+      }
+    }
+    for (; i < len; i++) {
+      if (data[i] > 0xFF) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the index of the first ASCII code unit in 'data[0..len)' that
+  // changes under ASCII lower (upper) case mapping, or 'len' if there is
+  // none. 'data' must be all ASCII.
+  template <bool kToUpper>
+  static intptr_t FirstAsciiCaseChange(const uint8_t* data, intptr_t len) {
+    intptr_t i = 0;
+    for (; i + kWordSize <= len; i += kWordSize) {
+      const uword mask = AsciiCaseMask<kToUpper>(LoadWord(data + i));
+      if (mask != 0) {
+        return i + (Utils::CountTrailingZeros(mask) >> 3);
+      }
+    }
+    for (; i < len; i++) {
+      if (AsciiCaseMask<kToUpper>(data[i]) != 0) {
+        return i;
+      }
+    }
+    return len;
+  }
+
+  // Copies 'src[0..len)' to 'dst', mapping ASCII letters to lower (upper)
+  // case. 'src' must be all ASCII.
+  template <bool kToUpper>
+  static void AsciiCaseCopy(const uint8_t* src, uint8_t* dst, intptr_t len) {
+    intptr_t i = 0;
+    for (; i + kWordSize <= len; i += kWordSize) {
+      const uword word = LoadWord(src + i);
+      // The case bit 0x20 is set in lower case letters and clear in upper
+      // case ones, so flipping it maps exactly the letters in the mask.
+      StoreWord(dst + i, word ^ (AsciiCaseMask<kToUpper>(word) >> 2));
+    }
+    for (; i < len; i++) {
+      const uint8_t ch = src[i];
+      dst[i] = ch ^ static_cast<uint8_t>(AsciiCaseMask<kToUpper>(ch) >> 2);
+    }
+  }
+
+ private:
+  static const uword kOnes8 = ~static_cast<uword>(0) / 0xFF;
+  static const uword kHigh8 = kOnes8 << 7;
+  static const uword kOnes16 = ~static_cast<uword>(0) / 0xFFFF;
+  static const uword kHigh16 = kOnes16 << 15;
+  static const uword kHighBytes16 = kOnes16 * 0xFF00;
+  static const intptr_t kUnitsPerWord16 = kWordSize / sizeof(uint16_t);
+
+  static uword LoadWord(const void* addr) {
+    uword result;
+    memmove(&result, addr, sizeof(result));
+    return result;
+  }
+
+  static void StoreWord(void* addr, uword value) {
+    memmove(addr, &value, sizeof(value));
+  }
+
+#if defined(ARCH_IS_64_BIT)
+  typedef uint32_t HalfWord;
+#else
+  typedef uint16_t HalfWord;
+#endif
+
+  static HalfWord LoadHalfWord(const void* addr) {
+    HalfWord result;
+    memmove(&result, addr, sizeof(result));
+    return result;
+  }
+
+  // Zero-extends each byte of 'half' into a 16-bit lane of the result.
+  static uword WidenHalfWord(HalfWord half) {
+    uword result = 0;
+    for (intptr_t i = 0; i < kUnitsPerWord16; i++) {
+      result |= static_cast<uword>((half >> (i * 8)) & 0xFF) << (i * 16);
+    }
+    return result;
+  }
+
+  // Returns a word with the top bit of every 16-bit lane of 'x' that is
+  // zero set. Lanes above the first zero lane may be reported spuriously,
+  // so only the lowest set bit is meaningful.
+  static uword ZeroHalfWords(uword x) { return (x - kOnes16) & ~x & kHigh16; }
+
+  // Returns a word with the top bit set in every byte of the all-ASCII word
+  // 'x' that holds an upper (lower) case letter to be mapped.
+  template <bool kToUpper>
+  static uword AsciiCaseMask(uword x) {
+    const uword lo = kToUpper ? 'a' : 'A';
+    const uword hi = kToUpper ? 'z' : 'Z';
+    // Bytes are below 0x80, so these additions never carry across bytes.
+    const uword ge_lo = x + kOnes8 * (0x80 - lo);
+    const uword gt_hi = x + kOnes8 * (0x80 - hi - 1);
+    return ge_lo & ~gt_hi & kHigh8;
+  }
+
+  template <typename A, typename B>
+  static intptr_t FirstMismatch(const A* a, const B* b, intptr_t len) {
+    for (intptr_t i = 0; i < len; i++) {
+      if (a[i] != b[i]) {
+        return i;
+      }
+    }
+    return len;
+  }
+
+  static intptr_t FirstMismatch(const uint16_t* a,
+                                const uint16_t* b,
+                                intptr_t len) {
+    intptr_t i = 0;
+    for (; i + kUnitsPerWord16 <= len; i += kUnitsPerWord16) {
+      const uword diff = LoadWord(a + i) ^ LoadWord(b + i);
+      if (diff != 0) {
+        return i + (Utils::CountTrailingZeros(diff) >> 4);
+      }
+    }
+    for (; i < len; i++) {
+      if (a[i] != b[i]) {
+        return i;
+      }
+    }
+    return len;
+  }
+
+  static intptr_t CompareLengths(intptr_t a_len, intptr_t b_len) {
+    if (a_len < b_len) return -1;
+    if (a_len > b_len) return 1;
+    return 0;
+  }
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_STRING_SEARCH_H_
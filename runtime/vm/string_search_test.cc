@@ -0,0 +1,133 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/string_search.h"
+#include "platform/assert.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+// Naive reference implementation to check the word-at-a-time kernels.
+template <typename S, typename P>
+static intptr_t NaiveIndexOf(const S* data,
+                             intptr_t len,
+                             const P* pattern,
+                             intptr_t pattern_len,
+                             intptr_t start) {
+  for (intptr_t i = start; i + pattern_len <= len; i++) {
+    intptr_t j = 0;
+    while ((j < pattern_len) && (data[i + j] == pattern[j])) {
+      j++;
+    }
+    if (j == pattern_len) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+VM_UNIT_TEST_CASE(StringSearch_IndexOfChar) {
+  uint8_t one_byte[67];
+  uint16_t two_byte[67];
+  for (intptr_t i = 0; i < 67; i++) {
+    one_byte[i] = 'a';
+    two_byte[i] = 0x100 + 'a';
+  }
+  for (intptr_t pos = 0; pos < 67; pos++) {
+    one_byte[pos] = 'x';
+    two_byte[pos] = 0x100 + 'x';
+    for (intptr_t start = 0; start <= 67; start++) {
+      const intptr_t expected = (start <= pos) ? pos : -1;
+      EXPECT_EQ(expected, StringSearch::IndexOfChar(one_byte, 67, 'x', start));
+      EXPECT_EQ(expected,
+                StringSearch::IndexOfChar(two_byte, 67, 0x100 + 'x', start));
+    }
+    // Only the low byte matches.
+    EXPECT_EQ(-1, StringSearch::IndexOfChar(two_byte, 67, 'x', 0));
+    EXPECT_EQ(-1, StringSearch::IndexOfChar(one_byte, 67, 0x100 + 'x', 0));
+    one_byte[pos] = 'a';
+    two_byte[pos] = 0x100 + 'a';
+  }
+}
+
+VM_UNIT_TEST_CASE(StringSearch_IndexOf) {
+  const char* kHaystack = "GET /index.html HTTP/1.1\r\nHost: example.com\r\n"
+                          "Content-Type: text/html\r\n\r\n";
+  const char* kNeedles[] = {"GET", "\r\n", "\r\n\r\n", "Host:", "html",
+                            "missing", "", "1\r\nHost", "\n"};
+  const intptr_t len = strlen(kHaystack);
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(kHaystack);
+  uint16_t* wide = new uint16_t[len];
+  for (intptr_t i = 0; i < len; i++) {
+    wide[i] = data[i];
+  }
+  for (intptr_t n = 0; n < static_cast<intptr_t>(ARRAY_SIZE(kNeedles)); n++) {
+    const uint8_t* needle = reinterpret_cast<const uint8_t*>(kNeedles[n]);
+    const intptr_t needle_len = strlen(kNeedles[n]);
+    uint16_t wide_needle[16];
+    for (intptr_t i = 0; i < needle_len; i++) {
+      wide_needle[i] = needle[i];
+    }
+    for (intptr_t start = 0; start <= len; start++) {
+      const intptr_t expected =
+          NaiveIndexOf(data, len, needle, needle_len, start);
+      EXPECT_EQ(expected,
+                StringSearch::IndexOf(data, len, needle, needle_len, start));
+      EXPECT_EQ(expected, StringSearch::IndexOf(data, len, wide_needle,
+                                                needle_len, start));
+      EXPECT_EQ(expected,
+                StringSearch::IndexOf(wide, len, needle, needle_len, start));
+      EXPECT_EQ(expected, StringSearch::IndexOf(wide, len, wide_needle,
+                                                needle_len, start));
+    }
+  }
+  EXPECT_EQ(6, StringSearch::LastIndexOf(data, len, data + 6, 4, len));
+  EXPECT_EQ(len - 4, StringSearch::LastIndexOf(wide, len, data + len - 4, 4,
+                                               len));
+  EXPECT_EQ(0, StringSearch::LastIndexOf(data, len, data, 3, 0));
+  EXPECT_EQ(-1, StringSearch::LastIndexOf(data, len, data + 6, 4, 5));
+  delete[] wide;
+}
+
+VM_UNIT_TEST_CASE(StringSearch_Compare) {
+  const uint8_t a[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j'};
+  const uint16_t b[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 0x100};
+  const uint16_t c[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j'};
+  EXPECT_EQ(0, StringSearch::Compare(a, 10, a, 10));
+  EXPECT_EQ(-1, StringSearch::Compare(a, 9, a, 10));
+  EXPECT_EQ(1, StringSearch::Compare(a, 10, a, 9));
+  EXPECT_EQ(-1, StringSearch::Compare(a, 10, b, 10));
+  EXPECT_EQ(1, StringSearch::Compare(b, 10, a, 10));
+  EXPECT_EQ(0, StringSearch::Compare(a, 10, c, 10));
+  EXPECT_EQ(1, StringSearch::Compare(b, 10, c, 10));
+  EXPECT_EQ(0, StringSearch::Compare(b, 9, c, 9));
+  EXPECT(StringSearch::Matches(a, c, 10));
+  EXPECT(!StringSearch::Matches(a, b, 10));
+  EXPECT(StringSearch::Matches(b, a, 9));
+}
+
+VM_UNIT_TEST_CASE(StringSearch_AsciiCase) {
+  const char* kInput = "Content-Type: TEXT/html; charset=UTF-8 @[`{";
+  const char* kLower = "content-type: text/html; charset=utf-8 @[`{";
+  const char* kUpper = "CONTENT-TYPE: TEXT/HTML; CHARSET=UTF-8 @[`{";
+  const intptr_t len = strlen(kInput);
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(kInput);
+  EXPECT(StringSearch::IsAscii(input, len));
+  uint8_t output[64];
+  StringSearch::AsciiCaseCopy<false>(input, output, len);
+  EXPECT(memcmp(kLower, output, len) == 0);
+  StringSearch::AsciiCaseCopy<true>(input, output, len);
+  EXPECT(memcmp(kUpper, output, len) == 0);
+  EXPECT_EQ(0, StringSearch::FirstAsciiCaseChange<false>(input, len));
+  EXPECT_EQ(1, StringSearch::FirstAsciiCaseChange<true>(input, len));
+  EXPECT_EQ(len, StringSearch::FirstAsciiCaseChange<false>(
+                     reinterpret_cast<const uint8_t*>(kLower), len));
+  EXPECT_EQ(len, StringSearch::FirstAsciiCaseChange<true>(
+                     reinterpret_cast<const uint8_t*>(kUpper), len));
+  const uint8_t latin1[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 0xC0};
+  EXPECT(!StringSearch::IsAscii(latin1, ARRAY_SIZE(latin1)));
+  EXPECT(StringSearch::IsAscii(latin1, ARRAY_SIZE(latin1) - 1));
+}
+
+}  // namespace dart
@@ -27,6 +27,7 @@ class SnapshotWriter;
   V(RunExceptionHandler)                                                       \
   V(DeoptForRewind)                                                            \
   V(UpdateStoreBuffer)                                                         \
+  V(ArrayWriteBarrier)                                                         \
   V(PrintStopMessage)                                                          \
   V(CallToRuntime)                                                             \
   V(LazyCompile)                                                               \
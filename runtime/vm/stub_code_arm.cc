@@ -27,6 +27,7 @@ DEFINE_FLAG(bool,
             use_slow_path,
             false,
             "Set to true for debugging & verifying the slow paths.");
+DECLARE_FLAG(bool, pretenuring);
 DECLARE_FLAG(bool, trace_optimized_ic_calls);
 
 // Input parameters:
@@ -999,10 +1000,33 @@ void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
   __ Ret();
 }
 
-// Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   R0: address (i.e. object) being stored into.
-void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+//   R1: address of the slot written (only if cards is true).
+static void GenerateWriteBarrierStubHelper(Assembler* assembler, bool cards) {
+  if (cards) {
+    Label remember_object;
+    __ ldr(IP, FieldAddress(R0, Object::tags_offset()));
+    __ tst(IP, Operand(1 << RawObject::kCardRememberedBit));
+    __ b(&remember_object, EQ);
+
+    // Mark the card of the slot in the card table of the large page.
+    // R0: Address being stored
+    // R1: Address of the slot written
+    __ Push(R2);
+    __ AddImmediate(R2, R0,
+                    -(kHeapObjectTag + HeapPage::ObjectStartOffset()));
+    __ sub(R1, R1, Operand(R2));
+    __ Lsr(R1, R1, Operand(HeapPage::kBytesPerCardLog2));
+    __ ldr(R2, Address(R2, HeapPage::card_table_offset()));
+    __ LoadImmediate(IP, 1);
+    __ strb(IP, Address(R2, R1));
+    __ Pop(R2);
+    __ Ret();
+
+    __ Bind(&remember_object);
+  }
+
   // Save values being destroyed.
   __ PushList((1 << R1) | (1 << R2) | (1 << R3));
 
@@ -1071,6 +1095,21 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ Ret();
 }
 
+// Helper stub to implement Assembler::StoreIntoObject.
+// Input parameters:
+//   R0: address (i.e. object) being stored into.
+void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, false);
+}
+
+// Helper stub to implement Assembler::StoreIntoArray.
+// Input parameters:
+//   R0: address (i.e. object) being stored into.
+//   R1: address of the slot written.
+void StubCode::GenerateArrayWriteBarrierStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, true);
+}
+
 // Called for inline allocation of objects.
 // Input parameters:
 //   LR : return address.
@@ -1097,6 +1136,12 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // Allocate the object and update top to point to
     // next object start and initialize the allocated object.
     NOT_IN_PRODUCT(Heap::Space space = Heap::kNew);
+#ifndef PRODUCT
+    if (FLAG_pretenuring) {
+      // Classes become pretenured after their allocation stub was generated.
+      __ MaybeTraceAllocation(cls.id(), R0, &slow_case);
+    }
+#endif  // !PRODUCT
     __ ldr(R0, Address(THR, Thread::top_offset()));
     __ AddImmediate(R1, R0, instance_size);
     // Check if the allocation fits into the remaining space.
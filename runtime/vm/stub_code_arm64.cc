@@ -26,6 +26,7 @@ DEFINE_FLAG(bool,
             use_slow_path,
             false,
             "Set to true for debugging & verifying the slow paths.");
+DECLARE_FLAG(bool, pretenuring);
 DECLARE_FLAG(bool, trace_optimized_ic_calls);
 
 // Input parameters:
@@ -1050,10 +1051,31 @@ void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
   __ ret();
 }
 
-// Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   R0: Address being stored
-void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+//   R1: Address of the slot written (only if cards is true)
+static void GenerateWriteBarrierStubHelper(Assembler* assembler, bool cards) {
+  if (cards) {
+    Label remember_object;
+    __ LoadFieldFromOffset(TMP, R0, Object::tags_offset(), kWord);
+    __ tsti(TMP, Immediate(1 << RawObject::kCardRememberedBit));
+    __ b(&remember_object, EQ);
+
+    // Mark the card of the slot in the card table of the large page.
+    // R0: Address being stored
+    // R1: Address of the slot written
+    __ AddImmediate(TMP, R0,
+                    -(kHeapObjectTag + HeapPage::ObjectStartOffset()));
+    __ sub(R1, R1, Operand(TMP));
+    __ LsrImmediate(R1, R1, HeapPage::kBytesPerCardLog2);
+    __ LoadFromOffset(TMP, TMP, HeapPage::card_table_offset());
+    __ LoadImmediate(TMP2, 1);
+    __ str(TMP2, Address(TMP, R1), kUnsignedByte);
+    __ ret();
+
+    __ Bind(&remember_object);
+  }
+
   Label add_to_buffer;
   // Check whether this object has already been remembered. Skip adding to the
   // store buffer if the object is in the store buffer already.
@@ -1115,6 +1137,21 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ ret();
 }
 
+// Helper stub to implement Assembler::StoreIntoObject.
+// Input parameters:
+//   R0: Address being stored
+void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, false);
+}
+
+// Helper stub to implement Assembler::StoreIntoArray.
+// Input parameters:
+//   R0: Address being stored
+//   R1: Address of the slot written
+void StubCode::GenerateArrayWriteBarrierStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, true);
+}
+
 // Called for inline allocation of objects.
 // Input parameters:
 //   LR : return address.
@@ -1143,6 +1180,12 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // next object start and initialize the allocated object.
     // R1: instantiated type arguments (if is_cls_parameterized).
     NOT_IN_PRODUCT(Heap::Space space = Heap::kNew);
+#ifndef PRODUCT
+    if (FLAG_pretenuring) {
+      // Classes become pretenured after their allocation stub was generated.
+      __ MaybeTraceAllocation(cls.id(), R2, &slow_case);
+    }
+#endif  // !PRODUCT
     __ ldr(R2, Address(THR, Thread::top_offset()));
     __ AddImmediate(R3, R2, instance_size);
     // Check if the allocation fits into the remaining space.
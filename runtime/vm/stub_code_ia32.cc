@@ -27,6 +27,7 @@ DEFINE_FLAG(bool,
             use_slow_path,
             false,
             "Set to true for debugging & verifying the slow paths.");
+DECLARE_FLAG(bool, pretenuring);
 DECLARE_FLAG(bool, trace_optimized_ic_calls);
 
 #define INT32_SIZEOF(x) static_cast<int32_t>(sizeof(x))
@@ -925,10 +926,34 @@ void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
   __ ret();
 }
 
-// Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   EDX: Address being stored
-void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+//   EAX: Address of the slot written (only if cards is true)
+static void GenerateWriteBarrierStubHelper(Assembler* assembler, bool cards) {
+  if (cards) {
+    Label remember_object;
+    __ pushl(ECX);
+    __ movl(ECX, FieldAddress(EDX, Object::tags_offset()));
+    __ testl(ECX, Immediate(1 << RawObject::kCardRememberedBit));
+    __ j(EQUAL, &remember_object, Assembler::kNearJump);
+
+    // Mark the card of the slot in the card table of the large page.
+    // Spilled: ECX
+    // EDX: Address being stored
+    // EAX: Address of the slot written
+    __ leal(ECX, Address(EDX, -(kHeapObjectTag +
+                                HeapPage::ObjectStartOffset())));
+    __ subl(EAX, ECX);
+    __ shrl(EAX, Immediate(HeapPage::kBytesPerCardLog2));
+    __ movl(ECX, Address(ECX, HeapPage::card_table_offset()));
+    __ movb(Address(ECX, EAX, TIMES_1, 0), Immediate(1));
+    __ popl(ECX);
+    __ ret();
+
+    __ Bind(&remember_object);
+    __ popl(ECX);
+  }
+
   // Save values being destroyed.
   __ pushl(EAX);
   __ pushl(ECX);
@@ -992,6 +1017,21 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ ret();
 }
 
+// Helper stub to implement Assembler::StoreIntoObject.
+// Input parameters:
+//   EDX: Address being stored
+void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, false);
+}
+
+// Helper stub to implement Assembler::StoreIntoArray.
+// Input parameters:
+//   EDX: Address being stored
+//   EAX: Address of the slot written
+void StubCode::GenerateArrayWriteBarrierStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, true);
+}
+
 // Called for inline allocation of objects.
 // Input parameters:
 //   ESP + 4 : type arguments object (only if class is parameterized).
@@ -1026,6 +1066,13 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // next object start and initialize the allocated object.
     // EDX: instantiated type arguments (if is_cls_parameterized).
     NOT_IN_PRODUCT(Heap::Space space = Heap::kNew);
+#ifndef PRODUCT
+    if (FLAG_pretenuring) {
+      // Classes become pretenured after their allocation stub was generated.
+      __ MaybeTraceAllocation(cls.id(), EAX, &slow_case,
+                              Assembler::kFarJump);
+    }
+#endif  // !PRODUCT
     __ movl(EAX, Address(THR, Thread::top_offset()));
     __ leal(EBX, Address(EAX, instance_size));
     // Check if the allocation fits into the remaining space.
@@ -27,6 +27,7 @@ DEFINE_FLAG(bool,
             use_slow_path,
             false,
             "Set to true for debugging & verifying the slow paths.");
+DECLARE_FLAG(bool, pretenuring);
 DECLARE_FLAG(bool, trace_optimized_ic_calls);
 
 // Input parameters:
@@ -988,10 +989,34 @@ void StubCode::GenerateAllocateContextStub(Assembler* assembler) {
   __ ret();
 }
 
-// Helper stub to implement Assembler::StoreIntoObject.
 // Input parameters:
 //   RDX: Address being stored
-void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+//   RAX: Address of the slot written (only if cards is true)
+static void GenerateWriteBarrierStubHelper(Assembler* assembler, bool cards) {
+  if (cards) {
+    Label remember_object;
+    __ pushq(RCX);
+    __ movl(RCX, FieldAddress(RDX, Object::tags_offset()));
+    __ testl(RCX, Immediate(1 << RawObject::kCardRememberedBit));
+    __ j(EQUAL, &remember_object, Assembler::kNearJump);
+
+    // Mark the card of the slot in the card table of the large page.
+    // Spilled: RCX
+    // RDX: Address being stored
+    // RAX: Address of the slot written
+    __ leaq(RCX, Address(RDX, -(kHeapObjectTag +
+                                HeapPage::ObjectStartOffset())));
+    __ subq(RAX, RCX);
+    __ shrq(RAX, Immediate(HeapPage::kBytesPerCardLog2));
+    __ movq(RCX, Address(RCX, HeapPage::card_table_offset()));
+    __ movb(Address(RCX, RAX, TIMES_1, 0), Immediate(1));
+    __ popq(RCX);
+    __ ret();
+
+    __ Bind(&remember_object);
+    __ popq(RCX);
+  }
+
   // Save registers being destroyed.
   __ pushq(RAX);
   __ pushq(RCX);
@@ -1052,6 +1077,21 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
   __ ret();
 }
 
+// Helper stub to implement Assembler::StoreIntoObject.
+// Input parameters:
+//   RDX: Address being stored
+void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, false);
+}
+
+// Helper stub to implement Assembler::StoreIntoArray.
+// Input parameters:
+//   RDX: Address being stored
+//   RAX: Address of the slot written
+void StubCode::GenerateArrayWriteBarrierStub(Assembler* assembler) {
+  GenerateWriteBarrierStubHelper(assembler, true);
+}
+
 // Called for inline allocation of objects.
 // Input parameters:
 //   RSP + 8 : type arguments object (only if class is parameterized).
@@ -1082,6 +1122,12 @@ void StubCode::GenerateAllocationStubForClass(Assembler* assembler,
     // next object start and initialize the allocated object.
     // RDX: instantiated type arguments (if is_cls_parameterized).
     NOT_IN_PRODUCT(Heap::Space space = Heap::kNew);
+#ifndef PRODUCT
+    if (FLAG_pretenuring) {
+      // Classes become pretenured after their allocation stub was generated.
+      __ MaybeTraceAllocation(cls.id(), &slow_case, Assembler::kFarJump);
+    }
+#endif  // !PRODUCT
     __ movq(RAX, Address(THR, Thread::top_offset()));
     __ leaq(RBX, Address(RAX, instance_size));
     // Check if the allocation fits into the remaining space.
@@ -4,6 +4,7 @@
 
 #include "vm/symbols.h"
 
+#include "vm/atomic.h"
 #include "vm/handles.h"
 #include "vm/hash_table.h"
 #include "vm/isolate.h"
@@ -179,13 +180,22 @@ class SymbolTraits {
   static uword Hash(const ConcatString& concat) { return concat.Hash(); }
   template <typename CharType>
   static RawObject* NewKey(const CharArray<CharType>& array) {
-    return array.ToSymbol();
+    return Publish(array.ToSymbol());
   }
   static RawObject* NewKey(const StringSlice& slice) {
-    return slice.ToSymbol();
+    return Publish(slice.ToSymbol());
   }
   static RawObject* NewKey(const ConcatString& concat) {
-    return concat.ToSymbol();
+    return Publish(concat.ToSymbol());
+  }
+
+ private:
+  // The table is read without holding the symbols mutex (see
+  // Symbols::NewSymbol), so a new symbol must be completely initialized
+  // before it is stored in the table.
+  static RawObject* Publish(RawString* symbol) {
+    AtomicOperations::ReleaseFence();
+    return symbol;
   }
 };
 typedef UnorderedHashSet<SymbolTraits> SymbolTable;
@@ -392,6 +402,27 @@ void Symbols::Compact(Isolate* isolate) {
   isolate->object_store()->set_symbol_table(table.Release());
 }
 
+void Symbols::RehashSymbolTable(Isolate* isolate) {
+  Zone* zone = Thread::Current()->zone();
+  Array& symbols = Array::Handle(zone);
+  {
+    SymbolTable table(zone, isolate->object_store()->symbol_table());
+    symbols = HashTables::ToArray(table, false);
+    table.Release();
+  }
+  Array& array = Array::Handle(
+      zone, HashTables::New<SymbolTable>(symbols.Length() * 4 / 3, Heap::kOld));
+  SymbolTable table(zone, array.raw());
+  String& symbol = String::Handle(zone);
+  for (intptr_t i = 0; i < symbols.Length(); i++) {
+    symbol ^= symbols.At(i);
+    ASSERT(symbol.IsCanonical());
+    bool present = table.Insert(symbol);
+    ASSERT(!present);
+  }
+  isolate->object_store()->set_symbol_table(table.Release());
+}
+
 void Symbols::GetStats(Isolate* isolate, intptr_t* size, intptr_t* capacity) {
   ASSERT(isolate != NULL);
   SymbolTable table(isolate->object_store()->symbol_table());
@@ -544,6 +575,13 @@ RawString* Symbols::FromConcatAll(
   }
 }
 
+// The symbol tables are read without locking. Symbols are never removed from
+// the table while other threads use the isolate, and a thread reading the
+// table cannot reach a safepoint, so the array it reads stays alive and
+// consistent: an insertion only fills an unused entry, and growth copies the
+// table to a new array before replacing the old one. A reader that misses a
+// symbol being inserted concurrently retries under the symbols mutex.
+//
 // StringType can be StringSlice, ConcatString, or {Latin1,UTF16,UTF32}Array.
 template <typename StringType>
 RawString* Symbols::NewSymbol(Thread* thread, const StringType& str) {
@@ -561,12 +599,21 @@ RawString* Symbols::NewSymbol(Thread* thread, const StringType& str) {
     symbol ^= table.GetOrNull(str);
     table.Release();
   }
+  if (symbol.IsNull()) {
+    Isolate* isolate = thread->isolate();
+    data ^= isolate->object_store()->symbol_table();
+    SymbolTable table(&key, &value, &data);
+    symbol ^= table.GetOrNull(str);
+    table.Release();
+  }
   if (symbol.IsNull()) {
     Isolate* isolate = thread->isolate();
     SafepointMutexLocker ml(isolate->symbols_mutex());
     data ^= isolate->object_store()->symbol_table();
     SymbolTable table(&key, &value, &data);
     symbol ^= table.InsertNewOrGet(str);
+    // The entries of a grown table must be visible before the table is.
+    AtomicOperations::ReleaseFence();
     isolate->object_store()->set_symbol_table(table.Release());
   }
   ASSERT(symbol.IsSymbol());
@@ -592,7 +639,6 @@ RawString* Symbols::Lookup(Thread* thread, const StringType& str) {
   }
   if (symbol.IsNull()) {
     Isolate* isolate = thread->isolate();
-    SafepointMutexLocker ml(isolate->symbols_mutex());
     data ^= isolate->object_store()->symbol_table();
     SymbolTable table(&key, &value, &data);
     symbol ^= table.GetOrNull(str);
@@ -591,6 +591,9 @@ class Symbols : public AllStatic {
   // Treat the symbol table as weak and collect garbage.
   static void Compact(Isolate* isolate);
 
+  // Rebuilds the symbol table from the current hashes of its symbols.
+  static void RehashSymbolTable(Isolate* isolate);
+
   // Creates a Symbol given a C string that is assumed to contain
   // UTF-8 encoded characters and '\0' is considered a termination character.
   // TODO(7123) - Rename this to FromCString(....).
@@ -7,6 +7,7 @@
 #include "vm/compiler_stats.h"
 #include "vm/dart_api_state.h"
 #include "vm/growable_array.h"
+#include "vm/heap.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
 #include "vm/lockers.h"
@@ -91,6 +92,8 @@ Thread::Thread(Isolate* isolate)
       deferred_interrupts_mask_(0),
       deferred_interrupts_(0),
       stack_overflow_count_(0),
+      old_space_top_(0),
+      old_space_end_(0),
       cha_(NULL),
       deopt_id_(0),
       pending_functions_(GrowableObjectArray::null()),
@@ -99,6 +102,9 @@ Thread::Thread(Isolate* isolate)
       resume_pc_(0),
       sticky_error_(Error::null()),
       compiler_stats_(NULL),
+#if !defined(PRODUCT)
+      profiler_block_(-1),
+#endif
       REUSABLE_HANDLE_LIST(REUSABLE_HANDLE_INITIALIZERS)
           REUSABLE_HANDLE_LIST(REUSABLE_HANDLE_SCOPE_INIT) safepoint_state_(0),
       execution_state_(kThreadInNative),
@@ -327,6 +333,7 @@ void Thread::ExitIsolate() {
   // Clear since GC will not visit the thread once it is unscheduled.
   thread->ClearReusableHandles();
   thread->StoreBufferRelease();
+  isolate->heap()->old_space()->AbandonThreadBuffer(thread);
   if (isolate->is_runnable()) {
     thread->set_vm_tag(VMTag::kIdleTagId);
   } else {
@@ -368,6 +375,7 @@ void Thread::ExitIsolateAsHelper(bool bypass_safepoint) {
   thread->StoreBufferRelease();
   Isolate* isolate = thread->isolate();
   ASSERT(isolate != NULL);
+  isolate->heap()->old_space()->AbandonThreadBuffer(thread);
   const bool kIsNotMutatorThread = false;
   isolate->UnscheduleThread(thread, kIsNotMutatorThread, bypass_safepoint);
 }
@@ -381,6 +389,9 @@ void Thread::PrepareForGC() {
   // at GC time.
   // TODO(koda): Replace with an epilogue (PrepareAfterGC) that acquires.
   store_buffer_block_ = isolate()->store_buffer()->PopEmptyBlock();
+  // Objects are neither marked nor swept in the allocation buffer, and the
+  // free lists are rebuilt by mark-sweep.
+  heap()->old_space()->AbandonThreadBuffer(this);
 }
 
 void Thread::SetStackLimitFromStackBase(uword stack_base) {
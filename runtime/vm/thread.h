@@ -80,6 +80,8 @@ class Zone;
 #define CACHED_VM_STUBS_LIST(V)                                                \
   V(RawCode*, update_store_buffer_code_,                                       \
     StubCode::UpdateStoreBuffer_entry()->code(), NULL)                         \
+  V(RawCode*, array_write_barrier_code_,                                       \
+    StubCode::ArrayWriteBarrier_entry()->code(), NULL)                         \
   V(RawCode*, fix_callers_target_code_,                                        \
     StubCode::FixCallersTarget_entry()->code(), NULL)                          \
   V(RawCode*, fix_allocation_stub_code_,                                       \
@@ -112,6 +114,8 @@ class Zone;
 #define CACHED_VM_STUBS_ADDRESSES_LIST(V)                                      \
   V(uword, update_store_buffer_entry_point_,                                   \
     StubCode::UpdateStoreBuffer_entry()->EntryPoint(), 0)                      \
+  V(uword, array_write_barrier_entry_point_,                                   \
+    StubCode::ArrayWriteBarrier_entry()->EntryPoint(), 0)                      \
   V(uword, call_to_runtime_entry_point_,                                       \
     StubCode::CallToRuntime_entry()->EntryPoint(), 0)                          \
   V(uword, megamorphic_call_checked_entry_,                                    \
@@ -235,6 +239,13 @@ class Thread : public BaseThread {
 
   TaskKind task_kind() const { return task_kind_; }
 
+#if !defined(PRODUCT)
+  // The block of the continuous profiler's sample buffer this thread is
+  // filling, or -1. See SampleBlockBuffer.
+  intptr_t profiler_block() const { return profiler_block_; }
+  void set_profiler_block(intptr_t block) { profiler_block_ = block; }
+#endif  // !defined(PRODUCT)
+
   // Retrieves and clears the stack overflow flags.  These are set by
   // the generated code before the slow path runtime routine for a
   // stack overflow is called.
@@ -380,6 +391,13 @@ class Thread : public BaseThread {
   static intptr_t top_offset() { return OFFSET_OF(Thread, top_); }
   static intptr_t end_offset() { return OFFSET_OF(Thread, end_); }
 
+  // Bounds of the thread's old-space allocation buffer, see
+  // PageSpace::TryAllocateInThreadBuffer.
+  uword old_space_top() const { return old_space_top_; }
+  uword old_space_end() const { return old_space_end_; }
+  void set_old_space_top(uword value) { old_space_top_ = value; }
+  void set_old_space_end(uword value) { old_space_end_ = value; }
+
   int32_t no_handle_scope_depth() const {
 #if defined(DEBUG)
     return no_handle_scope_depth_;
@@ -753,6 +771,8 @@ class Thread : public BaseThread {
   uint16_t deferred_interrupts_mask_;
   uint16_t deferred_interrupts_;
   int32_t stack_overflow_count_;
+  uword old_space_top_;
+  uword old_space_end_;
 
   // Compiler state:
   CHA* cha_;
@@ -768,6 +788,10 @@ class Thread : public BaseThread {
 
   CompilerStats* compiler_stats_;
 
+#if !defined(PRODUCT)
+  intptr_t profiler_block_;
+#endif  // !defined(PRODUCT)
+
 // Reusable handles support.
 #define REUSABLE_HANDLE_FIELDS(object) object* object##_handle_;
   REUSABLE_HANDLE_LIST(REUSABLE_HANDLE_FIELDS)
@@ -7,6 +7,7 @@
 #include "vm/flags.h"
 #include "vm/lockers.h"
 #include "vm/os.h"
+#include "vm/profiler.h"
 #include "vm/simulator.h"
 
 namespace dart {
@@ -198,6 +199,9 @@ void ThreadInterrupter::ThreadMain(uword parameters) {
         }
       }
 
+      // Changes the interrupt period, which the signal handlers cannot do.
+      Profiler::MaybeAdaptSamplePeriod();
+
       // Take the monitor lock again.
       wait_ml.Enter();
 
@@ -213,6 +217,8 @@ void ThreadInterrupter::ThreadMain(uword parameters) {
 
       woken_up_ = false;
 
+      // Pick up changes to the period.
+      current_wait_time_ = interrupt_period_;
       ASSERT(current_wait_time_ != Monitor::kNoTimeout);
     }
   }
@@ -4,6 +4,7 @@
 
 #include "vm/thread_pool.h"
 
+#include "vm/atomic.h"
 #include "vm/dart.h"
 #include "vm/flags.h"
 #include "vm/lockers.h"
@@ -14,8 +15,21 @@ DEFINE_FLAG(int,
             worker_timeout_millis,
             5000,
             "Free workers when they have been idle for this amount of time.");
+DEFINE_FLAG(int,
+            thread_pool_workers,
+            0,
+            "Number of fixed workers that share the short tasks of the VM "
+            "thread pool by work stealing, or -1 for one per processor. With "
+            "0 every task runs on a thread of its own.");
+
+// A fixed worker looks at the shared queue before its own deque once in this
+// many tasks, so that tasks posted from outside of the fixed workers are not
+// starved by the tasks the workers keep posting to themselves.
+static const intptr_t kSharedQueueInterval = 61;
+
+ThreadLocalKey ThreadPool::worker_key_ = kUnsetThreadLocalKey;
 
-ThreadPool::ThreadPool()
+ThreadPool::ThreadPool(intptr_t num_fixed_workers)
     : shutting_down_(false),
       all_workers_(NULL),
       idle_workers_(NULL),
@@ -24,13 +38,58 @@ ThreadPool::ThreadPool()
       count_running_(0),
       count_idle_(0),
       shutting_down_workers_(NULL),
-      join_list_(NULL) {}
+      join_list_(NULL),
+      num_fixed_workers_(num_fixed_workers),
+      deques_(NULL),
+      fixed_shutting_down_(false),
+      injected_head_(NULL),
+      injected_tail_(NULL),
+      injected_count_(0),
+      fixed_running_(0),
+      spares_running_(0),
+      blocked_workers_(0),
+      sleeping_workers_(0),
+      tasks_stolen_(0),
+      fixed_join_list_(NULL) {
+  ASSERT(num_fixed_workers_ >= 0);
+  if (num_fixed_workers_ == 0) {
+    return;
+  }
+  ASSERT(worker_key_ != kUnsetThreadLocalKey);
+  deques_ = new TaskDeque*[num_fixed_workers_];
+  for (intptr_t i = 0; i < num_fixed_workers_; i++) {
+    deques_[i] = new TaskDeque();
+  }
+  fixed_running_ = num_fixed_workers_;
+  for (intptr_t i = 0; i < num_fixed_workers_; i++) {
+    FixedWorker* worker = new FixedWorker(this, deques_[i]);
+    worker->StartThread();
+  }
+}
 
 ThreadPool::~ThreadPool() {
+  ShutdownFixedWorkers();
   Shutdown();
+  if (deques_ != NULL) {
+    for (intptr_t i = 0; i < num_fixed_workers_; i++) {
+      delete deques_[i];
+    }
+    delete[] deques_;
+  }
+}
+
+void ThreadPool::InitOnce() {
+  // The key outlives the pools, so it is kept when the VM is restarted.
+  if (worker_key_ == kUnsetThreadLocalKey) {
+    worker_key_ = OSThread::CreateThreadLocal();
+    ASSERT(worker_key_ != kUnsetThreadLocalKey);
+  }
 }
 
 bool ThreadPool::Run(Task* task) {
+  if ((num_fixed_workers_ > 0) && !task->IsBlocking()) {
+    return RunOnFixedWorker(task);
+  }
   Worker* worker = NULL;
   bool new_worker = false;
   {
@@ -308,10 +367,378 @@ void ThreadPool::JoinList::Join(JoinList** list) {
   }
 }
 
-ThreadPool::Task::Task() {}
+ThreadPool::Task::Task() : next_(NULL) {}
 
 ThreadPool::Task::~Task() {}
 
+intptr_t ThreadPool::fixed_workers() const {
+  return AtomicOperations::LoadRelaxed(&fixed_running_) +
+         AtomicOperations::LoadRelaxed(&spares_running_);
+}
+
+intptr_t ThreadPool::queue_depth() const {
+  intptr_t depth = AtomicOperations::LoadRelaxed(&injected_count_);
+  for (intptr_t i = 0; i < num_fixed_workers_; i++) {
+    depth += deques_[i]->Size();
+  }
+  return depth;
+}
+
+int64_t ThreadPool::tasks_stolen() const {
+  return AtomicOperations::LoadRelaxed(&tasks_stolen_);
+}
+
+ThreadPool::FixedWorker* ThreadPool::CurrentFixedWorker() {
+  if (worker_key_ == kUnsetThreadLocalKey) {
+    return NULL;
+  }
+  return reinterpret_cast<FixedWorker*>(OSThread::GetThreadLocal(worker_key_));
+}
+
+bool ThreadPool::RunOnFixedWorker(Task* task) {
+  // A fixed worker keeps the tasks it posts for itself, where the other
+  // workers can steal them. Everything else goes through the shared queue.
+  FixedWorker* worker = CurrentFixedWorker();
+  if ((worker != NULL) && (worker->pool_ == this) &&
+      (worker->deque_ != NULL) &&
+      !AtomicOperations::LoadRelaxed(&fixed_shutting_down_) &&
+      worker->deque_->Push(task)) {
+    if (AtomicOperations::LoadRelaxed(&sleeping_workers_) > 0) {
+      MonitorLocker ml(&fixed_monitor_);
+      ml.Notify();
+    }
+    return true;
+  }
+  MonitorLocker ml(&fixed_monitor_);
+  if (fixed_shutting_down_) {
+    return false;
+  }
+  InjectLocked(task);
+  if (sleeping_workers_ > 0) {
+    ml.Notify();
+  }
+  return true;
+}
+
+void ThreadPool::InjectLocked(Task* task) {
+  ASSERT(fixed_monitor_.IsOwnedByCurrentThread());
+  task->next_ = NULL;
+  if (injected_tail_ == NULL) {
+    injected_head_ = task;
+  } else {
+    injected_tail_->next_ = task;
+  }
+  injected_tail_ = task;
+  injected_count_++;
+}
+
+ThreadPool::Task* ThreadPool::TakeInjectedLocked() {
+  ASSERT(fixed_monitor_.IsOwnedByCurrentThread());
+  Task* task = injected_head_;
+  if (task != NULL) {
+    injected_head_ = task->next_;
+    if (injected_head_ == NULL) {
+      injected_tail_ = NULL;
+    }
+    task->next_ = NULL;
+    injected_count_--;
+  }
+  return task;
+}
+
+ThreadPool::Task* ThreadPool::FindTask(FixedWorker* worker,
+                                       bool monitor_held) {
+  TaskDeque* deque = worker->deque_;
+  Task* task = NULL;
+  const bool shared_first = (++worker->ticks_ % kSharedQueueInterval) == 0;
+  if ((deque != NULL) && !shared_first) {
+    task = deque->Pop();
+    if (task != NULL) {
+      return task;
+    }
+  }
+  if (monitor_held) {
+    task = TakeInjectedLocked();
+  } else if (AtomicOperations::LoadRelaxed(&injected_count_) > 0) {
+    MonitorLocker ml(&fixed_monitor_);
+    task = TakeInjectedLocked();
+  }
+  if (task != NULL) {
+    return task;
+  }
+  if ((deque != NULL) && shared_first) {
+    task = deque->Pop();
+    if (task != NULL) {
+      return task;
+    }
+  }
+  // Steal from the other workers, starting at a random one so that thieves
+  // spread out over the victims.
+  const intptr_t start = worker->NextRandom(num_fixed_workers_);
+  for (intptr_t i = 0; i < num_fixed_workers_; i++) {
+    TaskDeque* victim = deques_[(start + i) % num_fixed_workers_];
+    if (victim == deque) {
+      continue;
+    }
+    task = victim->Steal();
+    if (task != NULL) {
+      AtomicOperations::IncrementInt64By(&tasks_stolen_, 1);
+      return task;
+    }
+  }
+  return NULL;
+}
+
+ThreadPool::Task* ThreadPool::NextTask(FixedWorker* worker) {
+  if (!AtomicOperations::LoadRelaxed(&fixed_shutting_down_)) {
+    Task* task = FindTask(worker, false);
+    if (task != NULL) {
+      return task;
+    }
+  }
+
+  // Announce that we are about to sleep before looking for tasks again, so
+  // that a task posted concurrently either is found below or sees the
+  // sleeper and notifies it.
+  MonitorLocker ml(&fixed_monitor_);
+  AtomicOperations::FetchAndIncrement(&sleeping_workers_);
+  Task* task = NULL;
+  while (true) {
+    if (RetireLocked(worker)) {
+      // Shutdown waits for the last worker to leave.
+      ml.NotifyAll();
+      break;
+    }
+    task = FindTask(worker, true);
+    if (task != NULL) {
+      break;
+    }
+    ml.Wait();
+  }
+  AtomicOperations::FetchAndDecrement(&sleeping_workers_);
+  return task;
+}
+
+bool ThreadPool::RetireLocked(FixedWorker* worker) {
+  ASSERT(fixed_monitor_.IsOwnedByCurrentThread());
+  if (worker->deque_ == NULL) {
+    // Spares leave once the workers they stand in for are back.
+    if (!fixed_shutting_down_ && (spares_running_ <= blocked_workers_)) {
+      return false;
+    }
+    spares_running_--;
+  } else {
+    if (!fixed_shutting_down_) {
+      return false;
+    }
+    fixed_running_--;
+  }
+  // The thread is joined at shutdown, or when the next spare is started.
+  OSThread* os_thread = OSThread::Current();
+  ASSERT(os_thread != NULL);
+  JoinList::AddLocked(OSThread::GetCurrentThreadJoinId(os_thread),
+                      &fixed_join_list_);
+  return true;
+}
+
+void ThreadPool::EnterBlocking() {
+  JoinList* list = NULL;
+  {
+    MonitorLocker ml(&fixed_monitor_);
+    blocked_workers_++;
+    if (fixed_shutting_down_ || (spares_running_ >= blocked_workers_)) {
+      return;
+    }
+    spares_running_++;
+    list = fixed_join_list_;
+    fixed_join_list_ = NULL;
+  }
+  JoinList::Join(&list);
+  FixedWorker* spare = new FixedWorker(this, NULL);
+  spare->StartThread();
+}
+
+void ThreadPool::ExitBlocking() {
+  MonitorLocker ml(&fixed_monitor_);
+  blocked_workers_--;
+  if (spares_running_ > blocked_workers_) {
+    // Wake up an idle spare so that it can leave.
+    ml.NotifyAll();
+  }
+}
+
+void ThreadPool::ShutdownFixedWorkers() {
+  if (num_fixed_workers_ == 0) {
+    return;
+  }
+  ASSERT((CurrentFixedWorker() == NULL) ||
+         (CurrentFixedWorker()->pool_ != this));
+  JoinList* list = NULL;
+  {
+    MonitorLocker ml(&fixed_monitor_);
+    fixed_shutting_down_ = true;
+    ml.NotifyAll();
+    while ((fixed_running_ + spares_running_) > 0) {
+      ml.Wait();
+    }
+    list = fixed_join_list_;
+    fixed_join_list_ = NULL;
+  }
+  JoinList::Join(&list);
+
+  // Drop the tasks that were posted but never ran.
+  for (intptr_t i = 0; i < num_fixed_workers_; i++) {
+    Task* task = deques_[i]->Steal();
+    while (task != NULL) {
+      delete task;
+      task = deques_[i]->Steal();
+    }
+  }
+  MonitorLocker ml(&fixed_monitor_);
+  Task* task = TakeInjectedLocked();
+  while (task != NULL) {
+    delete task;
+    task = TakeInjectedLocked();
+  }
+}
+
+ThreadPool::BlockingScope::BlockingScope() : pool_(NULL) {
+  FixedWorker* worker = CurrentFixedWorker();
+  if (worker != NULL) {
+    pool_ = worker->pool_;
+    pool_->EnterBlocking();
+  }
+}
+
+ThreadPool::BlockingScope::~BlockingScope() {
+  if (pool_ != NULL) {
+    pool_->ExitBlocking();
+  }
+}
+
+ThreadPool::TaskDeque::TaskDeque() : ends_(0) {
+  for (intptr_t i = 0; i < kCapacity; i++) {
+    tasks_[i] = NULL;
+  }
+}
+
+bool ThreadPool::TaskDeque::Push(Task* task) {
+  uword ends = AtomicOperations::LoadAcquire(&ends_);
+  if (Count(ends) >= kCapacity) {
+    return false;
+  }
+  // Thieves only move the top, so the slot below the bottom stays ours until
+  // the new bottom is published by the compare-and-swap.
+  const uword bottom = Bottom(ends);
+  tasks_[bottom % kCapacity] = task;
+  while (true) {
+    const uword old_ends = AtomicOperations::CompareAndSwapWord(
+        &ends_, ends, Ends(Top(ends), bottom + 1));
+    if (old_ends == ends) {
+      return true;
+    }
+    ends = old_ends;
+  }
+}
+
+ThreadPool::Task* ThreadPool::TaskDeque::Pop() {
+  uword ends = AtomicOperations::LoadAcquire(&ends_);
+  while (Count(ends) > 0) {
+    const uword top = Top(ends);
+    const uword bottom = Bottom(ends);
+    // The last task is taken from the top, like a thief would, so that the
+    // ends never go back to a value a thief may still be holding.
+    const bool last = Count(ends) == 1;
+    const uword index = last ? top : bottom - 1;
+    const uword new_ends = last ? Ends(top + 1, bottom) : Ends(top, bottom - 1);
+    const uword old_ends =
+        AtomicOperations::CompareAndSwapWord(&ends_, ends, new_ends);
+    if (old_ends == ends) {
+      return tasks_[index % kCapacity];
+    }
+    ends = old_ends;
+  }
+  return NULL;
+}
+
+ThreadPool::Task* ThreadPool::TaskDeque::Steal() {
+  uword ends = AtomicOperations::LoadAcquire(&ends_);
+  while (Count(ends) > 0) {
+    const uword top = Top(ends);
+    // Read the task before claiming it: once the top moves, the owner may
+    // reuse the slot.
+    Task* task = tasks_[top % kCapacity];
+    const uword old_ends = AtomicOperations::CompareAndSwapWord(
+        &ends_, ends, Ends(top + 1, Bottom(ends)));
+    if (old_ends == ends) {
+      return task;
+    }
+    ends = old_ends;
+  }
+  return NULL;
+}
+
+intptr_t ThreadPool::TaskDeque::Size() const {
+  return Count(AtomicOperations::LoadRelaxed(&ends_));
+}
+
+ThreadPool::FixedWorker::FixedWorker(ThreadPool* pool, TaskDeque* deque)
+    : pool_(pool),
+      deque_(deque),
+      random_state_(static_cast<uint32_t>(reinterpret_cast<uword>(this) >> 4) |
+                    1),
+      ticks_(0) {}
+
+void ThreadPool::FixedWorker::StartThread() {
+  int result = OSThread::Start("Dart ThreadPool Worker", &FixedWorker::Main,
+                               reinterpret_cast<uword>(this));
+  if (result != 0) {
+    FATAL1("Could not start worker thread: result = %d.", result);
+  }
+}
+
+intptr_t ThreadPool::FixedWorker::NextRandom(intptr_t limit) {
+  // Xorshift.
+  uint32_t x = random_state_;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  random_state_ = x;
+  return static_cast<intptr_t>(x % static_cast<uint32_t>(limit));
+}
+
+// static
+void ThreadPool::FixedWorker::Main(uword args) {
+  FixedWorker* worker = reinterpret_cast<FixedWorker*>(args);
+  ThreadPool* pool = worker->pool_;
+  OSThread* os_thread = OSThread::Current();
+  ASSERT(os_thread != NULL);
+
+  // Set the thread's stack_base based on the current stack pointer.
+  uword current_sp = Thread::GetCurrentStackPointer();
+  if (current_sp > os_thread->stack_base()) {
+    os_thread->set_stack_base(current_sp);
+  }
+
+  OSThread::SetThreadLocal(worker_key_, reinterpret_cast<uword>(worker));
+  Task* task = pool->NextTask(worker);
+  while (task != NULL) {
+    task->Run();
+    ASSERT(Isolate::Current() == NULL);
+    delete task;
+    task = pool->NextTask(worker);
+  }
+  // The pool may be gone by now.
+  OSThread::SetThreadLocal(worker_key_, 0);
+  delete worker;
+
+  // Call the thread exit hook here to notify the embedder that the
+  // thread pool thread is exiting.
+  if (Dart::thread_exit_callback() != NULL) {
+    (*Dart::thread_exit_callback())();
+  }
+}
+
 ThreadPool::Worker::Worker(ThreadPool* pool)
     : pool_(pool),
       task_(NULL),
@@ -24,16 +24,47 @@ class ThreadPool {
     // Override this to provide task-specific behavior.
     virtual void Run() = 0;
 
+    // Whether the task may wait for other tasks or for events outside of
+    // the VM for a long time. Blocking tasks always get a thread of their
+    // own. Short tasks should override this to return false so that they
+    // can share the fixed workers of the pool.
+    virtual bool IsBlocking() const { return true; }
+
    private:
+    friend class ThreadPool;
+
+    // Link in the shared queue of the fixed workers.
+    Task* next_;
+
     DISALLOW_COPY_AND_ASSIGN(Task);
   };
 
-  ThreadPool();
+  // Marks a region in which the current thread may block for a long time,
+  // e.g. while an isolate is paused in the debugger. If the current thread
+  // is one of the fixed workers of a pool, a spare worker takes its place
+  // until the region is left. Elsewhere this does nothing.
+  class BlockingScope : public ValueObject {
+   public:
+    BlockingScope();
+    ~BlockingScope();
+
+   private:
+    ThreadPool* pool_;
+
+    DISALLOW_COPY_AND_ASSIGN(BlockingScope);
+  };
+
+  // Runs the tasks that are not blocking on 'num_fixed_workers' threads that
+  // steal work from each other, and every blocking task on a thread of its
+  // own. Without fixed workers every task gets a thread of its own.
+  explicit ThreadPool(intptr_t num_fixed_workers = 0);
 
   // Shuts down this thread pool. Causes workers to terminate
   // themselves when they are active again.
   ~ThreadPool();
 
+  static void InitOnce();
+
   // Runs a task on the thread pool.
   bool Run(Task* task);
 
@@ -43,7 +74,75 @@ class ThreadPool {
   uint64_t workers_started() const { return count_started_; }
   uint64_t workers_stopped() const { return count_stopped_; }
 
+  // Stats of the fixed workers. The number of fixed workers includes the
+  // spares that stand in for blocked workers.
+  intptr_t fixed_workers() const;
+  intptr_t queue_depth() const;
+  int64_t tasks_stolen() const;
+
  private:
+  // A bounded deque of tasks owned by one fixed worker. The owner pushes
+  // and pops at the bottom, other workers steal from the top. Both ends are
+  // kept in a single word that is only changed by compare-and-swap, so each
+  // operation takes effect in one atomic step.
+  class TaskDeque {
+   public:
+    static const intptr_t kCapacity = 256;
+
+    TaskDeque();
+
+    // Only called by the owner. Returns false if the deque is full.
+    bool Push(Task* task);
+    // Only called by the owner.
+    Task* Pop();
+    // May be called by any thread.
+    Task* Steal();
+
+    intptr_t Size() const;
+
+   private:
+    static const intptr_t kIndexBits = kBitsPerWord / 2;
+    static const uword kIndexMask = (static_cast<uword>(1) << kIndexBits) - 1;
+
+    static uword Top(uword ends) { return ends & kIndexMask; }
+    static uword Bottom(uword ends) { return ends >> kIndexBits; }
+    static uword Ends(uword top, uword bottom) {
+      return (top & kIndexMask) | ((bottom & kIndexMask) << kIndexBits);
+    }
+    static intptr_t Count(uword ends) {
+      return (Bottom(ends) - Top(ends)) & kIndexMask;
+    }
+
+    uword ends_;
+    Task* tasks_[kCapacity];
+
+    DISALLOW_COPY_AND_ASSIGN(TaskDeque);
+  };
+
+  class FixedWorker {
+   public:
+    // Spares have no deque.
+    FixedWorker(ThreadPool* pool, TaskDeque* deque);
+
+    void StartThread();
+
+   private:
+    friend class ThreadPool;
+
+    // The main entry point for fixed worker threads.
+    static void Main(uword args);
+
+    // Returns a number in [0, limit) for picking victims to steal from.
+    intptr_t NextRandom(intptr_t limit);
+
+    ThreadPool* pool_;
+    TaskDeque* deque_;
+    uint32_t random_state_;
+    intptr_t ticks_;
+
+    DISALLOW_COPY_AND_ASSIGN(FixedWorker);
+  };
+
   class Worker {
    public:
     explicit Worker(ThreadPool* pool);
@@ -123,6 +222,18 @@ class ThreadPool {
 
   void ReapExitedIdleThreads();
 
+  // Operations of the fixed workers.
+  static FixedWorker* CurrentFixedWorker();
+  bool RunOnFixedWorker(Task* task);
+  void InjectLocked(Task* task);
+  Task* TakeInjectedLocked();
+  Task* FindTask(FixedWorker* worker, bool monitor_held);
+  Task* NextTask(FixedWorker* worker);
+  bool RetireLocked(FixedWorker* worker);
+  void EnterBlocking();
+  void ExitBlocking();
+  void ShutdownFixedWorkers();
+
   // Worker operations.
   void SetIdleLocked(Worker* worker);  // Assumes mutex_ is held.
   void SetIdleAndReapExited(Worker* worker);
@@ -141,6 +252,24 @@ class ThreadPool {
   Worker* shutting_down_workers_;
   JoinList* join_list_;
 
+  // The fixed workers. Tasks posted from outside of them go to the shared
+  // queue, which is protected by fixed_monitor_ like the counts below.
+  const intptr_t num_fixed_workers_;
+  TaskDeque** deques_;
+  Monitor fixed_monitor_;
+  bool fixed_shutting_down_;
+  Task* injected_head_;
+  Task* injected_tail_;
+  intptr_t injected_count_;
+  intptr_t fixed_running_;
+  intptr_t spares_running_;
+  intptr_t blocked_workers_;
+  intptr_t sleeping_workers_;  // Updated atomically.
+  int64_t tasks_stolen_;       // Updated atomically.
+  JoinList* fixed_join_list_;
+
+  static ThreadLocalKey worker_key_;
+
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
 
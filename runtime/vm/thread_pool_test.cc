@@ -188,8 +188,18 @@ VM_UNIT_TEST_CASE(ThreadPool_WorkerTimeout) {
 
 class SpawnTask : public ThreadPool::Task {
  public:
-  SpawnTask(ThreadPool* pool, Monitor* sync, int todo, int total, int* done)
-      : pool_(pool), sync_(sync), todo_(todo), total_(total), done_(done) {}
+  SpawnTask(ThreadPool* pool,
+            Monitor* sync,
+            int todo,
+            int total,
+            int* done,
+            bool blocking = true)
+      : pool_(pool),
+        sync_(sync),
+        todo_(todo),
+        total_(total),
+        done_(done),
+        blocking_(blocking) {}
 
   virtual void Run() {
     todo_--;  // Subtract one for current task.
@@ -197,11 +207,12 @@ class SpawnTask : public ThreadPool::Task {
 
     // Spawn 0-2 children.
     if (todo_ > 0) {
-      pool_->Run(
-          new SpawnTask(pool_, sync_, todo_ - child_todo, total_, done_));
+      pool_->Run(new SpawnTask(pool_, sync_, todo_ - child_todo, total_,
+                               done_, blocking_));
     }
     if (todo_ > 1) {
-      pool_->Run(new SpawnTask(pool_, sync_, child_todo, total_, done_));
+      pool_->Run(
+          new SpawnTask(pool_, sync_, child_todo, total_, done_, blocking_));
     }
 
     {
@@ -213,12 +224,15 @@ class SpawnTask : public ThreadPool::Task {
     }
   }
 
+  virtual bool IsBlocking() const { return blocking_; }
+
  private:
   ThreadPool* pool_;
   Monitor* sync_;
   int todo_;
   int total_;
   int* done_;
+  bool blocking_;
 };
 
 VM_UNIT_TEST_CASE(ThreadPool_RecursiveSpawn) {
@@ -237,4 +251,171 @@ VM_UNIT_TEST_CASE(ThreadPool_RecursiveSpawn) {
   EXPECT_EQ(kTotalTasks, done);
 }
 
+VM_UNIT_TEST_CASE(ThreadPool_FixedWorkersCreate) {
+  ThreadPool thread_pool(4);
+  EXPECT_EQ(4, thread_pool.fixed_workers());
+  EXPECT_EQ(0, thread_pool.queue_depth());
+}
+
+VM_UNIT_TEST_CASE(ThreadPool_FixedWorkersRecursiveSpawn) {
+  ThreadPool thread_pool(4);
+  Monitor sync;
+  // More tasks than fit in the deques of the workers.
+  const int kTotalTasks = 5000;
+  int done = 0;
+  thread_pool.Run(new SpawnTask(&thread_pool, &sync, kTotalTasks, kTotalTasks,
+                                &done, false));
+  {
+    MonitorLocker ml(&sync);
+    while (done < kTotalTasks) {
+      ml.Wait();
+    }
+  }
+  EXPECT_EQ(kTotalTasks, done);
+  EXPECT_EQ(4, thread_pool.fixed_workers());
+  // No task needed a thread of its own.
+  EXPECT_EQ(0U, thread_pool.workers_started());
+}
+
+class CountTask : public ThreadPool::Task {
+ public:
+  CountTask(Monitor* sync, int* done) : sync_(sync), done_(done) {}
+
+  virtual void Run() {
+    MonitorLocker ml(sync_);
+    (*done_)++;
+    ml.NotifyAll();
+  }
+
+ private:
+  Monitor* sync_;
+  int* done_;
+};
+
+// Posts tasks to the deque of its worker, and keeps the worker busy until
+// they ran, so that only the other worker can run them by stealing.
+class VictimTask : public ThreadPool::Task {
+ public:
+  VictimTask(ThreadPool* pool, Monitor* sync, int count, int* done)
+      : pool_(pool), sync_(sync), count_(count), done_(done) {}
+
+  virtual void Run() {
+    for (int i = 0; i < count_; i++) {
+      pool_->Run(new CountTask(sync_, done_));
+    }
+    MonitorLocker ml(sync_);
+    while (*done_ < count_) {
+      ml.Wait();
+    }
+  }
+
+ private:
+  ThreadPool* pool_;
+  Monitor* sync_;
+  int count_;
+  int* done_;
+};
+
+VM_UNIT_TEST_CASE(ThreadPool_FixedWorkersSteal) {
+  ThreadPool thread_pool(2);
+  Monitor sync;
+  const int kTotalTasks = 10;
+  int done = 0;
+  thread_pool.Run(new VictimTask(&thread_pool, &sync, kTotalTasks, &done));
+  {
+    MonitorLocker ml(&sync);
+    while (done < kTotalTasks) {
+      ml.Wait();
+    }
+  }
+  EXPECT_EQ(kTotalTasks, done);
+  EXPECT_EQ(kTotalTasks, thread_pool.tasks_stolen());
+}
+
+VM_UNIT_TEST_CASE(ThreadPool_FixedWorkersBlockingTask) {
+  ThreadPool thread_pool(1);
+  Monitor sync;
+  bool done = true;
+  thread_pool.Run(new TestTask(&sync, &done));
+  {
+    MonitorLocker ml(&sync);
+    done = false;
+    ml.Notify();
+    while (!done) {
+      ml.Wait();
+    }
+  }
+  EXPECT(done);
+  EXPECT_EQ(1U, thread_pool.workers_started());
+}
+
+class SignalTask : public ThreadPool::Task {
+ public:
+  SignalTask(Monitor* sync, bool* signaled)
+      : sync_(sync), signaled_(signaled) {}
+
+  virtual void Run() {
+    MonitorLocker ml(sync_);
+    *signaled_ = true;
+    ml.NotifyAll();
+  }
+
+  virtual bool IsBlocking() const { return false; }
+
+ private:
+  Monitor* sync_;
+  bool* signaled_;
+};
+
+// Waits for a task that it posts to the only fixed worker of the pool.
+class WaitForSignalTask : public ThreadPool::Task {
+ public:
+  WaitForSignalTask(ThreadPool* pool,
+                    Monitor* sync,
+                    bool* signaled,
+                    bool* done)
+      : pool_(pool), sync_(sync), signaled_(signaled), done_(done) {}
+
+  virtual void Run() {
+    pool_->Run(new SignalTask(sync_, signaled_));
+    {
+      ThreadPool::BlockingScope blocking_scope;
+      MonitorLocker ml(sync_);
+      while (!*signaled_) {
+        ml.Wait();
+      }
+    }
+    MonitorLocker ml(sync_);
+    *done_ = true;
+    ml.NotifyAll();
+  }
+
+  virtual bool IsBlocking() const { return false; }
+
+ private:
+  ThreadPool* pool_;
+  Monitor* sync_;
+  bool* signaled_;
+  bool* done_;
+};
+
+VM_UNIT_TEST_CASE(ThreadPool_FixedWorkersBlockingScope) {
+  ThreadPool thread_pool(1);
+  Monitor sync;
+  bool signaled = false;
+  bool done = false;
+  thread_pool.Run(
+      new WaitForSignalTask(&thread_pool, &sync, &signaled, &done));
+  {
+    MonitorLocker ml(&sync);
+    while (!done) {
+      ml.Wait();
+    }
+  }
+  EXPECT(signaled);
+  EXPECT(done);
+  // A spare stood in for the blocked worker and stole the signal task.
+  EXPECT_EQ(1, thread_pool.tasks_stolen());
+}
+
 }  // namespace dart
@@ -7,6 +7,7 @@
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
 #include "vm/lockers.h"
+#include "vm/pages.h"
 
 namespace dart {
 
@@ -87,6 +88,25 @@ void ThreadRegistry::PrepareForGC() {
   }
 }
 
+void ThreadRegistry::AbandonOldSpaceBuffers(PageSpace* old_space) {
+  MonitorLocker ml(threads_lock());
+  Thread* thread = active_list_;
+  while (thread != NULL) {
+    old_space->AbandonThreadBuffer(thread);
+    thread = thread->next_;
+  }
+}
+
+void ThreadRegistry::MakeOldSpaceBuffersIterable(
+    const PageSpace* old_space) const {
+  MonitorLocker ml(threads_lock());
+  Thread* thread = active_list_;
+  while (thread != NULL) {
+    old_space->MakeThreadBufferIterable(thread);
+    thread = thread->next_;
+  }
+}
+
 #ifndef PRODUCT
 void ThreadRegistry::PrintJSON(JSONStream* stream) const {
   MonitorLocker ml(threads_lock());
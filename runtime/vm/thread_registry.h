@@ -18,6 +18,7 @@ namespace dart {
 class JSONStream;
 class JSONArray;
 #endif
+class PageSpace;
 
 // Unordered collection of threads relating to a particular isolate.
 class ThreadRegistry {
@@ -33,6 +34,11 @@ class ThreadRegistry {
   void PrepareForGC();
   Thread* mutator_thread() const { return mutator_thread_; }
 
+  // Apply to the old-space allocation buffers of all active threads, see
+  // PageSpace::TryAllocateInThreadBuffer.
+  void AbandonOldSpaceBuffers(PageSpace* old_space);
+  void MakeOldSpaceBuffersIterable(const PageSpace* old_space) const;
+
 #ifndef PRODUCT
   void PrintJSON(JSONStream* stream) const;
 #endif
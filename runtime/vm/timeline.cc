@@ -12,11 +12,13 @@
 #include <cstdlib>
 
 #include "vm/atomic.h"
+#include "vm/hash_map.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
 #include "vm/lockers.h"
 #include "vm/log.h"
 #include "vm/object.h"
+#include "vm/protobuf.h"
 #include "vm/service_event.h"
 #include "vm/thread.h"
 
@@ -53,7 +55,12 @@ DEFINE_FLAG(charp,
             timeline_recorder,
             "ring",
             "Select the timeline recorder used. "
-            "Valid values: ring, endless, startup, and systrace.")
+            "Valid values: ring, endless, startup, systrace, and file.")
+DEFINE_FLAG(charp,
+            timeline_file,
+            NULL,
+            "Path of the Perfetto trace written by the file timeline "
+            "recorder. Defaults to dart-timeline-<pid>.pftrace.");
 
 // Implementation notes:
 //
@@ -116,6 +123,13 @@ static TimelineEventRecorder* CreateTimelineRecorder() {
     }
   }
 
+  if ((flag != NULL) && (strcmp("file", flag) == 0)) {
+    if (FLAG_trace_timeline) {
+      THR_Print("Using the file timeline recorder.\n");
+    }
+    return new TimelineEventFileRecorder(FLAG_timeline_file);
+  }
+
   if (use_endless_recorder || (flag != NULL)) {
     if (use_endless_recorder || (strcmp("endless", flag) == 0)) {
       if (FLAG_trace_timeline) {
@@ -261,13 +275,10 @@ void Timeline::ReclaimCachedBlocksFromThreads() {
   while (it.HasNext()) {
     OSThread* thread = it.Next();
     MutexLocker ml(thread->timeline_block_lock());
-    // Grab block and clear it.
-    TimelineEventBlock* block = thread->timeline_block();
-    thread->set_timeline_block(NULL);
     // TODO(johnmccutchan): Consider dropping the timeline_block_lock here
     // if we can do it everywhere. This would simplify the lock ordering
     // requirements.
-    recorder->FinishBlock(block);
+    recorder->ReleaseThreadBuffers(thread);
   }
 }
 
@@ -1150,6 +1161,13 @@ void TimelineEventRecorder::FinishBlock(TimelineEventBlock* block) {
   block->Finish();
 }
 
+void TimelineEventRecorder::ReleaseThreadBuffers(OSThread* thread) {
+  // Grab block and clear it.
+  TimelineEventBlock* block = thread->timeline_block();
+  thread->set_timeline_block(NULL);
+  FinishBlock(block);
+}
+
 TimelineEventBlock* TimelineEventRecorder::GetNewBlock() {
   MutexLocker ml(&lock_);
   return GetNewBlockLocked();
@@ -1468,6 +1486,936 @@ void TimelineEventEndlessRecorder::Clear() {
   thread->set_timeline_block(NULL);
 }
 
+const char* TimelineEventFileRecorder::kStreamName = "timeline.pftrace";
+
+// Maps the content of labels to the ids used in records. Ids start at 1 and
+// are assigned in increasing order, so the writer can emit the labels it has
+// not seen yet.
+class LabelIdKeyValueTrait {
+ public:
+  typedef const char* Key;
+  typedef intptr_t Value;
+
+  struct Pair {
+    Key key;
+    Value value;
+    Pair() : key(NULL), value(0) {}
+    Pair(const Key key, const Value& value) : key(key), value(value) {}
+    Pair(const Pair& other) : key(other.key), value(other.value) {}
+  };
+
+  static Key KeyOf(Pair kv) { return kv.key; }
+  static Value ValueOf(Pair kv) { return kv.value; }
+  static intptr_t Hashcode(Key key) {
+    return Utils::StringHash(key, strlen(key));
+  }
+  static bool IsKeyEqual(Pair kv, Key key) { return strcmp(kv.key, key) == 0; }
+};
+
+class TimelineLabelTable {
+ public:
+  TimelineLabelTable() {}
+
+  ~TimelineLabelTable() {
+    for (intptr_t i = 0; i < labels_.length(); i++) {
+      free(labels_[i]);
+    }
+  }
+
+  intptr_t Intern(const char* label) {
+    MutexLocker ml(&lock_);
+    intptr_t id = ids_.LookupValue(label);
+    if (id == 0) {
+      char* copy = strdup(label);
+      labels_.Add(copy);
+      id = labels_.length();
+      ids_.Insert(LabelIdKeyValueTrait::Pair(copy, id));
+    }
+    return id;
+  }
+
+  intptr_t length() {
+    MutexLocker ml(&lock_);
+    return labels_.length();
+  }
+
+  // Labels are never freed before the table, so the result can be used
+  // without holding the lock.
+  const char* At(intptr_t id) {
+    MutexLocker ml(&lock_);
+    return labels_[id - 1];
+  }
+
+ private:
+  Mutex lock_;
+  MallocDirectChainedHashMap<LabelIdKeyValueTrait> ids_;
+  MallocGrowableArray<char*> labels_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimelineLabelTable);
+};
+
+// The records of the events completed by one thread. A record is:
+//
+//   type       byte, the TimelineEvent::EventType
+//   label      unsigned, the label id
+//   category   unsigned, the label id of the stream name
+//   timestamp  signed, microseconds since the previous record of the buffer
+//   extra      unsigned, the duration of kDuration events or the async id of
+//              async and flow events; absent for other events
+//   arguments  unsigned count, then the name id, length and bytes of each
+//              argument value
+//
+// where unsigned and signed values are (zigzag encoded) LEB128 varints.
+class TimelineRecordBuffer {
+ public:
+  static const intptr_t kSize = 32 * KB;
+  static const intptr_t kMaxUnsignedSize = 10;
+  static const intptr_t kMaxHeaderSize = 1 + 5 * kMaxUnsignedSize;
+  // Longer argument values are truncated and further arguments are dropped,
+  // so that any record fits into an empty buffer.
+  static const intptr_t kMaxArgumentLength = 1 * KB;
+  static const intptr_t kMaxArguments =
+      (kSize - kMaxHeaderSize) / (kMaxArgumentLength + 2 * kMaxUnsignedSize);
+
+  TimelineRecordBuffer()
+      : next_(NULL),
+        thread_id_(0),
+        thread_name_(NULL),
+        length_(0),
+        record_count_(0),
+        last_timestamp_(0) {
+    memset(label_cache_, 0, sizeof(label_cache_));
+  }
+
+  ~TimelineRecordBuffer() { free(thread_name_); }
+
+  TimelineRecordBuffer* next() const { return next_; }
+  void set_next(TimelineRecordBuffer* next) { next_ = next; }
+
+  // The event handed out by the recorder while this buffer is cached by a
+  // thread.
+  TimelineEvent* event() { return &event_; }
+
+  intptr_t thread_id() const { return thread_id_; }
+  const char* thread_name() const { return thread_name_; }
+
+  const uint8_t* data() const { return data_; }
+  intptr_t length() const { return length_; }
+  intptr_t record_count() const { return record_count_; }
+
+  bool IsEmpty() const { return length_ == 0; }
+  bool HasRoom(intptr_t size) const { return (length_ + size) <= kSize; }
+
+  // Prepares the buffer for records of |thread|.
+  void Claim(OSThread* thread) {
+    free(thread_name_);
+    thread_id_ = OSThread::ThreadIdToIntPtr(thread->trace_id());
+    thread_name_ = (thread->name() != NULL) ? strdup(thread->name()) : NULL;
+    Clear();
+  }
+
+  // Drops all records.
+  void Clear() {
+    length_ = 0;
+    record_count_ = 0;
+    last_timestamp_ = 0;
+  }
+
+  void WriteByte(uint8_t value) { data_[length_++] = value; }
+
+  void WriteUnsigned(uint64_t value) {
+    while (value >= 0x80) {
+      data_[length_++] = static_cast<uint8_t>(value | 0x80);
+      value >>= 7;
+    }
+    data_[length_++] = static_cast<uint8_t>(value);
+  }
+
+  void WriteSigned(int64_t value) {
+    WriteUnsigned((static_cast<uint64_t>(value) << 1) ^
+                  static_cast<uint64_t>(value >> 63));
+  }
+
+  void WriteBytes(const void* bytes, intptr_t length) {
+    memmove(&data_[length_], bytes, length);
+    length_ += length;
+  }
+
+  void WriteTimestamp(int64_t micros) {
+    WriteSigned(micros - last_timestamp_);
+    last_timestamp_ = micros;
+  }
+
+  void FinishRecord() { record_count_++; }
+
+  // A direct mapped cache of the ids of compile time constant labels, which
+  // saves taking the lock of the label table for most records.
+  intptr_t LookupLabel(const char* label) const {
+    const LabelCacheEntry& entry = label_cache_[LabelCacheIndex(label)];
+    return (entry.label == label) ? entry.id : 0;
+  }
+
+  void CacheLabel(const char* label, intptr_t id) {
+    LabelCacheEntry* entry = &label_cache_[LabelCacheIndex(label)];
+    entry->label = label;
+    entry->id = id;
+  }
+
+ private:
+  static const intptr_t kLabelCacheSize = 64;
+
+  struct LabelCacheEntry {
+    const char* label;
+    intptr_t id;
+  };
+
+  static intptr_t LabelCacheIndex(const char* label) {
+    const uword bits = reinterpret_cast<uword>(label);
+    return (bits ^ (bits >> 6)) & (kLabelCacheSize - 1);
+  }
+
+  TimelineRecordBuffer* next_;
+  TimelineEvent event_;
+  intptr_t thread_id_;
+  char* thread_name_;
+  intptr_t length_;
+  intptr_t record_count_;
+  int64_t last_timestamp_;
+  LabelCacheEntry label_cache_[kLabelCacheSize];
+  uint8_t data_[kSize];
+
+  DISALLOW_COPY_AND_ASSIGN(TimelineRecordBuffer);
+};
+
+// Field numbers from the Perfetto trace protos.
+enum {
+  kTracePacket = 1,
+
+  kPacketTimestamp = 8,
+  kPacketSequenceId = 10,
+  kPacketTrackEvent = 11,
+  kPacketInternedData = 12,
+  kPacketSequenceFlags = 13,
+  kPacketTrackDescriptor = 60,
+
+  kSequenceIncrementalStateCleared = 1,
+  kSequenceNeedsIncrementalState = 2,
+
+  kTrackEventCategoryIids = 3,
+  kTrackEventDebugAnnotations = 4,
+  kTrackEventType = 9,
+  kTrackEventNameIid = 10,
+  kTrackEventTrackUuid = 11,
+  kTrackEventDoubleCounterValue = 44,
+  kTrackEventFlowIds = 47,
+  kTrackEventTerminatingFlowIds = 48,
+
+  kTrackEventSliceBegin = 1,
+  kTrackEventSliceEnd = 2,
+  kTrackEventInstant = 3,
+  kTrackEventCounter = 4,
+
+  kDebugAnnotationNameIid = 1,
+  kDebugAnnotationStringValue = 6,
+
+  kInternedEventCategories = 1,
+  kInternedEventNames = 2,
+  kInternedDebugAnnotationNames = 3,
+  kInternedStringIid = 1,
+  kInternedStringName = 2,
+
+  kTrackDescriptorUuid = 1,
+  kTrackDescriptorName = 2,
+  kTrackDescriptorProcess = 3,
+  kTrackDescriptorThread = 4,
+  kTrackDescriptorParentUuid = 5,
+  kTrackDescriptorCounter = 8,
+
+  kProcessDescriptorPid = 1,
+
+  kThreadDescriptorPid = 1,
+  kThreadDescriptorTid = 2,
+  kThreadDescriptorThreadName = 5,
+};
+
+class TrackKeyValueTrait {
+ public:
+  typedef uint64_t Key;
+  typedef bool Value;
+
+  struct Pair {
+    Key key;
+    Value value;
+    Pair() : key(0), value(false) {}
+    Pair(const Key key, const Value& value) : key(key), value(value) {}
+    Pair(const Pair& other) : key(other.key), value(other.value) {}
+  };
+
+  static Key KeyOf(Pair kv) { return kv.key; }
+  static Value ValueOf(Pair kv) { return kv.value; }
+  static intptr_t Hashcode(Key key) {
+    return Utils::WordHash(static_cast<intptr_t>(key ^ (key >> 32)));
+  }
+  static bool IsKeyEqual(Pair kv, Key key) { return kv.key == key; }
+};
+
+// Converts record buffers to the Perfetto trace format. All packets belong
+// to one sequence, whose interned data maps label ids to labels. Labels,
+// stream names and argument names share one id space, so each label is
+// interned as an event name, a category and an annotation name.
+//
+// Events of a thread are written on the thread's track. Async events are
+// written on a track per async id, and counters on a track per label, using
+// the first argument as the value.
+class TimelinePerfettoWriter {
+ public:
+  static const intptr_t kChunkSize = 64 * KB;
+
+  TimelinePerfettoWriter(Dart_StreamConsumer consumer,
+                         void* user_data,
+                         TimelineLabelTable* labels)
+      : consumer_(consumer),
+        user_data_(user_data),
+        labels_(labels),
+        pid_(OS::ProcessId()),
+        cursor_(NULL),
+        end_(NULL) {}
+
+  void WriteHeader() {
+    if (consumer_ != NULL) {
+      consumer_(Dart_StreamConsumer_kStart,
+                TimelineEventFileRecorder::kStreamName, NULL, 0, user_data_);
+    }
+    message_.Clear();
+    message_.WriteInt(kTrackDescriptorUuid, ProcessTrack());
+    nested_.Clear();
+    nested_.WriteInt(kProcessDescriptorPid, pid_);
+    message_.WriteMessage(kTrackDescriptorProcess, nested_);
+    WritePacket(0, kPacketTrackDescriptor, message_,
+                kSequenceIncrementalStateCleared);
+  }
+
+  void WriteBuffer(TimelineRecordBuffer* buffer) {
+    WriteInternedLabels();
+    const uint64_t thread_track = Track(kThreadTrackTag, buffer->thread_id());
+    if (!tracks_.HasKey(thread_track)) {
+      tracks_.Insert(TrackKeyValueTrait::Pair(thread_track, true));
+      message_.Clear();
+      message_.WriteInt(kTrackDescriptorUuid, thread_track);
+      message_.WriteInt(kTrackDescriptorParentUuid, ProcessTrack());
+      nested_.Clear();
+      nested_.WriteInt(kThreadDescriptorPid, pid_);
+      nested_.WriteInt(kThreadDescriptorTid, buffer->thread_id());
+      if (buffer->thread_name() != NULL) {
+        nested_.WriteString(kThreadDescriptorThreadName,
+                            buffer->thread_name());
+      }
+      message_.WriteMessage(kTrackDescriptorThread, nested_);
+      WritePacket(0, kPacketTrackDescriptor, message_, 0);
+    }
+    cursor_ = buffer->data();
+    end_ = cursor_ + buffer->length();
+    int64_t timestamp = 0;
+    while (cursor_ < end_) {
+      const intptr_t type = *cursor_++;
+      const intptr_t label = ReadUnsigned();
+      const intptr_t category = ReadUnsigned();
+      timestamp += ReadSigned();
+      switch (type) {
+        case TimelineEvent::kBegin:
+          StartTrackEvent(kTrackEventSliceBegin, thread_track, label, category);
+          ReadAnnotations(true);
+          WriteTrackEvent(timestamp);
+          break;
+        case TimelineEvent::kEnd:
+          StartTrackEvent(kTrackEventSliceEnd, thread_track, 0, 0);
+          ReadAnnotations(true);
+          WriteTrackEvent(timestamp);
+          break;
+        case TimelineEvent::kDuration: {
+          const int64_t duration = ReadUnsigned();
+          StartTrackEvent(kTrackEventSliceBegin, thread_track, label, category);
+          ReadAnnotations(true);
+          WriteTrackEvent(timestamp);
+          StartTrackEvent(kTrackEventSliceEnd, thread_track, 0, 0);
+          WriteTrackEvent(timestamp + duration);
+          break;
+        }
+        case TimelineEvent::kInstant:
+          StartTrackEvent(kTrackEventInstant, thread_track, label, category);
+          ReadAnnotations(true);
+          WriteTrackEvent(timestamp);
+          break;
+        case TimelineEvent::kAsyncBegin:
+        case TimelineEvent::kAsyncInstant:
+        case TimelineEvent::kAsyncEnd: {
+          const uint64_t async_track = Track(kAsyncTrackTag, ReadUnsigned());
+          if (type == TimelineEvent::kAsyncBegin) {
+            // The track is named after the operation it records.
+            WriteNamedTrack(async_track, label, false);
+          }
+          const intptr_t event_type =
+              (type == TimelineEvent::kAsyncBegin)
+                  ? kTrackEventSliceBegin
+                  : ((type == TimelineEvent::kAsyncEnd) ? kTrackEventSliceEnd
+                                                        : kTrackEventInstant);
+          StartTrackEvent(event_type, async_track, label, category);
+          ReadAnnotations(true);
+          WriteTrackEvent(timestamp);
+          break;
+        }
+        case TimelineEvent::kCounter: {
+          const uint64_t counter_track = Track(kCounterTrackTag, label);
+          if (!tracks_.HasKey(counter_track)) {
+            tracks_.Insert(TrackKeyValueTrait::Pair(counter_track, true));
+            WriteNamedTrack(counter_track, label, true);
+          }
+          StartTrackEvent(kTrackEventCounter, counter_track, 0, 0);
+          event_.WriteDouble(kTrackEventDoubleCounterValue,
+                             ReadAnnotations(false));
+          WriteTrackEvent(timestamp);
+          break;
+        }
+        case TimelineEvent::kFlowBegin:
+        case TimelineEvent::kFlowStep:
+        case TimelineEvent::kFlowEnd: {
+          const uint64_t flow_id = ReadUnsigned();
+          StartTrackEvent(kTrackEventInstant, thread_track, label, category);
+          ReadAnnotations(true);
+          event_.WriteFixed64((type == TimelineEvent::kFlowEnd)
+                                  ? kTrackEventTerminatingFlowIds
+                                  : kTrackEventFlowIds,
+                              flow_id);
+          WriteTrackEvent(timestamp);
+          break;
+        }
+        default:
+          UNREACHABLE();
+      }
+    }
+  }
+
+  void Flush() {
+    if ((consumer_ != NULL) && (output_.length() > 0)) {
+      consumer_(Dart_StreamConsumer_kData,
+                TimelineEventFileRecorder::kStreamName, output_.data(),
+                output_.length(), user_data_);
+    }
+    output_.Clear();
+  }
+
+  void WriteTrailer() {
+    Flush();
+    if (consumer_ != NULL) {
+      consumer_(Dart_StreamConsumer_kFinish,
+                TimelineEventFileRecorder::kStreamName, NULL, 0, user_data_);
+    }
+  }
+
+ private:
+  // Tracks are identified by a tag and a thread, async or label id.
+  enum {
+    kProcessTrackTag = 1,
+    kThreadTrackTag = 2,
+    kAsyncTrackTag = 3,
+    kCounterTrackTag = 4,
+  };
+  static const intptr_t kTrackTagShift = 60;
+
+  static uint64_t Track(intptr_t tag, uint64_t id) {
+    const uint64_t kIdMask = (static_cast<uint64_t>(1) << kTrackTagShift) - 1;
+    return (static_cast<uint64_t>(tag) << kTrackTagShift) | (id & kIdMask);
+  }
+
+  uint64_t ProcessTrack() const { return Track(kProcessTrackTag, pid_); }
+
+  uint64_t ReadUnsigned() {
+    uint64_t value = 0;
+    intptr_t shift = 0;
+    uint8_t byte;
+    do {
+      ASSERT(cursor_ < end_);
+      byte = *cursor_++;
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      shift += 7;
+    } while ((byte & 0x80) != 0);
+    return value;
+  }
+
+  int64_t ReadSigned() {
+    const uint64_t value = ReadUnsigned();
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+
+  // Reads the arguments of a record, and writes them as debug annotations of
+  // the current track event if |annotate|. Returns the value of the first
+  // argument as a number, for counters.
+  double ReadAnnotations(bool annotate) {
+    double first_value = 0.0;
+    const intptr_t count = ReadUnsigned();
+    for (intptr_t i = 0; i < count; i++) {
+      const intptr_t name = ReadUnsigned();
+      const intptr_t length = ReadUnsigned();
+      const uint8_t* value = cursor_;
+      cursor_ += length;
+      ASSERT(cursor_ <= end_);
+      if (annotate) {
+        nested_.Clear();
+        nested_.WriteInt(kDebugAnnotationNameIid, name);
+        nested_.WriteBytes(kDebugAnnotationStringValue, value, length);
+        event_.WriteMessage(kTrackEventDebugAnnotations, nested_);
+      } else if (i == 0) {
+        char number[64];
+        const intptr_t number_length =
+            Utils::Minimum<intptr_t>(length, sizeof(number) - 1);
+        memmove(number, value, number_length);
+        number[number_length] = '\0';
+        first_value = strtod(number, NULL);
+      }
+    }
+    return first_value;
+  }
+
+  void WriteInternedLabels() {
+    const intptr_t length = labels_->length();
+    if (length == names_.length()) {
+      return;
+    }
+    message_.Clear();
+    for (intptr_t id = names_.length() + 1; id <= length; id++) {
+      const char* label = labels_->At(id);
+      names_.Add(label);
+      nested_.Clear();
+      nested_.WriteInt(kInternedStringIid, id);
+      nested_.WriteString(kInternedStringName, label);
+      message_.WriteMessage(kInternedEventNames, nested_);
+      message_.WriteMessage(kInternedEventCategories, nested_);
+      message_.WriteMessage(kInternedDebugAnnotationNames, nested_);
+    }
+    WritePacket(0, kPacketInternedData, message_,
+                kSequenceNeedsIncrementalState);
+  }
+
+  void WriteNamedTrack(uint64_t uuid, intptr_t label, bool counter) {
+    message_.Clear();
+    message_.WriteInt(kTrackDescriptorUuid, uuid);
+    message_.WriteInt(kTrackDescriptorParentUuid, ProcessTrack());
+    message_.WriteString(kTrackDescriptorName, names_[label - 1]);
+    if (counter) {
+      nested_.Clear();
+      message_.WriteMessage(kTrackDescriptorCounter, nested_);
+    }
+    WritePacket(0, kPacketTrackDescriptor, message_, 0);
+  }
+
+  void StartTrackEvent(intptr_t type,
+                       uint64_t track,
+                       intptr_t label,
+                       intptr_t category) {
+    event_.Clear();
+    event_.WriteInt(kTrackEventType, type);
+    event_.WriteInt(kTrackEventTrackUuid, track);
+    event_.WriteInt(kTrackEventNameIid, label);
+    event_.WriteInt(kTrackEventCategoryIids, category);
+  }
+
+  void WriteTrackEvent(int64_t micros) {
+    WritePacket(micros * kNanosecondsPerMicrosecond, kPacketTrackEvent, event_,
+                kSequenceNeedsIncrementalState);
+  }
+
+  // Writes a packet holding |message| as its field |field|. The timestamp is
+  // omitted when |nanos| is 0.
+  void WritePacket(int64_t nanos,
+                   intptr_t field,
+                   const ProtobufBuffer& message,
+                   intptr_t flags) {
+    packet_.Clear();
+    packet_.WriteInt(kPacketTimestamp, nanos);
+    packet_.WriteInt(kPacketSequenceId, kSequenceId);
+    packet_.WriteInt(kPacketSequenceFlags, flags);
+    packet_.WriteMessage(field, message);
+    output_.WriteMessage(kTracePacket, packet_);
+    if (output_.length() >= kChunkSize) {
+      Flush();
+    }
+  }
+
+  static const intptr_t kSequenceId = 1;
+
+  Dart_StreamConsumer consumer_;
+  void* user_data_;
+  TimelineLabelTable* labels_;
+  const int64_t pid_;
+  // The labels already interned in the trace, by id - 1.
+  MallocGrowableArray<const char*> names_;
+  // The thread and counter tracks already described.
+  MallocDirectChainedHashMap<TrackKeyValueTrait> tracks_;
+  const uint8_t* cursor_;
+  const uint8_t* end_;
+  ProtobufBuffer output_;
+  ProtobufBuffer packet_;
+  ProtobufBuffer message_;
+  ProtobufBuffer event_;
+  ProtobufBuffer nested_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimelinePerfettoWriter);
+};
+
+TimelineEventFileRecorder::TimelineEventFileRecorder(const char* path)
+    : consumer_(NULL),
+      user_data_(NULL),
+      labels_(new TimelineLabelTable()),
+      writer_(NULL),
+      pending_head_(NULL),
+      pending_tail_(NULL),
+      pending_count_(0),
+      free_buffers_(NULL),
+      dropped_count_(0),
+      writing_(false),
+      shutdown_(false),
+      writer_thread_id_(OSThread::kInvalidThreadJoinId) {
+  Dart_FileOpenCallback file_open = Dart::file_open_callback();
+  if ((file_open != NULL) && (Dart::file_write_callback() != NULL) &&
+      (Dart::file_close_callback() != NULL)) {
+    char* filename =
+        (path != NULL)
+            ? strdup(path)
+            : OS::SCreate(NULL, "dart-timeline-%" Pd ".pftrace",
+                          static_cast<intptr_t>(OS::ProcessId()));
+    void* file = (*file_open)(filename, true);
+    if (file != NULL) {
+      consumer_ = FileConsumer;
+      user_data_ = file;
+    } else {
+      OS::PrintErr("Failed to open timeline file: %s\n", filename);
+    }
+    free(filename);
+  }
+  Start();
+}
+
+TimelineEventFileRecorder::TimelineEventFileRecorder(
+    Dart_StreamConsumer consumer,
+    void* user_data)
+    : consumer_(consumer),
+      user_data_(user_data),
+      labels_(new TimelineLabelTable()),
+      writer_(NULL),
+      pending_head_(NULL),
+      pending_tail_(NULL),
+      pending_count_(0),
+      free_buffers_(NULL),
+      dropped_count_(0),
+      writing_(false),
+      shutdown_(false),
+      writer_thread_id_(OSThread::kInvalidThreadJoinId) {
+  Start();
+}
+
+TimelineEventFileRecorder::~TimelineEventFileRecorder() {
+  Flush();
+  {
+    MonitorLocker ml(&monitor_);
+    shutdown_ = true;
+    ml.NotifyAll();
+  }
+  OSThread::Join(writer_thread_id_);
+  writer_thread_id_ = OSThread::kInvalidThreadJoinId;
+
+  // Buffers released by threads that exited after the writer stopped.
+  for (TimelineRecordBuffer* buffer = pending_head_; buffer != NULL;
+       buffer = buffer->next()) {
+    writer_->WriteBuffer(buffer);
+  }
+  writer_->WriteTrailer();
+  delete writer_;
+  writer_ = NULL;
+
+  TimelineRecordBuffer* buffers[] = {pending_head_, free_buffers_};
+  for (intptr_t i = 0; i < 2; i++) {
+    TimelineRecordBuffer* buffer = buffers[i];
+    while (buffer != NULL) {
+      TimelineRecordBuffer* next = buffer->next();
+      delete buffer;
+      buffer = next;
+    }
+  }
+  pending_head_ = pending_tail_ = free_buffers_ = NULL;
+  delete labels_;
+  labels_ = NULL;
+}
+
+void TimelineEventFileRecorder::FileConsumer(Dart_StreamConsumer_State state,
+                                             const char* stream_name,
+                                             const uint8_t* buffer,
+                                             intptr_t buffer_length,
+                                             void* user_data) {
+  if (state == Dart_StreamConsumer_kData) {
+    (*Dart::file_write_callback())(buffer, buffer_length, user_data);
+  } else if (state == Dart_StreamConsumer_kFinish) {
+    (*Dart::file_close_callback())(user_data);
+  }
+}
+
+void TimelineEventFileRecorder::Start() {
+  writer_ = new TimelinePerfettoWriter(consumer_, user_data_, labels_);
+  writer_->WriteHeader();
+  MonitorLocker ml(&monitor_);
+  int result = OSThread::Start("TimelineWriter", WriterMain,
+                               reinterpret_cast<uword>(this));
+  if (result != 0) {
+    FATAL1("Could not start timeline writer thread %d.", result);
+  }
+  while (writer_thread_id_ == OSThread::kInvalidThreadJoinId) {
+    ml.Wait();
+  }
+}
+
+void TimelineEventFileRecorder::WriterMain(uword parameter) {
+  reinterpret_cast<TimelineEventFileRecorder*>(parameter)->RunWriter();
+}
+
+void TimelineEventFileRecorder::RunWriter() {
+  MonitorLocker ml(&monitor_);
+  writer_thread_id_ = OSThread::GetCurrentThreadJoinId(OSThread::Current());
+  ml.NotifyAll();
+  while (true) {
+    if (pending_head_ == NULL) {
+      if (shutdown_) {
+        break;
+      }
+      ml.Wait();
+      continue;
+    }
+    TimelineRecordBuffer* buffers = pending_head_;
+    pending_head_ = pending_tail_ = NULL;
+    pending_count_ = 0;
+    writing_ = true;
+
+    // Convert the records without blocking the threads recording them.
+    ml.Exit();
+    for (TimelineRecordBuffer* buffer = buffers; buffer != NULL;
+         buffer = buffer->next()) {
+      writer_->WriteBuffer(buffer);
+    }
+    writer_->Flush();
+    ml.Enter();
+
+    while (buffers != NULL) {
+      TimelineRecordBuffer* next = buffers->next();
+      buffers->set_next(free_buffers_);
+      free_buffers_ = buffers;
+      buffers = next;
+    }
+    writing_ = false;
+    ml.NotifyAll();
+  }
+}
+
+void TimelineEventFileRecorder::PrintJSON(JSONStream* js,
+                                          TimelineEventFilter* filter) {
+  if (!FLAG_support_service) {
+    return;
+  }
+  JSONObject topLevel(js);
+  topLevel.AddProperty("type", "_Timeline");
+  {
+    JSONArray events(&topLevel, "traceEvents");
+    PrintJSONMeta(&events);
+  }
+}
+
+void TimelineEventFileRecorder::PrintTraceEvent(JSONStream* js,
+                                                TimelineEventFilter* filter) {
+  if (!FLAG_support_service) {
+    return;
+  }
+  JSONArray events(js);
+}
+
+void TimelineEventFileRecorder::ReleaseThreadBuffers(OSThread* thread) {
+  TimelineRecordBuffer* buffer = thread->timeline_records();
+  thread->set_timeline_records(NULL);
+  if (buffer != NULL) {
+    EnqueueBuffer(buffer);
+  }
+}
+
+void TimelineEventFileRecorder::Flush() {
+  {
+    OSThreadIterator it;
+    while (it.HasNext()) {
+      OSThread* thread = it.Next();
+      MutexLocker ml(thread->timeline_block_lock());
+      ReleaseThreadBuffers(thread);
+    }
+  }
+  MonitorLocker ml(&monitor_);
+  while ((pending_head_ != NULL) || writing_) {
+    ml.Wait();
+  }
+}
+
+TimelineEvent* TimelineEventFileRecorder::StartEvent() {
+  OSThread* thread = OSThread::Current();
+  ASSERT(thread != NULL);
+  // As in |ThreadBlockStartEvent|, the thread's block lock is held until the
+  // call to |CompleteEvent| is made.
+  thread->timeline_block_lock()->Lock();
+#if defined(DEBUG)
+  Thread* T = Thread::Current();
+  if (T != NULL) {
+    T->IncrementNoSafepointScopeDepth();
+  }
+#endif  // defined(DEBUG)
+  TimelineRecordBuffer* buffer = thread->timeline_records();
+  if (buffer == NULL) {
+    {
+      MonitorLocker ml(&monitor_);
+      buffer = NewBufferLocked();
+    }
+    buffer->Claim(thread);
+    thread->set_timeline_records(buffer);
+  }
+  return buffer->event();
+}
+
+void TimelineEventFileRecorder::CompleteEvent(TimelineEvent* event) {
+  if (event == NULL) {
+    return;
+  }
+  OSThread* thread = OSThread::Current();
+  ASSERT(thread != NULL);
+  TimelineRecordBuffer* buffer = thread->timeline_records();
+  ASSERT((buffer != NULL) && (event == buffer->event()));
+  TimelineRecordBuffer* full = NULL;
+  if (event->IsValid() && (event->event_type() != TimelineEvent::kMetadata)) {
+    if (!buffer->HasRoom(RecordSize(event))) {
+      MonitorLocker ml(&monitor_);
+      if (pending_count_ >= kMaxPendingBuffers) {
+        // The writer is falling behind, drop the records of this buffer.
+        dropped_count_ += buffer->record_count();
+        buffer->Clear();
+      } else {
+        full = buffer;
+        buffer = NewBufferLocked();
+      }
+    }
+    if (full != NULL) {
+      buffer->Claim(thread);
+      thread->set_timeline_records(buffer);
+    }
+    WriteRecord(buffer, event);
+  }
+  event->Reset();
+  // |event| belongs to |full|, so it can only be handed to the writer once
+  // the event is reset.
+  if (full != NULL) {
+    EnqueueBuffer(full);
+  }
+  ThreadBlockCompleteEvent(event);
+}
+
+intptr_t TimelineEventFileRecorder::RecordSize(TimelineEvent* event) {
+  intptr_t size = TimelineRecordBuffer::kMaxHeaderSize;
+  const intptr_t count = Utils::Minimum(event->arguments_length(),
+                                        TimelineRecordBuffer::kMaxArguments);
+  for (intptr_t i = 0; i < count; i++) {
+    const char* value = event->arguments()[i].value;
+    const intptr_t length = (value != NULL) ? strlen(value) : 0;
+    size += 2 * TimelineRecordBuffer::kMaxUnsignedSize +
+            Utils::Minimum(length, TimelineRecordBuffer::kMaxArgumentLength);
+  }
+  return size;
+}
+
+void TimelineEventFileRecorder::WriteRecord(TimelineRecordBuffer* buffer,
+                                            TimelineEvent* event) {
+  // Events that own their label come from Dart code or the embedder, whose
+  // labels and argument names are not compile time constants.
+  const bool constant_labels = !event->owns_label();
+  const TimelineEvent::EventType type = event->event_type();
+  buffer->WriteByte(static_cast<uint8_t>(type));
+  buffer->WriteUnsigned(InternLabel(buffer, event->label(), constant_labels));
+  buffer->WriteUnsigned(InternLabel(buffer, event->category_, true));
+  buffer->WriteTimestamp(event->TimeOrigin());
+  switch (type) {
+    case TimelineEvent::kDuration:
+      buffer->WriteUnsigned(event->IsFinishedDuration()
+                                ? event->TimeEnd() - event->TimeOrigin()
+                                : 0);
+      break;
+    case TimelineEvent::kAsyncBegin:
+    case TimelineEvent::kAsyncInstant:
+    case TimelineEvent::kAsyncEnd:
+    case TimelineEvent::kFlowBegin:
+    case TimelineEvent::kFlowStep:
+    case TimelineEvent::kFlowEnd:
+      buffer->WriteUnsigned(static_cast<uint64_t>(event->AsyncId()));
+      break;
+    default:
+      break;
+  }
+  const intptr_t count = Utils::Minimum(event->arguments_length(),
+                                        TimelineRecordBuffer::kMaxArguments);
+  buffer->WriteUnsigned(count);
+  for (intptr_t i = 0; i < count; i++) {
+    const TimelineEventArgument& argument = event->arguments()[i];
+    buffer->WriteUnsigned(
+        InternLabel(buffer, argument.name, constant_labels));
+    const char* value = (argument.value != NULL) ? argument.value : "";
+    const intptr_t length = Utils::Minimum<intptr_t>(
+        strlen(value), TimelineRecordBuffer::kMaxArgumentLength);
+    buffer->WriteUnsigned(length);
+    buffer->WriteBytes(value, length);
+  }
+  buffer->FinishRecord();
+}
+
+intptr_t TimelineEventFileRecorder::InternLabel(TimelineRecordBuffer* buffer,
+                                                const char* label,
+                                                bool constant) {
+  if (!constant) {
+    return labels_->Intern(label);
+  }
+  intptr_t id = buffer->LookupLabel(label);
+  if (id == 0) {
+    id = labels_->Intern(label);
+    buffer->CacheLabel(label, id);
+  }
+  return id;
+}
+
+TimelineRecordBuffer* TimelineEventFileRecorder::NewBufferLocked() {
+  TimelineRecordBuffer* buffer = free_buffers_;
+  if (buffer != NULL) {
+    free_buffers_ = buffer->next();
+    buffer->set_next(NULL);
+  } else {
+    buffer = new TimelineRecordBuffer();
+  }
+  return buffer;
+}
+
+void TimelineEventFileRecorder::EnqueueBuffer(TimelineRecordBuffer* buffer) {
+  MonitorLocker ml(&monitor_);
+  ASSERT(buffer->next() == NULL);
+  if (buffer->IsEmpty()) {
+    buffer->set_next(free_buffers_);
+    free_buffers_ = buffer;
+    return;
+  }
+  if (pending_tail_ == NULL) {
+    pending_head_ = buffer;
+  } else {
+    pending_tail_->set_next(buffer);
+  }
+  pending_tail_ = buffer;
+  pending_count_++;
+  ml.NotifyAll();
+}
+
 TimelineEventBlock::TimelineEventBlock(intptr_t block_index)
     : next_(NULL),
       length_(0),
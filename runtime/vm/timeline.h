@@ -26,6 +26,9 @@ class Thread;
 class TimelineEvent;
 class TimelineEventBlock;
 class TimelineEventRecorder;
+class TimelineLabelTable;
+class TimelinePerfettoWriter;
+class TimelineRecordBuffer;
 class TimelineStream;
 class VirtualMemory;
 class Zone;
@@ -441,6 +444,7 @@ class TimelineEvent {
   friend class TimelineEventRingRecorder;
   friend class TimelineEventStartupRecorder;
   friend class TimelineEventPlatformRecorder;
+  friend class TimelineEventFileRecorder;
   friend class TimelineStream;
   friend class TimelineTestHelper;
   DISALLOW_COPY_AND_ASSIGN(TimelineEvent);
@@ -695,6 +699,10 @@ class TimelineEventRecorder {
 
   void FinishBlock(TimelineEventBlock* block);
 
+  // Takes the buffers cached by |thread|. Must be called with the thread's
+  // |timeline_block_lock_| held, or once the thread is no longer listed.
+  virtual void ReleaseThreadBuffers(OSThread* thread);
+
  protected:
   void WriteTo(const char* directory);
 
@@ -837,6 +845,83 @@ class TimelineEventEndlessRecorder : public TimelineEventRecorder {
   friend class TimelineTestHelper;
 };
 
+// A recorder that writes events as compact binary records into per-thread
+// buffers, which a background thread streams to a file in the Perfetto trace
+// format (https://perfetto.dev/docs/reference/trace-packet-proto).
+//
+// Labels, stream names and argument names are interned, so a record only
+// holds ids, timestamp deltas and argument values. Events are not kept once
+// written and cannot be retrieved through the service. If the writer falls
+// behind, the records of full buffers are dropped instead of growing the
+// backlog without bound.
+class TimelineEventFileRecorder : public TimelineEventRecorder {
+ public:
+  static const char* kStreamName;
+  static const intptr_t kMaxPendingBuffers = 64;
+
+  // Writes to |path|, or to dart-timeline-<pid>.pftrace if |path| is NULL.
+  explicit TimelineEventFileRecorder(const char* path);
+  // Hands the trace to |consumer| instead of writing a file.
+  TimelineEventFileRecorder(Dart_StreamConsumer consumer, void* user_data);
+  virtual ~TimelineEventFileRecorder();
+
+  void PrintJSON(JSONStream* js, TimelineEventFilter* filter);
+  void PrintTraceEvent(JSONStream* js, TimelineEventFilter* filter);
+
+  const char* name() const { return "File"; }
+
+  void ReleaseThreadBuffers(OSThread* thread);
+
+  // Waits until the records of all threads have been handed to the consumer.
+  void Flush();
+
+  // The number of events dropped because the writer fell behind.
+  intptr_t dropped_count() const { return dropped_count_; }
+
+ protected:
+  TimelineEvent* StartEvent();
+  void CompleteEvent(TimelineEvent* event);
+  TimelineEventBlock* GetHeadBlockLocked() { return NULL; }
+  TimelineEventBlock* GetNewBlockLocked() { return NULL; }
+  void Clear() {}
+
+ private:
+  static void WriterMain(uword parameter);
+  static void FileConsumer(Dart_StreamConsumer_State state,
+                           const char* stream_name,
+                           const uint8_t* buffer,
+                           intptr_t buffer_length,
+                           void* user_data);
+
+  void Start();
+  void RunWriter();
+  static intptr_t RecordSize(TimelineEvent* event);
+  void WriteRecord(TimelineRecordBuffer* buffer, TimelineEvent* event);
+  intptr_t InternLabel(TimelineRecordBuffer* buffer,
+                       const char* label,
+                       bool constant);
+  TimelineRecordBuffer* NewBufferLocked();
+  void EnqueueBuffer(TimelineRecordBuffer* buffer);
+
+  Dart_StreamConsumer consumer_;
+  void* user_data_;
+  TimelineLabelTable* labels_;
+  TimelinePerfettoWriter* writer_;
+
+  // Protects the fields below and signals changes to them.
+  Monitor monitor_;
+  TimelineRecordBuffer* pending_head_;
+  TimelineRecordBuffer* pending_tail_;
+  intptr_t pending_count_;
+  TimelineRecordBuffer* free_buffers_;
+  intptr_t dropped_count_;
+  bool writing_;
+  bool shutdown_;
+  ThreadJoinId writer_thread_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimelineEventFileRecorder);
+};
+
 // An iterator for blocks.
 class TimelineEventBlockIterator {
  public:
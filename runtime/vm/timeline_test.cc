@@ -343,6 +343,129 @@ TEST_CASE(TimelineEventCallbackRecorderBasic) {
   delete recorder;
 }
 
+// Collects the trace written by a TimelineEventFileRecorder.
+struct TimelineFileOutput {
+  TimelineFileOutput() : started(false), finished(false) {}
+
+  MallocGrowableArray<uint8_t> bytes;
+  bool started;
+  bool finished;
+};
+
+static void TimelineFileConsumer(Dart_StreamConsumer_State state,
+                                 const char* stream_name,
+                                 const uint8_t* buffer,
+                                 intptr_t buffer_length,
+                                 void* user_data) {
+  TimelineFileOutput* output = reinterpret_cast<TimelineFileOutput*>(user_data);
+  EXPECT_STREQ(TimelineEventFileRecorder::kStreamName, stream_name);
+  if (state == Dart_StreamConsumer_kStart) {
+    output->started = true;
+  } else if (state == Dart_StreamConsumer_kData) {
+    for (intptr_t i = 0; i < buffer_length; i++) {
+      output->bytes.Add(buffer[i]);
+    }
+  } else {
+    output->finished = true;
+  }
+}
+
+static intptr_t CountOccurrences(const MallocGrowableArray<uint8_t>& bytes,
+                                 const char* str) {
+  const intptr_t length = strlen(str);
+  intptr_t count = 0;
+  for (intptr_t i = 0; i + length <= bytes.length(); i++) {
+    if (memcmp(&bytes[i], str, length) == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+// Returns the number of trace packets, or -1 if |bytes| is not a sequence
+// of length delimited packets.
+static intptr_t CountPackets(const MallocGrowableArray<uint8_t>& bytes) {
+  const uint8_t kPacketTag = (1 << 3) | 2;
+  intptr_t count = 0;
+  intptr_t i = 0;
+  while (i < bytes.length()) {
+    if (bytes[i++] != kPacketTag) {
+      return -1;
+    }
+    uint64_t length = 0;
+    intptr_t shift = 0;
+    while ((i < bytes.length()) && ((bytes[i] & 0x80) != 0)) {
+      length |= static_cast<uint64_t>(bytes[i++] & 0x7F) << shift;
+      shift += 7;
+    }
+    if (i == bytes.length()) {
+      return -1;
+    }
+    length |= static_cast<uint64_t>(bytes[i++]) << shift;
+    i += length;
+    count++;
+  }
+  return (i == bytes.length()) ? count : -1;
+}
+
+TEST_CASE(TimelineFileRecorderPerfetto) {
+  TimelineFileOutput output;
+  TimelineEventFileRecorder* recorder =
+      new TimelineEventFileRecorder(TimelineFileConsumer, &output);
+  {
+    TimelineRecorderOverride override(recorder);
+    EXPECT(output.started);
+
+    // Create a test stream.
+    TimelineStream stream;
+    stream.Init("testStream", true);
+
+    TimelineEvent* event = stream.StartEvent();
+    event->Duration("cabbage", 10, 20);
+    event->Complete();
+
+    event = stream.StartEvent();
+    event->Instant("kale", 30);
+    event->SetNumArguments(1);
+    event->CopyArgument(0, "leaf", "curly");
+    event->Complete();
+
+    event = stream.StartEvent();
+    event->AsyncBegin("broccoli", recorder->GetNextAsyncId(), 40);
+    event->Complete();
+
+    event = stream.StartEvent();
+    event->Counter("lettuce", 50);
+    event->SetNumArguments(1);
+    event->CopyArgument(0, "heads", "42");
+    event->Complete();
+
+    recorder->Flush();
+    EXPECT(!output.finished);
+    EXPECT(CountPackets(output.bytes) > 0);
+    const intptr_t cabbages = CountOccurrences(output.bytes, "cabbage");
+    EXPECT(cabbages > 0);
+    EXPECT(CountOccurrences(output.bytes, "testStream") > 0);
+    EXPECT(CountOccurrences(output.bytes, "leaf") > 0);
+    EXPECT_EQ(1, CountOccurrences(output.bytes, "curly"));
+    EXPECT(CountOccurrences(output.bytes, "broccoli") > 0);
+    EXPECT(CountOccurrences(output.bytes, "lettuce") > 0);
+
+    // Labels are interned, so recording them again only adds ids.
+    for (intptr_t i = 0; i < 1000; i++) {
+      event = stream.StartEvent();
+      event->Duration("cabbage", 100 + 2 * i, 101 + 2 * i);
+      event->Complete();
+    }
+    recorder->Flush();
+    EXPECT_EQ(cabbages, CountOccurrences(output.bytes, "cabbage"));
+    EXPECT_EQ(0, recorder->dropped_count());
+    delete recorder;
+  }
+  EXPECT(output.finished);
+  EXPECT(CountPackets(output.bytes) > 2000);
+}
+
 static bool LabelMatch(TimelineEvent* event, const char* label) {
   ASSERT(event != NULL);
   return strcmp(event->label(), label) == 0;
@@ -17,7 +17,7 @@ bool VirtualMemory::InSamePage(uword address0, uword address1) {
 void VirtualMemory::Truncate(intptr_t new_size, bool try_unmap) {
   ASSERT((new_size & (PageSize() - 1)) == 0);
   ASSERT(new_size <= size());
-  if (try_unmap &&
+  if (try_unmap && (huge_page_region_ == NULL) &&
       (reserved_size_ == size()) && /* Don't create holes in reservation. */
       FreeSubSegment(handle(), reinterpret_cast<void*>(start() + new_size),
                      size() - new_size)) {
@@ -26,6 +26,28 @@ void VirtualMemory::Truncate(intptr_t new_size, bool try_unmap) {
   region_.Subregion(region_, 0, new_size);
 }
 
+#if !defined(HOST_OS_LINUX)
+// Huge pages are only used on Linux (see virtual_memory_linux.cc).
+VirtualMemory* VirtualMemory::ReserveHeap(intptr_t size, bool is_executable) {
+  return ReserveInternal(size);
+}
+
+// Dirty page tracking relies on the soft-dirty bits of Linux.
+bool VirtualMemory::SupportsDirtyPageTracking() {
+  return false;
+}
+
+bool VirtualMemory::ClearDirtyPages() {
+  UNREACHABLE();
+  return false;
+}
+
+bool VirtualMemory::GetDirtyPages(uword start, intptr_t size, bool* dirty) {
+  UNREACHABLE();
+  return false;
+}
+#endif  // !defined(HOST_OS_LINUX)
+
 VirtualMemory* VirtualMemory::ForImagePage(void* pointer, uword size) {
   // Memory for precompilated instructions was allocated by the embedder, so
   // create a VirtualMemory without allocating.
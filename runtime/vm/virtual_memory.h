@@ -11,6 +11,8 @@
 
 namespace dart {
 
+class HugePageRegion;
+
 class VirtualMemory {
  public:
   enum Protection {
@@ -50,6 +52,17 @@ class VirtualMemory {
   // size cannot be allocated NULL is returned.
   static VirtualMemory* Reserve(intptr_t size) { return ReserveInternal(size); }
 
+  // The size of the huge pages used with --use_huge_pages.
+  static const intptr_t kHugePageSize = 2 * MB;
+
+  // Reserves a segment of the Dart heap: a page of old space or code, or a
+  // semispace. With --use_huge_pages, on platforms that support it, the
+  // segment is backed by huge pages once committed. Segments of at least
+  // kHugePageSize are aligned to huge pages, and smaller segments that divide
+  // a huge page are allocated together with segments of the same size and
+  // executability from shared regions of huge pages (see HugePageRegion).
+  static VirtualMemory* ReserveHeap(intptr_t size, bool is_executable);
+
   static intptr_t PageSize() {
     ASSERT(page_size_ != 0);
     ASSERT(Utils::IsPowerOfTwo(page_size_));
@@ -58,6 +71,22 @@ class VirtualMemory {
 
   static bool InSamePage(uword address0, uword address1);
 
+  // Tracking of the pages written since the last call to ClearDirtyPages, in
+  // the whole process. Used by incremental marking to find the objects the
+  // mutator wrote to between marking steps. Only supported on Linux, with the
+  // kernel's soft-dirty bits.
+  //
+  // Clearing the bits affects all the memory of the process, including the
+  // embedder's, and anyone else relying on them (such as checkpointing
+  // tools). After clearing, the first write to each page faults again. Only
+  // call these (SupportsDirtyPageTracking included, which clears the bits to
+  // probe the kernel) when --incremental_marking is set.
+  static bool SupportsDirtyPageTracking();
+  static bool ClearDirtyPages();
+  // Sets dirty[i] iff the i-th page of PageSize() in [start, start + size) was
+  // written since the last ClearDirtyPages. Returns false on failure.
+  static bool GetDirtyPages(uword start, intptr_t size, bool* dirty);
+
   // Truncate this virtual memory segment. If try_unmap is false, the
   // memory beyond the new end is still accessible, but will be returned
   // upon destruction.
@@ -85,7 +114,8 @@ class VirtualMemory {
       : region_(region.pointer(), region.size()),
         reserved_size_(region.size()),
         handle_(handle),
-        vm_owns_region_(true) {}
+        vm_owns_region_(true),
+        huge_page_region_(NULL) {}
 
   MemoryRegion region_;
 
@@ -102,6 +132,12 @@ class VirtualMemory {
   // protection status changed by the VM.
   bool vm_owns_region_;
 
+  // The shared region of huge pages this segment was allocated from, if any.
+  // Such a segment is returned to the region rather than unmapped.
+  HugePageRegion* huge_page_region_;
+
+  friend class HugePageRegion;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(VirtualMemory);
 };
 
@@ -7,16 +7,31 @@
 
 #include "vm/virtual_memory.h"
 
+#include <fcntl.h>     // NOLINT
 #include <sys/mman.h>  // NOLINT
 #include <unistd.h>    // NOLINT
 
 #include "platform/assert.h"
 #include "platform/utils.h"
 
+#include "vm/flags.h"
 #include "vm/isolate.h"
+#include "vm/lockers.h"
+#include "vm/os_thread.h"
 
 namespace dart {
 
+DEFINE_FLAG(bool,
+            use_huge_pages,
+            false,
+            "Back the Dart heap and code with transparent huge pages.");
+DEFINE_FLAG(bool,
+            use_hugetlb,
+            false,
+            "Back semispaces and other huge-page-sized parts of the Dart heap "
+            "with explicitly reserved huge pages (MAP_HUGETLB) when available. "
+            "Implies --use_huge_pages.");
+
 // standard MAP_FAILED causes "error: use of old-style cast" as it
 // defines MAP_FAILED as ((void *) -1)
 #undef MAP_FAILED
@@ -24,8 +39,265 @@ namespace dart {
 
 uword VirtualMemory::page_size_ = 0;
 
+static bool UseHugePages() {
+  return FLAG_use_huge_pages || FLAG_use_hugetlb;
+}
+
+static bool IsHugePageAligned(uword address, intptr_t size) {
+  return Utils::IsAligned(address, VirtualMemory::kHugePageSize) &&
+         Utils::IsAligned(size, VirtualMemory::kHugePageSize);
+}
+
+// Asks for the range to be backed by transparent huge pages. This is only a
+// hint, which the kernel ignores if they are disabled.
+static void AdviseHugePages(void* address, intptr_t size) {
+  madvise(address, size, MADV_HUGEPAGE);
+}
+
+static void unmap(void* address, intptr_t size) {
+  if (size == 0) {
+    return;
+  }
+
+  if (munmap(address, size) != 0) {
+    FATAL("munmap failed\n");
+  }
+}
+
+// Maps size bytes at a multiple of alignment, by mapping a larger range and
+// unmapping its excess on both sides.
+static void* MapAligned(intptr_t size,
+                        intptr_t alignment,
+                        int prot,
+                        int flags) {
+  ASSERT(Utils::IsAligned(size, VirtualMemory::PageSize()));
+  const intptr_t mapped_size = size + alignment - VirtualMemory::PageSize();
+  void* address = mmap(NULL, mapped_size, prot, flags, -1, 0);
+  if (address == MAP_FAILED) {
+    return MAP_FAILED;
+  }
+  const uword start = reinterpret_cast<uword>(address);
+  const uword aligned_start = Utils::RoundUp(start, alignment);
+  const uword aligned_end = aligned_start + size;
+  unmap(address, aligned_start - start);
+  unmap(reinterpret_cast<void*>(aligned_end),
+        start + mapped_size - aligned_end);
+  return reinterpret_cast<void*>(aligned_start);
+}
+
+// A huge-page-aligned region of kHugePageSize bytes, divided into segments of
+// one size that are reserved by ReserveHeap. It lets the regular pages of old
+// space (and separately, of code) share huge pages, and therefore TLB
+// entries, instead of each being mapped on its own.
+//
+// The whole region is committed and advised to use huge pages when it is
+// created. A segment is committed again only to restore its protection, and
+// to zero it if it was used before. The region is unmapped once all of its
+// segments are free.
+class HugePageRegion {
+ public:
+  static void InitOnce() { mutex_ = new Mutex(); }
+
+  static VirtualMemory* ReserveSegment(intptr_t size, bool is_executable);
+  static void FreeSegment(VirtualMemory* memory);
+
+  bool CommitSegment(uword address, intptr_t size, int prot);
+
+ private:
+  HugePageRegion(uword start, intptr_t segment_size, bool is_executable)
+      : start_(start),
+        segment_size_(segment_size),
+        is_executable_(is_executable),
+        used_(0),
+        dirty_(0),
+        next_(NULL) {}
+
+  intptr_t num_segments() const { return kHugePageSize / segment_size_; }
+  intptr_t SegmentIndex(uword address) const {
+    return (address - start_) / segment_size_;
+  }
+  bool IsFull() const {
+    return used_ == ((static_cast<uword>(1) << num_segments()) - 1);
+  }
+
+  static const intptr_t kHugePageSize = VirtualMemory::kHugePageSize;
+
+  const uword start_;
+  const intptr_t segment_size_;
+  const bool is_executable_;
+  uword used_;   // Bit mask of the segments in use.
+  uword dirty_;  // Bit mask of the segments that need to be zeroed.
+  HugePageRegion* next_;
+
+  static Mutex* mutex_;
+  static HugePageRegion* regions_;
+
+  DISALLOW_COPY_AND_ASSIGN(HugePageRegion);
+};
+
+Mutex* HugePageRegion::mutex_ = NULL;
+HugePageRegion* HugePageRegion::regions_ = NULL;
+
+VirtualMemory* HugePageRegion::ReserveSegment(intptr_t size,
+                                              bool is_executable) {
+  ASSERT((kHugePageSize % size) == 0);
+  ASSERT((kHugePageSize / size) < kBitsPerWord);
+  MutexLocker ml(mutex_);
+  HugePageRegion* region = regions_;
+  while ((region != NULL) &&
+         ((region->segment_size_ != size) ||
+          (region->is_executable_ != is_executable) || region->IsFull())) {
+    region = region->next_;
+  }
+  if (region == NULL) {
+    void* address = MapAligned(kHugePageSize, kHugePageSize,
+                               PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON);
+    if (address == MAP_FAILED) {
+      return NULL;
+    }
+    AdviseHugePages(address, kHugePageSize);
+    region = new HugePageRegion(reinterpret_cast<uword>(address), size,
+                                is_executable);
+    region->next_ = regions_;
+    regions_ = region;
+  }
+  intptr_t index = 0;
+  while ((region->used_ & (static_cast<uword>(1) << index)) != 0) {
+    index++;
+  }
+  region->used_ |= static_cast<uword>(1) << index;
+  MemoryRegion segment(reinterpret_cast<void*>(region->start_ + index * size),
+                       size);
+  VirtualMemory* memory = new VirtualMemory(segment);
+  memory->huge_page_region_ = region;
+  return memory;
+}
+
+void HugePageRegion::FreeSegment(VirtualMemory* memory) {
+  HugePageRegion* region = memory->huge_page_region_;
+  MutexLocker ml(mutex_);
+  const uword mask = static_cast<uword>(1)
+                     << region->SegmentIndex(memory->start());
+  ASSERT((region->used_ & mask) != 0);
+  region->used_ &= ~mask;
+  region->dirty_ |= mask;
+  if (region->used_ != 0) {
+    return;
+  }
+  HugePageRegion** link = &regions_;
+  while (*link != region) {
+    link = &(*link)->next_;
+  }
+  *link = region->next_;
+  unmap(reinterpret_cast<void*>(region->start_), kHugePageSize);
+  delete region;
+}
+
+bool HugePageRegion::CommitSegment(uword address, intptr_t size, int prot) {
+  // Only whole segments are committed, after any earlier protection change.
+  ASSERT(Utils::IsAligned(address - start_, segment_size_));
+  if (mprotect(reinterpret_cast<void*>(address), size, prot) != 0) {
+    return false;
+  }
+  bool dirty;
+  {
+    MutexLocker ml(mutex_);
+    const uword mask = static_cast<uword>(1) << SegmentIndex(address);
+    dirty = (dirty_ & mask) != 0;
+    dirty_ &= ~mask;
+  }
+  if (dirty) {
+    memset(reinterpret_cast<void*>(address), 0, size);
+  }
+  return true;
+}
+
+// The soft-dirty bit of a page is set by the kernel when the page is written,
+// reported in bit 55 of its entry in /proc/self/pagemap, and cleared for the
+// whole process by writing "4" to /proc/self/clear_refs.
+static const uint64_t kSoftDirtyBit = static_cast<uint64_t>(1) << 55;
+
+static Mutex* dirty_tracking_mutex_ = NULL;
+static bool dirty_tracking_checked_ = false;
+static int pagemap_fd_ = -1;
+
 void VirtualMemory::InitOnce() {
   page_size_ = getpagesize();
+  HugePageRegion::InitOnce();
+  dirty_tracking_mutex_ = new Mutex();
+}
+
+bool VirtualMemory::SupportsDirtyPageTracking() {
+  MutexLocker ml(dirty_tracking_mutex_);
+  if (dirty_tracking_checked_) {
+    return pagemap_fd_ >= 0;
+  }
+  dirty_tracking_checked_ = true;
+  if (FLAG_use_hugetlb) {
+    // Not all kernels report soft-dirty bits for hugetlbfs mappings.
+    return false;
+  }
+  pagemap_fd_ = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+  if (pagemap_fd_ < 0) {
+    return false;
+  }
+  // Soft-dirty bits are only maintained by kernels built with
+  // CONFIG_MEM_SOFT_DIRTY; check that writing to a clean page sets its bit.
+  const intptr_t size = PageSize();
+  void* address =
+      mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  bool supported = false;
+  if (address != MAP_FAILED) {
+    volatile uword* word = reinterpret_cast<volatile uword*>(address);
+    const uword start = reinterpret_cast<uword>(address);
+    *word = 1;
+    bool clean_dirty = true;
+    bool written_dirty = false;
+    if (ClearDirtyPages() && GetDirtyPages(start, size, &clean_dirty)) {
+      *word = 2;
+      supported =
+          GetDirtyPages(start, size, &written_dirty) && written_dirty &&
+          !clean_dirty;
+    }
+    unmap(address, size);
+  }
+  if (!supported) {
+    close(pagemap_fd_);
+    pagemap_fd_ = -1;
+  }
+  return supported;
+}
+
+bool VirtualMemory::ClearDirtyPages() {
+  int fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  const bool result = write(fd, "4", 1) == 1;
+  close(fd);
+  return result;
+}
+
+bool VirtualMemory::GetDirtyPages(uword start, intptr_t size, bool* dirty) {
+  ASSERT(pagemap_fd_ >= 0);
+  const intptr_t page_size = PageSize();
+  ASSERT(Utils::IsAligned(start, page_size));
+  const intptr_t count = Utils::RoundUp(size, page_size) / page_size;
+  const off_t offset = (start / page_size) * sizeof(uint64_t);
+  const intptr_t kBatchSize = 512;
+  uint64_t entries[kBatchSize];
+  for (intptr_t i = 0; i < count; i += kBatchSize) {
+    const intptr_t batch = Utils::Minimum(kBatchSize, count - i);
+    const ssize_t length = batch * sizeof(uint64_t);
+    if (pread(pagemap_fd_, entries, length, offset + i * sizeof(uint64_t)) !=
+        length) {
+      return false;
+    }
+    for (intptr_t j = 0; j < batch; j++) {
+      dirty[i + j] = (entries[j] & kSoftDirtyBit) != 0;
+    }
+  }
+  return true;
 }
 
 VirtualMemory* VirtualMemory::ReserveInternal(intptr_t size) {
@@ -38,18 +310,29 @@ VirtualMemory* VirtualMemory::ReserveInternal(intptr_t size) {
   return new VirtualMemory(region);
 }
 
-static void unmap(void* address, intptr_t size) {
-  if (size == 0) {
-    return;
-  }
-
-  if (munmap(address, size) != 0) {
-    FATAL("munmap failed\n");
+VirtualMemory* VirtualMemory::ReserveHeap(intptr_t size, bool is_executable) {
+  if (UseHugePages()) {
+    if (size >= kHugePageSize) {
+      void* address = MapAligned(size, kHugePageSize, PROT_NONE,
+                                 MAP_PRIVATE | MAP_ANON | MAP_NORESERVE);
+      if (address == MAP_FAILED) {
+        return NULL;
+      }
+      MemoryRegion region(address, size);
+      return new VirtualMemory(region);
+    }
+    if (((kHugePageSize % size) == 0) &&
+        ((kHugePageSize / size) < kBitsPerWord)) {
+      return HugePageRegion::ReserveSegment(size, is_executable);
+    }
   }
+  return ReserveInternal(size);
 }
 
 VirtualMemory::~VirtualMemory() {
-  if (vm_owns_region()) {
+  if (huge_page_region_ != NULL) {
+    HugePageRegion::FreeSegment(this);
+  } else if (vm_owns_region()) {
     unmap(address(), reserved_size_);
   }
 }
@@ -57,8 +340,9 @@ VirtualMemory::~VirtualMemory() {
 bool VirtualMemory::FreeSubSegment(int32_t handle,
                                    void* address,
                                    intptr_t size) {
-  unmap(address, size);
-  return true;
+  // Fails for a part of a segment backed by MAP_HUGETLB that is not aligned
+  // to huge pages, which then stays mapped.
+  return (size == 0) || (munmap(address, size) == 0);
 }
 
 bool VirtualMemory::Commit(uword addr,
@@ -68,10 +352,24 @@ bool VirtualMemory::Commit(uword addr,
   ASSERT(Contains(addr));
   ASSERT(Contains(addr + size) || (addr + size == end()));
   int prot = PROT_READ | PROT_WRITE | (executable ? PROT_EXEC : 0);
-  void* address = mmap(reinterpret_cast<void*>(addr), size, prot,
-                       MAP_PRIVATE | MAP_ANON | MAP_FIXED, -1, 0);
+  if (huge_page_region_ != NULL) {
+    return huge_page_region_->CommitSegment(addr, size, prot);
+  }
+  const int flags = MAP_PRIVATE | MAP_ANON | MAP_FIXED;
+  void* address = MAP_FAILED;
+  if (FLAG_use_hugetlb && !executable && IsHugePageAligned(addr, size)) {
+    // Fails if not enough huge pages are reserved in the system.
+    address = mmap(reinterpret_cast<void*>(addr), size, prot,
+                   flags | MAP_HUGETLB, -1, 0);
+  }
   if (address == MAP_FAILED) {
-    return false;
+    address = mmap(reinterpret_cast<void*>(addr), size, prot, flags, -1, 0);
+    if (address == MAP_FAILED) {
+      return false;
+    }
+    if (UseHugePages() && (size >= kHugePageSize)) {
+      AdviseHugePages(address, size);
+    }
   }
   return true;
 }
@@ -8,6 +8,10 @@
 
 namespace dart {
 
+#if defined(HOST_OS_LINUX)
+DECLARE_FLAG(bool, use_huge_pages);
+#endif
+
 bool IsZero(char* begin, char* end) {
   for (char* current = begin; current < end; ++current) {
     if (*current != 0) {
@@ -104,4 +108,53 @@ VM_UNIT_TEST_CASE(VirtualMemoryCommitPartial) {
   delete vm;
 }
 
+VM_UNIT_TEST_CASE(ReserveHeapVirtualMemory) {
+#if defined(HOST_OS_LINUX)
+  const bool saved_use_huge_pages = FLAG_use_huge_pages;
+  FLAG_use_huge_pages = true;
+#endif
+  const intptr_t kSegmentSize = 256 * KB;
+  VirtualMemory* vm1 = VirtualMemory::ReserveHeap(kSegmentSize, false);
+  VirtualMemory* vm2 = VirtualMemory::ReserveHeap(kSegmentSize, false);
+  EXPECT(vm1 != NULL);
+  EXPECT(vm2 != NULL);
+  EXPECT_EQ(kSegmentSize, vm1->size());
+  EXPECT_EQ(kSegmentSize, vm2->size());
+#if defined(HOST_OS_LINUX)
+  // Both segments belong to the same region of huge pages.
+  EXPECT_EQ(Utils::RoundDown(vm1->start(), VirtualMemory::kHugePageSize),
+            Utils::RoundDown(vm2->start(), VirtualMemory::kHugePageSize));
+#endif
+  EXPECT(vm1->Commit(false, NULL));
+  EXPECT(vm2->Commit(false, NULL));
+  char* buf = reinterpret_cast<char*>(vm1->address());
+  EXPECT(IsZero(buf, buf + vm1->size()));
+  memset(buf, 'x', vm1->size());
+  delete vm1;
+
+  // A segment is zeroed when it is committed again.
+  vm1 = VirtualMemory::ReserveHeap(kSegmentSize, false);
+  EXPECT(vm1 != NULL);
+  EXPECT(vm1->Commit(false, NULL));
+  buf = reinterpret_cast<char*>(vm1->address());
+  EXPECT(IsZero(buf, buf + vm1->size()));
+  delete vm1;
+  delete vm2;
+
+  const intptr_t kLargeSize = 3 * VirtualMemory::kHugePageSize;
+  VirtualMemory* large = VirtualMemory::ReserveHeap(kLargeSize, false);
+  EXPECT(large != NULL);
+#if defined(HOST_OS_LINUX)
+  EXPECT(Utils::IsAligned(large->start(), VirtualMemory::kHugePageSize));
+#endif
+  EXPECT(large->Commit(false, NULL));
+  buf = reinterpret_cast<char*>(large->address());
+  EXPECT(IsZero(buf, buf + large->size()));
+  large->Truncate(VirtualMemory::kHugePageSize, true);
+  delete large;
+#if defined(HOST_OS_LINUX)
+  FLAG_use_huge_pages = saved_use_huge_pages;
+#endif
+}
+
 }  // namespace dart
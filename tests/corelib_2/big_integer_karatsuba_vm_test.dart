@@ -0,0 +1,135 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Testing Bigint multiplication and squaring around the Karatsuba threshold
+// of 64 digits, with and without intrinsics.
+// VMOptions=
+// VMOptions=--no_intrinsify
+
+library big_integer_karatsuba_test;
+
+import "dart:math" show Random;
+import "package:expect/expect.dart";
+
+// Returns the absolute value of x as 16-bit limbs, least significant first.
+List<int> toLimbs(int x) {
+  x = x.abs();
+  var limbs = <int>[];
+  while (x != 0) {
+    limbs.add(x & 0xFFFF);
+    x >>= 16;
+  }
+  return limbs;
+}
+
+int fromLimbs(List<int> limbs) {
+  var x = 0;
+  for (var i = limbs.length - 1; i >= 0; i--) {
+    x = (x << 16) | limbs[i];
+  }
+  return x;
+}
+
+// Returns a * b, computed with the schoolbook algorithm on 16-bit limbs so
+// that only products of small integers are used.
+int schoolbookMul(int a, int b) {
+  var x = toLimbs(a);
+  var y = toLimbs(b);
+  var r = new List<int>.filled(x.length + y.length, 0);
+  for (var i = 0; i < x.length; i++) {
+    var carry = 0;
+    for (var j = 0; j < y.length; j++) {
+      var t = r[i + j] + x[i] * y[j] + carry;
+      r[i + j] = t & 0xFFFF;
+      carry = t >> 16;
+    }
+    r[i + y.length] = carry;
+  }
+  var product = fromLimbs(r);
+  return (a.isNegative != b.isNegative) ? -product : product;
+}
+
+// Returns a positive number of exactly 'digits' 32-bit digits.
+int randomBigint(Random random, int digits) {
+  var x = 1 + random.nextInt(0xFFFFFFFF);
+  for (var i = 1; i < digits; i++) {
+    x = (x << 32) | random.nextInt(0xFFFFFFFF);
+  }
+  return x;
+}
+
+// Returns a number of 'digits' 32-bit digits, all set to 0xFFFFFFFF, which
+// maximizes the carries between the partial products.
+int allOnes(int digits) => (1 << (32 * digits)) - 1;
+
+void expectProduct(int a, int b) {
+  var expected = schoolbookMul(a, b);
+  // Use isTrue instead of equals to avoid printing such big numbers.
+  Expect.isTrue(a * b == expected,
+      'product of ${a.bitLength} and ${b.bitLength} bit operands');
+  Expect.isTrue(b * a == expected,
+      'product of ${b.bitLength} and ${a.bitLength} bit operands');
+}
+
+void expectSigns(int a, int b) {
+  expectProduct(a, b);
+  expectProduct(-a, b);
+  expectProduct(a, -b);
+  expectProduct(-a, -b);
+}
+
+testBalanced(Random random) {
+  for (var digits in [63, 64, 65, 66, 127, 128, 129, 255]) {
+    expectSigns(randomBigint(random, digits), randomBigint(random, digits));
+    expectSigns(allOnes(digits), allOnes(digits));
+  }
+}
+
+testUnbalanced(Random random) {
+  // Operands of at least 64 digits whose sizes differ. The smaller one is
+  // split with the larger one when it has more than half its digits, and
+  // multiplied whole otherwise.
+  var sizes = [
+    [65, 64],
+    [127, 64],
+    [128, 64],
+    [129, 64],
+    [129, 65],
+    [130, 65],
+    [131, 66],
+    [200, 99],
+    [300, 64],
+    [65, 63],
+    [1000, 63],
+  ];
+  for (var size in sizes) {
+    expectSigns(randomBigint(random, size[0]), randomBigint(random, size[1]));
+    expectSigns(allOnes(size[0]), allOnes(size[1]));
+    expectSigns(allOnes(size[0]), randomBigint(random, size[1]));
+  }
+}
+
+testSquare(Random random) {
+  // x * x takes the multiplication path, modPow squares its intermediate
+  // results with the dedicated squaring path.
+  var m = randomBigint(random, 260) | 1;
+  for (var digits in [63, 64, 65, 66, 127, 128, 129]) {
+    for (var x in [randomBigint(random, digits), allOnes(digits)]) {
+      var expected = schoolbookMul(x, x);
+      Expect.isTrue(x * x == expected, 'square of $digits digits');
+      Expect.isTrue((-x) * (-x) == expected, 'square of -$digits digits');
+      Expect.isTrue(
+          x.modPow(2, m) == expected % m, 'modPow 2 of $digits digits');
+      Expect.isTrue(x.modPow(3, m) == schoolbookMul(expected, x) % m,
+          'modPow 3 of $digits digits');
+    }
+  }
+}
+
+main() {
+  var random = new Random(1234);
+  testBalanced(random);
+  testUnbalanced(random);
+  testSquare(random);
+}
@@ -25,6 +25,8 @@
 // THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+// VMOptions=
+// VMOptions=--native_irregexp
 
 import 'v8_regexp_utils.dart';
 import 'package:expect/expect.dart';
@@ -1,5 +1,7 @@
 // Copyright (c) 2014, the Dart project authors. All rights reserved.
 // Autogenerated from the PCRE test suite Mon Feb  2 15:14:04 CET 2009
+// VMOptions=
+// VMOptions=--native_irregexp
 
 // Note that some regexps in the PCRE test suite use features not present
 // in JavaScript.  These don't work in JS, but they fail to work in a
@@ -1,6 +1,8 @@
 // Copyright (c) 2014, the Dart project authors.  Please see the AUTHORS file
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE file.
+// VMOptions=
+// VMOptions=--native_irregexp
 
 import 'v8_regexp_utils.dart';
 import 'package:expect/expect.dart';
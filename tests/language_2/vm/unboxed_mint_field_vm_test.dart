@@ -0,0 +1,171 @@
+// Copyright (c) 2018, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+// Test fields that only hold mints, which the VM stores in a mutable box that
+// is overwritten in place.
+// VMOptions=--optimization_counter_threshold=10 --no-background_compilation
+
+import "package:expect/expect.dart";
+
+// Not a Smi on any platform.
+const int kBig = 0x4000000000000000;
+
+class A {
+  int x;
+  A(this.x);
+
+  add(int y) {
+    x = x + y;
+  }
+}
+
+// Loads must copy the value out of the box, and stores must copy the value
+// into it, so a value read from the field never changes.
+testAliasing() {
+  for (var i = 0; i < 50; i++) {
+    var a = new A(kBig);
+    var b = new A(kBig + 1);
+    var values = <int>[];
+    for (var j = 0; j < 20; j++) {
+      values.add(a.x);
+      a.add(1);
+    }
+    for (var j = 0; j < 20; j++) {
+      Expect.equals(kBig + j, values[j]);
+    }
+    var saved = a.x;
+    b.x = a.x;
+    a.add(1);
+    Expect.equals(kBig + 20, saved);
+    Expect.equals(kBig + 20, b.x);
+    Expect.equals(kBig + 21, a.x);
+    Expect.isTrue(identical(a.x, a.x));
+    Expect.isFalse(identical(a.x, b.x));
+    var capture = () => saved;
+    a.x = saved;
+    a.add(5);
+    Expect.equals(kBig + 20, capture());
+  }
+}
+
+// Instances initialized with the same Mint must not share its box.
+testSharedInitialValue() {
+  for (var i = 0; i < 50; i++) {
+    var m = kBig + i;
+    var a1 = new A(m);
+    var a2 = new A(m);
+    a1.add(1);
+    Expect.equals(kBig + i + 1, a1.x);
+    Expect.equals(kBig + i, a2.x);
+    Expect.equals(kBig + i, m);
+  }
+}
+
+// Values stored as map keys must stay valid when the field is updated.
+testMapKeys() {
+  var a = new A(kBig);
+  var map = <int, int>{};
+  for (var i = 0; i < 50; i++) {
+    map[a.x] = i;
+    a.add(1);
+  }
+  for (var i = 0; i < 50; i++) {
+    Expect.equals(i, map[kBig + i]);
+  }
+}
+
+class B {
+  int x;
+  B(this.x);
+}
+
+sumX(List<B> list) {
+  var sum = 0;
+  for (var b in list) {
+    sum += b.x;
+  }
+  return sum;
+}
+
+incrementX(List<B> list) {
+  for (var b in list) {
+    b.x = b.x + 1;
+  }
+}
+
+// The guard of B.x starts as Smi and widens to Smi or Mint, so the field is
+// no longer unboxed and the optimized code deoptimizes.
+testSmiToMint() {
+  var list = <B>[];
+  for (var i = 0; i < 10; i++) {
+    list.add(new B(i));
+  }
+  for (var i = 0; i < 50; i++) {
+    Expect.equals(45 + 10 * i, sumX(list));
+    incrementX(list);
+  }
+  list.add(new B(kBig));
+  for (var i = 0; i < 50; i++) {
+    Expect.equals(45 + 500 + 10 * i + kBig + i, sumX(list));
+    incrementX(list);
+  }
+}
+
+class C {
+  int x;
+  C(this.x);
+}
+
+List<C> others = <C>[];
+
+// Stores a Smi or null in the field of another instance on request, which
+// widens the guard of C.x while 'bump' runs.
+widen(int mode) {
+  if (mode == 1) others.add(new C(1));
+  if (mode == 2) others.add(new C(null));
+}
+
+bump(C c, int mode) {
+  var old = c.x;
+  widen(mode);
+  c.x = old + 1;
+  return old;
+}
+
+// Deoptimize code that holds a value loaded from the box, and keep using the
+// box that existed before the guard was widened.
+testDeoptWhileBoxShared(int mode) {
+  others.clear();
+  var c = new C(kBig);
+  var d = new C(kBig);
+  var loaded = <int>[];
+  for (var i = 0; i < 50; i++) {
+    loaded.add(bump(c, 0));
+    d.x = c.x;
+  }
+  var before = c.x;
+  Expect.equals(kBig + 50, before);
+  Expect.equals(kBig + 50, bump(c, mode));
+  Expect.equals(kBig + 51, c.x);
+  Expect.equals(kBig + 50, d.x);
+  Expect.equals(kBig + 50, before);
+  for (var i = 0; i < 50; i++) {
+    Expect.equals(kBig + i, loaded[i]);
+    bump(c, 0);
+  }
+  Expect.equals(kBig + 101, c.x);
+  Expect.equals(kBig + 50, d.x);
+  for (var other in others) {
+    Expect.equals(mode == 1 ? 1 : null, other.x);
+  }
+}
+
+main() {
+  testAliasing();
+  testSharedInitialValue();
+  testMapKeys();
+  testSmiToMint();
+  // Widen to a nullable Mint first, then to Smi or Mint.
+  testDeoptWhileBoxShared(2);
+  testDeoptWhileBoxShared(1);
+}